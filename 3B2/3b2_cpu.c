@@ -2330,6 +2330,9 @@ t_stat sim_instr(void)
 
     stop_reason = 0;
 
+    /* MMU state may have been changed from the console */
+    mmu_xlate_flush();
+
     abort_reason = (uint32) setjmp(save_env);
 
     /* Exception handler.
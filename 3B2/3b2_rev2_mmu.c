@@ -38,6 +38,29 @@ UNIT mmu_unit = { UDATA(NULL, 0, 0) };
 
 MMU_STATE mmu_state;
 
+/*
+ * Host-side translation cache.
+ *
+ * The SDC and PDC are modeled faithfully because software can read
+ * and write them, so they are far too small to keep a multiuser
+ * working set. This direct-mapped cache sits in front of them and
+ * remembers the physical address of a 2K virtual block for a given
+ * access type and CPU mode, but only when a fresh decode of that
+ * block would hit both architectural caches without updating any
+ * R or M bits, trapping, or faulting. A hit therefore has no
+ * architectural side effects to reproduce. Every change to either
+ * architectural cache, and every MMU register write, invalidates
+ * the whole cache by bumping a generation number.
+ */
+typedef struct {
+    uint32 tag;
+    uint32 gen;
+    uint32 pa;
+} MMU_XLATE;
+
+static MMU_XLATE mmu_xlate[MMU_XLATE_SIZE];
+static uint32 mmu_xlate_gen = 1;
+
 REG mmu_reg[] = {
     { HRDATAD (ENABLE, mmu_state.enabled, 1, "Enabled?")        },
     { HRDATAD (CONFIG, mmu_state.conf,   32, "Configuration")   },
@@ -84,6 +107,17 @@ DEVICE mmu_dev = {
     &mmu_description                /* device description */
 };
 
+/*
+ * Invalidate the host-side translation cache.
+ */
+void mmu_xlate_flush()
+{
+    if (++mmu_xlate_gen == 0) {
+        memset(mmu_xlate, 0, sizeof(mmu_xlate));
+        mmu_xlate_gen = 1;
+    }
+}
+
 /*
  * Find an SD in the cache.
  */
@@ -149,6 +183,8 @@ static SIM_INLINE void put_sdce(uint32 va, uint32 sd0, uint32 sd1)
 
     mmu_state.sdcl[ci] = SD_TO_SDCL(va, sd0);
     mmu_state.sdch[ci] = SD_TO_SDCH(sd0, sd1);
+
+    mmu_xlate_flush();
 }
 
 
@@ -197,6 +233,8 @@ static SIM_INLINE void put_pdce(uint32 va, uint32 sd0, uint32 pd)
             mmu_state.pdclh[ci] |= PDCLH_USED_MASK;
         }
     }
+
+    mmu_xlate_flush();
 }
 
 static SIM_INLINE void flush_sdce(uint32 va)
@@ -208,6 +246,8 @@ static SIM_INLINE void flush_sdce(uint32 va)
     if (mmu_state.sdch[ci] & SD_GOOD_MASK) {
         mmu_state.sdch[ci] &= ~SD_GOOD_MASK;
     }
+
+    mmu_xlate_flush();
 }
 
 static SIM_INLINE void flush_pdce(uint32 va)
@@ -231,6 +271,8 @@ static SIM_INLINE void flush_pdce(uint32 va)
     } else if ((pdcrh & PD_GOOD_MASK) && PDCXL_TAG(pdcrl) == tag) {
         mmu_state.pdcrh[ci] &= ~PD_GOOD_MASK;
     }
+
+    mmu_xlate_flush();
 }
 
 static SIM_INLINE void flush_cache_sec(uint8 sec)
@@ -244,6 +286,8 @@ static SIM_INLINE void flush_cache_sec(uint8 sec)
         mmu_state.pdclh[(sec * NUM_PDCE) + i] &= ~PD_GOOD_MASK;
         mmu_state.pdcrh[(sec * NUM_PDCE) + i] &= ~PD_GOOD_MASK;
     }
+
+    mmu_xlate_flush();
 }
 
 static SIM_INLINE void flush_caches()
@@ -299,6 +343,8 @@ static SIM_INLINE void mmu_update_sd(uint32 va, uint32 mask)
     if (mask == SD_M_MASK) {
         mmu_state.sdch[ci] |= mask;
     }
+
+    mmu_xlate_flush();
 }
 
 /*
@@ -334,11 +380,14 @@ static SIM_INLINE void mmu_update_pd(uint32 va, uint32 pd_addr, uint32 mask)
     } else if ((pdcrh & PD_GOOD_MASK) && PDCXL_TAG(pdcrl) == tag) {
         mmu_state.pdcrh[ci] |= mask;
     }
+
+    mmu_xlate_flush();
 }
 
 t_stat mmu_init(DEVICE *dptr)
 {
     flush_caches();
+    mmu_xlate_flush();
     return SCPE_OK;
 }
 
@@ -427,6 +476,8 @@ void mmu_write(uint32 pa, uint32 val, size_t size)
 
     offset = (pa >> 2) & 0x1f;
 
+    mmu_xlate_flush();
+
     switch ((pa >> 8) & 0xf) {
     case MMU_SDCL:
         sim_debug(WRITE_MSG, &mmu_dev,
@@ -786,15 +837,71 @@ t_stat mmu_decode_va(uint32 va, uint8 r_acc, t_bool fc, uint32 *pa)
     }
 }
 
+/*
+ * Enter a translation into the host-side translation cache if the
+ * next decode of any address in the same 2K block, for the same
+ * access type and CPU mode, would be a side-effect-free hit in both
+ * the SDC and PDC.
+ */
+static void mmu_xlate_fill(uint32 va, uint8 r_acc)
+{
+    uint32 sd0, sd1, pd, pa;
+    uint8 pd_acc;
+    MMU_XLATE *xe;
+
+    if (get_sdce(va, &sd0, &sd1) != SCPE_OK) {
+        return;
+    }
+
+    if (SD_PAGED(sd0)) {
+        if (get_pdce(va, &pd, &pd_acc) != SCPE_OK ||
+            !PD_PRESENT(pd) ||
+            mmu_check_perm(pd_acc, r_acc) != SCPE_OK ||
+            (PD_LAST(pd) && (PSL_C(va) | MMU_XLATE_OFF) >= MAX_OFFSET(sd0)) ||
+            ((r_acc == ACC_W || r_acc == ACC_IR) && PD_WFAULT(pd)) ||
+            SHOULD_UPDATE_PD_M_BIT(pd) ||
+            SHOULD_UPDATE_PD_R_BIT(pd)) {
+            return;
+        }
+        pa = PD_ADDR(pd) + POT(va);
+    } else {
+        if (mmu_check_perm(SD_ACC(sd0), r_acc) != SCPE_OK ||
+            (SOT(va) | MMU_XLATE_OFF) >= MAX_OFFSET(sd0) ||
+            SHOULD_UPDATE_SD_R_BIT(sd0) ||
+            SHOULD_UPDATE_SD_M_BIT(sd0) ||
+            SD_TRAP(sd0)) {
+            return;
+        }
+        pa = SD_SEG_ADDR(sd1) + SOT(va);
+    }
+
+    xe = &mmu_xlate[MMU_XLATE_IDX(va, r_acc)];
+    xe->tag = MMU_XLATE_TAG(va, r_acc);
+    xe->gen = mmu_xlate_gen;
+    xe->pa = pa - (va & MMU_XLATE_OFF);
+}
+
 uint32 mmu_xlate_addr(uint32 va, uint8 r_acc)
 {
     uint32 pa;
     t_stat succ;
+    MMU_XLATE *xe;
+
+    if (mmu_state.enabled) {
+        xe = &mmu_xlate[MMU_XLATE_IDX(va, r_acc)];
+        if (xe->gen == mmu_xlate_gen && xe->tag == MMU_XLATE_TAG(va, r_acc)) {
+            mmu_state.var = va;
+            return xe->pa + (va & MMU_XLATE_OFF);
+        }
+    }
 
     succ = mmu_decode_va(va, r_acc, TRUE, &pa);
 
     if (succ == SCPE_OK) {
         mmu_state.var = va;
+        if (mmu_state.enabled) {
+            mmu_xlate_fill(va, r_acc);
+        }
         return pa;
     } else {
         cpu_abort(NORMAL_EXCEPTION, EXTERNAL_MEMORY_FAULT);
@@ -807,6 +914,7 @@ void mmu_enable()
     sim_debug(EXECUTE_MSG, &mmu_dev,
               "Enabling MMU.\n");
     mmu_state.enabled = TRUE;
+    mmu_xlate_flush();
 }
 
 void mmu_disable()
@@ -814,6 +922,7 @@ void mmu_disable()
     sim_debug(EXECUTE_MSG, &mmu_dev,
               "Disabling MMU.\n");
     mmu_state.enabled = FALSE;
+    mmu_xlate_flush();
 }
 
 CONST char *mmu_description(DEVICE *dptr)
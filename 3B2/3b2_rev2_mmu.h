@@ -181,6 +181,13 @@
 /* Index of entry in the PD cache */
 #define PD_IDX(vaddr)     (((vaddr >> 11) & 3) | ((vaddr >> 15) & 4))
 
+/* Host-side translation cache, indexed and tagged by 2K virtual
+   block, access type, and CPU mode */
+#define MMU_XLATE_SIZE    1024
+#define MMU_XLATE_OFF     0x7ffu
+#define MMU_XLATE_IDX(va, r_acc) ((((va) >> 11) ^ ((uint32)(r_acc) << 6)) & (MMU_XLATE_SIZE - 1))
+#define MMU_XLATE_TAG(va, r_acc) (((va) & ~MMU_XLATE_OFF) | ((uint32)(r_acc) << 2) | (CPU_CM))
+
 /* Shift and mask the flag bits for the current CPU mode */
 #define MMU_PERM(f)  ((f >> ((3 - CPU_CM) * 2)) & 3)
 
@@ -325,6 +332,7 @@ CONST char *mmu_description(DEVICE *dptr);
 
 /* Virtual memory translation */
 uint32 mmu_xlate_addr(uint32 va, uint8 r_acc);
+void   mmu_xlate_flush();
 t_stat mmu_decode_vaddr(uint32 vaddr, uint8 r_acc,
                         t_bool fc, uint32 *pa);
 
@@ -38,6 +38,30 @@ UNIT mmu_unit = { UDATA(NULL, 0, 0) };
 
 MMU_STATE mmu_state;
 
+/*
+ * Host-side translation cache.
+ *
+ * The SDC and PDC are visible to software, so they are modeled
+ * exactly, and a PDC hit costs a scan of all 64 entries. This
+ * direct-mapped cache remembers the physical address of a 2K
+ * virtual block for a given access type and CPU mode, together
+ * with the PDC entry it came from, but only when a fresh decode
+ * of that block would hit in the PDC without updating any R or M
+ * bits or faulting. The only architectural effect of such a hit is
+ * setting the entry's U bit, which is reproduced. Every change to
+ * either architectural cache, and every MMU register write,
+ * invalidates the whole cache by bumping a generation number.
+ */
+typedef struct {
+    uint32 tag;
+    uint32 gen;
+    uint32 pa;
+    uint32 pdc_idx;
+} MMU_XLATE;
+
+static MMU_XLATE mmu_xlate[MMU_XLATE_SIZE];
+static uint32 mmu_xlate_gen = 1;
+
 REG mmu_reg[] = {
     { HRDATAD (ENABLE, mmu_state.enabled, 1, "Enabled?")        },
     { HRDATAD (CONFIG, mmu_state.conf,   32, "Configuration")   },
@@ -152,6 +176,17 @@ uint32 pd_psl_masks[4] = {
 
 #define PDC_TAG(VA)     (MMU_CONF_MCE ? PDC_MTAG(VA) : PDC_STAG(VA))
 
+/*
+ * Invalidate the host-side translation cache.
+ */
+void mmu_xlate_flush()
+{
+    if (++mmu_xlate_gen == 0) {
+        memset(mmu_xlate, 0, sizeof(mmu_xlate));
+        mmu_xlate_gen = 1;
+    }
+}
+
 /*
  * Retrieve a Segment Descriptor from the SD cache. The Segment
  * Descriptor Cache entry is returned in sd_lo and sd_hi, if found.
@@ -187,6 +222,8 @@ static void put_sdce(uint32 va, uint32 sd_hi, uint32 sd_lo)
     mmu_state.sdch[ci] = SD_TO_SDCH(sd_hi, sd_lo);
     mmu_state.sdcl[ci] = SD_TO_SDCL(sd_lo, va);
 
+    mmu_xlate_flush();
+
     sim_debug(MMU_CACHE_DBG, &mmu_dev,
               "CACHED SD AT IDX %d. va=%08x sd_hi=%08x sd_lo=%08x sdc_hi=%08x sdc_lo=%08x\n",
               ci, va, sd_hi, sd_lo, mmu_state.sdch[ci], mmu_state.sdcl[ci]);
@@ -273,6 +310,8 @@ static uint32 put_pdce(uint32 va, uint32 sd_lo, uint32 pd)
 {
     uint32 i;
 
+    mmu_xlate_flush();
+
     /*
      * If all the U bits have been set, flush them all EXCEPT the most
      * recently cached entry.
@@ -322,6 +361,8 @@ static void flush_pdc(uint32 va)
 {
     uint32 i, j, key_tag, target_tag;
 
+    mmu_xlate_flush();
+
     /* Flush the PDC. This is a fully associative cache, so we must
      * scan for an entry with the correct tag. */
 
@@ -373,6 +414,8 @@ static void flush_caches()
     sim_debug(MMU_CACHE_DBG, &mmu_dev,
               "Flushing MMU PDC and SDC\n");
 
+    mmu_xlate_flush();
+
     for (i = 0; i < MMU_SDCS; i++) {
         mmu_state.sdch[i] &= ~SDC_G_MASK;
     }
@@ -420,6 +463,7 @@ static t_stat mmu_check_perm(uint8 flags, uint8 r_acc)
 t_stat mmu_init(DEVICE *dptr)
 {
     flush_caches();
+    mmu_xlate_flush();
     return SCPE_OK;
 }
 
@@ -542,6 +586,8 @@ void mmu_write(uint32 pa, uint32 val, size_t size)
 {
     uint32 index, entity, i;
 
+    mmu_xlate_flush();
+
     /* Register entity */
     entity = ((uint8)(pa >> 8)) & 0xf;
 
@@ -707,6 +753,7 @@ static t_stat mmu_update_history(uint32 va, uint8 r_acc, uint32 pdc_idx, t_bool
     if (MMU_CONF_M && r_acc == ACC_W && (mmu_state.sdcl[SDC_IDX(va)] & SDC_M_MASK) == 0) {
         if (update_sdc) {
             mmu_state.sdcl[SDC_IDX(va)] |= SDC_M_MASK;
+            mmu_xlate_flush();
         }
 
         if (mmu_check_perm(SD_ACC(sd_lo), r_acc) != SCPE_OK) {
@@ -722,6 +769,7 @@ static t_stat mmu_update_history(uint32 va, uint8 r_acc, uint32 pdc_idx, t_bool
     if (MMU_CONF_R && (mmu_state.sdcl[SDC_IDX(va)] & SDC_R_MASK) == 0) {
         if (update_sdc) {
             mmu_state.sdcl[SDC_IDX(va)] |= SDC_R_MASK;
+            mmu_xlate_flush();
         }
 
         if (mmu_check_perm(SD_ACC(sd_lo), r_acc) != SCPE_OK) {
@@ -739,12 +787,14 @@ static t_stat mmu_update_history(uint32 va, uint8 r_acc, uint32 pdc_idx, t_bool
 
         if (r_acc == ACC_W && (mmu_state.pdcl[pdc_idx] & PDC_M_MASK) == 0) {
             mmu_state.pdcl[pdc_idx] |= PDC_M_MASK;
+            mmu_xlate_flush();
             pd = pread_w(pd_addr, BUS_PER);
             pwrite_w(pd_addr, pd | PD_M_MASK, BUS_PER);
         }
 
         if ((mmu_state.pdcl[pdc_idx] & PDC_R_MASK) == 0) {
             mmu_state.pdcl[pdc_idx] |= PDC_R_MASK;
+            mmu_xlate_flush();
             pd = pread_w(pd_addr, BUS_PER);
             pwrite_w(pd_addr, pd | PD_R_MASK, BUS_PER);
         }
@@ -1032,6 +1082,54 @@ t_stat mmu_decode_va(uint32 va, uint8 r_acc, t_bool fc, uint32 *pa)
     return SCPE_OK;
 }
 
+/*
+ * Enter a translation into the host-side translation cache if the
+ * next decode of any address in the same 2K block, for the same
+ * access type and CPU mode, would hit in the PDC without updating
+ * R or M bits or faulting.
+ */
+static void mmu_xlate_fill(uint32 va, uint8 r_acc)
+{
+    uint32 i, key_tag, pdcl, sdcl, pd;
+    MMU_XLATE *xe;
+
+    if (MMU_CONF_PS > 2) {
+        return;
+    }
+
+    /* Find the entry that get_pdce() would, without touching U */
+    key_tag = PDC_TAG(va) & PDC_TAG_MASK;
+
+    for (i = 0; i < MMU_PDCS; i++) {
+        if ((mmu_state.pdch[i] & PDC_TAG_MASK) == key_tag) {
+            break;
+        }
+    }
+
+    if (i == MMU_PDCS) {
+        return;
+    }
+
+    pdcl = mmu_state.pdcl[i];
+    sdcl = mmu_state.sdcl[SDC_IDX(va)];
+    pd = PDCE_TO_PD(pdcl);
+
+    if (mmu_check_perm((pdcl >> 24) & 0xff, r_acc) != SCPE_OK ||
+        (r_acc == ACC_W && (pd & PD_W_MASK)) ||
+        (MMU_CONF_M && r_acc == ACC_W && (sdcl & SDC_M_MASK) == 0) ||
+        (MMU_CONF_R && (sdcl & SDC_R_MASK) == 0) ||
+        (r_acc == ACC_W && (pdcl & PDC_M_MASK) == 0) ||
+        (pdcl & PDC_R_MASK) == 0) {
+        return;
+    }
+
+    xe = &mmu_xlate[MMU_XLATE_IDX(va, r_acc)];
+    xe->tag = MMU_XLATE_TAG(va, r_acc);
+    xe->gen = mmu_xlate_gen;
+    xe->pa = PD_ADDR(pd) + POT(va) - (va & MMU_XLATE_OFF);
+    xe->pdc_idx = i;
+}
+
 /*
  * Translate a virtual address into a physical address.
  *
@@ -1042,12 +1140,27 @@ uint32 mmu_xlate_addr(uint32 va, uint8 r_acc)
 {
     uint32 pa;
     t_stat succ;
+    MMU_XLATE *xe;
+
+    if (mmu_state.enabled && !(mmu_dev.dctrl & MMU_TRACE_DBG)) {
+        xe = &mmu_xlate[MMU_XLATE_IDX(va, r_acc)];
+        if (xe->gen == mmu_xlate_gen && xe->tag == MMU_XLATE_TAG(va, r_acc)) {
+            if ((mmu_state.pdch[xe->pdc_idx] & PDC_U_MASK) == 0) {
+                set_u_bit(xe->pdc_idx);
+            }
+            mmu_state.var = va;
+            return xe->pa + (va & MMU_XLATE_OFF);
+        }
+    }
 
     succ = mmu_decode_va(va, r_acc, TRUE, &pa);
 
     mmu_state.var = va;
 
     if (succ == SCPE_OK) {
+        if (mmu_state.enabled) {
+            mmu_xlate_fill(va, r_acc);
+        }
         return pa;
     } else {
         cpu_abort(NORMAL_EXCEPTION, EXTERNAL_MEMORY_FAULT);
@@ -1061,6 +1174,7 @@ uint32 mmu_xlate_addr(uint32 va, uint8 r_acc)
 void mmu_enable()
 {
     mmu_state.enabled = TRUE;
+    mmu_xlate_flush();
 }
 
 /*
@@ -1069,6 +1183,7 @@ void mmu_enable()
 void mmu_disable()
 {
     mmu_state.enabled = FALSE;
+    mmu_xlate_flush();
 }
 
 CONST char *mmu_description(DEVICE *dptr)
@@ -67,6 +67,13 @@
 /* Shift and mask the flag bits for the current CPU mode */
 #define MMU_PERM(f)     ((f >> ((3 - (CPU_CM)) * 2)) & 3)
 
+/* Host-side translation cache, indexed and tagged by 2K virtual
+   block, access type, and CPU mode */
+#define MMU_XLATE_SIZE  1024
+#define MMU_XLATE_OFF   0x7ffu
+#define MMU_XLATE_IDX(va, r_acc) ((((va) >> 11) ^ ((uint32)(r_acc) << 6)) & (MMU_XLATE_SIZE - 1))
+#define MMU_XLATE_TAG(va, r_acc) (((va) & ~MMU_XLATE_OFF) | ((uint32)(r_acc) << 2) | (CPU_CM))
+
 /* Codes set in the MMU Fault register */
 #define MMU_F_MISS_MEM           1
 #define MMU_F_RM_UPD             2
@@ -344,6 +351,7 @@ CONST char *mmu_description(DEVICE *dptr);
 
 /* Virtual memory translation */
 uint32 mmu_xlate_addr(uint32 va, uint8 r_acc);
+void   mmu_xlate_flush();
 t_stat mmu_decode_vaddr(uint32 vaddr, uint8 r_acc,
                         t_bool fc, uint32 *pa);
 
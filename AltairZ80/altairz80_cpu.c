@@ -1851,6 +1851,44 @@ static MDEV RAM_PAGE    =   {TRUE,  FALSE,  NULL, "RAM"};       /* this makes a
 static MDEV EMPTY_PAGE  =   {FALSE, TRUE,   NULL, "NONEXIST"};  /* this is non-existing memory  */
 static MDEV mmu_table[MAXMEMORY >> LOG2PAGESIZE];
 
+/* Host pointers to the pages of M which can be accessed directly: RAM and ROM
+   pages for reading, RAM pages for writing. NULL means the access has to go
+   through mmu_table (memory mapped I/O, non existing memory, writes to ROM).
+   mmu_host_read/write are indexed by the physical page and used for the
+   extended (8086 and DMA) accesses. mmu_bank_read/write hold the same
+   pointers for the 64KB address space of the 8080/Z80 as seen with each bank
+   selected, with the common area already resolved, so that GetBYTE/PutBYTE
+   just index the row of the selected bank. The tables are rebuilt by
+   mmu_rebuild whenever mmu_table or the banking configuration changes. */
+static uint8 *mmu_host_read[MAXMEMORY >> LOG2PAGESIZE];
+static uint8 *mmu_host_write[MAXMEMORY >> LOG2PAGESIZE];
+static uint8 *mmu_bank_read[MAXBANKS][MAXBANKSIZE >> LOG2PAGESIZE];
+static uint8 *mmu_bank_write[MAXBANKS][MAXBANKSIZE >> LOG2PAGESIZE];
+static uint8 **mmu_read  = mmu_bank_read[0];    /* row of the selected bank   */
+static uint8 **mmu_write = mmu_bank_write[0];
+static uint32 mmu_banked, mmu_common, mmu_common_low;   /* configuration of last rebuild */
+
+static void mmu_rebuild(void) {
+    uint32 page, bank, addr;
+    for (page = 0; page < (MAXMEMORY >> LOG2PAGESIZE); page++) {
+        const MDEV *m = &mmu_table[page];
+        uint8 *host = M + (page << LOG2PAGESIZE);
+        mmu_host_write[page] = m->isRAM ? host : NULL;
+        mmu_host_read[page] = (m->isRAM || (!m->isEmpty && (m->routine == NULL))) ? host : NULL;
+    }
+    mmu_banked = cpu_unit.flags & UNIT_CPU_BANKED;
+    mmu_common = common;
+    mmu_common_low = common_low;
+    for (bank = 0; bank < MAXBANKS; bank++)
+        for (page = 0; page < (MAXBANKSIZE >> LOG2PAGESIZE); page++) {
+            addr = page << LOG2PAGESIZE;
+            if (mmu_banked && (((common_low == 0) && (addr < common)) || ((common_low == 1) && (addr >= common))))
+                addr |= bank << MAXBANKSIZELOG2;
+            mmu_bank_read[bank][page] = mmu_host_read[addr >> LOG2PAGESIZE];
+            mmu_bank_write[bank][page] = mmu_host_write[addr >> LOG2PAGESIZE];
+        }
+}
+
 /* Memory and I/O Resource Mapping and Unmapping routine. */
 uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
                         int32 (*routine)(const int32, const int32, const int32), const char* name, uint8 unmap) {
@@ -1880,6 +1918,7 @@ uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
                 mmu_table[page].name = name;
             }
         }
+        mmu_rebuild();
     } else if (resource_type == RESOURCE_TYPE_IO) {
         for (i = baseaddr; i < baseaddr + size; i++)
             if (unmap) {
@@ -1904,8 +1943,14 @@ uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
 
 static void PutBYTE(register uint32 Addr, const register uint32 Value) {
     MDEV m;
+    uint8 *p;
 
     Addr &= ADDRMASK;   /* registers are NOT guaranteed to be always 16-bit values */
+    p = mmu_write[Addr >> LOG2PAGESIZE];
+    if (p != NULL) {    /* RAM */
+        p[Addr & (PAGESIZE - 1)] = Value;
+        return;
+    }
     if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
         Addr |= bankSelect << MAXBANKSIZELOG2;
 
@@ -1925,8 +1970,14 @@ static void PutBYTE(register uint32 Addr, const register uint32 Value) {
 
 void PutBYTEExtended(register uint32 Addr, const register uint32 Value) {
     MDEV m;
+    uint8 *p;
 
     Addr &= ADDRMASKEXTENDED;
+    p = mmu_host_write[Addr >> LOG2PAGESIZE];
+    if (p != NULL) {    /* RAM */
+        p[Addr & (PAGESIZE - 1)] = Value;
+        return;
+    }
     m = mmu_table[Addr >> LOG2PAGESIZE];
 
     if (m.isRAM)
@@ -1948,8 +1999,12 @@ static void PutWORD(register uint32 Addr, const register uint32 Value) {
 
 static uint32 GetBYTE(register uint32 Addr) {
     MDEV m;
+    const uint8 *p;
 
     Addr &= ADDRMASK;   /* registers are NOT guaranteed to be always 16-bit values */
+    p = mmu_read[Addr >> LOG2PAGESIZE];
+    if (p != NULL)      /* RAM or ROM */
+        return p[Addr & (PAGESIZE - 1)];
     if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
         Addr |= bankSelect << MAXBANKSIZELOG2;
     m = mmu_table[Addr >> LOG2PAGESIZE];
@@ -1968,8 +2023,12 @@ static uint32 GetBYTE(register uint32 Addr) {
 
 uint32 GetBYTEExtended(register uint32 Addr) {
     MDEV m;
+    const uint8 *p;
 
     Addr &= ADDRMASKEXTENDED;
+    p = mmu_host_read[Addr >> LOG2PAGESIZE];
+    if (p != NULL)      /* RAM or ROM */
+        return p[Addr & (PAGESIZE - 1)];
     m = mmu_table[Addr >> LOG2PAGESIZE];
 
     if (m.isRAM)
@@ -1990,6 +2049,11 @@ int32 getBankSelect(void) {
 
 void setBankSelect(const int32 b) {
     bankSelect = b;
+    if ((mmu_banked != (cpu_unit.flags & UNIT_CPU_BANKED)) ||
+        (mmu_common != common) || (mmu_common_low != common_low))
+        mmu_rebuild();  /* banking configuration has changed */
+    mmu_read = mmu_bank_read[b & BANKMASK];
+    mmu_write = mmu_bank_write[b & BANKMASK];
 }
 
 uint32 getCommon(void) {
@@ -2113,6 +2177,8 @@ int32 switch_cpu_now = TRUE;
 
 t_stat sim_instr (void) {
     t_stat result;
+    mmu_rebuild();      /* pick up configuration changes made while stopped */
+    setBankSelect(bankSelect);
     if (chiptype == CHIP_TYPE_M68K) {
         result = sim_instr_m68k();
     } else if ((chiptype == CHIP_TYPE_8086) || (cpu_unit.flags & UNIT_CPU_MMU))
@@ -6495,6 +6561,8 @@ t_stat install_bootrom(const int32 bootrom[], const int32 size, const int32 addr
             mmu_table[(i + addr) >> LOG2PAGESIZE] = ROM_PAGE;
         M[i + addr] = bootrom[i] & 0xff;
     }
+    if (makeROM)
+        mmu_rebuild();
     return SCPE_OK;
 }
 
@@ -6704,6 +6772,7 @@ static void cpu_clear(void) {
         mmu_table[i] = RAM_PAGE;
     for (i = (MEMORYSIZE >> LOG2PAGESIZE); i < (MAXMEMORY >> LOG2PAGESIZE); i++)
         mmu_table[i] = EMPTY_PAGE;
+    mmu_rebuild();
     if (cpu_unit.flags & UNIT_CPU_ALTAIRROM)
         install_ALTAIRbootROM();
     m68k_clear_memory();
@@ -6723,6 +6792,7 @@ static t_stat cpu_set_altairrom(UNIT *uptr, int32 value, CONST char *cptr, void
 static t_stat cpu_set_noaltairrom(UNIT *uptr, int32 value, CONST char *cptr, void *desc) {
     mmu_table[ALTAIR_ROM_LOW >> LOG2PAGESIZE] = MEMORYSIZE < MAXBANKSIZE ?
         EMPTY_PAGE : RAM_PAGE;
+    mmu_rebuild();
     return SCPE_OK;
 }
 
@@ -7337,6 +7407,8 @@ t_stat sim_load(FILE *fileref, CONST char *cptr, CONST char *fnam, int flag) {
             addr++;
             cnt++;
         } /* end while */
+        if (pagesModified || makeROM)
+            mmu_rebuild();
         sim_printf("%d byte%s [%d page%s] loaded at %x%s.\n", PLURAL(cnt),
             PLURAL((cnt + 0xff) >> 8), org, makeROM ? " [ROM]" : "");
         if (pagesModified)
@@ -854,7 +854,7 @@ static t_stat cmd_show (int32 num, CONST char *cptr)
     if (strncmp ("STATISTICS", gbuf, len) == 0) {
         sprintf (gbuf, "line %d: input queued/total = %d/%d, "
                  "output queued/total = %d/%d\r\n", num,
-                 t->rxbpi - t->rxbpr, t->rxcnt,
+                 tmxr_input_pending_ln (t), t->rxcnt,
                  t->txbpi - t->txbpr, t->txcnt);
         tmxr_linemsg (t, gbuf);
     } else {
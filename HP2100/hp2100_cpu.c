@@ -2010,6 +2010,7 @@ if (initialize_io (TRUE) == FALSE)                      /* set up the I/O table;
     return SCPE_STOP;                                   /*   then inhibit execution */
 
 mp_is_present = mp_initialize ();                       /* set up memory protect */
+meu_update_pages ();                                    /*   and the memory expansion fast access tables */
 
 exec_save = 0;                                          /* clear the EXEC match */
 idle_save = 0;                                          /*   and idle match trace flags */
@@ -4006,6 +4007,8 @@ else if (!currently_enabled && enable == 1) {           /* otherwise if the disa
     mem_end = mem_size;                                 /*     and increase available memory */
     }
 
+meu_update_pages ();                                    /* update the fast access tables for the new memory limit */
+
 return SCPE_OK;
 }
 
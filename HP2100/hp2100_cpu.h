@@ -87,7 +87,8 @@
 
    These macros provide simplified function call sequences for memory reads and
    writes by the CPU.  They supply the correct access classification.  The
-   following macro routines are provided:
+   current map fetch, read, and write macros use the fast accessors declared in
+   hp2100_cpu_dmm.h.  The following macro routines are provided:
 
      Name     Action
      -------  ------------------------------------------------------------
@@ -109,8 +110,8 @@
      WriteBA  Write a data byte using the alternate map
 */
 
-#define ReadF(a)            mem_read (&cpu_dev, Fetch, a)
-#define ReadW(a)            mem_read (&cpu_dev, Data, a)
+#define ReadF(a)            mem_fetch_fast (a)
+#define ReadW(a)            mem_read_data_fast (a)
 #define ReadWA(a)           mem_read (&cpu_dev, Data_Alternate, a)
 #define ReadS(a)            mem_read (&cpu_dev, Data_System, a)
 #define ReadU(a)            mem_read (&cpu_dev, Data_User, a)
@@ -118,7 +119,7 @@
 #define ReadB(a)            mem_read_byte (&cpu_dev, Data, a)
 #define ReadBA(a)           mem_read_byte (&cpu_dev, Data_Alternate, a)
 
-#define WriteW(a,v)         mem_write (&cpu_dev, Data, a, v)
+#define WriteW(a,v)         mem_write_data_fast (a, v)
 #define WriteWA(a,v)        mem_write (&cpu_dev, Data_Alternate, a, v)
 #define WriteS(a,v)         mem_write (&cpu_dev, Data_System, a, v)
 #define WriteU(a,v)         mem_write (&cpu_dev, Data_User, a, v)
@@ -142,10 +142,15 @@ typedef enum {                                  /* MEM operational state */
 extern char   meu_indicator;                    /* last map access indicator (S | U | A | B | -) */
 extern uint32 meu_page;                         /* last physical page number accessed */
 
+extern MEMORY_WORD **meu_read_page;             /* current map fast read page table */
+extern MEMORY_WORD **meu_write_page;            /* current map fast write page table */
+
 
 /* Memory Protect global state */
 
-extern HP_WORD mp_fence;                        /* memory protect fence register */
+extern HP_WORD   mp_fence;                      /* memory protect fence register */
+extern HP_WORD   mp_VR;                         /* memory protect violation register */
+extern FLIP_FLOP mp_evrff;                      /* enable violation register flip-flop */
 
 
 /* I/O subsystem global utility routine declarations */
@@ -188,6 +193,7 @@ extern void    meu_set_state        (MEU_STATE operation, MEU_MAP_SELECTOR map);
 extern HP_WORD meu_update_status    (void);
 extern HP_WORD meu_update_violation (void);
 extern void    meu_assert_IAK       (void);
+extern void    meu_update_pages     (void);
 extern void    meu_privileged       (MEU_CONDITION condition);
 extern uint32  meu_breakpoint_type  (t_bool is_iak);
 extern uint32  meu_map_address      (HP_WORD logical, int32 switches);
@@ -205,3 +211,84 @@ extern void   mp_disable             (void);
 extern t_bool mp_is_on               (void);
 extern t_bool mp_reenable_interrupts (void);
 extern t_bool mp_trace_violation     (void);
+
+
+
+/* Fast CPU memory accessors.
+
+   These routines provide the CPU with fast paths for the most common memory
+   accesses: instruction fetches and data reads and writes using the current
+   map.  Each access is satisfied directly from the memory array if the fast
+   access page table for the current map has an entry for the logical page (see
+   the table description in hp2100_mem.c), and memory tracing is not enabled.
+   Otherwise, the access is passed to the "mem_read" or "mem_write" routine.
+   The CPU register and MP Violation Register side effects are identical in
+   either case.
+
+   A write is permitted by the fast path only if it is at or above the MP fence,
+   so that the full routine may check for MP violations.  The fence need not
+   be checked when MP is off, but doing so keeps the test short.
+
+
+   Implementation notes:
+
+    1. The map indicator and physical page number retained for tracing are not
+       updated by the fast paths, as they are reported only when tracing is
+       enabled.
+
+    2. The logical address is checked against the 32K logical address space
+       limit, because the unmapped paths of the full routines use the supplied
+       address without masking.
+*/
+
+#define FAST_ACCESS(a)      ((sim_deb == NULL || cpu_dev.dctrl == 0) && (a) <= LA_MAX)
+
+static SIM_INLINE HP_WORD mem_fetch_fast (HP_WORD address)
+{
+MEMORY_WORD *page;
+
+if (FAST_ACCESS (address) && (page = meu_read_page [PAGE (address)]) != NULL) {
+    MR = address;                                       /* save the logical memory address */
+
+    if (mp_evrff)                                       /* if the violation register is enabled */
+        mp_VR = address;                                /*   then update it with the instruction address */
+
+    return TR = (HP_WORD) page [address & OF_MASK];     /* return the instruction word */
+    }
+
+else                                                    /* otherwise */
+    return mem_read (&cpu_dev, Fetch, address);         /*   the full read routine is required */
+}
+
+
+static SIM_INLINE HP_WORD mem_read_data_fast (HP_WORD address)
+{
+MEMORY_WORD *page;
+
+if (FAST_ACCESS (address) && (page = meu_read_page [PAGE (address)]) != NULL) {
+    MR = address;                                       /* save the logical memory address */
+    return TR = (HP_WORD) page [address & OF_MASK];     /*   and return the data word */
+    }
+
+else                                                    /* otherwise */
+    return mem_read (&cpu_dev, Data, address);          /*   the full read routine is required */
+}
+
+
+static SIM_INLINE void mem_write_data_fast (HP_WORD address, HP_WORD value)
+{
+MEMORY_WORD *page;
+
+if (FAST_ACCESS (address) && address >= mp_fence
+  && (page = meu_write_page [PAGE (address)]) != NULL) {
+    MR = address;                                       /* save the logical memory address */
+    TR = value;                                         /*   and the value to be written */
+
+    page [address & OF_MASK] = (MEMORY_WORD) value;     /* write the value to memory */
+    }
+
+else                                                    /* otherwise */
+    mem_write (&cpu_dev, Data, address, value);         /*   the full write routine is required */
+
+return;
+}
@@ -463,6 +463,46 @@ static HP_WORD          meu_violation   = 0;                /* the MEM violation
 static HP_WORD          meu_maps [MAP_COUNT] [REG_COUNT];   /* the MEM map registers */
 
 
+/* Memory Expansion Unit fast access page tables.
+
+   The CPU reads and writes memory through the "mem_fetch_fast",
+   "mem_read_data_fast", and "mem_write_data_fast" routines in hp2100_cpu_dmm.h.
+   These bypass the general "mem_read" and "mem_write" routines for accesses
+   that cannot cause a protection violation or an A/B-register reference.  To
+   do this, a table for each of the system and user maps holds the host address
+   of the first word of the physical page mapped to each logical page.  Entries
+   are NULL for pages that must take the full path, i.e., for:
+
+     - logical page 0, which contains the A/B-registers, the base-page fence,
+       and the MP lower bound
+
+     - physical page 0, which contains the A/B-registers
+
+     - read-protected pages (read table) and write-protected pages (write
+       table)
+
+     - pages that extend beyond the end of defined memory (write table)
+
+   If the MEU is disabled, each logical page maps to the same physical page
+   without protection.  The "meu_read_page" and "meu_write_page" pointers
+   select the tables corresponding to the current map.
+
+   The tables must be kept consistent with the map registers, the MEU enabled
+   state, the current map, and the memory size.  Changes made by the CPU are
+   tracked by the routines that make them.  Changes made by the user via SCP
+   commands are picked up when the "meu_update_pages" routine is called by the
+   CPU instruction prelude.
+*/
+
+#define FAST_MAP_COUNT      (User_Map + 1)      /* the system and user maps have tables */
+
+static MEMORY_WORD *meu_read_pages  [FAST_MAP_COUNT] [REG_COUNT];   /* the read access page tables */
+static MEMORY_WORD *meu_write_pages [FAST_MAP_COUNT] [REG_COUNT];   /* the write access page tables */
+
+MEMORY_WORD **meu_read_page  = meu_read_pages  [System_Map];        /* the current map read access table */
+MEMORY_WORD **meu_write_page = meu_write_pages [System_Map];        /* the current map write access table */
+
+
 /* Memory Expansion Unit local SCP support routine declarations */
 
 static t_stat meu_reset (DEVICE *dptr);
@@ -471,6 +511,8 @@ static t_stat meu_reset (DEVICE *dptr);
 /* Memory Expansion Unit local utility routine declarations */
 
 static void   dm_violation (HP_WORD violation);
+static void   set_page     (MEU_MAP_SELECTOR map, uint32 index);
+static void   select_pages (void);
 static t_bool is_mapped    (HP_WORD address);
 static uint32 map_address  (HP_WORD address, MEU_MAP_SELECTOR map, HP_WORD protection);
 
@@ -571,12 +613,12 @@ HP_WORD mp_fence = 0;                           /* MP fence register */
 
 /* Memory Protect local state declarations */
 
-static HP_WORD   mp_VR          = 0;            /* MP violation register */
+HP_WORD          mp_VR          = 0;            /* MP violation register */
 static FLIP_FLOP mp_control     = CLEAR;        /* MP control flip-flop */
 static FLIP_FLOP mp_flag_buffer = CLEAR;        /* MP flag buffer flip-flop */
 static FLIP_FLOP mp_flag        = CLEAR;        /* MP flag flip-flop */
 static FLIP_FLOP mp_mevff       = CLEAR;        /* memory expansion violation flip-flop */
-static FLIP_FLOP mp_evrff       = SET;          /* enable violation register flip-flop */
+FLIP_FLOP        mp_evrff       = SET;          /* enable violation register flip-flop */
 static FLIP_FLOP mp_enabled     = CLEAR;        /* MP was enabled at interrupt */
 static FLIP_FLOP mp_reenable    = CLEAR;        /* MP will be reenabled after IAK */
 static t_bool    mp_mem_changed = TRUE;         /* TRUE if the MP or MEM registers have been altered */
@@ -1376,12 +1418,15 @@ else                                                    /* otherwise */
 
 void meu_write_map (MEU_MAP_SELECTOR map, uint32 index, uint32 value)
 {
-if (map == Linear_Map)                                      /* if linear access is specified */
-    meu_maps [index / REG_COUNT & MAP_MASK]                 /*   then use the upper index bits for the map */
-             [index % REG_COUNT] = value & ~MAP_RESERVED;   /*     and the lower index bits for the register */
+if (map == Linear_Map) {                                    /* if linear access is specified */
+    map = TO_MAP_SELECTOR (index / REG_COUNT);              /*   then use the upper index bits for the map */
+    index = index % REG_COUNT;                              /*     and the lower index bits for the register */
+    }
 
-else                                                        /* otherwise */
-    meu_maps [map] [index] = value & ~MAP_RESERVED;         /*   write to the specified map and register */
+meu_maps [map] [index] = value & ~MAP_RESERVED;             /* write to the specified map and register */
+
+if (map < FAST_MAP_COUNT)                                   /* if the map has a fast access table */
+    set_page (map, index);                                  /*   then update the entry for the register */
 
 return;
 }
@@ -1413,6 +1458,8 @@ return;
 
 void meu_set_state (MEU_STATE operation, MEU_MAP_SELECTOR map)
 {
+const HP_WORD was_enabled = meu_status & MEST_ENABLED;  /* the MEM enabled state before the change */
+
 if (operation == ME_Enabled)                            /* if the MEM is being enabled */
     meu_status |= MEST_ENABLED;                         /*   then set the MEM enabled status bit */
 
@@ -1424,6 +1471,34 @@ else {                                                  /* otherwise disable the
 meu_current_map = map;                                  /* set the current map in either case */
 mp_mem_changed = TRUE;                                  /*   and set the MP/MEM registers changed flag */
 
+if ((meu_status & MEST_ENABLED) != was_enabled)         /* if mapping was turned on or off */
+    meu_update_pages ();                                /*   then rebuild the fast access tables */
+else                                                    /* otherwise */
+    select_pages ();                                    /*   just select the tables for the current map */
+
+return;
+}
+
+
+/* Update the fast access page tables.
+
+   This routine rebuilds the fast memory access tables for the system and user
+   maps from the current MEU state and memory size and then selects the tables
+   for the current map.  It is called whenever more than a single map register
+   may have changed, e.g., when the MEU is enabled or disabled, or when the
+   user may have changed the MEU registers or memory size from the SCP prompt.
+*/
+
+void meu_update_pages (void)
+{
+uint32 map, index;
+
+for (map = System_Map; map < FAST_MAP_COUNT; map++)             /* for each map with a fast access table */
+    for (index = 0; index < REG_COUNT; index++)                 /*   and each register in that map */
+        set_page ((MEU_MAP_SELECTOR) map, index);               /*     set the corresponding table entries */
+
+select_pages ();                                                /* select the tables for the current map */
+
 return;
 }
 
@@ -1540,6 +1615,7 @@ if (TRACING (cpu_dev, TRACE_INSTR))                     /* if instruction tracin
     map_address (PR, meu_current_map, NO_PROTECTION);   /*   then set the MEM page and indicator */
 
 meu_current_map = System_Map;                           /* switch to the system map for the interrupt */
+select_pages ();                                        /*   and select its fast access tables */
 
 mp_mem_changed = TRUE;                                  /* set the MP/MEM registers changed flag */
 
@@ -1676,6 +1752,8 @@ meu_current_map = System_Map;                           /* enable the system map
 meu_status = 0;                                         /* disable MEM and clear the status register */
 meu_violation = 0;                                      /* clear the violation register */
 
+meu_update_pages ();                                    /* rebuild the fast access tables for the unmapped state */
+
 mp_mem_changed = TRUE;                                  /* set the MP/MEM registers changed flag */
 
 return SCPE_OK;
@@ -1709,6 +1787,72 @@ return;
 }
 
 
+/* Set the fast access page table entries for a map register.
+
+   This routine sets the read and write fast access table entries for the
+   logical page corresponding to register "index" of "map", which must be the
+   system or the user map.  If the MEU is enabled, the entries point at the
+   physical page designated by the map register, unless the register protects
+   the page against the corresponding access.  If the MEU is disabled, the
+   entries point at the physical page with the same number as the logical page.
+   Entries for pages that require the full "mem_read" or "mem_write" processing
+   are set to NULL.
+
+
+   Implementation notes:
+
+    1. Reads beyond the end of defined memory return zero, because the memory
+       array beyond the limit is always zero.  Writes beyond the limit are
+       ignored, so pages containing such locations have no write entries.
+*/
+
+static void set_page (MEU_MAP_SELECTOR map, uint32 index)
+{
+HP_WORD     map_register;
+uint32      page;
+MEMORY_WORD *page_address;
+
+if (meu_status & MEST_ENABLED) {                        /* if the MEU is enabled */
+    map_register = meu_maps [map] [index];              /*   then get the map register for the logical page */
+    page = MAP_PAGE (map_register);                     /*     and the physical page it designates */
+    }
+
+else {                                                  /* otherwise the MEU is disabled */
+    map_register = NO_PROTECTION;                       /*   so no protection applies */
+    page = index;                                       /*     and the physical page is the logical page */
+    }
+
+if (M == NULL || index == 0 || page == 0)               /* if memory is absent or page 0 is involved */
+    page_address = NULL;                                /*   then the full access path must be used */
+else                                                    /* otherwise */
+    page_address = M + TO_PA (page, 0);                 /*   point at the start of the physical page */
+
+if (map_register & READ_PROTECTED)                      /* if the page is read-protected */
+    meu_read_pages [map] [index] = NULL;                /*   then reads must check for a violation */
+else                                                    /* otherwise */
+    meu_read_pages [map] [index] = page_address;        /*   reads may access the page directly */
+
+if (map_register & WRITE_PROTECTED                      /* if the page is write-protected */
+  || TO_PA (page, OF_MASK) >= mem_end)                  /*   or extends beyond defined memory */
+    meu_write_pages [map] [index] = NULL;               /*     then writes must take the full path */
+else                                                    /* otherwise */
+    meu_write_pages [map] [index] = page_address;       /*   writes may access the page directly */
+
+return;
+}
+
+
+/* Select the fast access page tables for the current map */
+
+static void select_pages (void)
+{
+meu_read_page  = meu_read_pages  [meu_current_map];     /* the current map is always */
+meu_write_page = meu_write_pages [meu_current_map];     /*   either the system or the user map */
+
+return;
+}
+
+
 /* Determine whether an address is mapped.
 
    This routine determines whether a logical address is mapped to a physical
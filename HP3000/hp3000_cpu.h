@@ -114,7 +114,7 @@
 
 /* Memory access macros */
 
-#define cpu_read_memory(c,o,v)      mem_read  (&cpu_dev, c, o, v)
+#define cpu_read_memory(c,o,v)      mem_read_fast (c, o, v)
 #define cpu_write_memory(c,o,v)     mem_write (&cpu_dev, c, o, v)
 
 
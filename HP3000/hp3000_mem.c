@@ -196,12 +196,12 @@ static const ACCESS_PROPERTIES mem_access [] = {        /* indexed by ACCESS_CLA
     };
 
 
-/* Memory local data structures */
+/* Memory global data structures */
 
 
 /* Main memory */
 
-static MEMORY_WORD *M = NULL;                           /* the pointer to the main memory allocation */
+MEMORY_WORD *M = NULL;                                  /* the pointer to the main memory allocation */
 
 
 
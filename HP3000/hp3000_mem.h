@@ -160,3 +160,99 @@ extern void   mem_update_byte (BYTE_ACCESS *bap);
 extern char   *fmt_byte_operand            (uint32 byte_address, uint32 byte_count);
 extern char   *fmt_translated_byte_operand (uint32 byte_address, uint32 byte_count, uint32 table_address);
 extern char   *fmt_bcd_operand             (uint32 byte_address, uint32 digit_count);
+
+
+/* Global memory data */
+
+extern MEMORY_WORD *M;                          /* the pointer to the main memory allocation */
+
+
+/* Fast CPU memory read.
+
+   The CPU reads memory through the "cpu_read_memory" macro, which calls this
+   routine.  Reads for the common access classifications whose locations are
+   known to lie in physical memory and outside of the TOS register window are
+   satisfied directly from the memory array.  All other reads, including those
+   that must take bounds violation or illegal address actions and those made
+   while memory tracing is enabled, are passed to the "mem_read" routine.  The
+   results are identical in either case.
+
+   On entry, "classification" is the type of access requested, "offset" is a
+   logical offset into the memory bank implied by the classification, and
+   "value" points to the variable to receive the memory content.  The routine
+   returns TRUE if the access succeeds and FALSE if it does not.
+
+
+   Implementation notes:
+
+    1. The routine references the CPU registers, so it is defined only for
+       modules that include "hp3000_cpu.h", which defines MEMSIZE, before this
+       file.
+
+    2. A checked program or data access within bounds reads memory without
+       regard to the privilege state, which is only consulted when the bounds
+       check fails.  A checked stack access must also lie outside of the TOS
+       register window, so it is in bounds only for DL <= offset <= SM.
+*/
+
+#if defined (MEMSIZE)
+
+static SIM_INLINE t_bool mem_read_fast (ACCESS_CLASS classification, uint32 offset, HP_WORD *value)
+{
+uint32 address;
+
+if (DPPRINTING (&cpu_dev, DEB_MFETCH | DEB_MDATA))                  /* if memory tracing is enabled */
+    return mem_read (&cpu_dev, classification, offset, value);      /*   then the full routine must be used */
+
+switch (classification) {                                           /* dispatch on the access classification */
+
+    case fetch_checked:
+    case program_checked:
+        if (offset < PB || offset > PL)                             /* if the offset is out of bounds */
+            return mem_read (&cpu_dev, classification, offset, value);  /*   then let the full routine decide */
+
+    /* fall through into the unchecked program case */
+
+    case fetch:
+    case program:
+        address = PBANK << LA_WIDTH | offset;                       /* form the program bank address */
+        break;
+
+
+    case data_checked:
+        if (offset < DL || offset > SM + SR)                        /* if the offset is out of bounds */
+            return mem_read (&cpu_dev, classification, offset, value);  /*   then let the full routine decide */
+
+    /* fall through into the unchecked data case */
+
+    case data:
+        address = DBANK << LA_WIDTH | offset;                       /* form the data bank address */
+        break;
+
+
+    case stack_checked:
+        if (offset < DL)                                            /* if the offset is below the data limit */
+            return mem_read (&cpu_dev, classification, offset, value);  /*   then let the full routine decide */
+
+    /* fall through into the unchecked stack case */
+
+    case stack:
+        if (offset > SM)                                            /* if the offset may be within the TOS */
+            return mem_read (&cpu_dev, classification, offset, value);  /*   then let the full routine decide */
+
+        address = SBANK << LA_WIDTH | offset;                       /* form the stack bank address */
+        break;
+
+
+    default:                                                        /* the remaining classifications */
+        return mem_read (&cpu_dev, classification, offset, value);  /*   are handled by the full routine */
+    }
+
+if (address >= MEMSIZE)                                             /* if the access is beyond the memory size */
+    return mem_read (&cpu_dev, classification, offset, value);      /*   then let the full routine interrupt */
+
+*value = (HP_WORD) M [address];                                     /* otherwise read the value from memory */
+return TRUE;                                                        /*   and indicate success */
+}
+
+#endif
@@ -477,12 +477,12 @@ static const char *xio_funcs[] = {
 };
 static int32 ibm1130_qcount ()
 {
-    int32 i, cnt;
+    int32 i, q, cnt;
     UNIT *uptr;
     DEVICE *dptr;
 
     cnt = 0;
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    for (q = 0; (uptr = sim_qunit(q)) != NULL; q++) {
         dptr = find_dev_from_unit (uptr);
         for (i=0; sim_devices[i]; i++)
             if (dptr == sim_devices[i]) {
@@ -277,6 +277,29 @@ typedef struct {
     uint16              inst[HIST_ILNT];
     } InstHistory;
 
+/* Relocation cache
+
+   rd_tlb and wr_tlb hold one entry per APRFILE index (mode, I/D space,
+   page) for the pages that relocR and relocW have validated for read or
+   read/write access and found to be memory.  An entry describes the range
+   of displacements the page length field allows and the physical address
+   of displacement 0; an invalid entry has an empty (zero length) range.  A reference in
+   the range can skip the access control, page length and I/O page checks
+   and go straight to memory.  Entries are flushed when an APR is written,
+   when MMR0<mme> or MMR3 change, and whenever the simulator is started;
+   since the entries are indexed by mode and space, PSW mode changes need
+   no flush.  Nothing is entered while breakpoints of the type are set, so
+   the fast paths need not test for them.
+*/
+
+typedef struct {
+    uint32              lo;                             /* first valid disp */
+    uint32              lnt;                            /* number valid, 0 = none */
+    int32               pa;                             /* pa of disp 0 */
+    } RELOC_TLB;
+
+#define TLB_HIT(t,va)   (((uint32) (((va) & VA_DF) - (t).lo)) < (t).lnt)
+
 /* Global state */
 
 uint16 *M = NULL;                                       /* memory */
@@ -328,6 +351,8 @@ int16 inst_pc;                                          /* PC of current instr *
 int32 inst_psw;                                         /* PSW at instr. start */
 int16 reg_mods;                                         /* reg deltas */
 int32 last_pa;                                          /* pa from ReadMW/ReadMB */
+RELOC_TLB rd_tlb[64];                                   /* read translations */
+RELOC_TLB wr_tlb[64];                                   /* write translations */
 int32 saved_sim_interval;                               /* saved at inst start */
 t_stat reason;                                          /* stop reason */
 
@@ -338,6 +363,7 @@ extern CPUTAB cpu_tab[];
 
 t_stat cpu_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat cpu_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
+void *cpu_membase (UNIT *uptr, size_t *bytes, size_t *width);
 t_stat cpu_reset (DEVICE *dptr);
 t_stat cpu_boot (int32 unitno, DEVICE *dptr);
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
@@ -355,6 +381,8 @@ void relocW_test (int32 va, int32 apridx);
 int32 relocC (int32 va, int32 sw);
 t_bool PLF_test (int32 va, int32 apr);
 void reloc_abort (int32 err, int32 apridx);
+void reloc_tlb_fill (RELOC_TLB *tlb, int32 va, int32 apr);
+void reloc_tlb_flush (void);
 int32 ReadE (int32 addr);
 int32 ReadW (int32 addr);
 int32 ReadB (int32 addr);
@@ -715,7 +743,7 @@ DEVICE cpu_dev = {
     NULL, DEV_DYNM, 0,
     NULL, &cpu_set_size, NULL,
     &cpu_help, NULL, NULL, &cpu_description,
-    cpu_breakpoints
+    cpu_breakpoints, NULL, &cpu_membase
     };
 
 t_value pdp11_pc_value (void)
@@ -757,6 +785,7 @@ dsenable = calc_ds (cm);
 put_PIRQ (PIRQ);                                        /* rewrite PIRQ */
 STKLIM = STKLIM & STKLIM_RW;                            /* clean up STKLIM */
 MMR0 = MMR0 & ~MMR0_IC;                                 /* usually off */
+reloc_tlb_flush ();                                     /* maps, bkpts may have changed */
 
 trap_req = calc_ints (ipl, trap_req);                   /* upd int req */
 trapea = 0;
@@ -1043,6 +1072,7 @@ while (reason == 0)  {
                     STKLIM = 0;                         /* clear STKLIM */
                     MMR0 = 0;                           /* clear MMR0 */
                     MMR3 = 0;                           /* clear MMR3 */
+                    reloc_tlb_flush ();
                     cpu_bme = 0;                        /* (also clear bme) */
                     for (i = 0; i < IPL_HLVL; i++)
                         int_req[i] = 0;
@@ -2628,7 +2658,10 @@ switch (spec >> 3) {                                    /* decode spec<5:3> */
 int32 ReadE (int32 va)
 {
 int32 pa, data;
+RELOC_TLB *tlb = &rd_tlb[(va >> VA_V_APF) & 077];
 
+if (((va & 1) == 0) && TLB_HIT (*tlb, va))              /* cached, even? */
+    return RdMemW (tlb->pa + (va & VA_DF));
 if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     setCPUERR (CPUE_ODD);
     ABORT (TRAP_ODD);
@@ -2655,7 +2688,10 @@ return data;
 int32 ReadW (int32 va)
 {
 int32 pa;
+RELOC_TLB *tlb = &rd_tlb[(va >> VA_V_APF) & 077];
 
+if (((va & 1) == 0) && TLB_HIT (*tlb, va))              /* cached, even? */
+    return RdMemW (tlb->pa + (va & VA_DF));
 if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     setCPUERR (CPUE_ODD);
     ABORT (TRAP_ODD);
@@ -2671,7 +2707,10 @@ return PReadW (pa);
 int32 ReadB (int32 va)
 {
 int32 pa;
+RELOC_TLB *tlb = &rd_tlb[(va >> VA_V_APF) & 077];
 
+if (TLB_HIT (*tlb, va))                                 /* cached? */
+    return RdMemB (tlb->pa + (va & VA_DF));
 pa = relocR (va);                                       /* relocate */
 if (BPT_SUMM_RD &&
     (sim_brk_test (va & 0177777, BPT_RDVIR) ||
@@ -2769,7 +2808,12 @@ return ((pa & 1)? data >> 8: data) & 0377;
 void WriteW (int32 data, int32 va)
 {
 int32 pa;
+RELOC_TLB *tlb = &wr_tlb[(va >> VA_V_APF) & 077];
 
+if (((va & 1) == 0) && TLB_HIT (*tlb, va)) {            /* cached, even? */
+    WrMemW (tlb->pa + (va & VA_DF), data);
+    return;
+    }
 if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     setCPUERR (CPUE_ODD);
     ABORT (TRAP_ODD);
@@ -2785,7 +2829,12 @@ PWriteW (data, pa);
 void WriteB (int32 data, int32 va)
 {
 int32 pa;
+RELOC_TLB *tlb = &wr_tlb[(va >> VA_V_APF) & 077];
 
+if (TLB_HIT (*tlb, va)) {                               /* cached? */
+    WrMemB (tlb->pa + (va & VA_DF), data);
+    return;
+    }
 pa = relocW (va);                                       /* relocate */
 if (BPT_SUMM_WR &&
     (sim_brk_test (va & 0177777, BPT_WRVIR) ||
@@ -2867,8 +2916,10 @@ int32 relocR (int32 va)
 {
 int32 apridx, apr, pa;
 
+apridx = (va >> VA_V_APF) & 077;                        /* index into APR */
+if (TLB_HIT (rd_tlb[apridx], va))                       /* cached? */
+    return rd_tlb[apridx].pa + (va & VA_DF);
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
-    apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
     apr = APRFILE[apridx];                              /* with va<18:13> */
     if ((apr & PDR_PRD) != 2)                           /* not 2, 6? */
          relocR_test (va, apridx);                      /* long test */
@@ -2880,11 +2931,15 @@ if (MMR0 & MMR0_MME) {                                  /* if mmgt */
         if (pa >= 0760000)
             pa = 017000000 | pa;
         }
+    if (((apr & PDR_PRD) == 2) && !BPT_SUMM_RD)         /* readable? */
+        reloc_tlb_fill (&rd_tlb[apridx], va, apr);
     }
 else {
     pa = va & 0177777;                                  /* mmgt off */
     if (pa >= 0160000)
         pa = 017600000 | pa;
+    else if (!BPT_SUMM_RD)
+        reloc_tlb_fill (&rd_tlb[apridx], va, 0);
     }
 return pa;
 }
@@ -2976,8 +3031,10 @@ int32 relocW (int32 va)
 {
 int32 apridx, apr, pa;
 
+apridx = (va >> VA_V_APF) & 077;                        /* index into APR */
+if (TLB_HIT (wr_tlb[apridx], va))                       /* cached? W is set */
+    return wr_tlb[apridx].pa + (va & VA_DF);
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
-    apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
     apr = APRFILE[apridx];                              /* with va<18:13> */
     if ((apr & PDR_ACF) != 6)                           /* not writeable? */
         relocW_test (va, apridx);                       /* long test */
@@ -2990,15 +3047,69 @@ if (MMR0 & MMR0_MME) {                                  /* if mmgt */
         if (pa >= 0760000)
             pa = 017000000 | pa;
         }
+    if (((apr & PDR_ACF) == 6) && !BPT_SUMM_WR)         /* read/write? */
+        reloc_tlb_fill (&wr_tlb[apridx], va, apr);
     }
 else {
     pa = va & 0177777;                                  /* mmgt off */
     if (pa >= 0160000)
         pa = 017600000 | pa;
+    else if (!BPT_SUMM_WR)
+        reloc_tlb_fill (&wr_tlb[apridx], va, 0);
     }
 return pa;
 }
 
+/* Enter a validated page in a relocation cache
+
+   Inputs:
+        tlb     =       pointer to cache entry
+        va      =       virtual address just relocated
+        apr     =       APR used, if mmgt on
+   Outputs: none
+
+   The entry is only made if every displacement the page length field
+   allows maps to memory, below the I/O page and without wrapping.
+*/
+
+void reloc_tlb_fill (RELOC_TLB *tlb, int32 va, int32 apr)
+{
+uint32 lo, hi, plf;
+int32 base;
+
+if (MMR0 & MMR0_MME) {                                  /* if mmgt */
+    plf = (apr & PDR_PLF) >> 2;                         /* page length */
+    lo = (apr & PDR_ED)? plf: 0;                        /* valid disps */
+    hi = (apr & PDR_ED)? VA_DF: plf | (VA_DF & ~VA_BN);
+    base = (apr >> 10) & 017777700;
+    if (((base + hi) > PAMASK) ||                       /* wraps? */
+        (((MMR3 & MMR3_M22E) == 0) && ((base + hi) >= 0760000)))
+        return;                                         /* or 18b I/O page? */
+    }
+else {
+    lo = 0;                                             /* mmgt off */
+    hi = VA_DF;
+    base = va & 0160000;                                /* never I/O page */
+    }
+if (!ADDR_IS_MEM (base + hi))                           /* all memory? */
+    return;
+tlb->lo = lo;
+tlb->lnt = hi - lo + 1;
+tlb->pa = base;
+return;
+}
+
+/* Flush the relocation caches */
+
+void reloc_tlb_flush (void)
+{
+int32 i;
+
+for (i = 0; i < 64; i++)
+    rd_tlb[i].lnt = wr_tlb[i].lnt = 0;                  /* empty range */
+return;
+}
+
 /* Write relocation, access control field != read/write
 
    ACF value            11/45,11/70             all others
@@ -3141,6 +3252,8 @@ switch ((pa >> 1) & 3) {                                /* decode pa<2:1> */
         if (access == WRITEB)
             data = (pa & 1)? (MMR0 & 0377) | (data << 8): (MMR0 & ~0377) | data;
         data = data & cpu_tab[cpu_model].mm0;
+        if ((MMR0 ^ data) & MMR0_MME)                   /* mmgt on/off? */
+            reloc_tlb_flush ();
         MMR0 = (MMR0 & ~MMR0_WR) | (data & MMR0_WR);
         return SCPE_OK;
 
@@ -3160,6 +3273,7 @@ t_stat MMR3_wr (int32 data, int32 pa, int32 access)     /* MMR3 */
 if (pa & 1)
     return SCPE_OK;
 MMR3 = data & cpu_tab[cpu_model].mm3;
+reloc_tlb_flush ();                                     /* M22E may change */
 cpu_bme = (MMR3 & MMR3_BME) && (cpu_opt & OPT_UBM);
 dsenable = calc_ds (cm);
 return SCPE_OK;
@@ -3219,6 +3333,7 @@ if (left)
         (((uint32) (data & cpu_tab[cpu_model].par)) << 16)) & ~(PDR_A|PDR_W);
 else APRFILE[idx] = ((APRFILE[idx] & ~0177777) |
     (data & cpu_tab[cpu_model].pdr)) & ~(PDR_A|PDR_W);
+rd_tlb[idx].lnt = wr_tlb[idx].lnt = 0;                  /* flush page */
 return SCPE_OK;
 }
 
@@ -3434,6 +3549,7 @@ MMR0 = 0;
 MMR1 = 0;
 MMR2 = 0;
 MMR3 = 0;
+reloc_tlb_flush ();
 trap_req = 0;
 wait_state = 0;
 if (M == NULL) {                    /* First time init */
@@ -3569,6 +3685,15 @@ if (addr < IOPAGEBASE)
 return iopageW ((int32) val, addr, WRITEC);
 }
 
+/* Memory image for SAVE/RESTORE */
+
+void *cpu_membase (UNIT *uptr, size_t *bytes, size_t *width)
+{
+*bytes = (size_t)MEMSIZE;
+*width = sizeof (*M);
+return M;
+}
+
 /* Set R, SP register display addresses */
 
 void set_r_display (int32 rs, int32 cm)
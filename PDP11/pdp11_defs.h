@@ -923,10 +923,10 @@ int32 Map_Write18 (uint32 ba, int32 bc, uint32 *buf);
 
 #define RdMemW(pa)      (M[(pa) >> 1])
 #define RdMemB(pa)      ((((pa) & 1)? M[(pa) >> 1] >> 8: M[(pa) >> 1]) & 0377)
-#define WrMemW(pa,d)    M[(pa) >> 1] = (d)
-#define WrMemB(pa,d)    M[(pa) >> 1] = ((pa) & 1)? \
+#define WrMemW(pa,d)    (SIM_MEM_DIRTY (pa), M[(pa) >> 1] = (d))
+#define WrMemB(pa,d)    (SIM_MEM_DIRTY (pa), M[(pa) >> 1] = ((pa) & 1)? \
                             ((M[(pa) >> 1] & 0377) | (((d) & 0377) << 8)): \
-                            ((M[(pa) >> 1] & ~0377) | ((d) & 0377))
+                            ((M[(pa) >> 1] & ~0377) | ((d) & 0377)))
 
 #endif
 
@@ -249,11 +249,58 @@ return uba_last;
      trimmed to 18b.
    - In a Qbus configuration, the map is always disabled.
      Device addresses are trimmed to 22b.
+
+   Transfers are done in runs of consecutive memory addresses, each
+   moved with a single block copy where possible.
 */
 
+/* Block copies between memory and a device buffer
+
+   Word buffers have the layout of memory on any host, byte buffers
+   only on a little endian host.  If a copy isn't possible, or the run
+   isn't entirely in memory, FALSE is returned and the caller moves the
+   data a byte or word at a time.
+*/
+
+#if defined (UC15)
+#define Map_ReadBlk(ma,bc,buf,w)    FALSE
+#define Map_WriteBlk(ma,bc,buf,w)   FALSE
+#else
+static t_bool Map_ReadBlk (uint32 ma, uint32 bc, void *buf, t_bool words)
+{
+if ((!words && !sim_end) || (bc == 0) || !ADDR_IS_MEM (ma + bc - 1))
+    return FALSE;
+memcpy (buf, ((uint8 *) M) + ma, bc);
+return TRUE;
+}
+
+static t_bool Map_WriteBlk (uint32 ma, uint32 bc, const void *buf, t_bool words)
+{
+if ((!words && !sim_end) || (bc == 0) || !ADDR_IS_MEM (ma + bc - 1))
+    return FALSE;
+memcpy (((uint8 *) M) + ma, buf, bc);
+sim_mem_dirty_range (ma, bc);
+return TRUE;
+}
+#endif
+
+/* Length of the run of consecutive memory addresses mapped from ba,
+   up to bc bytes - caller checks cpu_bme */
+
+static uint32 Map_Run (uint32 ba, uint32 ma, uint32 bc)
+{
+uint32 last = uba_last;
+uint32 run = UBM_PAGSIZE - UBM_GETOFF (ba);             /* left in page */
+
+while ((run < bc) && (Map_Addr (ba + run) == (ma + run)))
+    run = run + UBM_PAGSIZE;
+uba_last = last;                                        /* lookahead only */
+return (run < bc)? run: bc;
+}
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run, j;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -272,11 +319,22 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
 if (cpu_bme) {                                          /* map enabled? */
-    for ( ; ba < lim; ba++) {                           /* by bytes */
+    for ( ; ba < lim; ba = ba + run) {                  /* by runs */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
             return (lim - ba);
-        *buf++ = (uint8) RdMemB (ma);                   /* get byte */
+        run = Map_Run (ba, ma, lim - ba);               /* contiguous run */
+        if (Map_ReadBlk (ma, run, buf, FALSE)) {        /* copy run? */
+            uba_last = ma + run - 1;
+            buf = buf + run;
+            continue;
+            }
+        for (j = 0; j < run; j++) {                     /* by bytes */
+            ma = Map_Addr (ba + j);
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba - j);
+            *buf++ = (uint8) RdMemB (ma);               /* get byte */
+            }
         }
     return 0;
     }
@@ -286,16 +344,17 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba++) {                          /* by bytes */
-        *buf++ = (uint8) RdMemB (ba);                   /* get byte */
-        }
+    if (!Map_ReadBlk (ba, alim - ba, buf, FALSE))       /* copy run? */
+        for ( ; ba < alim; ba++) {                      /* by bytes */
+            *buf++ = (uint8) RdMemB (ba);               /* get byte */
+            }
     return (lim - alim);
     }
 }
 
 int32 Map_ReadW (uint32 ba, int32 bc, uint16 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run, j;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -315,11 +374,22 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
 if (cpu_bme) {                                          /* map enabled? */
-    for (; ba < lim; ba = ba + 2) {                     /* by words */
+    for ( ; ba < lim; ba = ba + run) {                  /* by runs */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
             return (lim - ba);
-        *buf++ = (uint16) RdMemW (ma);
+        run = Map_Run (ba, ma, lim - ba);               /* contiguous run */
+        if (Map_ReadBlk (ma, run, buf, TRUE)) {         /* copy run? */
+            uba_last = ma + run - 2;
+            buf = buf + (run >> 1);
+            continue;
+            }
+        for (j = 0; j < run; j = j + 2) {               /* by words */
+            ma = Map_Addr (ba + j);
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba - j);
+            *buf++ = (uint16) RdMemW (ma);
+            }
         }
     return 0;
     }
@@ -329,16 +399,17 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba = ba + 2) {                   /* by words */
-        *buf++ = (uint16) RdMemW (ba);
-        }
+    if (!Map_ReadBlk (ba, alim - ba, buf, TRUE))        /* copy run? */
+        for ( ; ba < alim; ba = ba + 2) {               /* by words */
+            *buf++ = (uint16) RdMemW (ba);
+            }
     return (lim - alim);
     }
 }
 
 int32 Map_WriteB (uint32 ba, int32 bc, const uint8 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run, j;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -354,11 +425,22 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
 if (cpu_bme) {                                          /* map enabled? */
-    for ( ; ba < lim; ba++) {                           /* by bytes */
+    for ( ; ba < lim; ba = ba + run) {                  /* by runs */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
             return (lim - ba);
-        WrMemB (ma, ((uint16) *buf++));
+        run = Map_Run (ba, ma, lim - ba);               /* contiguous run */
+        if (Map_WriteBlk (ma, run, buf, FALSE)) {       /* copy run? */
+            uba_last = ma + run - 1;
+            buf = buf + run;
+            continue;
+            }
+        for (j = 0; j < run; j++) {                     /* by bytes */
+            ma = Map_Addr (ba + j);
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba - j);
+            WrMemB (ma, ((uint16) *buf++));
+            }
         }
     return 0;
     }
@@ -368,16 +450,17 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba++) {                          /* by bytes */
-        WrMemB (ba, ((uint16) *buf++));
-        }
+    if (!Map_WriteBlk (ba, alim - ba, buf, FALSE))      /* copy run? */
+        for ( ; ba < alim; ba++) {                      /* by bytes */
+            WrMemB (ba, ((uint16) *buf++));
+            }
     return (lim - alim);
     }
 }
 
 int32 Map_WriteW (uint32 ba, int32 bc, const uint16 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run, j;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -395,11 +478,22 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
 if (cpu_bme) {                                          /* map enabled? */
-    for (; ba < lim; ba = ba + 2) {                     /* by words */
+    for ( ; ba < lim; ba = ba + run) {                  /* by runs */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
             return (lim - ba);
-        WrMemW (ma, *buf++);
+        run = Map_Run (ba, ma, lim - ba);               /* contiguous run */
+        if (Map_WriteBlk (ma, run, buf, TRUE)) {        /* copy run? */
+            uba_last = ma + run - 2;
+            buf = buf + (run >> 1);
+            continue;
+            }
+        for (j = 0; j < run; j = j + 2) {               /* by words */
+            ma = Map_Addr (ba + j);
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba - j);
+            WrMemW (ma, *buf++);
+            }
         }
     return 0;
     }
@@ -409,9 +503,10 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba = ba + 2) {                   /* by words */
-        WrMemW (ba, *buf++);
-        }
+    if (!Map_WriteBlk (ba, alim - ba, buf, TRUE))       /* copy run? */
+        for ( ; ba < alim; ba = ba + 2) {               /* by words */
+            WrMemW (ba, *buf++);
+            }
     return (lim - alim);
     }
 }
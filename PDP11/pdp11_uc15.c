@@ -477,8 +477,10 @@ else {
 
 void uc15_WrMemW (int32 pa, int32 d)
 {
-if (((uint32) pa) < MEMSIZE)
+if (((uint32) pa) < MEMSIZE) {
+    SIM_MEM_DIRTY (pa);
     M[pa >> 1] = d;
+    }
 else {
     pa = pa - MEMSIZE;
     pdp15_mem[pa >> 1] = d & DMASK;
@@ -488,10 +490,12 @@ return;
 
 void uc15_WrMemB (int32 pa, int32 d)
 {
-if (((uint32) pa) < MEMSIZE)
+if (((uint32) pa) < MEMSIZE) {
+    SIM_MEM_DIRTY (pa);
     M[pa >> 1] = (pa & 1)?
          ((M[pa >> 1] & 0377) | ((d & 0377) << 8)): \
          ((M[pa >> 1] & ~0377) | (d & 0377));
+    }
 else {
     pa = pa - MEMSIZE;
     pdp15_mem[pa >> 1] = (pa & 1)?
@@ -534,8 +538,10 @@ else if (ba < uc15_memsize)                              /* no, strt ok? */
     alim = uc15_memsize;
 else return bc;                                         /* no, err */
 for ( ; ba < alim; ba = ba + 2) {                       /* by 18 bit words */
-    if (ba < MEMSIZE)
+    if (ba < MEMSIZE) {
+        SIM_MEM_DIRTY (ba);
         M[ba >> 1] = *buf++ & DMASK;
+        }
     else pdp15_mem[(ba - MEMSIZE) >> 1] = *buf++ & 0777777;
     }
 return (lim - alim);
@@ -87,6 +87,7 @@ t_stat qba_ex (t_value *vptr, t_addr exta, UNIT *uptr, int32 sw);
 t_stat qba_dep (t_value val, t_addr exta, UNIT *uptr, int32 sw);
 t_bool qba_map_addr (uint32 qa, uint32 *ma);
 t_bool qba_map_addr_c (uint32 qa, uint32 *ma);
+static int32 qba_map_run (uint32 qa, uint32 ma, int32 bc);
 t_stat qba_show_virt (FILE *of, UNIT *uptr, int32 val, CONST void *desc);
 t_stat qba_show_map (FILE *of, UNIT *uptr, int32 val, CONST void *desc);
 t_stat qba_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr);
@@ -526,6 +527,7 @@ if (qba_map_addr (qa, &ma)) {                           /* in map? */
             M[ma >> 2] = (M[ma >> 2] & ~(BMASK << sc)) |
                 ((dat & BMASK) << sc);
             }
+        SIM_MEM_DIRTY (ma);
         }                                               /* end if mem */
     else
         mem_err = 1;
@@ -587,6 +589,25 @@ if (qblk < QBNMAPR) {
 return FALSE;
 }
 
+/* Length of the physically contiguous run of memory mapped from qa
+
+   The run starts at ma, the already validated translation of qa, and
+   extends through following map registers that point to consecutive
+   pages of memory, up to bc bytes.
+*/
+
+static int32 qba_map_run (uint32 qa, uint32 ma, int32 bc)
+{
+int32 run = VA_PAGSIZE - VA_GETOFF (ma);                /* left in page */
+uint32 nma;
+
+while ((run < bc) &&                                    /* next page follows? */
+       qba_map_addr_c (qa + run, &nma) &&
+       (nma == (ma + run)) && ADDR_IS_MEM (nma))
+    run = run + VA_PAGSIZE;
+return (run < bc)? run: bc;                             /* limit to rem xfr */
+}
+
 /* Reset I/O bus */
 
 void ioreset_wr (int32 data)
@@ -612,11 +633,14 @@ return SCPE_OK;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   Longword aligned transfers are done in runs of physically contiguous
+   pages, each moved with a single block copy where possible.
 */
 
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
-int32 i;
+int32 i, j, pbc;
 uint32 ma, dat;
 
 if ((ba | bc) & 03) {                                   /* check alignment */
@@ -630,17 +654,21 @@ if ((ba | bc) & 03) {                                   /* check alignment */
         }
     }
 else {
-    for (i = ma = 0; i < bc; i = i + 4, buf++) {        /* by longwords */
-        if ((ma & VA_M_OFF) == 0) {                     /* need map? */
-            if (!qba_map_addr (ba + i, &ma))            /* inv or NXM? */
-                return (bc - i);
+    for (i = 0; i < bc; i = i + pbc) {                  /* by runs */
+        if (!qba_map_addr (ba + i, &ma))                /* inv or NXM? */
+            return (bc - i);
+        pbc = qba_map_run (ba + i, ma, bc - i);         /* contiguous run */
+        if (ReadMemBlk (ma, pbc, buf)) {                /* copy run? */
+            buf = buf + pbc;
+            continue;
+            }
+        for (j = 0; j < pbc; j = j + 4, ma = ma + 4) {  /* by longwords */
+            dat = ReadL (ma);                           /* get lw */
+            *buf++ = dat & BMASK;                       /* low 8b */
+            *buf++ = (dat >> 8) & BMASK;                /* next 8b */
+            *buf++ = (dat >> 16) & BMASK;               /* next 8b */
+            *buf++ = (dat >> 24) & BMASK;
             }
-        dat = ReadL (ma);                               /* get lw */
-        *buf++ = dat & BMASK;                           /* low 8b */
-        *buf++ = (dat >> 8) & BMASK;                    /* next 8b */
-        *buf++ = (dat >> 16) & BMASK;                   /* next 8b */
-        *buf = (dat >> 24) & BMASK;
-        ma = ma + 4;
         }
     }
 return 0;
@@ -648,8 +676,8 @@ return 0;
 
 int32 Map_ReadW (uint32 ba, int32 bc, uint16 *buf)
 {
-int32 i;
-uint32 ma,dat;
+int32 i, j, pbc;
+uint32 ma, dat;
 
 ba = ba & ~01;
 bc = bc & ~01;
@@ -664,15 +692,19 @@ if ((ba | bc) & 03) {                                   /* check alignment */
         }
     }
 else {
-    for (i = ma = 0; i < bc; i = i + 4, buf++) {        /* by longwords */
-        if ((ma & VA_M_OFF) == 0) {                     /* need map? */
-            if (!qba_map_addr (ba + i, &ma))            /* inv or NXM? */
-                return (bc - i);
+    for (i = 0; i < bc; i = i + pbc) {                  /* by runs */
+        if (!qba_map_addr (ba + i, &ma))                /* inv or NXM? */
+            return (bc - i);
+        pbc = qba_map_run (ba + i, ma, bc - i);         /* contiguous run */
+        if (ReadMemBlk (ma, pbc, buf)) {                /* copy run? */
+            buf = buf + (pbc >> 1);
+            continue;
+            }
+        for (j = 0; j < pbc; j = j + 4, ma = ma + 4) {  /* by longwords */
+            dat = ReadL (ma);                           /* get lw */
+            *buf++ = dat & WMASK;                       /* low 16b */
+            *buf++ = (dat >> 16) & WMASK;               /* high 16b */
             }
-        dat = ReadL (ma);                               /* get lw */
-        *buf++ = dat & WMASK;                           /* low 16b */
-        *buf = (dat >> 16) & WMASK;                     /* high 16b */
-        ma = ma + 4;
         }
     }
 return 0;
@@ -680,7 +712,7 @@ return 0;
 
 int32 Map_WriteB (uint32 ba, int32 bc, const uint8 *buf)
 {
-int32 i;
+int32 i, j, pbc;
 uint32 ma, dat;
 
 if ((ba | bc) & 03) {                                   /* check alignment */
@@ -694,17 +726,21 @@ if ((ba | bc) & 03) {                                   /* check alignment */
         }
     }
 else {
-    for (i = ma = 0; i < bc; i = i + 4, buf++) {        /* by longwords */
-        if ((ma & VA_M_OFF) == 0) {                     /* need map? */
-            if (!qba_map_addr (ba + i, &ma))            /* inv or NXM? */
-                return (bc - i);
+    for (i = 0; i < bc; i = i + pbc) {                  /* by runs */
+        if (!qba_map_addr (ba + i, &ma))                /* inv or NXM? */
+            return (bc - i);
+        pbc = qba_map_run (ba + i, ma, bc - i);         /* contiguous run */
+        if (WriteMemBlk (ma, pbc, buf)) {               /* copy run? */
+            buf = buf + pbc;
+            continue;
+            }
+        for (j = 0; j < pbc; j = j + 4, ma = ma + 4) {  /* by longwords */
+            dat = (uint32) *buf++;                      /* get low 8b */
+            dat = dat | (((uint32) *buf++) << 8);       /* merge next 8b */
+            dat = dat | (((uint32) *buf++) << 16);      /* merge next 8b */
+            dat = dat | (((uint32) *buf++) << 24);      /* merge hi 8b */
+            WriteL (ma, dat);                           /* store lw */
             }
-        dat = (uint32) *buf++;                          /* get low 8b */
-        dat = dat | (((uint32) *buf++) << 8);           /* merge next 8b */
-        dat = dat | (((uint32) *buf++) << 16);          /* merge next 8b */
-        dat = dat | (((uint32) *buf) << 24);            /* merge hi 8b */
-        WriteL (ma, dat);                               /* store lw */
-        ma = ma + 4;
         }
     }
 return 0;
@@ -712,7 +748,7 @@ return 0;
 
 int32 Map_WriteW (uint32 ba, int32 bc, const uint16 *buf)
 {
-int32 i;
+int32 i, j, pbc;
 uint32 ma, dat;
 
 ba = ba & ~01;
@@ -728,15 +764,19 @@ if ((ba | bc) & 03) {                                   /* check alignment */
         }
     }
 else {
-    for (i = ma = 0; i < bc; i = i + 4, buf++) {        /* by longwords */
-        if ((ma & VA_M_OFF) == 0) {                     /* need map? */
-            if (!qba_map_addr (ba + i, &ma))            /* inv or NXM? */
-                return (bc - i);
+    for (i = 0; i < bc; i = i + pbc) {                  /* by runs */
+        if (!qba_map_addr (ba + i, &ma))                /* inv or NXM? */
+            return (bc - i);
+        pbc = qba_map_run (ba + i, ma, bc - i);         /* contiguous run */
+        if (WriteMemBlk (ma, pbc, buf)) {               /* copy run? */
+            buf = buf + (pbc >> 1);
+            continue;
+            }
+        for (j = 0; j < pbc; j = j + 4, ma = ma + 4) {  /* by longwords */
+            dat = (uint32) *buf++;                      /* get low 16b */
+            dat = dat | (((uint32) *buf++) << 16);      /* merge hi 16b */
+            WriteL (ma, dat);                           /* store lw */
             }
-        dat = (uint32) *buf++;                          /* get low 16b */
-        dat = dat | (((uint32) *buf) << 16);            /* merge hi 16b */
-        WriteL (ma, dat);                               /* store lw */
-        ma = ma + 4;
         }
     }
 return 0;
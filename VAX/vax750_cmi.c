@@ -761,8 +761,10 @@ if (PC == 0x200) {    /* Use VMB directly to boot */
     if (r != SCPE_OK)
         return r;
     }
-else                    /* Boot ROM boot */
+else {                  /* Boot ROM boot */
     memcpy (&M[0xFA00>>2], rom, ROMSIZE);
+    sim_mem_dirty_range (0xFA00, ROMSIZE);
+    }
 return SCPE_OK;
 }
 
@@ -197,6 +197,8 @@ void uba_adap_clr_int ();
 void uba_set_dpr (uint32 ua, t_bool wr);
 void uba_ubpdn (int32 time);
 t_bool uba_map_addr (uint32 ua, uint32 *ma);
+t_bool uba_map_addr_c (uint32 ua, uint32 *ma);
+static int32 uba_map_run (uint32 ua, uint32 ma, int32 bc);
 t_stat uba_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat uba_show_map (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 
@@ -608,6 +610,9 @@ return vec;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   Transfers are done in runs of physically contiguous pages; longword
+   aligned runs are moved with a single block copy where possible.
 */
 
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
@@ -616,12 +621,10 @@ int32 i, j, pbc;
 uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                 /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 8b read, ma = %X, bc = %X\n", ma, pbc);
     if ((ma | pbc) & 3) {                               /* aligned LW? */
@@ -629,6 +632,8 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
             *buf++ = ReadB (ma);
             }
         }
+    else if (ReadMemBlk (ma, pbc, buf))                 /* copy run? */
+        buf = buf + pbc;
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = ReadL (ma);                           /* get lw */
@@ -650,12 +655,10 @@ uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
 bc = bc & ~01;
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                 /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 16b read, ma = %X, bc = %X\n", ma, pbc);
     if ((ma | pbc) & 1) {                               /* aligned word? */
@@ -672,6 +675,8 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
             *buf++ = ReadW (ma);                        /* get word */
             }
         }
+    else if (ReadMemBlk (ma, pbc, buf))                 /* copy run? */
+        buf = buf + (pbc >> 1);
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = ReadL (ma);                           /* get lw */
@@ -690,12 +695,10 @@ int32 i, j, pbc;
 uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                 /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 8b write, ma = %X, bc = %X\n", ma, pbc);
     if ((ma | pbc) & 3) {                               /* aligned LW? */
@@ -704,6 +707,8 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
             buf++;
             }
         }
+    else if (WriteMemBlk (ma, pbc, buf))                /* copy run? */
+        buf = buf + pbc;
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = (uint32) *buf++;                      /* get low 8b */
@@ -725,12 +730,10 @@ uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
 bc = bc & ~01;
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                 /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 16b write, ma = %X, bc = %X\n", ma, pbc);
     if ((ma | pbc) & 1) {                               /* aligned word? */
@@ -748,6 +751,8 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
             buf++;
             }
         }
+    else if (WriteMemBlk (ma, pbc, buf))                /* copy run? */
+        buf = buf + (pbc >> 1);
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = (uint32) *buf++;                      /* get low 16b */
@@ -801,6 +806,25 @@ if (umap & UBAMAP_VLD) {                                /* valid? */
 return FALSE;
 }
 
+/* Length of the physically contiguous run of memory mapped from ua
+
+   The run starts at ma, the already validated translation of ua, and
+   extends through following map registers that point to consecutive
+   pages of memory, up to bc bytes.
+*/
+
+static int32 uba_map_run (uint32 ua, uint32 ma, int32 bc)
+{
+int32 run = VA_PAGSIZE - VA_GETOFF (ma);                /* left in page */
+uint32 nma;
+
+while ((run < bc) &&                                    /* next page follows? */
+       uba_map_addr_c (ua + run, &nma) &&
+       (nma == (ma + run)) && ADDR_IS_MEM (nma))
+    run = run + VA_PAGSIZE;
+return (run < bc)? run: bc;                             /* limit to rem xfr */
+}
+
 /* At end of page or transfer, update DPR register, in case next page
    gets an error */
 
@@ -147,6 +147,8 @@ void uba_adap_set_int ();
 void uba_adap_clr_int ();
 void uba_ubpdn (int32 time);
 t_bool uba_map_addr (uint32 ua, uint32 *ma);
+t_bool uba_map_addr_c (uint32 ua, uint32 *ma);
+static int32 uba_map_run (uint32 ua, uint32 ma, int32 bc);
 t_stat uba_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat uba_show_map (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 
@@ -596,6 +598,9 @@ return vec;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   Transfers are done in runs of physically contiguous pages; longword
+   aligned runs are moved with a single block copy where possible.
 */
 
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
@@ -604,18 +609,18 @@ int32 i, j, pbc;
 uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                  /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     sim_debug (UBA_DEB_XFR, &uba_dev, "8b read, ba = %X, ma = %X, bc = %X\n", ba, ma, pbc);
     if ((ma | pbc) & 3) {                               /* aligned LW? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, do by bytes */
             *buf++ = ReadB (ma);
             }
         }
+    else if (ReadMemBlk (ma, pbc, buf))                 /* copy run? */
+        buf = buf + pbc;
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = ReadL (ma);                           /* get lw */
@@ -636,12 +641,10 @@ uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
 bc = bc & ~01;
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                 /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     sim_debug (UBA_DEB_XFR, &uba_dev, "16b read, ba = %X, ma = %X, bc = %X\n", ba, ma, pbc);
     if ((ma | pbc) & 1) {                               /* aligned word? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, do by bytes */
@@ -657,6 +660,8 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
             *buf++ = ReadW (ma);                        /* get word */
             }
         }
+    else if (ReadMemBlk (ma, pbc, buf))                 /* copy run? */
+        buf = buf + (pbc >> 1);
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = ReadL (ma);                           /* get lw */
@@ -674,12 +679,10 @@ int32 i, j, pbc;
 uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                 /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     sim_debug (UBA_DEB_XFR, &uba_dev, "8b write, ba = %X, ma = %X, bc = %X\n", ba, ma, pbc);
     if ((ma | pbc) & 3) {                               /* aligned LW? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, do by bytes */
@@ -687,6 +690,8 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
             buf++;
             }
         }
+    else if (WriteMemBlk (ma, pbc, buf))                /* copy run? */
+        buf = buf + pbc;
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = (uint32) *buf++;                      /* get low 8b */
@@ -707,12 +712,10 @@ uint32 ma, dat;
 
 ba = ba & UBADDRMASK;                                   /* mask UB addr */
 bc = bc & ~01;
-for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
+for (i = 0; i < bc; i = i + pbc) {                      /* loop by runs */
     if (!uba_map_addr (ba + i, &ma))                    /* page inv or NXM? */
         return (bc - i);
-    pbc = VA_PAGSIZE - VA_GETOFF (ma);                  /* left in page */
-    if (pbc > (bc - i))                                 /* limit to rem xfr */
-        pbc = bc - i;
+    pbc = uba_map_run (ba + i, ma, bc - i);             /* contiguous run */
     sim_debug (UBA_DEB_XFR, &uba_dev, "16b write, ba = %X, ma = %X, bc = %X\n", ba, ma, pbc);
     if ((ma | pbc) & 1) {                               /* aligned word? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, bytes */
@@ -729,6 +732,8 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
             buf++;
             }
         }
+    else if (WriteMemBlk (ma, pbc, buf))                /* copy run? */
+        buf = buf + (pbc >> 1);
     else {                                              /* yes, do by LW */
         for (j = 0; j < pbc; ma = ma + 4, j = j + 4) {
             dat = (uint32) *buf++;                      /* get low 16b */
@@ -794,6 +799,25 @@ if (umap & UBAMAP_VLD) {                                /* valid? */
 return FALSE;
 }
 
+/* Length of the physically contiguous run of memory mapped from ua
+
+   The run starts at ma, the already validated translation of ua, and
+   extends through following map registers that point to consecutive
+   pages of memory, up to bc bytes.
+*/
+
+static int32 uba_map_run (uint32 ua, uint32 ma, int32 bc)
+{
+int32 run = VA_PAGSIZE - VA_GETOFF (ma);                /* left in page */
+uint32 nma;
+
+while ((run < bc) &&                                    /* next page follows? */
+       uba_map_addr_c (ua + run, &nma) &&
+       (nma == (ma + run)) && ADDR_IS_MEM (nma))
+    run = run + VA_PAGSIZE;
+return (run < bc)? run: bc;                             /* limit to rem xfr */
+}
+
 /* Error routines
 
    uba_ub_nxm           SBI read/write to nx Unibus address
@@ -320,6 +320,7 @@ t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
 t_stat cpu_ex (t_value *vptr, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_dep (t_value val, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+void *cpu_membase (UNIT *uptr, size_t *bytes, size_t *width);
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
@@ -462,7 +463,7 @@ DEVICE cpu_dev = {
     &cpu_boot, NULL, NULL,
     NULL, DEV_DYNM | DEV_DEBUG, 0,
     cpu_deb, &cpu_set_size, NULL, &cpu_help, NULL, NULL,
-    &cpu_description
+    &cpu_description, NULL, NULL, &cpu_membase
     };
 
 t_stat cpu_show_model (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
@@ -3334,6 +3335,7 @@ if (M == NULL) {                        /* first time init? */
     vax_init();
     sim_brk_types = sim_brk_dflt = SWMASK ('E');
     sim_vm_is_subroutine_call = cpu_is_pc_a_subroutine_call;
+    sim_vm_test = &cpu_test;
     sim_clock_precalibrate_commands = vax_clock_precalibrate_commands;
     sim_vm_initial_ips = SIM_INITIAL_IPS;
     pcq_r = find_reg ("PCQ", NULL, dptr);
@@ -3440,6 +3442,15 @@ if (ADDR_IS_ROM (addr)) {
 return SCPE_NXM;
 }
 
+/* Memory image for SAVE/RESTORE */
+
+void *cpu_membase (UNIT *uptr, size_t *bytes, size_t *width)
+{
+*bytes = (size_t)MEMSIZE;
+*width = sizeof (*M);
+return M;
+}
+
 /* Memory allocation */
 
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
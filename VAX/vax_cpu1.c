@@ -781,6 +781,21 @@ return 0;                                               /* q can't be empty */
 #define MVC_M_STATE     3
 #define MVC_V_CC        2
 
+/* The string instructions first work a page at a time directly in host
+   memory, translating each page of each operand once with HostAddr.  The
+   registers are brought up to date after each page, so a fault on the
+   next page leaves the same interruptible state (PSL<fpd> and R0-R5) as
+   the element at a time loops would.  Whatever can't be done in host
+   memory, because a page is not main memory or the host is big endian,
+   is left to those loops.  str_host turns the page at a time paths off
+   for the CPU library test.
+*/
+
+#define STR_PAGE_LEFT(va)       ((int32) (VA_PAGSIZE - VA_GETOFF (va)))  /* bytes to end of page */
+#define STR_PAGE_BEFORE(va)     ((int32) (VA_GETOFF ((va) - 1) + 1))     /* bytes before va in page */
+
+static t_bool str_host = TRUE;                          /* use page at a time paths */
+
 /* MOVC3, MOVC5
 
    if PSL<fpd> = 0 and MOVC3,
@@ -808,6 +823,7 @@ int32 op_movc (int32 *opnd, int32 movc5, int32 acc)
 {
 int32 i, cc, fill, wd;
 int32 j, lnt, mlnt[3];
+uint8 *sp, *dp;
 static const int32 looplnt[3] = { L_BYTE, L_LONG, L_BYTE };
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
@@ -859,6 +875,22 @@ else {
 switch (R[5] & MVC_M_STATE) {                           /* case on state */
 
     case MVC_FRWD:                                      /* move forward */
+        while (str_host && (R[2] > 0)) {                /* page at a time */
+            lnt = R[2];
+            if (lnt > STR_PAGE_LEFT (R[1]))
+                lnt = STR_PAGE_LEFT (R[1]);
+            if (lnt > STR_PAGE_LEFT (R[3]))
+                lnt = STR_PAGE_LEFT (R[3]);
+            if (((sp = HostAddr (R[1], RA)) == NULL) ||
+                ((dp = HostAddr (R[3], WA)) == NULL))
+                break;
+            memmove (dp, sp, lnt);
+            HostWritten (dp);
+            R[1] = R[1] + lnt;                          /* inc src addr */
+            R[3] = R[3] + lnt;                          /* inc dst addr */
+            R[2] = R[2] - lnt;                          /* dec move lnt */
+            extra_bytes = extra_bytes + (lnt >> 2);
+            }
         mlnt[0] = (4 - R[3]) & 3;                       /* length to align */
         if (mlnt[0] > R[2])                             /* cant exceed total */
             mlnt[0] = R[2];
@@ -877,6 +909,22 @@ switch (R[5] & MVC_M_STATE) {                           /* case on state */
         goto FILL;                                      /* check for fill */
 
     case MVC_BACK:                                      /* move backward */
+        while (str_host && (R[2] > 0)) {                /* page at a time */
+            lnt = R[2];
+            if (lnt > STR_PAGE_BEFORE (R[1]))
+                lnt = STR_PAGE_BEFORE (R[1]);
+            if (lnt > STR_PAGE_BEFORE (R[3]))
+                lnt = STR_PAGE_BEFORE (R[3]);
+            if (((sp = HostAddr (R[1] - 1, RA)) == NULL) ||
+                ((dp = HostAddr (R[3] - 1, WA)) == NULL))
+                break;
+            memmove (dp - (lnt - 1), sp - (lnt - 1), lnt);
+            HostWritten (dp);
+            R[1] = R[1] - lnt;                          /* dec src addr */
+            R[3] = R[3] - lnt;                          /* dec dst addr */
+            R[2] = R[2] - lnt;                          /* dec move lnt */
+            extra_bytes = extra_bytes + (lnt >> 2);
+            }
         mlnt[0] = R[3] & 03;                            /* length to align */
         if (mlnt[0] > R[2])                             /* cant exceed total */
             mlnt[0] = R[2];
@@ -900,6 +948,18 @@ switch (R[5] & MVC_M_STATE) {                           /* case on state */
         if (R[4] <= 0)                                  /* any fill? */
             break;
         R[5] = R[5] | MVC_FILL;                         /* set state */
+        while (str_host && (R[4] > 0)) {                /* page at a time */
+            lnt = R[4];
+            if (lnt > STR_PAGE_LEFT (R[3]))
+                lnt = STR_PAGE_LEFT (R[3]);
+            if ((dp = HostAddr (R[3], WA)) == NULL)
+                break;
+            memset (dp, fill & BMASK, lnt);
+            HostWritten (dp);
+            R[3] = R[3] + lnt;                          /* inc dst addr */
+            R[4] = R[4] - lnt;                          /* dec fill lnt */
+            extra_bytes = extra_bytes + (lnt >> 2);
+            }
         mlnt[0] = (4 - R[3]) & 3;                       /* length to align */
         if (mlnt[0] > R[4])                             /* cant exceed total */
             mlnt[0] = R[4];
@@ -952,7 +1012,8 @@ return cc;
 
 int32 op_cmpc (int32 *opnd, int32 cmpc5, int32 acc)
 {
-int32 cc, s1, s2, fill;
+int32 cc, s1, s2, fill, i, lnt;
+uint8 *p1, *p2;
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
     SETPC (fault_PC + STR_GETDPC (R[0]));               /* reset PC */
@@ -974,6 +1035,30 @@ else {
     PSL = PSL | PSL_FPD;
     }
 R[2] = R[2] & STR_LNMASK;                               /* mask src2len */
+while (str_host && (R[0] & STR_LNMASK) && R[2]) {       /* page at a time */
+    lnt = R[0] & STR_LNMASK;                            /* while both strings */
+    if (lnt > R[2])
+        lnt = R[2];
+    if (lnt > STR_PAGE_LEFT (R[1]))
+        lnt = STR_PAGE_LEFT (R[1]);
+    if (lnt > STR_PAGE_LEFT (R[3]))
+        lnt = STR_PAGE_LEFT (R[3]);
+    if (((p1 = HostAddr (R[1], RA)) == NULL) ||
+        ((p2 = HostAddr (R[3], RA)) == NULL))
+        break;
+    if (memcmp (p1, p2, lnt) == 0)
+        i = lnt;
+    else {
+        for (i = 0; p1[i] == p2[i]; i++) ;              /* find difference */
+        }
+    R[0] = R[0] - i;                                    /* skip equal bytes */
+    R[1] = R[1] + i;
+    R[2] = R[2] - i;
+    R[3] = R[3] + i;
+    extra_bytes = extra_bytes + i;
+    if (i < lnt)                                        /* difference? */
+        break;                                          /* compared below */
+    }
 for (s1 = s2 = 0; ((R[0] | R[2]) & STR_LNMASK) != 0; extra_bytes++) {
     if (R[0] & STR_LNMASK)                              /* src1? read */
         s1 = Read (R[1], L_BYTE, RA);
@@ -1012,7 +1097,8 @@ return cc;
 
 int32 op_locskp (int32 *opnd, int32 skpc, int32 acc)
 {
-int32 c, match;
+int32 c, match, i, lnt;
+uint8 *sp, *fp;
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
     SETPC (fault_PC + STR_GETDPC (R[0]));               /* reset PC */
@@ -1024,6 +1110,25 @@ else {
     R[1] = opnd[2];                                     /* src addr */
     PSL = PSL | PSL_FPD;
     }
+while (str_host && (R[0] & STR_LNMASK)) {               /* page at a time */
+    lnt = R[0] & STR_LNMASK;
+    if (lnt > STR_PAGE_LEFT (R[1]))
+        lnt = STR_PAGE_LEFT (R[1]);
+    if ((sp = HostAddr (R[1], RA)) == NULL)
+        break;
+    if (skpc) {
+        for (i = 0; (i < lnt) && (sp[i] == match); i++) ;
+        }
+    else {
+        fp = (uint8 *) memchr (sp, match, lnt);
+        i = (fp == NULL)? lnt: (int32) (fp - sp);
+        }
+    R[0] = R[0] - i;                                    /* skip bytes */
+    R[1] = R[1] + i;
+    extra_bytes = extra_bytes + i;
+    if (i < lnt)                                        /* found? */
+        break;                                          /* finished below */
+    }
 for ( ; (R[0] & STR_LNMASK) != 0; extra_bytes++ ) {    /* loop thru string */
     c = Read (R[1], L_BYTE, RA);                        /* get src byte */
     if ((c == match) ^ skpc)                            /* match & locc? */
@@ -1052,7 +1157,8 @@ return (R[0]? 0: CC_Z);                                 /* set cc's */
 
 int32 op_scnspn (int32 *opnd, int32 spanc, int32 acc)
 {
-int32 c, t, mask;
+int32 c, t, mask, i, lnt;
+uint8 *sp, *tp;
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
     SETPC (fault_PC + STR_GETDPC (R[0]));               /* reset PC */
@@ -1065,6 +1171,21 @@ else {
     R[0] = STR_PACK (mask, opnd[0]);                    /* srclen + FPD data */
     PSL = PSL | PSL_FPD;
     }
+while (str_host && (R[0] & STR_LNMASK) &&               /* page at a time, */
+       (STR_PAGE_LEFT (R[3]) >= 256)) {                 /* table in one page? */
+    lnt = R[0] & STR_LNMASK;
+    if (lnt > STR_PAGE_LEFT (R[1]))
+        lnt = STR_PAGE_LEFT (R[1]);
+    if (((sp = HostAddr (R[1], RA)) == NULL) ||
+        ((tp = HostAddr (R[3], RA)) == NULL))
+        break;
+    for (i = 0; (i < lnt) && ((((tp[sp[i]] & mask) != 0) ^ spanc) == 0); i++) ;
+    R[0] = R[0] - i;                                    /* skip bytes */
+    R[1] = R[1] + i;
+    extra_bytes = extra_bytes + i;
+    if (i < lnt)                                        /* found? */
+        break;                                          /* finished below */
+    }
 for ( ; (R[0] & STR_LNMASK) != 0; extra_bytes++ ) {    /* loop thru string */
     c = Read (R[1], L_BYTE, RA);                        /* get byte */
     t = Read (R[3] + c, L_BYTE, RA);                    /* get table ent */
@@ -1079,6 +1200,189 @@ R[2] = 0;
 return (R[0]? 0: CC_Z);
 }
 
+/* CPU library test (TESTLIB CPU)
+
+   Runs the string instructions over a test pattern with and without the
+   page at a time paths, first with memory management off and then with
+   it on and the pages of the test area mapped in reverse physical order,
+   and checks that memory, R0-R5, PSL<fpd> and the condition codes come
+   out the same.  Then times MOVC3 both ways.
+*/
+
+#define STRT_SIZE       0x20000                         /* test area size */
+#define STRT_PA         0x20000                         /* test area phys addr */
+#define STRT_VA         0x80000000                      /* test area virt addr */
+#define STRT_SPT        0x1000                          /* test SPT phys addr */
+#define STRT_SAVE       (STRT_PA + STRT_SIZE)           /* memory used */
+#define STRT_PAGES      (STRT_SIZE >> VA_N_OFF)
+
+typedef struct {
+    const char  *name;
+    int32       (*op)(int32 *opnd, int32 flg, int32 acc);
+    int32       flg;
+    int32       opnd[5];                                /* addresses relative */
+    int32       rel;                                    /* opnds that are addrs */
+    } STRTEST;
+
+static const STRTEST str_tests[] = {
+    { "MOVC3 forward",     &op_movc,   0, { 0x5003, 0x10203, 0x107 }, 06 },
+    { "MOVC3 overlap up",  &op_movc,   0, { 0x2345, 0x1001, 0x1403 }, 06 },
+    { "MOVC3 overlap down",&op_movc,   0, { 0x2345, 0x1403, 0x1001 }, 06 },
+    { "MOVC5 fill",        &op_movc,   1, { 0x311, 0x5, 0x5A, 0x1800, 0x12001 }, 022 },
+    { "MOVC5 truncate",    &op_movc,   1, { 0x1800, 0x7, 0, 0x611, 0x13003 }, 022 },
+    { "CMPC3",             &op_cmpc,   0, { 0x8000, 0x10, 0x10010 }, 06 },
+    { "CMPC5",             &op_cmpc,   1, { 0x100, 0x8000, 0x20, 0x1200, 0x8000 }, 022 },
+    { "LOCC",              &op_locskp, 0, { 0xEE, 0x8000, 0x10000 }, 04 },
+    { "LOCC not found",    &op_locskp, 0, { 0x20, 0x7000, 0x9000 }, 04 },
+    { "SKPC",              &op_locskp, 1, { 0x20, 0x1800, 0x8000 }, 04 },
+    { "SCANC",             &op_scnspn, 0, { 0x3000, 0x33, 0x1F000, 0x40 }, 06 },
+    { "SPANC",             &op_scnspn, 1, { 0x3000, 0x1033, 0x1F1C0, 0x01 }, 06 },
+    { NULL }
+    };
+
+static void str_test_fill (uint32 base)
+{
+int32 i, acc = ACC_MASK (PSL_GETCUR (PSL));
+
+for (i = 0; i < STRT_SIZE; i++) {
+    int32 j = (i >= 0x10000)? i - 0x10000: i;
+    int32 c = ((j * 13) + ((j >> 8) * 7)) & BMASK;
+
+    if ((j >= 0x8000) && (j < 0x9000))
+        c = ' ';
+    if (i == 0x14321)
+        c = 0xEE;
+    Write (base + i, c, L_BYTE, WA);
+    }
+}
+
+static t_stat str_test_run (uint32 base, const STRTEST *t, uint8 *mem, int32 *regs)
+{
+int32 i, opnd[5], acc = ACC_MASK (PSL_GETCUR (PSL));
+
+str_test_fill (base);
+for (i = 0; i < 5; i++)
+    opnd[i] = t->opnd[i] + (((t->rel >> i) & 1)? base: 0);
+for (i = 0; i < 6; i++)
+    R[i] = 0;
+PSL = PSL & ~PSL_FPD;
+regs[6] = t->op (opnd, t->flg, acc);
+for (i = 0; i < 6; i++)
+    regs[i] = R[i];
+regs[7] = PSL & PSL_FPD;
+for (i = 0; i < STRT_SIZE; i++)
+    mem[i] = (uint8) Read (base + i, L_BYTE, RA);
+return SCPE_OK;
+}
+
+static t_stat str_test_mode (uint32 base, uint8 **mem)
+{
+const STRTEST *t;
+int32 i, regs[2][8];
+
+for (t = str_tests; t->name != NULL; t++) {
+    str_host = FALSE;
+    str_test_run (base, t, mem[0], regs[0]);
+    str_host = TRUE;
+    str_test_run (base, t, mem[1], regs[1]);
+    for (i = 0; i < 8; i++) {
+        static const char *rname[8] = { "R0", "R1", "R2", "R3", "R4", "R5", "cc", "fpd" };
+
+        if (regs[0][i] != regs[1][i])
+            return sim_messagef (SCPE_IERR, "%s: %s is %X, expected %X\n", t->name,
+                                 rname[i], regs[1][i], regs[0][i]);
+        }
+    if (memcmp (mem[0], mem[1], STRT_SIZE) != 0) {
+        for (i = 0; mem[0][i] == mem[1][i]; i++) ;
+        return sim_messagef (SCPE_IERR, "%s: byte %X is %02X, expected %02X\n",
+                             t->name, base + i, mem[1][i], mem[0][i]);
+        }
+    }
+return SCPE_OK;
+}
+
+static double str_test_rate (uint32 base, t_bool host)
+{
+int32 i, opnd[3], acc = ACC_MASK (PSL_GETCUR (PSL));
+uint32 start, msec;
+
+str_host = host;
+opnd[0] = 0xFFFF;
+opnd[1] = base + 3;
+opnd[2] = base + 0x10001;
+start = sim_os_msec ();
+for (i = 0; (msec = sim_os_msec () - start) < 200; i++) {  /* for 200 msec */
+    PSL = PSL & ~PSL_FPD;
+    op_movc (opnd, 0, acc);
+    }
+return (((double) i) * 0xFFFF) / (msec * 1000.0);
+}
+
+t_stat cpu_test (DEVICE *dptr, CONST char *cptr)
+{
+uint8 *save, *mem[2];
+int32 i, sv_R[6], sv_PSL, sv_mapen, sv_SBR, sv_SLR;
+t_stat r;
+
+sim_printf ("Testing %s string instructions:\n", dptr->name);
+if (MEMSIZE < STRT_SAVE)
+    return sim_messagef (SCPE_OK, "  Skipped, memory size too small\n");
+save = (uint8 *) malloc (STRT_SAVE);
+mem[0] = (uint8 *) malloc (STRT_SIZE);
+mem[1] = (uint8 *) malloc (STRT_SIZE);
+if ((save == NULL) || (mem[0] == NULL) || (mem[1] == NULL)) {
+    free (save);
+    free (mem[0]);
+    free (mem[1]);
+    return SCPE_MEM;
+    }
+memcpy (save, M, STRT_SAVE);
+for (i = 0; i < 6; i++)
+    sv_R[i] = R[i];
+sv_PSL = PSL;
+sv_mapen = mapen;
+sv_SBR = SBR;
+sv_SLR = SLR;
+
+mapen = 0;                                              /* physical */
+zap_tb (1);
+r = str_test_mode (STRT_PA, mem);
+if (r == SCPE_OK) {
+    sim_printf ("  Physical: OK\n");
+    for (i = 0; i < STRT_PAGES; i++)                    /* reversed pages */
+        M[(STRT_SPT >> 2) + i] = PTE_V | (4 << PTE_V_ACC) |
+                                 ((STRT_PA >> VA_N_OFF) + STRT_PAGES - 1 - i);
+    SBR = STRT_SPT;
+    SLR = STRT_PAGES;
+    mapen = 1;
+    set_map_reg ();
+    zap_tb (1);
+    r = str_test_mode (STRT_VA, mem);
+    }
+if (r == SCPE_OK) {
+    sim_printf ("  Mapped: OK\n");
+    sim_printf ("  MOVC3 65535 bytes, mapped: %.1f MB/s a byte or longword at a time, "
+                "%.1f MB/s a page at a time\n",
+                str_test_rate (STRT_VA, FALSE), str_test_rate (STRT_VA, TRUE));
+    }
+
+str_host = TRUE;                                        /* restore state */
+memcpy (M, save, STRT_SAVE);
+for (i = 0; i < 6; i++)
+    R[i] = sv_R[i];
+PSL = sv_PSL;
+mapen = sv_mapen;
+SBR = sv_SBR;
+SLR = sv_SLR;
+set_map_reg ();
+zap_tb (1);
+extra_bytes = 0;
+free (save);
+free (mem[0]);
+free (mem[1]);
+return r;
+}
+
 /* Operating system interfaces */
 
 /* Interrupt or exception
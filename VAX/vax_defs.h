@@ -911,6 +911,7 @@ extern int32 op_movc (int32 *opnd, int32 opc, int32 acc);
 extern int32 op_cmpc (int32 *opnd, int32 opc, int32 acc);
 extern int32 op_locskp (int32 *opnd, int32 opc, int32 acc);
 extern int32 op_scnspn (int32 *opnd, int32 opc, int32 acc);
+extern t_stat cpu_test (DEVICE *dptr, CONST char *cptr);
 extern int32 op_chm (int32 *opnd, int32 cc, int32 opc);
 extern int32 op_rei (int32 acc);
 extern void op_ldpctx (int32 acc);
@@ -57,6 +57,17 @@ int32 d_p0br, d_p0lr;                                   /* dynamic copies */
 int32 d_p1br, d_p1lr;                                   /* altered per ucode */
 int32 d_sbr, d_slr;
 TLBENT stlb[VA_TBSIZE], ptlb[VA_TBSIZE];
+t_bool tlb_stats = FALSE;                               /* count hits */
+t_uint64 tlb_hits = 0;                                  /* statistics */
+static t_uint64 tlb_misses = 0;
+static t_uint64 tlb_flushes = 0;                        /* all entries */
+static t_uint64 tlb_pflushes = 0;                       /* process entries */
+static t_uint64 tlb_sflushes = 0;                       /* single entry */
+
+/* Host pointer to a page of memory, NULL if not memory */
+
+#define TLB_HOSTPTR(pte) (ADDR_IS_MEM ((pte) & TLB_PFN)? \
+                          (uint32 *)(M + (((pte) & TLB_PFN) >> 2)): NULL)
 static const int32 cvtacc[16] = { 0, 0,
     TLB_ACCW (KERN)+TLB_ACCR (KERN),
     TLB_ACCR (KERN),
@@ -83,6 +94,8 @@ static const int32 cvtacc[16] = { 0, 0,
 t_stat tlb_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat tlb_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
 t_stat tlb_reset (DEVICE *dptr);
+t_stat tlb_set_stats (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat tlb_show_stats (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 const char *tlb_description (DEVICE *dptr);
 
 TLBENT fill (uint32 va, int32 lnt, int32 acc, int32 *stat);
@@ -109,8 +122,16 @@ REG tlb_reg[] = {
     { NULL }
     };
 
+MTAB tlb_mod[] = {
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 1, "STATISTICS", "STATISTICS",
+      &tlb_set_stats, &tlb_show_stats, NULL, "Count translation buffer hits / Display translation buffer statistics" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOSTATISTICS",
+      &tlb_set_stats, NULL, NULL, "Stop counting translation buffer hits" },
+    { 0 }
+    };
+
 DEVICE tlb_dev = {
-    "TLB", tlb_unit, tlb_reg, NULL,
+    "TLB", tlb_unit, tlb_reg, tlb_mod,
     2, 16, VA_N_TBI * 2, 1, 16, 32,
     &tlb_ex, &tlb_dep, &tlb_reset,
     NULL, NULL, NULL, NULL, 0, 0, NULL, NULL, NULL, NULL, NULL, NULL, 
@@ -142,7 +163,9 @@ TLBENT fill (uint32 va, int32 lnt, int32 acc, int32 *stat)
 {
 int32 ptidx = (((uint32) va) >> 7) & ~03;
 int32 tlbpte, ptead, pte, tbi, vpn;
-static TLBENT zero_pte = { 0, 0 };
+static TLBENT zero_pte = { 0, 0, NULL };
+
+tlb_misses = tlb_misses + 1;
 
 if (va & VA_S0) {                                       /* system space? */
     if (ptidx >= d_slr)                                 /* system */
@@ -179,6 +202,7 @@ else {
         stlb[tbi].tag = vpn;                            /* set stlb tag */
         stlb[tbi].pte = cvtacc[PTE_GETACC (pte)] |
             ((pte << VA_N_OFF) & TLB_PFN);              /* set stlb data */
+        stlb[tbi].hp = TLB_HOSTPTR (stlb[tbi].pte);
         }
     ptead = (stlb[tbi].pte & TLB_PFN) | VA_GETOFF (ptead);
 #endif
@@ -200,10 +224,12 @@ tbi = VA_GETTBI (vpn);
 if ((va & VA_S0) == 0) {                                /* process space? */
     ptlb[tbi].tag = vpn;                                /* store tlb ent */
     ptlb[tbi].pte = tlbpte;
+    ptlb[tbi].hp = TLB_HOSTPTR (tlbpte);
     return ptlb[tbi];
     }
 stlb[tbi].tag = vpn;                                    /* system space */
 stlb[tbi].pte = tlbpte;                                 /* store tlb ent */
+stlb[tbi].hp = TLB_HOSTPTR (tlbpte);
 return stlb[tbi];
 }
 
@@ -227,9 +253,15 @@ size_t i;
 
 for (i = 0; i < VA_TBSIZE; i++) {
     ptlb[i].tag = ptlb[i].pte = -1;
-    if (stb)
+    ptlb[i].hp = NULL;
+    if (stb) {
         stlb[i].tag = stlb[i].pte = -1;
+        stlb[i].hp = NULL;
+        }
     }
+if (stb)
+    tlb_flushes = tlb_flushes + 1;
+else tlb_pflushes = tlb_pflushes + 1;
 }
 
 /* Zap single tb entry corresponding to va */
@@ -238,9 +270,15 @@ void zap_tb_ent (uint32 va)
 {
 int32 tbi = VA_GETTBI (VA_GETVPN (va));
 
-if (va & VA_S0)
+if (va & VA_S0) {
     stlb[tbi].tag = stlb[tbi].pte = -1;
-else ptlb[tbi].tag = ptlb[tbi].pte = -1;
+    stlb[tbi].hp = NULL;
+    }
+else {
+    ptlb[tbi].tag = ptlb[tbi].pte = -1;
+    ptlb[tbi].hp = NULL;
+    }
+tlb_sflushes = tlb_sflushes + 1;
 }
 
 /* Check for tlb entry corresponding to va */
@@ -282,8 +320,14 @@ uint32 idx = (uint32) addr >> 1;
 if (idx >= VA_TBSIZE)
     return SCPE_NXM;
 if (addr & 1) {
-    if (tlbn) stlb[idx].pte = (int32) val;
-    else ptlb[idx].pte = (int32) val;
+    if (tlbn) {
+        stlb[idx].pte = (int32) val;
+        stlb[idx].hp = TLB_HOSTPTR (stlb[idx].pte);
+        }
+    else {
+        ptlb[idx].pte = (int32) val;
+        ptlb[idx].hp = TLB_HOSTPTR (ptlb[idx].pte);
+        }
     }
 else {
     if (tlbn) stlb[idx].tag = (int32) val;
@@ -298,8 +342,42 @@ t_stat tlb_reset (DEVICE *dptr)
 {
 size_t i;
 
-for (i = 0; i < VA_TBSIZE; i++)
+for (i = 0; i < VA_TBSIZE; i++) {
     stlb[i].tag = ptlb[i].tag = stlb[i].pte = ptlb[i].pte = -1;
+    stlb[i].hp = ptlb[i].hp = NULL;
+    }
+tlb_hits = tlb_misses = 0;
+tlb_flushes = tlb_pflushes = tlb_sflushes = 0;
+return SCPE_OK;
+}
+
+/* Hits are only counted after SET TLB STATISTICS, which keeps the
+   counter update out of the inlined memory access routines otherwise.
+   Misses and flushes are counted in the slow paths and always kept.
+*/
+
+t_stat tlb_set_stats (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr)
+    return SCPE_ARG;
+tlb_stats = (val != 0);
+tlb_hits = tlb_misses = 0;
+tlb_flushes = tlb_pflushes = tlb_sflushes = 0;
+return SCPE_OK;
+}
+
+t_stat tlb_show_stats (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+t_uint64 total = tlb_hits + tlb_misses;
+
+if (tlb_stats)
+    fprintf (st, "  Hits:     %" LL_FMT "u\n", (unsigned LL_TYPE)tlb_hits);
+else fprintf (st, "  Hits:     not counted, SET TLB STATISTICS to count\n");
+fprintf (st, "  Misses:   %" LL_FMT "u\n", (unsigned LL_TYPE)tlb_misses);
+if (tlb_stats && total)
+    fprintf (st, "  Hit rate: %.1f%%\n", (100.0 * (double)tlb_hits) / (double)total);
+fprintf (st, "  Flushes:  %" LL_FMT "u all, %" LL_FMT "u process, %" LL_FMT "u single\n",
+    (unsigned LL_TYPE)tlb_flushes, (unsigned LL_TYPE)tlb_pflushes, (unsigned LL_TYPE)tlb_sflushes);
 return SCPE_OK;
 }
 
@@ -54,6 +54,7 @@
 typedef struct {
     int32       tag;                                    /* tag */
     int32       pte;                                    /* pte */
+    uint32      *hp;                                    /* host page ptr, NULL if not memory */
     } TLBENT;
 
 extern uint32 *M;
@@ -63,6 +64,8 @@ extern int32 mapen;                                     /* map enable */
 
 extern int32 mchk_va, mchk_ref;                         /* for mcheck */
 extern TLBENT stlb[VA_TBSIZE], ptlb[VA_TBSIZE];
+extern t_bool tlb_stats;                                /* TB statistics enabled */
+extern t_uint64 tlb_hits;                               /* TB statistics */
 
 static const int32 insert[4] = {
     0x00000000, 0x000000FF, 0x0000FFFF, 0x00FFFFFF
@@ -103,6 +106,11 @@ static SIM_INLINE void WriteL (uint32 pa, int32 val);
         write, with three cases: unaligned long, unaligned word within
         a longword, unaligned word crossing a longword boundary.
 
+   A translation buffer entry for a page of main memory also holds a
+   pointer to the page in the simulator's memory array, so that an aligned
+   reference which hits in the translation buffer is made directly, without
+   the physical address checks of the physical read and write routines.
+
    Note that these routines do not handle quad or octa references.
 */
 
@@ -131,6 +139,17 @@ if (mapen) {                                            /* mapping on? */
     if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
         ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0)))
         xpte = fill (va, lnt, acc, NULL);               /* fill if needed */
+    else if (tlb_stats)
+        tlb_hits = tlb_hits + 1;
+    if ((xpte.hp != NULL) && ((off & (lnt - 1)) == 0)) { /* memory, aligned? */
+        int32 dat = xpte.hp[off >> 2];
+
+        if (lnt >= L_LONG)                              /* long, quad? */
+            return dat;
+        if (lnt == L_WORD)                              /* word? */
+            return ((dat >> ((off & 2)? 16: 0)) & WMASK);
+        return ((dat >> ((off & 3) << 3)) & BMASK);     /* byte */
+        }
     pa = (xpte.pte & TLB_PFN) | off;                    /* get phys addr */
     }
 else {
@@ -197,7 +216,24 @@ if (mapen) {
     if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
         ((xpte.pte & TLB_M) == 0))
         xpte = fill (va, lnt, acc, NULL);
+    else if (tlb_stats)
+        tlb_hits = tlb_hits + 1;
     pa = (xpte.pte & TLB_PFN) | off;
+    if ((xpte.hp != NULL) && ((off & (lnt - 1)) == 0)) { /* memory, aligned? */
+        uint32 *mp = &xpte.hp[off >> 2];
+
+        if (lnt >= L_LONG)                              /* long, quad? */
+            *mp = val;
+        else if (lnt == L_WORD)                         /* word? */
+            *mp = (off & 2)? (*mp & 0xFFFF) | (val << 16):
+                (*mp & ~0xFFFF) | val;
+        else {                                          /* byte */
+            int32 sc = (off & 3) << 3;
+            *mp = (*mp & ~(0xFF << sc)) | (val << sc);
+            }
+        SIM_MEM_DIRTY (pa);
+        return;
+        }
     }
 else {
     pa = va & PAMASK;
@@ -366,6 +402,7 @@ if (ADDR_IS_MEM (pa)) {
     int32 sc = (pa & 3) << 3;
     int32 mask = 0xFF << sc;
     M[id] = (M[id] & ~mask) | (val << sc);
+    SIM_MEM_DIRTY (pa);
     }
 else {
     mchk_ref = REF_V;
@@ -383,6 +420,7 @@ if (ADDR_IS_MEM (pa)) {
     int32 id = pa >> 2;
     M[id] = (pa & 2)? (M[id] & 0xFFFF) | (val << 16):
         (M[id] & ~0xFFFF) | val;
+    SIM_MEM_DIRTY (pa);
     }
 else {
     mchk_ref = REF_V;
@@ -396,8 +434,10 @@ return;
 
 static SIM_INLINE void WriteL (uint32 pa, int32 val)
 {
-if (ADDR_IS_MEM (pa))
+if (ADDR_IS_MEM (pa)) {
     M[pa >> 2] = val;
+    SIM_MEM_DIRTY (pa);
+    }
 else {
     mchk_ref = REF_V;
     if (ADDR_IS_IO (pa))
@@ -410,8 +450,10 @@ return;
 
 static SIM_INLINE void WriteLP (uint32 pa, int32 val)
 {
-if (ADDR_IS_MEM (pa))
+if (ADDR_IS_MEM (pa)) {
     M[pa >> 2] = val;
+    SIM_MEM_DIRTY (pa);
+    }
 else {
     mchk_va = pa;
     mchk_ref = REF_P;
@@ -439,6 +481,7 @@ if (ADDR_IS_MEM (pa)) {
     int32 bo = pa & 3;
     int32 sc = bo << 3;
     M[pa >> 2] = (M[pa >> 2] & ~(insert[lnt] << sc)) | ((val & insert[lnt]) << sc);
+    SIM_MEM_DIRTY (pa);
     }
 else {
     mchk_ref = REF_V;
@@ -450,4 +493,83 @@ else {
 return;
 }
 
+/* Host address of a virtual byte, for the string instructions
+
+   Translates va as a byte reference with access acc would, taking the
+   same faults, and returns a pointer to the byte in the memory array.
+   The pointer is good through the end of the page.  NULL is returned if
+   the page is not main memory, or if the host is big endian: memory is
+   an array of longwords, so its bytes are only in VAX order on a little
+   endian host.  After storing through the pointer, the caller must call
+   HostWritten for the page.
+*/
+
+static SIM_INLINE uint8 *HostAddr (uint32 va, int32 acc)
+{
+int32 vpn, off, tbi;
+uint32 pa;
+TLBENT xpte;
+
+if (!sim_end)
+    return NULL;
+mchk_va = va;
+if (mapen) {                                            /* mapping on? */
+    vpn = VA_GETVPN (va);                               /* get vpn, offset */
+    off = VA_GETOFF (va);
+    tbi = VA_GETTBI (vpn);
+    xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
+    if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
+        ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0)))
+        xpte = fill (va, L_BYTE, acc, NULL);            /* fill if needed */
+    else if (tlb_stats)
+        tlb_hits = tlb_hits + 1;
+    if (xpte.hp == NULL)                                /* not memory? */
+        return NULL;
+    return ((uint8 *) xpte.hp) + off;
+    }
+pa = va & PAMASK;
+if (!ADDR_IS_MEM (pa))
+    return NULL;
+return ((uint8 *) M) + pa;
+}
+
+/* Note a store into the page at a HostAddr pointer */
+
+static SIM_INLINE void HostWritten (const uint8 *hp)
+{
+uint32 pa = (uint32) (hp - (uint8 *) M);
+
+SIM_MEM_DIRTY (pa);
+}
+
+/* Block transfers between memory and a device buffer
+
+   ReadMemBlk and WriteMemBlk move a run of physically contiguous memory
+   to or from a device buffer with a single copy.  They are used by the
+   bus adapter DMA routines, which otherwise move a longword at a time.
+   The buffer holds the bytes (or little endian words) in memory order,
+   so a copy is only possible on a little endian host; on a big endian
+   host, or if the run is not entirely in memory, they return FALSE and
+   the caller transfers the data itself.
+*/
+
+static SIM_INLINE t_bool ReadMemBlk (uint32 pa, int32 bc, void *buf)
+{
+if (!sim_end || (bc <= 0) ||
+    !ADDR_IS_MEM (pa) || !ADDR_IS_MEM (pa + bc - 1))
+    return FALSE;
+memcpy (buf, ((uint8 *) M) + pa, bc);
+return TRUE;
+}
+
+static SIM_INLINE t_bool WriteMemBlk (uint32 pa, int32 bc, const void *buf)
+{
+if (!sim_end || (bc <= 0) ||
+    !ADDR_IS_MEM (pa) || !ADDR_IS_MEM (pa + bc - 1))
+    return FALSE;
+memcpy (((uint8 *) M) + pa, buf, bc);
+sim_mem_dirty_range (pa, bc);
+return TRUE;
+}
+
 #endif /* VAX_MMU_H_ */
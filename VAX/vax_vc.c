@@ -181,6 +181,9 @@ BITFIELD vc_ic_mode_bits[] = {
 #define VC_XSIZE        1024                            /* screen size */
 #define VC_YSIZE        864
 #define VC_MEMSIZE      (1u << 16)                      /* video memory size */
+#define VC_BUFLINES     (VC_MEMSIZE >> 5)               /* video memory lines (32 longwords each) */
+#define VC_TILE_W       32                              /* display update tile size */
+#define VC_TILE_H       16
 
 #define VC_MOVE_MAX     49                              /* mouse movement max (per update) */
 
@@ -228,7 +231,9 @@ uint32 vc_icdr = 0;                                     /* Interrupt controller
 uint32 vc_icsr = 0;                                     /* Interrupt controller status */
 uint32 *vc_map;                                         /* Scanline map */
 uint32 *vc_buf = NULL;                                  /* Video memory */
-uint32 *vc_lines = NULL;                                /* Video Display Lines */
+VID_FRAMEBUFFER vc_fb;                                  /* Video Display */
+uint32 vc_dirty[VC_BUFLINES];                           /* changed longwords in each memory line */
+t_bool vc_headless = FALSE;                             /* render without a display window */
 uint8 vc_cur[256];                                      /* Cursor image */
 uint32 vc_palette[2];                                   /* Monochrome palette */
 t_bool vc_active = FALSE;
@@ -241,6 +246,7 @@ t_stat vc_detach (UNIT *dptr);
 t_stat vc_set_enable (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat vc_set_capture (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat vc_show_capture (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
+t_stat vc_set_headless (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 void vc_setint (int32 src);
 int32 vc_inta (void);
 void vc_clrint (int32 src);
@@ -332,6 +338,10 @@ MTAB vc_mod[] = {
         &vc_set_capture, NULL, NULL, "Disable Captured Input Mode" },
     { MTAB_XTD|MTAB_VDV, TRUE, "OSCURSOR", NULL,
         NULL, &vc_show_capture, NULL, "Display Input Capture mode" },
+    { MTAB_XTD|MTAB_VDV, TRUE, NULL, "HEADLESS",
+        &vc_set_headless, NULL, NULL, "Render to memory without a display window" },
+    { MTAB_XTD|MTAB_VDV, FALSE, NULL, "NOHEADLESS",
+        &vc_set_headless, NULL, NULL, "Render to a display window" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "VIDEO", NULL,
         NULL, &vid_show_video, NULL, "Display the host system video capabilities" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 004, "ADDRESS", "ADDRESS",
@@ -528,7 +538,8 @@ switch (rg) {
     case 1:                                             /* Cursor X */
         vc_curx = data;
         sim_debug (SIM_VID_DBG_MOUSE, &vc_dev, "Cursor-X set: %d\n", vc_curx);
-        vid_set_cursor_position (CUR_X, CUR_Y);
+        if (!vc_headless)
+            vid_set_cursor_position (CUR_X, CUR_Y);
         break;
 
     case 2:                                             /* Mouse position */
@@ -546,7 +557,8 @@ switch (rg) {
         sim_debug (DBG_CRTC, &vc_dev, "CRTC-Data:%s[%d] Set: 0x%x\n", vc_crtc_regnames[crtc_rg], crtc_rg, vc_crtc[crtc_rg]);
         if (crtc_rg == CRTC_CAH) {
             sim_debug (SIM_VID_DBG_MOUSE, &vc_dev, "Cursor-Y-High set (%d). Y value: %d\n", vc_crtc[crtc_rg], CUR_Y);
-            vid_set_cursor_position (CUR_X, CUR_Y);
+            if (!vc_headless)
+                vid_set_cursor_position (CUR_X, CUR_Y);
             }
         if (crtc_rg == CRTC_CAL) {
             sim_debug (SIM_VID_DBG_MOUSE, &vc_dev, "Cursor-Y-Low set (%d). Y value: %d\n", vc_crtc[crtc_rg], CUR_Y);
@@ -719,13 +731,10 @@ else if (rg >= 0xFE00) {                                /* scanline map */
             }
         }
     }
-bufln = rg / 32;
-for (scrln = 0; scrln < 1024; scrln++) {
-    if ((vc_map[scrln] & 0x7FF) == bufln) {
-        vc_map[scrln] &= ~VCMAP_VLD;                    /* invalidate map */
-        }
+if (nval != t) {
+    vc_buf[rg] = nval;
+    vc_dirty[rg >> 5] |= (1u << (rg & 0x1F));          /* longword changed */
     }
-vc_buf[rg] = nval;
 }
 
 static SIM_INLINE void vc_invalidate (uint32 y1, uint32 y2)
@@ -871,9 +880,9 @@ t_stat vc_svc (UNIT *uptr)
 {
 SIM_MOUSE_EVENT mev;
 SIM_KEY_EVENT kev;
-t_bool updated = FALSE;                                 /* flag for refresh */
-uint32 lines;
-uint32 ln, col, off;
+uint32 ln, col, off, words, wd;
+uint32 *line;
+t_bool cur_line;
 int32 xpos, ypos, dx, dy;
 uint8 *cur;
 
@@ -896,7 +905,7 @@ else if ((vc_cur_x != CUR_X) ||                         /* moved (X)? or */
     vc_invalidate (CUR_Y, (CUR_Y + 16));                /* invalidate new pos */
     }
 
-if ((!vc_input_captured) &&                             /* OS cursor? AND*/
+if ((!vc_input_captured) && (!vc_headless) &&           /* OS cursor? AND*/
     ((vc_cur_f != CUR_F) ||                             /* (mask changed? OR */
      (vc_cur_new_data) ||                               /*  cursor image changed? OR) */
      (vc_cur_v != CUR_V))) {                            /*  visibility changed?) */
@@ -905,14 +914,15 @@ if ((!vc_input_captured) &&                             /* OS cursor? AND*/
 
 vc_cur_x = CUR_X;                                       /* store cursor data */
 vc_cur_y = CUR_Y;
-vid_set_cursor_position (vc_cur_x, vc_cur_y);
+if (!vc_headless)
+    vid_set_cursor_position (vc_cur_x, vc_cur_y);
 vc_cur_v = CUR_V;
 vc_cur_f = CUR_F;
 vc_cur_new_data = FALSE;
 
-if (vid_poll_kb (&kev) == SCPE_OK)                      /* poll keyboard */
+if ((!vc_headless) && (vid_poll_kb (&kev) == SCPE_OK))  /* poll keyboard */
     lk_event (&kev);                                    /* push event */
-if (vid_poll_mouse (&mev) == SCPE_OK) {                 /* poll mouse */
+if ((!vc_headless) && (vid_poll_mouse (&mev) == SCPE_OK)) {/* poll mouse */
     xpos = vc_mpos & 0xFF;                              /* get current mouse position */
     ypos = (vc_mpos >> 8) & 0xFF;
     dx = mev.x_rel;                                     /* get relative movement */
@@ -940,40 +950,50 @@ if (vid_poll_mouse (&mev) == SCPE_OK) {                 /* poll mouse */
     vs_event (&mev);                                    /* push event */
     }
 
-lines = 0;
+/* Only the longwords of video memory written since the last update are
+   expanded, unless the line's scanline map entry changed or the cursor is
+   drawn on it, and only the tiles they touch are sent to the display. */
+
 for (ln = 0; ln < VC_YSIZE; ln++) {
-    if ((vc_map[ln] & VCMAP_VLD) == 0) {                /* line invalid? */
-        off = vc_map[ln] * 32;                          /* get video buf offset */
-        for (col = 0; col < VC_XSIZE; col++)  
-            vc_lines[ln*VC_XSIZE + col] = vc_palette[(vc_buf[off + (col >> 5)] >> (col & 0x1F)) & 1];
-                                                        /* 1bpp to 32bpp */
-        if (CUR_V &&                                    /* cursor visible && need to draw cursor? */
-            (vc_input_captured || (vc_dev.dctrl & DBG_CURSOR))) {
-            if ((ln >= CUR_Y) && (ln < (CUR_Y + 16))) { /* cursor on this line? */
-                cur = &vc_cur[((ln - CUR_Y) << 4)];     /* get image base */
-                for (col = 0; col < 16; col++) {
-                    if ((CUR_X + col) >= VC_XSIZE)      /* Part of cursor off screen? */
-                        continue;                       /* Skip */
-                    if (CUR_F)                          /* mask function */
-                        vc_lines[ln*VC_XSIZE + CUR_X + col] = vc_palette[(vc_lines[ln*VC_XSIZE + CUR_X + col] == vc_palette[1]) | (cur[col] & 1)];
-                    else
-                        vc_lines[ln*VC_XSIZE + CUR_X + col] = vc_palette[(vc_lines[ln*VC_XSIZE + CUR_X + col] == vc_palette[1]) & (~cur[col] & 1)];
-                    }
+    off = (vc_map[ln] & VCMAP_LN) << 5;                 /* get video buf offset */
+    cur_line = (CUR_V &&                                /* cursor visible && need to draw cursor? */
+        (vc_input_captured || (vc_dev.dctrl & DBG_CURSOR)) &&
+        (ln >= CUR_Y) && (ln < (CUR_Y + 16)));          /* cursor on this line? */
+    words = vc_dirty[off >> 5];                         /* changed longwords */
+    if (((vc_map[ln] & VCMAP_VLD) == 0) ||              /* line invalid? or */
+        (cur_line && words))                            /* cursor line changed? */
+        words = 0xFFFFFFFF;                             /* redraw it all */
+    if (words == 0)                                     /* unchanged? */
+        continue;
+    line = &vc_fb.pixels[ln*VC_XSIZE];
+    if (words == 0xFFFFFFFF) {
+        vid_expand_1bpp (line, &vc_buf[off], VC_XSIZE, vc_palette);/* 1bpp to 32bpp */
+        vid_fb_mark (&vc_fb, 0, ln, VC_XSIZE, 1);
+        }
+    else {
+        for (wd = 0; words != 0; wd++, words >>= 1) {
+            if (words & 1) {
+                vid_expand_1bpp (&line[wd << 5], &vc_buf[off + wd], 32, vc_palette);
+                vid_fb_mark (&vc_fb, wd << 5, ln, 32, 1);
                 }
             }
-        vc_map[ln] |= VCMAP_VLD;                        /* set valid */
-        if ((ln == (VC_YSIZE-1)) ||                     /* if end of window OR */
-            (vc_map[ln+1] & VCMAP_VLD)) {               /* next is already valid? */
-            vid_draw (0, ln-lines, VC_XSIZE, lines+1, vc_lines+(ln-lines)*VC_XSIZE); /* update region */
-            lines = 0;
+        }
+    if (cur_line) {
+        cur = &vc_cur[((ln - CUR_Y) << 4)];             /* get image base */
+        for (col = 0; col < 16; col++) {
+            if ((CUR_X + col) >= VC_XSIZE)              /* Part of cursor off screen? */
+                continue;                               /* Skip */
+            if (CUR_F)                                  /* mask function */
+                line[CUR_X + col] = vc_palette[(line[CUR_X + col] == vc_palette[1]) | (cur[col] & 1)];
+            else
+                line[CUR_X + col] = vc_palette[(line[CUR_X + col] == vc_palette[1]) & (~cur[col] & 1)];
             }
-        else
-            lines++;
-        updated = TRUE;
         }
+    vc_map[ln] |= VCMAP_VLD;                            /* set valid */
     }
+memset (vc_dirty, 0, sizeof (vc_dirty));
 
-if (updated)                                            /* video updated? */
+if ((vid_fb_flush (&vc_fb) != 0) && (!vc_headless))     /* video updated? */
     vid_refresh ();                                     /* put to screen */
 
 ua2681_svc (&vc_uart);                                  /* service DUART */
@@ -1012,50 +1032,57 @@ if (dptr->flags & DEV_DIS) {
     if (vc_active) {
         free (vc_buf);
         vc_buf = NULL;
-        free (vc_lines);
-        vc_lines = NULL;
+        vid_fb_free (&vc_fb);
         free (vc_map);
         vc_map = NULL;
         vc_active = FALSE;
-        return vid_close ();
+        return vc_headless ? SCPE_OK : vid_close ();
         }
     else
         return SCPE_OK;
     }
 
-if (!vid_active)  {
-    r = vid_open (dptr, NULL, VC_XSIZE, VC_YSIZE, vc_input_captured ? SIM_VID_INPUTCAPTURED : 0);/* display size & capture mode */
-    if (r != SCPE_OK)
-        return r;
+if (!vc_active)  {
+    if (!vc_headless) {
+        r = vid_open (dptr, NULL, VC_XSIZE, VC_YSIZE, vc_input_captured ? SIM_VID_INPUTCAPTURED : 0);/* display size & capture mode */
+        if (r != SCPE_OK)
+            return r;
+        }
     vc_buf = (uint32 *) calloc (VC_MEMSIZE, sizeof (uint32));
     if (vc_buf == NULL) {
-        vid_close ();
+        if (!vc_headless)
+            vid_close ();
         return SCPE_MEM;
         }
-    vc_lines = (uint32 *) calloc (VC_XSIZE*VC_YSIZE, sizeof (uint32));
-    if (vc_lines == NULL) {
+    if (vid_fb_init (&vc_fb, NULL, VC_XSIZE, VC_YSIZE, VC_TILE_W, VC_TILE_H, vc_headless) != SCPE_OK) {
         free (vc_buf);
         vc_buf = NULL;
-        vid_close ();
+        if (!vc_headless)
+            vid_close ();
         return SCPE_MEM;
         }
     vc_map = (uint32 *) calloc (VC_XSIZE, sizeof (uint32));
     if (vc_map == NULL) {
-        free (vc_lines);
-        vc_lines = NULL;
+        vid_fb_free (&vc_fb);
         free (vc_buf);
         vc_buf = NULL;
-        vid_close ();
+        if (!vc_headless)
+            vid_close ();
         return SCPE_MEM;
         }
-    vc_palette[0] = vid_map_rgb (0x00, 0x00, 0x00);     /* black */
-    vc_palette[1] = vid_map_rgb (0xFF, 0xFF, 0xFF);     /* white */
+    memset (vc_dirty, 0, sizeof (vc_dirty));
+    vc_palette[0] = vid_fb_map_rgb (&vc_fb, 0x00, 0x00, 0x00);/* black */
+    vc_palette[1] = vid_fb_map_rgb (&vc_fb, 0xFF, 0xFF, 0xFF);/* white */
     vc_active = TRUE;
-    sim_printf ("QVSS Display Created.  ");
-    vc_show_capture (stdout, NULL, 0, NULL);
-    if (sim_log)
-        vc_show_capture (sim_log, NULL, 0, NULL);
-    sim_printf ("\n");
+    if (vc_headless)
+        sim_printf ("QVSS Headless Display Created.\n");
+    else {
+        sim_printf ("QVSS Display Created.  ");
+        vc_show_capture (stdout, NULL, 0, NULL);
+        if (sim_log)
+            vc_show_capture (sim_log, NULL, 0, NULL);
+        sim_printf ("\n");
+        }
     }
 sim_activate_abs (&vc_unit, tmxr_poll);
 return auto_config (NULL, 0);                           /* run autoconfig */
@@ -1083,6 +1110,14 @@ vc_input_captured = val;
 return SCPE_OK;
 }
 
+t_stat vc_set_headless (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (vc_active)
+    return sim_messagef (SCPE_ALATT, "Headless Mode Can't be changed with device enabled\n");
+vc_headless = val;
+return SCPE_OK;
+}
+
 t_stat vc_show_capture (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
 {
 if (vc_input_captured) {
@@ -1098,7 +1133,10 @@ t_stat vc_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr
 {
 fprintf (st, "VCB01 Monochrome Video Subsystem (%s)\n\n", dptr->name);
 fprintf (st, "Use the Control-Right-Shift key combination to regain focus from the simulated\n");
-fprintf (st, "video display\n");
+fprintf (st, "video display\n\n");
+fprintf (st, "SET %s HEADLESS, before the device is enabled, renders the display to memory\n", dptr->name);
+fprintf (st, "without opening a window.  The SCREENSHOT command saves the rendered image as\n");
+fprintf (st, "a BMP file.\n");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 fprint_reg_help (st, dptr);
@@ -275,6 +275,14 @@
 
 #define MAX_DO_NEST_LVL 20                              /* DO cmd nesting level limit */
 #define SRBSIZ          1024                            /* save/restore buffer */
+#define SRPAGSIZ        (1u << SIM_MEM_PAGE_SHIFT)      /* save/restore memory image page */
+#define SR_FMT_WORDS    0                               /* memory saved as examined values */
+#define SR_FMT_IMAGE    1                               /* memory saved as a memory image */
+#define SR_PAGE_ZERO    0                               /* image page is all zero */
+#define SR_PAGE_DUP     1                               /* image page repeats prior page */
+#define SR_PAGE_DATA    2                               /* image page data follows */
+#define SR_PAGE_BASE    3                               /* image page unchanged from base */
+#define SR_MAXCHAIN     64                              /* max incremental save chain */
 #define SIM_BRK_INILNT  4096                            /* bpt tbl length */
 #define SIM_BRK_ALLTYP  0xFFFFFFFB
 #define UPDATE_SIM_TIME                                         \
@@ -378,60 +386,360 @@ int32 sim_asynch_check;
 int32 sim_asynch_latency = 4000;      /* 4 usec interrupt latency */
 int32 sim_asynch_inst_latency = 20;   /* assume 5 mip simulator */
 
+/* Asynchronous event migration
+
+   Units whose events are activated by threads other than the simulator
+   thread are queued and later migrated into the simulator's event queue
+   by sim_aio_update_queue when the simulator polls (AIO_CHECK_EVENT).
+   A unit's a_next field is non NULL while it is queued, so each unit
+   is queued at most once.  The simulator thread is the only consumer,
+   and it drains pending events in batches of up to SIM_AIO_BATCH units.
+
+   When the platform provides compare and swap intrinsics, events are
+   queued on sim_aio_ring, a bounded multiple producer, single consumer
+   ring.  Each ring slot carries a sequence number: the slot at ring
+   position pos is free when its sequence is pos and holds a published
+   unit when its sequence is pos + 1.  Producers claim a position by
+   advancing sim_aio_ring_tail with a compare and swap, and the
+   simulator thread advances sim_aio_ring_head without any atomic
+   operation or lock.  Events which find the ring full, and all events
+   when no intrinsics are available, are placed on the mutex protected
+   sim_asynch_queue list.
+
+   A producer marks a unit queued and sets its a_event_time and
+   a_activate_call while holding AIO_LOCK, and an activation of a unit
+   which is already queued only changes its a_activate_call under the
+   same lock, so neither overwrites the other.  The simulator thread
+   captures a_activate_call and a_event_time of each unit in a batch and
+   marks it no longer queued under the same lock, so such an activation
+   is either part of the captured event or queues the unit again.  The
+   lock is held only for these few stores; the ring slot is claimed and
+   published without it, and the simulator thread takes it once per
+   batch.
+
+   The event counters are updated while holding AIO_LOCK.  Ring slot
+   claim retries and the queue to migrate latency are only measured
+   while SCP QUEUE debugging is enabled, since they need an atomic
+   increment or a read of the host clock for each event.
+*/
+
+#define SIM_AIO_BATCH       32                  /* events migrated per batch */
+
+typedef struct AIO_EVENT {
+    UNIT                *uptr;
+    ACTIVATE_API        call;
+    int32               event_time;
+    } AIO_EVENT;
+
+static struct {
+    uint32              queued;                 /* events queued by other threads */
+    uint32              coalesced;              /* activations of an already queued unit */
+    volatile uint32     retries;                /* ring slot claim retries (contention) */
+    uint32              overflows;              /* events placed on the overflow list */
+    t_uint64            drains;                 /* polls which migrated events */
+    t_uint64            migrated;               /* events migrated to the event queue */
+    uint32              max_batch;              /* most events migrated by one poll */
+    t_uint64            latency_count;          /* events with measured latency */
+    double              latency_total;          /* queue to migrate latency sum (usecs) */
+    uint32              latency_max;            /* queue to migrate latency max (usecs) */
+    } sim_aio_stats;
+
+#if defined(USE_AIO_INTRINSICS)
+#define SIM_AIO_RING_SIZE   256                 /* ring slots (power of 2) */
+
+typedef struct AIO_RING_SLOT {
+    volatile uint32     seq;                    /* slot sequence */
+    UNIT * volatile     uptr;                   /* queued unit */
+    uint32              stamp;                  /* usecs when queued */
+    } AIO_RING_SLOT;
+
+static AIO_RING_SLOT sim_aio_ring[SIM_AIO_RING_SIZE];
+static volatile uint32 sim_aio_ring_tail;       /* next producer position */
+static uint32 sim_aio_ring_head;                /* next consumer position */
+
+static uint32 _sim_aio_cas32 (volatile uint32 *dest, uint32 newval, uint32 oldval)
+{
+#if defined(_WIN32)
+return (uint32)InterlockedCompareExchange ((volatile LONG *)dest, (LONG)newval, (LONG)oldval);
+#else
+return (uint32)InterlockedCompareExchange (dest, newval, oldval);
+#endif
+}
+
+static void _sim_aio_count (volatile uint32 *counter)
+{
+uint32 val;
+
+do {
+    val = *counter;
+    } while (_sim_aio_cas32 (counter, val + 1, val) != val);
+}
+
+#define SIM_AIO_COUNT(counter) _sim_aio_count (&sim_aio_stats.counter)
+#define SIM_AIO_MEASURED (sim_deb && (sim_scp_dev.dctrl & SIM_DBG_AIO_QUEUE))
+
+static uint32 _sim_aio_usecs (void)
+{
+struct timespec now;
+
+#if defined(CLOCK_MONOTONIC)
+clock_gettime (CLOCK_MONOTONIC, &now);
+#else
+clock_gettime (CLOCK_REALTIME, &now);
+#endif
+return ((uint32)now.tv_sec * 1000000) + (uint32)(now.tv_nsec / 1000);
+}
+
+void sim_aio_ring_init (void)
+{
+uint32 i;
+
+for (i = 0; i < SIM_AIO_RING_SIZE; i++) {
+    sim_aio_ring[i].seq = i;
+    sim_aio_ring[i].uptr = NULL;
+    }
+sim_aio_ring_head = sim_aio_ring_tail = 0;
+}
+
+/* Claim and publish a ring slot for uptr, returns FALSE if the ring is full */
+
+static t_bool _sim_aio_ring_put (UNIT *uptr)
+{
+uint32 pos = sim_aio_ring_tail;
+AIO_RING_SLOT *slot;
+
+while (1) {
+    int32 dif;
+
+    slot = &sim_aio_ring[pos & (SIM_AIO_RING_SIZE - 1)];
+    dif = (int32)(slot->seq - pos);
+    if (dif == 0) {                             /* slot free? */
+        uint32 seen = _sim_aio_cas32 (&sim_aio_ring_tail, pos + 1, pos);
+
+        if (seen == pos)                        /* claimed it? */
+            break;
+        if (SIM_AIO_MEASURED)
+            SIM_AIO_COUNT (retries);
+        pos = seen;
+        }
+    else {
+        if (dif < 0)                            /* ring full */
+            return FALSE;
+        pos = sim_aio_ring_tail;                /* lost the race, reload */
+        }
+    }
+slot->uptr = uptr;
+slot->stamp = SIM_AIO_MEASURED ? _sim_aio_usecs () : 0;
+AIO_MEMORY_BARRIER;                             /* unit visible before publishing */
+slot->seq = pos + 1;
+return TRUE;
+}
+#else
+void sim_aio_ring_init (void)
+{
+}
+#endif
+
+/* Remove up to max pending events, ring first and then the overflow list */
+
+static int _sim_aio_drain (AIO_EVENT *batch, int max)
+{
+int count = 0, i;
+#if defined(USE_AIO_INTRINSICS)
+uint32 now = 0;
+
+while (count < max) {
+    AIO_RING_SLOT *slot = &sim_aio_ring[sim_aio_ring_head & (SIM_AIO_RING_SIZE - 1)];
+    UNIT *uptr;
+    uint32 latency;
+
+    if (slot->seq != sim_aio_ring_head + 1)     /* nothing published? */
+        break;
+    AIO_MEMORY_BARRIER;
+    uptr = slot->uptr;
+    if (slot->stamp != 0) {                     /* latency measured? */
+        if (now == 0)
+            now = _sim_aio_usecs ();
+        latency = now - slot->stamp;
+        if (latency < 0x80000000) {             /* ignore stamps from a later read */
+            ++sim_aio_stats.latency_count;
+            sim_aio_stats.latency_total += latency;
+            if (latency > sim_aio_stats.latency_max)
+                sim_aio_stats.latency_max = latency;
+            }
+        }
+    batch[count].uptr = uptr;
+    ++count;
+    AIO_MEMORY_BARRIER;                         /* slot contents consumed before release */
+    slot->seq = sim_aio_ring_head + SIM_AIO_RING_SIZE;
+    ++sim_aio_ring_head;
+    }
+#endif
+if ((count == 0) && (sim_asynch_queue == QUEUE_LIST_END))
+    return 0;
+AIO_LOCK;
+for (i = 0; i < count; i++) {                   /* capture ring events */
+    UNIT *uptr = batch[i].uptr;
+
+    batch[i].call = uptr->a_activate_call;
+    batch[i].event_time = uptr->a_event_time;
+    uptr->a_next = NULL;                        /* no longer queued */
+    }
+while ((count < max) && (sim_asynch_queue != QUEUE_LIST_END)) {
+    UNIT *uptr = sim_asynch_queue;
+
+    sim_asynch_queue = uptr->a_next;
+    batch[count].uptr = uptr;
+    batch[count].call = uptr->a_activate_call;
+    batch[count].event_time = uptr->a_event_time;
+    uptr->a_next = NULL;                        /* no longer queued */
+    ++count;
+    }
+AIO_UNLOCK;
+return count;
+}
+
+static void _sim_aio_show_pending_unit (FILE *st, UNIT *uptr)
+{
+DEVICE *dptr = find_dev_from_unit (uptr);
+
+if (dptr != NULL) {
+    fprintf (st, "  %s", sim_dname (dptr));
+    if (dptr->numunits > 1) fprintf (st, " unit %d",
+        (int32) (uptr - dptr->units));
+    }
+else fprintf (st, "  Unknown");
+fprintf (st, " event delay %d\n", uptr->a_event_time);
+}
+
+/* List pending events, called by the simulator thread holding sim_asynch_lock */
+
+static void _sim_aio_show_pending (FILE *st)
+{
+int32 pending = 0;
+UNIT *uptr;
+#if defined(USE_AIO_INTRINSICS)
+uint32 pos;
+
+for (pos = sim_aio_ring_head; ; pos++) {
+    AIO_RING_SLOT *slot = &sim_aio_ring[pos & (SIM_AIO_RING_SIZE - 1)];
+
+    if (slot->seq != pos + 1)
+        break;
+    _sim_aio_show_pending_unit (st, slot->uptr);
+    ++pending;
+    }
+#endif
+for (uptr = sim_asynch_queue; uptr != QUEUE_LIST_END; uptr = uptr->a_next) {
+    _sim_aio_show_pending_unit (st, uptr);
+    ++pending;
+    }
+if (pending == 0)
+    fprintf (st, "  Empty\n");
+}
+
+static void _sim_aio_show_statistics (FILE *st)
+{
+fprintf (st, "Asynchronous event queue statistics\n");
+fprintf (st, "  Events queued:    %s\n", sim_fmt_numeric ((double)sim_aio_stats.queued));
+fprintf (st, "  Coalesced:        %s\n", sim_fmt_numeric ((double)sim_aio_stats.coalesced));
+#if defined(USE_AIO_INTRINSICS)
+fprintf (st, "  Ring size:        %d\n", SIM_AIO_RING_SIZE);
+fprintf (st, "  Ring contention:  %s retries\n", sim_fmt_numeric ((double)sim_aio_stats.retries));
+fprintf (st, "  Ring overflows:   %s\n", sim_fmt_numeric ((double)sim_aio_stats.overflows));
+#endif
+fprintf (st, "  Events migrated:  %s\n", sim_fmt_numeric ((double)sim_aio_stats.migrated));
+fprintf (st, "  Migrating polls:  %s\n", sim_fmt_numeric ((double)sim_aio_stats.drains));
+fprintf (st, "  Average batch:    %.2f\n", sim_aio_stats.drains ? (double)sim_aio_stats.migrated / (double)sim_aio_stats.drains : 0.0);
+fprintf (st, "  Maximum batch:    %u\n", sim_aio_stats.max_batch);
+#if defined(USE_AIO_INTRINSICS)
+if (sim_aio_stats.latency_count) {
+    fprintf (st, "  Average latency:  %.1f usecs\n", sim_aio_stats.latency_total / (double)sim_aio_stats.latency_count);
+    fprintf (st, "  Maximum latency:  %u usecs\n", sim_aio_stats.latency_max);
+    }
+else
+    fprintf (st, "  Latency:          measured while SCP QUEUE debugging is enabled\n");
+#endif
+}
+
 int sim_aio_update_queue (void)
 {
+AIO_EVENT batch[SIM_AIO_BATCH];
 int migrated = 0;
+int count, i;
 
-AIO_ILOCK;
-if (AIO_QUEUE_VAL != QUEUE_LIST_END) {  /* List !Empty */
-    UNIT *q, *uptr;
-    int32 a_event_time;
-    do {                                /* Grab current queue */
-        q = AIO_QUEUE_VAL;
-        } while (q != AIO_QUEUE_SET(QUEUE_LIST_END, q));
-    while (q != QUEUE_LIST_END) {       /* List !Empty */
-        sim_debug (SIM_DBG_AIO_QUEUE, &sim_scp_dev, "Migrating Asynch event for %s after %d %s\n", sim_uname(q), q->a_event_time, sim_vm_interval_units);
-        ++migrated;
-        uptr = q;
-        q = q->a_next;
-        uptr->a_next = NULL;        /* hygiene */
-        if (uptr->a_activate_call != &sim_activate_notbefore) {
-            a_event_time = uptr->a_event_time-((sim_asynch_inst_latency+1)/2);
+do {
+    count = _sim_aio_drain (batch, SIM_AIO_BATCH);
+    for (i = 0; i < count; i++) {
+        UNIT *uptr = batch[i].uptr;
+        int32 a_event_time = batch[i].event_time;
+
+        sim_debug (SIM_DBG_AIO_QUEUE, &sim_scp_dev, "Migrating Asynch event for %s after %d %s\n", sim_uname(uptr), a_event_time, sim_vm_interval_units);
+        if (batch[i].call != &sim_activate_notbefore) {
+            a_event_time -= ((sim_asynch_inst_latency+1)/2);
             if (a_event_time < 0)
                 a_event_time = 0;
             }
-        else
-            a_event_time = uptr->a_event_time;
-        AIO_IUNLOCK;
-        uptr->a_activate_call (uptr, a_event_time);
+        batch[i].call (uptr, a_event_time);
         if (uptr->a_check_completion) {
             sim_debug (SIM_DBG_AIO_QUEUE, &sim_scp_dev, "Calling Completion Check for asynch event on %s\n", sim_uname(uptr));
             uptr->a_check_completion (uptr);
             }
-        AIO_ILOCK;
         }
+    migrated += count;
+    } while (count == SIM_AIO_BATCH);
+if (migrated) {
+    ++sim_aio_stats.drains;
+    sim_aio_stats.migrated += migrated;
+    if ((uint32)migrated > sim_aio_stats.max_batch)
+        sim_aio_stats.max_batch = (uint32)migrated;
     }
-AIO_IUNLOCK;
 return migrated;
 }
 
 void sim_aio_activate (ACTIVATE_API caller, UNIT *uptr, int32 event_time)
 {
-AIO_ILOCK;
+#if defined(USE_AIO_INTRINSICS)
+t_bool coalesced;
+#endif
+
 sim_debug (SIM_DBG_AIO_QUEUE, &sim_scp_dev, "Queueing Asynch event for %s after %d %s\n", sim_uname(uptr), event_time, sim_vm_interval_units);
+#if defined(USE_AIO_INTRINSICS)
+AIO_LOCK;
+coalesced = (uptr->a_next != NULL);
+if (coalesced) {                                /* already queued? */
+    uptr->a_activate_call = sim_activate_abs;
+    ++sim_aio_stats.coalesced;
+    }
+else {                                          /* claim unit for queueing */
+    uptr->a_event_time = event_time;
+    uptr->a_activate_call = caller;
+    uptr->a_next = QUEUE_LIST_END;              /* Mark as queued */
+    ++sim_aio_stats.queued;
+    }
+AIO_UNLOCK;
+if (!coalesced && !_sim_aio_ring_put (uptr)) {  /* ring full? */
+    AIO_LOCK;
+    uptr->a_next = sim_asynch_queue;
+    sim_asynch_queue = uptr;
+    ++sim_aio_stats.overflows;
+    AIO_UNLOCK;
+    }
+#else
+AIO_LOCK;
 if (uptr->a_next) {
     uptr->a_activate_call = sim_activate_abs;
+    ++sim_aio_stats.coalesced;
     }
 else {
-    UNIT *q;
     uptr->a_event_time = event_time;
     uptr->a_activate_call = caller;
-    do {
-        q = AIO_QUEUE_VAL;
-        uptr->a_next = q;                               /* Mark as on list */
-        } while (q != AIO_QUEUE_SET(uptr, q));
+    uptr->a_next = sim_asynch_queue;            /* Mark as on list */
+    sim_asynch_queue = uptr;
+    ++sim_aio_stats.queued;
     }
-AIO_IUNLOCK;
+AIO_UNLOCK;
+#endif
 sim_asynch_check = 0;                             /* try to force check */
 if (sim_idle_wait) {
     sim_debug (TIMER_DBG_IDLE, &sim_timer_dev, "waking due to event on %s after %d %s\n", sim_uname(uptr), event_time, sim_vm_interval_units);
@@ -463,6 +771,7 @@ t_value (*sim_vm_pc_value) (void) = NULL;
 t_bool (*sim_vm_is_subroutine_call) (t_addr **ret_addrs) = NULL;
 void (*sim_vm_reg_update) (REG *rptr, uint32 idx, t_value prev_val, t_value new_val) = NULL;
 t_bool (*sim_vm_fprint_stopped) (FILE *st, t_stat reason) = NULL;
+t_stat (*sim_vm_test) (DEVICE *dptr, CONST char *cptr) = NULL;
 const char *sim_vm_release = NULL;
 const char *sim_vm_release_message = NULL;
 const char **sim_clock_precalibrate_commands = NULL;
@@ -477,6 +786,8 @@ t_stat set_dev_enbdis (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat set_dev_debug (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat set_unit_enbdis (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat set_unit_append (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat set_unit_cache (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat set_unit_index (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat ssh_break (FILE *st, const char *cptr, int32 flg);
 t_stat show_cmd_fi (FILE *ofile, int32 flag, CONST char *cptr);
 t_stat show_config (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
@@ -487,6 +798,7 @@ t_stat show_show_commands (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST
 t_stat show_log_names (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_radix (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat show_unit_cache (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_logicals (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_modifiers (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_show_commands (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
@@ -578,9 +890,12 @@ t_stat set_prompt (int32 flag, CONST char *cptr);
 t_stat set_runlimit (int32 flag, CONST char *cptr);
 t_stat sim_set_asynch (int32 flag, CONST char *cptr);
 static const char *_get_dbg_verb (uint32 dbits, DEVICE* dptr, UNIT *uptr);
+static void _sim_debug_binary_flush (void);
+static t_bool _sim_debug_binary_text (const char *buf, size_t len);
 static t_stat sim_sanity_check_register_declarations (DEVICE **devices);
 static void fix_writelock_mtab (DEVICE *dptr);
 static t_stat _sim_debug_flush (void);
+static int _sim_clock_compare (const void *pa, const void *pb);
 
 /* Global data */
 
@@ -632,6 +947,15 @@ size_t *sim_sub_instr_off = NULL;   /* offsets in substitution buffer where orig
 static double sim_time;
 static uint32 sim_rtime;
 static int32 noqueue_time;
+static UNIT **sim_clock_heap = NULL;                    /* event queue heap (origin 1) */
+static int32 sim_clock_heap_count = 0;                  /* units on event queue */
+static int32 sim_clock_heap_size = 0;                   /* allocated heap slots */
+static uint32 sim_clock_seq = 0;                        /* event insertion sequence */
+static t_uint64 sim_queue_inserts = 0;                  /* event queue statistics */
+static t_uint64 sim_queue_cancels = 0;
+static t_uint64 sim_queue_dispatches = 0;
+static double sim_queue_depth_sum = 0.0;
+static int32 sim_queue_depth_max = 0;
 volatile t_bool stop_cpu = FALSE;
 volatile t_bool sigterm_received = FALSE;
 static unsigned int sim_stop_sleep_ms = 250;
@@ -766,10 +1090,18 @@ static const char *sim_sa64 = "64b addresses";
 static const char *sim_sa64 = "32b addresses";
 #endif
 const char *sim_savename = sim_name;      /* Simulator Name used in SAVE/RESTORE images */
+uint32 *sim_mem_dirty = NULL;                           /* memory image dirty page map */
+t_addr sim_mem_dirty_limit = 0;                         /* bytes covered by dirty page map */
+static char sr_stamp[CBUFSIZE] = "";                    /* snapshot dirty pages are relative to */
+static char sr_stamp_file[4*CBUFSIZE] = "";             /* file holding that snapshot */
+static const char *sr_base = NULL;                      /* base file of incremental save */
+static int32 sr_chain = 0;                              /* incremental restore depth */
 
 /* Tables and strings */
 
-const char save_vercur[] = "V4.0";
+const char save_vercur[] = "V4.2";
+const char save_ver42[] = "V4.2";
+const char save_ver41[] = "V4.1";
 const char save_ver40[] = "V4.0";
 const char save_ver35[] = "V3.5";
 const char save_ver32[] = "V3.2";
@@ -830,6 +1162,7 @@ const struct scp_error {
          {"FSSIZE",    "File System size larger than disk size"},
          {"RUNTIME",   "Run time limit exhausted"},
          {"INCOMPDSK", "Incompatible Disk Container"},
+         {"QFULL",     "Request queue full"},
     };
 
 const size_t size_map[] = { sizeof (int8),
@@ -1017,6 +1350,14 @@ static const char simh_help1[] =
       " to a file.  This includes the contents of main memory and all registers,\n"
       " and the I/O connections of devices:\n\n"
       "++SAVE <filename>\n\n"
+      "4Switches\n"
+      " The -I switch saves only the changes made since a base save file:\n\n"
+      "++SAVE -I <basefile> <filename>\n\n"
+      " The base file must be the one most recently saved or restored.  Pages of\n"
+      " main memory which haven't been written since then aren't stored.  Each\n"
+      " incremental save may be the base of the next one.  RESTORE of an\n"
+      " incremental save first restores its base (by the name given to SAVE -I),\n"
+      " so a whole chain is restored from its last file.\n"
 #define HLP_RESTORE     "*Commands Saving_and_Restoring_State RESTORE"
       "3RESTORE\n"
       " The RESTORE command (abbreviation REST, alternately GET) restores a\n"
@@ -1029,7 +1370,9 @@ static const char simh_help1[] =
       "++-F      Overrides the related file timestamp validation check\n"
       "\n"
       "4Notes:\n"
-      " 1) SAVE file format compresses zeroes to minimize file size.\n"
+      " 1) SAVE file format compresses zeroes to minimize file size.  The main\n"
+      " memory of simulators which provide a memory image is saved a page at a\n"
+      " time, and pages which are all zero or repeat the prior page aren't stored.\n"
       " 2) The simulator can't restore active incoming telnet sessions to\n"
       " multiplexer devices, but the listening ports will be restored across a\n"
       " save/restore.\n"
@@ -1415,6 +1758,16 @@ static const char simh_help1[] =
       " The size of the circular memory buffer that is used is specified on\n"
       " the SET DEBUG command line, for example:\n\n"
       "++SET DEBUG -B <sizeinMB> <debug-destination>\n\n"
+      "5-C\n"
+      " The -C switch causes debug messages to be written to the debug file as\n"
+      " compact binary records rather than as text.  Each message's arguments\n"
+      " are captured without formatting them, and the records are written to\n"
+      " the file by a background thread, so that heavy debug output slows the\n"
+      " simulator much less.  A binary debug file is rendered as the equivalent\n"
+      " text with the SHOW DEBUG DECODE command:\n\n"
+      "++SHOW DEBUG DECODE <binary-debug-file> {<output-file>}\n\n"
+      " The -C switch can't be combined with -B, and the debug destination must\n"
+      " be a file.\n"
 #define HLP_SET_BREAK  "*Commands SET Breakpoints"
       "3Breakpoints\n"
       "+SET BREAK <list>            set breakpoints\n"
@@ -1454,6 +1807,8 @@ static const char simh_help1[] =
 #endif
       "+SET CLOCK nocatchup         disable catchup clock ticks\n"
       "+SET CLOCK catchup           enable catchup clock ticks\n"
+      "+SET CLOCK tickless          idle with microsecond host waits\n"
+      "+SET CLOCK notickless        idle with millisecond host waits\n"
       "+SET CLOCK calib=n%%          specify idle calibration skip %%\n"
       "+SET CLOCK calib=ALWAYS      specify calibration independent of idle\n"
       "+SET CLOCK stop=n            stop execution after n %C\n\n"
@@ -1554,6 +1909,12 @@ static const char simh_help1[] =
       "+SET <dev> arg{,arg...}      set device parameters (see show modifiers)\n"
       "+SET <unit> ENABLED          enable unit\n"
       "+SET <unit> DISABLED         disable unit\n"
+      "+SET <unit> CACHE{=size}     enable disk unit sector cache\n"
+      "+SET <unit> NOCACHE          disable disk unit sector cache\n"
+      "+SET <unit> WRITEBACK        defer disk unit cached writes until flushed\n"
+      "+SET <unit> WRITETHROUGH     write disk unit cached writes immediately\n"
+      "+SET <unit> INDEX            save tape unit record index in a file\n"
+      "+SET <unit> NOINDEX          don't save tape unit record index\n"
       "+SET <unit> arg{,arg...}     set unit parameters (see show modifiers)\n"
       "+HELP <dev> SET              displays the device specific set commands\n"
       "++++++++                     available\n"
@@ -1573,9 +1934,13 @@ static const char simh_help2[] =
       "+sh{ow} s{how}               show SHOW commands for all devices\n" 
       "+sh{ow} n{ames}              show logical names\n"
       "+sh{ow} q{ueue}              show event queue\n"
+      "+sh{ow} q{ueue} statistics   show event queue statistics\n"
       "+sh{ow} ti{me}               show simulated time\n"
       "+sh{ow} th{rottle}           show simulation rate\n"
-      "+sh{ow} a{synch}             show asynchronous I/O state\n" 
+      "+sh{ow} a{synch}             show asynchronous I/O state and statistics\n" 
+      "+sh{ow} deb{ug}              show debug output state\n"
+      "+sh{ow} deb{ug} decode <file> {<outfile>}\n"
+      "++++++++                     render a binary (SET DEBUG -C) debug file\n"
       "+sh{ow} ve{rsion}            show simulator version\n"
       "+sh{ow} def{ault}            show current directory\n" 
       "+sh{ow} re{mote}             show remote console configuration\n" 
@@ -1586,6 +1951,7 @@ static const char simh_help2[] =
       "+sh{ow} <dev> SHOW           show device SHOW commands\n"
       "+sh{ow} <dev> {arg,...}      show device parameters\n"
       "+sh{ow} <unit> {arg,...}     show unit parameters\n"
+      "+sh{ow} <unit> CACHE         show disk unit sector cache statistics\n"
       "+sh{ow} ethernet             show ethernet devices\n"
       "+sh{ow} serial               show serial devices\n"
       "+sh{ow} synchronous          show DDCMP synchronous interface devices\n"
@@ -2645,6 +3011,12 @@ static C1TAB set_unit_tab[] = {
     { "NODEBUG",    &set_dev_debug,     2+0 },
     { "APPEND",     &set_unit_append,   0 },
     { "EOF",        &set_unit_append,   0 },
+    { "CACHE",      &set_unit_cache,    DKCACHE_ON },
+    { "NOCACHE",    &set_unit_cache,    DKCACHE_OFF },
+    { "WRITEBACK",  &set_unit_cache,    DKCACHE_WRITEBACK },
+    { "WRITETHROUGH", &set_unit_cache,  DKCACHE_WRITETHROUGH },
+    { "INDEX",      &set_unit_index,    1 },
+    { "NOINDEX",    &set_unit_index,    0 },
     { NULL,         NULL,               0 }
     };
 
@@ -2693,6 +3065,7 @@ static SHTAB show_dev_tab[] = {
 
 static SHTAB show_unit_tab[] = {
     { "DEBUG",      &show_dev_debug,            1 },
+    { "CACHE",      &show_unit_cache,           0 },
     { NULL, NULL, 0 }
     };
 
@@ -5800,6 +6173,7 @@ fprintf (st, "Asynchronous Multiplexer support is available\n");
 #if defined(SIM_ASYNCH_CLOCKS)
 fprintf (st, "Asynchronous Clock is %sabled\n", (sim_asynch_timer) ? "en" : "dis");
 #endif
+_sim_aio_show_statistics (st);
 #else
 fprintf (st, "Asynchronous I/O is not available in this simulator\n");
 #endif
@@ -6182,6 +6556,24 @@ if (0 == sim_fseek (uptr->fileref, 0, SEEK_END)) {
 return sim_messagef (SCPE_IERR, "%s Can't seek to end of file: %s - %s\n", sim_uname (uptr), uptr->filename, strerror (errno));
 }
 
+/* Set disk unit sector cache */
+
+t_stat set_unit_cache (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (DEV_TYPE(dptr) != DEV_DISK)
+    return sim_messagef (SCPE_NOFNC, "%s is not a disk device.\n", sim_uname (uptr));
+return sim_disk_set_cache (uptr, flag, cptr, NULL);
+}
+
+/* Set tape unit record index sidecar file */
+
+t_stat set_unit_index (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (DEV_TYPE(dptr) != DEV_TAPE)
+    return sim_messagef (SCPE_NOFNC, "%s is not a tape device.\n", sim_uname (uptr));
+return sim_tape_set_index (uptr, flag, cptr, NULL);
+}
+
 /* Show command */
 
 t_stat show_cmd (int32 flag, CONST char *cptr)
@@ -6964,15 +7356,37 @@ else if (!flag)
 return SCPE_OK;
 }
 
+static t_stat show_queue_statistics (FILE *st)
+{
+t_uint64 ops = sim_queue_inserts + sim_queue_cancels + sim_queue_dispatches;
+
+fprintf (st, "%s event queue statistics\n", sim_name);
+fprintf (st, "  Current depth:    %d\n", sim_clock_heap_count);
+fprintf (st, "  Maximum depth:    %d\n", sim_queue_depth_max);
+fprintf (st, "  Average depth:    %.2f\n", ops ? sim_queue_depth_sum / (double)ops : 0.0);
+fprintf (st, "  Inserts:          %s\n", sim_fmt_numeric ((double)sim_queue_inserts));
+fprintf (st, "  Cancels:          %s\n", sim_fmt_numeric ((double)sim_queue_cancels));
+fprintf (st, "  Events processed: %s\n", sim_fmt_numeric ((double)sim_queue_dispatches));
+return SCPE_OK;
+}
+
 t_stat show_queue (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr)
 {
 DEVICE *dptr;
 UNIT *uptr;
+UNIT **sorted = NULL;
+int32 i;
 MEMFILE buf;
 
 memset (&buf, 0, sizeof (buf));
-if (cptr && (*cptr != 0))
-    return SCPE_2MARG;
+if (cptr && (*cptr != 0)) {
+    char gbuf[CBUFSIZE];
+
+    cptr = get_glyph (cptr, gbuf, 0);
+    if ((*cptr != 0) || (MATCH_CMD (gbuf, "STATISTICS") != 0))
+        return SCPE_2MARG;
+    return show_queue_statistics (st);
+    }
 if (sim_clock_queue == QUEUE_LIST_END)
     fprintf (st, "%s event queue empty, time = %.0f, executing %s %s/sec\n",
              sim_name, sim_time, sim_fmt_numeric (sim_timer_inst_per_sec ()), sim_vm_interval_units);
@@ -6982,7 +7396,13 @@ else {
 
     fprintf (st, "%s event queue status, time = %.0f, executing %s %s/sec\n",
              sim_name, sim_time, sim_fmt_numeric (inst_per_sec), sim_vm_interval_units);
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    sorted = (UNIT **)malloc (sim_clock_heap_count * sizeof (*sorted));
+    if (sorted == NULL)
+        return SCPE_MEM;
+    memcpy (sorted, &sim_clock_heap[1], sim_clock_heap_count * sizeof (*sorted));
+    qsort (sorted, sim_clock_heap_count, sizeof (*sorted), _sim_clock_compare);
+    for (i = 0; i < sim_clock_heap_count; i++) {
+        uptr = sorted[i];
         if (uptr == &sim_step_unit)
             fprintf (st, "  Step timer");
         else
@@ -7007,25 +7427,14 @@ else {
                                             (*tim) ? " (" : "", tim, (*tim) ? ")" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
         }
+    free (sorted);
     }
 sim_show_clock_queues (st, dnotused, unotused, flag, cptr);
 #if defined (SIM_ASYNCH_IO)
 pthread_mutex_lock (&sim_asynch_lock);
 sim_mfile = &buf;
 fprintf (st, "asynchronous pending event queue\n");
-if (sim_asynch_queue == QUEUE_LIST_END)
-    fprintf (st, "  Empty\n");
-else {
-    for (uptr = sim_asynch_queue; uptr != QUEUE_LIST_END; uptr = uptr->a_next) {
-        if ((dptr = find_dev_from_unit (uptr)) != NULL) {
-            fprintf (st, "  %s", sim_dname (dptr));
-            if (dptr->numunits > 1) fprintf (st, " unit %d",
-                (int32) (uptr - dptr->units));
-            }
-        else fprintf (st, "  Unknown");
-        fprintf (st, " event delay %d\n", uptr->a_event_time);
-        }
-    }
+_sim_aio_show_pending (st);
 fprintf (st, "asynch latency: %d nanoseconds\n", sim_asynch_latency);
 fprintf (st, "asynch instruction latency: %d %s\n", sim_asynch_inst_latency, sim_vm_interval_units);
 pthread_mutex_unlock (&sim_asynch_lock);
@@ -7061,6 +7470,15 @@ fprintf (st, "Radix=%d\n", dptr->dradix);
 return SCPE_OK;
 }
 
+/* Show disk unit sector cache */
+
+t_stat show_unit_cache (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (DEV_TYPE(dptr) != DEV_DISK)
+    return sim_messagef (SCPE_NOFNC, "%s is not a disk device.\n", sim_uname (uptr));
+return sim_disk_show_cache (st, uptr, flag, NULL);
+}
+
 t_stat show_dev_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 uflag, CONST char *cptr)
 {
 DEBTAB *dep;
@@ -7661,120 +8079,1334 @@ if (sim_rmdir (cptr))
 return SCPE_OK;
 }
 
-/* Debug command */
+/* Binary debug records (SET DEBUG -C)
+
+   In binary mode sim_debug doesn't format its message.  Each call is
+   captured as a fixed size record holding the simulated and host times,
+   the device, the debug bits, a pointer to the format string and the raw
+   argument values, in a ring which belongs to the calling thread.  A
+   background writer thread drains the rings to the debug file, replacing
+   the pointers with references to string table entries it writes ahead of
+   their first use, so the file can be rendered later, by any simulator,
+   with SHOW DEBUG DECODE.  A message whose arguments don't fit in one
+   record, or whose format uses a conversion that can't be captured, is
+   formatted and stored as one or more text records.
+
+   Format strings aren't always static (some callers build a format, pass
+   it to sim_debug and free it), so each ring interns the formats recorded
+   in it by content and records point at the ring's copy.  A thread's ring
+   is released by the writer once the thread has exited and its records
+   have been written.
+
+   Each file entry starts with DBGB_MAGIC and a type byte.  Text written
+   directly to the debug file rather than through sim_debug, while binary
+   records are being written, is stored in the calling thread's ring as
+   raw text records so that it stays in order with that thread's
+   messages.  Anything else in the file is text written before binary
+   output started, which the decoder passes through unchanged.
+
+   Without threads, or without the intrinsics needed for lock free rings,
+   a single ring is drained synchronously whenever it fills and whenever
+   the simulator isn't running.
+*/
 
-t_stat debug_cmd (int32 flg, CONST char *cptr)
-{
-char gbuf[CBUFSIZE];
-CONST char *svptr;
-DEVICE *dptr;
+#define DBGB_MAGIC      "\0SDB"                         /* entry marker */
+#define DBGB_MAGIC_LEN  4
+#define DBGB_VERSION    2
+#define DBGB_ARGSIZE    192                             /* argument bytes per record */
+#define DBGB_RINGSIZE   4096                            /* records per ring (power of 2) */
+#define DBGB_MAXPARTS   64                              /* text records per message */
+#define DBGB_E_HEADER   'H'                             /* entry: file header */
+#define DBGB_E_STRING   'S'                             /* entry: string table entry */
+#define DBGB_E_RECORD   'R'                             /* entry: debug record */
+#define DBGB_T_FMT      1                               /* record: format and arguments */
+#define DBGB_T_TEXT     2                               /* record: formatted text */
+#define DBGB_F_MORE     1                               /* text continues in next record */
+#define DBGB_F_THREAD   2                               /* not the simulator thread */
+#define DBGB_F_RAW      4                               /* text written directly */
+#if defined(SIM_ASYNCH_IO) && defined(USE_AIO_INTRINSICS)
+#define DBGB_THREADED   1                               /* per thread rings and writer */
+#endif
+#if defined(SIM_ASYNCH_IO) && !defined(DBGB_THREADED)
+#define DBGB_LOCK       pthread_mutex_lock (&debug_bin_lock)
+#define DBGB_UNLOCK     pthread_mutex_unlock (&debug_bin_lock)
+#else
+#define DBGB_LOCK
+#define DBGB_UNLOCK
+#endif
+#if defined(DBGB_THREADED)
+#define DBGB_COUNT(counter) _sim_aio_count (&counter)  /* any thread */
+#else
+#define DBGB_COUNT(counter) ++counter
+#endif
 
-GET_SWITCHES (cptr);                                    /* get switches */
-cptr = get_glyph (svptr = cptr, gbuf, 0);               /* get next glyph */
-if ((dptr = find_dev (gbuf)))                           /* device match? */
-return set_dev_debug (dptr, NULL, flg, *cptr ? cptr : NULL);
-cptr = svptr;
-if (flg)
-    return sim_set_debon (0, cptr);
-else
-    return sim_set_deboff (0, cptr);
-}
+typedef struct {
+    double          gtime;                              /* simulated time */
+    t_uint64        pc;                                 /* PC (-P) */
+    t_uint64        sec;                                /* host time (-T, -A) */
+    uint32          nsec;
+    uint32          dbits;                              /* debug bits */
+    const char      *fmt;                               /* format string */
+    DEVICE          *dptr;                              /* device */
+    const char      *verb;                              /* debug flag name */
+    uint16          len;                                /* argument bytes used */
+    uint8           type;                               /* record type */
+    uint8           flags;                              /* record flags */
+    uint8           args[DBGB_ARGSIZE];                 /* arguments or text */
+    } DEBUG_BREC;
+
+typedef struct {                                        /* record as written */
+    double          gtime;
+    t_uint64        pc;
+    t_uint64        sec;
+    uint32          nsec;
+    uint32          dbits;
+    uint32          fmt;                                /* string ids */
+    uint32          dev;
+    uint32          verb;
+    uint16          len;
+    uint8           type;
+    uint8           flags;
+    uint8           args[DBGB_ARGSIZE];
+    } DEBUG_FREC;
+
+typedef struct {                                        /* file header */
+    uint32          version;
+    uint32          byteorder;                          /* 0x01020304 */
+    uint32          recsize;                            /* sizeof (DEBUG_FREC) */
+    uint32          switches;                           /* debug switches */
+    uint32          pc_radix;                           /* PC display */
+    uint32          pc_width;
+    uint32          pc_format;
+    uint32          base_nsec;                          /* -R base time */
+    t_uint64        base_sec;
+    char            sim_name[64];
+    char            pc_name[32];
+    } DEBUG_FHDR;
+
+typedef struct {                                        /* interned format */
+    uint32          id;                                 /* string id (written by the writer) */
+    uint32          gen;                                /* file the id belongs to */
+    char            text[1];
+    } DEBUG_BFMT;
+
+typedef struct DEBUG_BRING DEBUG_BRING;
+struct DEBUG_BRING {
+    volatile uint32 head;                               /* next record to write */
+    volatile uint32 tail;                               /* next record to fill */
+    DEBUG_BRING     *next;                              /* next ring */
+    volatile t_bool orphaned;                           /* owning thread has exited */
+    DEBUG_BFMT      **fmts;                             /* interned formats (by content hash) */
+    uint32          fmtsize;                            /* format table size */
+    uint32          fmtcount;                           /* formats interned */
+    DEBUG_BREC      rec[DBGB_RINGSIZE];
+    };
 
-/* Breakpoint commands */
+static DEBUG_BRING *debug_bin_rings = NULL;             /* all rings */
+static const void **debug_bin_strs = NULL;              /* string table (by pointer hash) */
+static uint32 *debug_bin_ids = NULL;                    /* string ids */
+static uint32 debug_bin_strsize = 0;                    /* string table size */
+static uint32 debug_bin_strcount = 0;                   /* strings written */
+static uint32 debug_bin_gen = 1;                        /* current file's string ids */
+static t_uint64 debug_bin_records = 0;                  /* records written */
+static t_uint64 debug_bin_text = 0;                     /* of which text */
+static volatile uint32 debug_bin_stalls = 0;            /* waits for ring space */
+static volatile uint32 debug_bin_dropped = 0;           /* records lost */
+static t_bool debug_bin_active = FALSE;                 /* records being written */
+#if defined(SIM_ASYNCH_IO)
+static pthread_mutex_t debug_bin_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#if defined(DBGB_THREADED)
+static AIO_TLS DEBUG_BRING *debug_bin_ring = NULL;      /* this thread's ring */
+static pthread_key_t debug_bin_key;                     /* releases rings at thread exit */
+static t_bool debug_bin_key_valid = FALSE;
+static pthread_t debug_bin_writer;
+static volatile t_bool debug_bin_running = FALSE;
+static volatile t_bool debug_bin_busy = FALSE;          /* writer draining */
+static volatile t_bool debug_bin_idle = FALSE;          /* writer waiting for records */
+static pthread_cond_t debug_bin_wake = PTHREAD_COND_INITIALIZER;
+#else
+static DEBUG_BRING *debug_bin_ring = NULL;              /* the ring */
+#endif
 
-t_stat brk_cmd (int32 flg, CONST char *cptr)
-{
-GET_SWITCHES (cptr);                                    /* get switches */
-return ssh_break (NULL, cptr, flg);                     /* call common code */
-}
+/* Format conversion specifications
 
-t_stat ssh_break (FILE *st, const char *cptr, int32 flg)
-{
-char gbuf[CBUFSIZE], *aptr, abuf[4*CBUFSIZE];
-CONST char *tptr, *t1ptr;
-DEVICE *dptr = sim_dflt_dev;
-UNIT *uptr;
-t_stat r;
-t_addr lo, hi, max;
-int32 cnt;
+   The capture and the decoder parse the format string the same way so
+   that they agree on the arguments a record holds: 8 bytes for each
+   integer, pointer, floating point value or '*' width/precision, and a
+   16 bit length followed by the characters for each string.
+*/
 
-if (sim_brk_types == 0)
-    return sim_messagef (SCPE_NOFNC, "No breakpoint support in this simulator\n");
-if (dptr == NULL)
-    return SCPE_IERR;
-uptr = dptr->units;
-if (uptr == NULL)
-    return SCPE_IERR;
-max = uptr->capac - 1;
-abuf[sizeof(abuf)-1] = '\0';
-strlcpy (abuf, cptr, sizeof(abuf));
-if ((aptr = strchr (abuf, ';'))) {                      /* ;action? */
-    cptr += aptr - abuf + 1;
-    if (flg != SSH_ST)                                  /* only on SET */
-        return sim_messagef (SCPE_ARG, "Invalid argument: %s\n", cptr);
-    *aptr++ = 0;                                        /* separate strings */
-    if ((cptr > sim_sub_instr_buf) && ((size_t)(cptr - sim_sub_instr_buf) < sim_sub_instr_size))
-        aptr = &sim_sub_instr[sim_sub_instr_off[cptr - sim_sub_instr_buf]]; /* get un-substituted string */
-    }
-cptr = abuf;
-if (*cptr == 0) {                                       /* no argument? */
-    lo = (t_addr) get_rval (sim_PC, 0);                 /* use PC */
-    return ssh_break_one (st, flg, lo, 0, aptr);
+typedef struct {
+    char            conv;                               /* conversion character */
+    char            size;                               /* length: 0, H(hh), h, l, q(ll), z, L */
+    t_bool          star_width;                         /* width is an argument */
+    t_bool          star_prec;                          /* precision is an argument */
+    int             prec;                               /* literal precision or -1 */
+    const char      *flags;                             /* flags and literal width */
+    size_t          flagslen;
+    } DEBUG_BSPEC;
+
+static const char *_debug_bin_spec (const char *fmt, DEBUG_BSPEC *sp)
+{
+const char *cp = fmt + 1;                               /* skip % */
+
+memset (sp, 0, sizeof (*sp));
+sp->prec = -1;
+sp->flags = cp;
+while (*cp && strchr ("-+ #0'", *cp))
+    ++cp;
+if (*cp == '*') {
+    sp->star_width = TRUE;
+    ++cp;
     }
-while (*cptr) {
-    cptr = get_glyph (cptr, gbuf, ',');
-    tptr = get_range (dptr, gbuf, &lo, &hi, dptr->aradix, max, 0);
-    if (tptr == NULL)
-        return sim_messagef (SCPE_ARG, "Invalid address specifier: %s\n", gbuf);
-    if (*tptr == '[') {
-        cnt = (int32) strtotv (tptr + 1, &t1ptr, 10);
-        if ((tptr == t1ptr) || (*t1ptr != ']') || (flg != SSH_ST))
-            return sim_messagef (SCPE_ARG, "Invalid repeat count specifier: %s\n", tptr + 1);
-        tptr = t1ptr + 1;
-        }
-    else cnt = 0;
-    if (*tptr != 0)
-        return sim_messagef (SCPE_ARG, "Unexpected argument: %s\n", tptr);
-    if ((lo == 0) && (hi == max)) {
-        if (flg == SSH_CL)
-            sim_brk_clrall (sim_switches);
-        else
-            if (flg == SSH_SH)
-                sim_brk_showall (st, sim_switches);
-            else
-                return SCPE_ARG;
+else
+    while (sim_isdigit (*cp))
+        ++cp;
+sp->flagslen = cp - sp->flags - (sp->star_width ? 1 : 0);
+if (*cp == '.') {
+    ++cp;
+    if (*cp == '*') {
+        sp->star_prec = TRUE;
+        ++cp;
         }
     else {
-        for ( ; lo <= hi; lo = lo + 1) {
-            r = ssh_break_one (st, flg, lo, cnt, aptr);
-            if (r != SCPE_OK)
-                return r;
-            }
+        sp->prec = 0;
+        while (sim_isdigit (*cp))
+            sp->prec = 10 * sp->prec + (*cp++ - '0');
         }
     }
-return SCPE_OK;
-}
-
-t_stat ssh_break_one (FILE *st, int32 flg, t_addr lo, int32 cnt, CONST char *aptr)
-{
-if (!sim_brk_types)
-    return sim_messagef (SCPE_NOFNC, "No breakpoint support in this simulator\n");
-switch (flg) {
-
-    case SSH_ST:
-        return sim_brk_set (lo, sim_switches, cnt, aptr);
+switch (*cp) {
+    case 'h':
+        sp->size = (cp[1] == 'h') ? 'H' : 'h';
+        cp += (cp[1] == 'h') ? 2 : 1;
         break;
-
-    case SSH_CL:
-        return sim_brk_clr (lo, sim_switches);
+    case 'l':
+        sp->size = (cp[1] == 'l') ? 'q' : 'l';
+        cp += (cp[1] == 'l') ? 2 : 1;
         break;
-
-    case SSH_SH:
-        return sim_brk_show (st, lo, sim_switches);
+    case 'q': case 'j':
+        sp->size = 'q';
+        ++cp;
+        break;
+    case 'z': case 't':
+        sp->size = 'z';
+        ++cp;
+        break;
+    case 'L':
+        sp->size = 'L';
+        ++cp;
+        break;
+    case 'I':                                           /* Microsoft I, I32, I64 */
+        if ((cp[1] == '6') && (cp[2] == '4')) {
+            sp->size = 'q';
+            cp += 3;
+            }
+        else if ((cp[1] == '3') && (cp[2] == '2'))
+            cp += 3;
+        else {
+            sp->size = 'z';
+            ++cp;
+            }
         break;
-
-    default:
-        return SCPE_ARG;
+    }
+if ((*cp == '\0') || (strchr ("diouxXcspeEfFgGaA%", *cp) == NULL))
+    return NULL;                                        /* %n or unknown */
+sp->conv = *cp;
+return cp + 1;
+}
+
+static t_bool _debug_bin_put (DEBUG_BREC *rec, const void *data, size_t len)
+{
+if (rec->len + len > DBGB_ARGSIZE)
+    return FALSE;
+memcpy (&rec->args[rec->len], data, len);
+rec->len = (uint16)(rec->len + len);
+return TRUE;
+}
+
+/* Capture the arguments of a message into a record */
+
+static t_bool _debug_bin_args (DEBUG_BREC *rec, const char *fmt, va_list arglist)
+{
+DEBUG_BSPEC spec;
+t_uint64 val;
+double dval;
+
+rec->len = 0;
+while ((fmt = strchr (fmt, '%')) != NULL) {
+    if ((fmt = _debug_bin_spec (fmt, &spec)) == NULL)
+        return FALSE;
+    if (spec.conv == '%')
+        continue;
+    if (spec.star_width) {
+        val = (t_uint64)(t_int64)va_arg (arglist, int);
+        if (!_debug_bin_put (rec, &val, sizeof (val)))
+            return FALSE;
+        }
+    if (spec.star_prec) {
+        int prec = va_arg (arglist, int);
+
+        val = (t_uint64)(t_int64)prec;
+        if (!_debug_bin_put (rec, &val, sizeof (val)))
+            return FALSE;
+        spec.prec = prec;
+        }
+    switch (spec.conv) {
+        case 'd': case 'i':
+            switch (spec.size) {
+                case 'l': val = (t_uint64)(t_int64)va_arg (arglist, long); break;
+                case 'q': val = (t_uint64)va_arg (arglist, t_int64); break;
+                case 'z': val = (t_uint64)(t_int64)va_arg (arglist, ptrdiff_t); break;
+                case 'h': val = (t_uint64)(t_int64)(short)va_arg (arglist, int); break;
+                case 'H': val = (t_uint64)(t_int64)(signed char)va_arg (arglist, int); break;
+                default: val = (t_uint64)(t_int64)va_arg (arglist, int); break;
+                }
+            if (!_debug_bin_put (rec, &val, sizeof (val)))
+                return FALSE;
+            break;
+        case 'o': case 'u': case 'x': case 'X':
+            switch (spec.size) {
+                case 'l': val = (t_uint64)va_arg (arglist, unsigned long); break;
+                case 'q': val = va_arg (arglist, t_uint64); break;
+                case 'z': val = (t_uint64)va_arg (arglist, size_t); break;
+                case 'h': val = (t_uint64)(unsigned short)va_arg (arglist, unsigned int); break;
+                case 'H': val = (t_uint64)(unsigned char)va_arg (arglist, unsigned int); break;
+                default: val = (t_uint64)va_arg (arglist, unsigned int); break;
+                }
+            if (!_debug_bin_put (rec, &val, sizeof (val)))
+                return FALSE;
+            break;
+        case 'c':
+            val = (t_uint64)(t_int64)va_arg (arglist, int);
+            if (!_debug_bin_put (rec, &val, sizeof (val)))
+                return FALSE;
+            break;
+        case 'p':
+            val = (t_uint64)(uintptr_t)va_arg (arglist, void *);
+            if (!_debug_bin_put (rec, &val, sizeof (val)))
+                return FALSE;
+            break;
+        case 's': {
+            const char *s = va_arg (arglist, const char *);
+            const char *e;
+            uint16 slen;
+
+            if (s == NULL)
+                s = "(null)";
+            if ((spec.prec >= 0) && ((e = (const char *)memchr (s, 0, spec.prec)) == NULL))
+                slen = (uint16)MIN (spec.prec, DBGB_ARGSIZE);
+            else
+                slen = (uint16)MIN (strlen (s), DBGB_ARGSIZE);
+            if ((!_debug_bin_put (rec, &slen, sizeof (slen))) ||
+                (!_debug_bin_put (rec, s, slen)))
+                return FALSE;
+            break;
+            }
+        default:                                        /* floating point */
+            if (spec.size == 'L')
+                dval = (double)va_arg (arglist, long double);
+            else
+                dval = va_arg (arglist, double);
+            if (!_debug_bin_put (rec, &dval, sizeof (dval)))
+                return FALSE;
+            break;
+        }
+    }
+return TRUE;
+}
+
+/* Ring management */
+
+static DEBUG_BRING *_debug_bin_get_ring (void)
+{
+if (debug_bin_ring == NULL) {
+    DEBUG_BRING *ring = (DEBUG_BRING *)calloc (1, sizeof (*ring));
+
+    if (ring == NULL)
+        return NULL;
+#if defined(DBGB_THREADED)
+    pthread_mutex_lock (&debug_bin_lock);
+#endif
+    ring->next = debug_bin_rings;
+    debug_bin_rings = ring;
+#if defined(DBGB_THREADED)
+    pthread_mutex_unlock (&debug_bin_lock);
+    if (debug_bin_key_valid)
+        pthread_setspecific (debug_bin_key, ring);      /* release when the thread exits */
+#endif
+    debug_bin_ring = ring;
+    }
+return debug_bin_ring;
+}
+
+#if defined(DBGB_THREADED)
+static void _debug_bin_free_ring (DEBUG_BRING *ring)
+{
+uint32 i;
+
+for (i = 0; i < ring->fmtsize; i++)
+    free (ring->fmts[i]);
+free (ring->fmts);
+free (ring);
+}
+
+static void _debug_bin_thread_exit (void *arg)
+{
+DEBUG_BRING *ring = (DEBUG_BRING *)arg;
+
+AIO_MEMORY_BARRIER;                                     /* records published before */
+ring->orphaned = TRUE;                                  /* writer frees it once drained */
+pthread_mutex_lock (&debug_bin_lock);
+pthread_cond_signal (&debug_bin_wake);                  /* let an idle writer release it */
+pthread_mutex_unlock (&debug_bin_lock);
+}
+
+/* Release the rings of exited threads which have no pending records */
+
+static void _debug_bin_reap (void)
+{
+DEBUG_BRING **pring, *ring;
+
+pthread_mutex_lock (&debug_bin_lock);
+pring = &debug_bin_rings;
+while ((ring = *pring) != NULL) {
+    if (ring->orphaned && (ring->head == ring->tail)) {
+        *pring = ring->next;
+        _debug_bin_free_ring (ring);
+        }
+    else
+        pring = &ring->next;
+    }
+pthread_mutex_unlock (&debug_bin_lock);
+}
+#endif
+
+/* Return the ring's copy of a format string, adding it if necessary */
+
+static const char *_debug_bin_intern (DEBUG_BRING *ring, const char *fmt)
+{
+uint32 i, hash = 2166136261u;
+const char *cp;
+
+for (cp = fmt; *cp; ++cp)                               /* FNV-1a */
+    hash = (hash ^ (uint8)*cp) * 16777619u;
+if (2 * (ring->fmtcount + 1) > ring->fmtsize) {         /* grow table? */
+    uint32 osize = ring->fmtsize;
+    DEBUG_BFMT **ofmts = ring->fmts;
+    uint32 nsize = (osize == 0) ? 256 : 2 * osize;
+    DEBUG_BFMT **nfmts = (DEBUG_BFMT **)calloc (nsize, sizeof (*nfmts));
+
+    if (nfmts == NULL)
+        return NULL;
+    for (i = 0; i < osize; i++) {
+        uint32 h = 2166136261u, id;
+
+        if (ofmts[i] == NULL)
+            continue;
+        for (cp = ofmts[i]->text; *cp; ++cp)
+            h = (h ^ (uint8)*cp) * 16777619u;
+        id = h & (nsize - 1);
+        while (nfmts[id] != NULL)
+            id = (id + 1) & (nsize - 1);
+        nfmts[id] = ofmts[i];
+        }
+    free (ofmts);
+    ring->fmts = nfmts;
+    ring->fmtsize = nsize;
+    }
+i = hash & (ring->fmtsize - 1);
+while (ring->fmts[i] != NULL) {
+    if (strcmp (ring->fmts[i]->text, fmt) == 0)
+        return ring->fmts[i]->text;
+    i = (i + 1) & (ring->fmtsize - 1);
+    }
+if ((ring->fmts[i] = (DEBUG_BFMT *)malloc (sizeof (DEBUG_BFMT) + strlen (fmt))) == NULL)
+    return NULL;
+ring->fmts[i]->id = ring->fmts[i]->gen = 0;
+strcpy (ring->fmts[i]->text, fmt);
+++ring->fmtcount;
+return ring->fmts[i]->text;
+}
+
+/* Start a file entry (fputc can't be used, it goes through Fprintf) */
+
+static void _debug_bin_entry (char type)
+{
+char entry[DBGB_MAGIC_LEN + 1];
+
+memcpy (entry, DBGB_MAGIC, DBGB_MAGIC_LEN);
+entry[DBGB_MAGIC_LEN] = type;
+fwrite (entry, 1, sizeof (entry), sim_deb);
+}
+
+static uint32 _debug_bin_new_string (const char *text)
+{
+uint32 id = ++debug_bin_strcount;
+uint32 len = (uint32)strlen (text);
+
+_debug_bin_entry (DBGB_E_STRING);
+fwrite (&id, sizeof (id), 1, sim_deb);
+fwrite (&len, sizeof (len), 1, sim_deb);
+fwrite (text, 1, len, sim_deb);
+return id;
+}
+
+/* String id of a static string (device name or debug flag name) */
+
+static uint32 _debug_bin_string (const void *str, const char *text)
+{
+uint32 i, id;
+
+if (str == NULL)
+    return 0;
+if (2 * (debug_bin_strcount + 1) > debug_bin_strsize) { /* grow table? */
+    uint32 osize = debug_bin_strsize;
+    const void **ostrs = debug_bin_strs;
+    uint32 *oids = debug_bin_ids;
+
+    debug_bin_strsize = (osize == 0) ? 1024 : 2 * osize;
+    debug_bin_strs = (const void **)calloc (debug_bin_strsize, sizeof (*debug_bin_strs));
+    debug_bin_ids = (uint32 *)calloc (debug_bin_strsize, sizeof (*debug_bin_ids));
+    for (i = 0; i < osize; i++) {
+        if (ostrs[i] == NULL)
+            continue;
+        id = (uint32)(((uintptr_t)ostrs[i] >> 3) * 2654435761u) & (debug_bin_strsize - 1);
+        while (debug_bin_strs[id] != NULL)
+            id = (id + 1) & (debug_bin_strsize - 1);
+        debug_bin_strs[id] = ostrs[i];
+        debug_bin_ids[id] = oids[i];
+        }
+    free (ostrs);
+    free (oids);
+    }
+i = (uint32)(((uintptr_t)str >> 3) * 2654435761u) & (debug_bin_strsize - 1);
+while (debug_bin_strs[i] != NULL) {
+    if (debug_bin_strs[i] == str)
+        return debug_bin_ids[i];
+    i = (i + 1) & (debug_bin_strsize - 1);
+    }
+debug_bin_strs[i] = str;
+id = debug_bin_ids[i] = _debug_bin_new_string (text);
+return id;
+}
+
+/* String id of an interned format, written to the file on first use */
+
+static uint32 _debug_bin_fmt_string (const char *fmt)
+{
+DEBUG_BFMT *bf;
+
+if (fmt == NULL)
+    return 0;
+bf = (DEBUG_BFMT *)(fmt - offsetof (DEBUG_BFMT, text));
+if ((bf->id == 0) || (bf->gen != debug_bin_gen)) {
+    bf->id = _debug_bin_new_string (fmt);
+    bf->gen = debug_bin_gen;
+    }
+return bf->id;
+}
+
+/* Write the records pending in all rings */
+
+static uint32 _debug_bin_drain (void)
+{
+DEBUG_BRING *ring;
+DEBUG_FREC frec;
+uint32 count = 0;
+
+#if defined(DBGB_THREADED) && !defined(_WIN32)
+if (sim_deb)
+    flockfile (sim_deb);                                /* keep entries whole */
+#endif
+for (ring = debug_bin_rings; ring != NULL; ring = ring->next) {
+    uint32 head = ring->head;
+    uint32 tail = ring->tail;
+
+#if defined(DBGB_THREADED)
+    AIO_MEMORY_BARRIER;                                 /* records filled before tail */
+#endif
+    while (head != tail) {
+        DEBUG_BREC *rec = &ring->rec[head & (DBGB_RINGSIZE - 1)];
+
+        if (sim_deb != NULL) {
+            memset (&frec, 0, sizeof (frec));
+            frec.gtime = rec->gtime;
+            frec.pc = rec->pc;
+            frec.sec = rec->sec;
+            frec.nsec = rec->nsec;
+            frec.dbits = rec->dbits;
+            frec.fmt = _debug_bin_fmt_string (rec->fmt);
+            frec.dev = rec->dptr ? _debug_bin_string (rec->dptr, rec->dptr->name) : 0;
+            frec.verb = _debug_bin_string (rec->verb, rec->verb);
+            frec.len = rec->len;
+            frec.type = rec->type;
+            frec.flags = rec->flags;
+            memcpy (frec.args, rec->args, rec->len);
+            _debug_bin_entry (DBGB_E_RECORD);
+            fwrite (&frec, sizeof (frec), 1, sim_deb);
+            ++debug_bin_records;
+            if (rec->type == DBGB_T_TEXT)
+                ++debug_bin_text;
+            }
+        ++head;
+        ++count;
+        }
+#if defined(DBGB_THREADED)
+    AIO_MEMORY_BARRIER;                                 /* records consumed before head */
+#endif
+    ring->head = head;
+    }
+#if defined(DBGB_THREADED) && !defined(_WIN32)
+if (sim_deb)
+    funlockfile (sim_deb);
+#endif
+#if defined(DBGB_THREADED)
+_debug_bin_reap ();
+#endif
+return count;
+}
+
+#if defined(DBGB_THREADED)
+/* The writer waits on debug_bin_wake when it finds nothing to write.  It
+   sets debug_bin_idle and then looks at the rings again, while producers
+   publish their records and then look at debug_bin_idle, so either the
+   writer sees the new records or the producer sees that it must signal.
+*/
+
+static t_bool _debug_bin_pending (void)                 /* called with debug_bin_lock held */
+{
+DEBUG_BRING *ring;
+
+for (ring = debug_bin_rings; ring != NULL; ring = ring->next)
+    if (ring->head != ring->tail)
+        return TRUE;
+return FALSE;
+}
+
+static void _debug_bin_wake (void)
+{
+pthread_mutex_lock (&debug_bin_lock);
+pthread_cond_signal (&debug_bin_wake);
+pthread_mutex_unlock (&debug_bin_lock);
+}
+
+static void *_debug_bin_writer (void *arg)
+{
+while (debug_bin_running) {
+    debug_bin_busy = TRUE;
+    if (_debug_bin_drain () == 0) {
+        debug_bin_busy = FALSE;
+        pthread_mutex_lock (&debug_bin_lock);
+        debug_bin_idle = TRUE;
+        AIO_MEMORY_BARRIER;                             /* idle visible before the check */
+        if (debug_bin_running && !_debug_bin_pending ())
+            pthread_cond_wait (&debug_bin_wake, &debug_bin_lock);
+        debug_bin_idle = FALSE;
+        pthread_mutex_unlock (&debug_bin_lock);
+        }
+    }
+debug_bin_busy = FALSE;
+return NULL;
+}
+
+static void _debug_bin_stop_writer (void)
+{
+if (debug_bin_running) {
+    debug_bin_running = FALSE;
+    _debug_bin_wake ();
+    pthread_join (debug_bin_writer, NULL);
+    }
+}
+#endif
+
+/* Claim n consecutive records in the calling thread's ring */
+
+static DEBUG_BREC *_debug_bin_claim (DEBUG_BRING **pring, uint32 n)
+{
+DEBUG_BRING *ring = _debug_bin_get_ring ();
+
+*pring = ring;
+if (ring == NULL) {
+    DBGB_COUNT (debug_bin_dropped);
+    return NULL;
+    }
+while ((ring->tail - ring->head) > (DBGB_RINGSIZE - n)) {   /* full? */
+    DBGB_COUNT (debug_bin_stalls);
+#if defined(DBGB_THREADED)
+    if (!debug_bin_running) {
+        DBGB_COUNT (debug_bin_dropped);
+        return NULL;
+        }
+    sim_os_ms_sleep (1);                                /* let the writer catch up */
+#else
+    _debug_bin_drain ();
+#endif
+    }
+return &ring->rec[ring->tail & (DBGB_RINGSIZE - 1)];
+}
+
+static void _debug_bin_publish (DEBUG_BRING *ring, uint32 n)
+{
+#if defined(DBGB_THREADED)
+AIO_MEMORY_BARRIER;                                     /* records filled before tail */
+#endif
+ring->tail += n;
+#if defined(DBGB_THREADED)
+AIO_MEMORY_BARRIER;                                     /* tail visible before the check */
+if (debug_bin_idle)                                     /* writer waiting? */
+    _debug_bin_wake ();
+#endif
+}
+
+/* Store text as one or more text records (called with DBGB_LOCK held) */
+
+static void _debug_bin_store_text (const DEBUG_BREC *hdr, const char *buf, size_t len)
+{
+DEBUG_BRING *ring;
+DEBUG_BREC *rec;
+uint32 i, parts;
+
+if (len > DBGB_MAXPARTS * DBGB_ARGSIZE)
+    len = DBGB_MAXPARTS * DBGB_ARGSIZE;
+parts = (uint32)((len + DBGB_ARGSIZE - 1) / DBGB_ARGSIZE);
+if (parts == 0)
+    parts = 1;
+if ((rec = _debug_bin_claim (&ring, parts)) == NULL)
+    return;
+for (i = 0; i < parts; i++) {
+    rec = &ring->rec[(ring->tail + i) & (DBGB_RINGSIZE - 1)];
+    memcpy (rec, hdr, offsetof (DEBUG_BREC, args));
+    rec->type = DBGB_T_TEXT;
+    rec->fmt = NULL;
+    rec->len = (uint16)MIN (DBGB_ARGSIZE, len - i * DBGB_ARGSIZE);
+    memcpy (rec->args, buf + i * DBGB_ARGSIZE, rec->len);
+    rec->flags |= (i + 1 < parts) ? DBGB_F_MORE : 0;
+    }
+_debug_bin_publish (ring, parts);
+}
+
+static void _debug_bin_header (DEBUG_BREC *hdr)
+{
+struct timespec time_now;
+
+memset (hdr, 0, offsetof (DEBUG_BREC, args));
+hdr->gtime = sim_gtime ();
+if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
+    sim_rtcn_get_time (&time_now, 0);
+    hdr->sec = (t_uint64)time_now.tv_sec;
+    hdr->nsec = (uint32)time_now.tv_nsec;
+    }
+if ((sim_deb_switches & SWMASK ('P')) && sim_PC)
+    hdr->pc = (t_uint64)(sim_vm_pc_value ? (*sim_vm_pc_value)() : get_rval (sim_PC, 0));
+hdr->flags = AIO_MAIN_THREAD ? 0 : DBGB_F_THREAD;
+}
+
+static void _sim_debug_binary (uint32 dbits, DEVICE* dptr, UNIT *uptr, const char* fmt, va_list arglist)
+{
+DEBUG_BRING *ring;
+DEBUG_BREC *rec;
+DEBUG_BREC hdr;
+va_list args;
+
+_debug_bin_header (&hdr);
+hdr.dbits = dbits;
+hdr.dptr = dptr;
+hdr.verb = _get_dbg_verb (dbits, dptr, uptr);
+DBGB_LOCK;
+if ((rec = _debug_bin_claim (&ring, 1)) == NULL) {
+    DBGB_UNLOCK;
+    return;
+    }
+memcpy (rec, &hdr, offsetof (DEBUG_BREC, args));
+rec->type = DBGB_T_FMT;
+rec->fmt = _debug_bin_intern (ring, fmt);
+va_copy (args, arglist);
+if ((rec->fmt != NULL) && _debug_bin_args (rec, fmt, args)) {
+    va_end (args);
+    _debug_bin_publish (ring, 1);
+    }
+else {                                                  /* store formatted text */
+    char stackbuf[STACKBUFSIZE];
+    char *buf = stackbuf;
+    int len;
+
+    va_end (args);
+    va_copy (args, arglist);
+    len = vsnprintf (buf, sizeof (stackbuf), fmt, args);
+    va_end (args);
+    if (len >= (int)sizeof (stackbuf)) {                /* didn't fit? */
+        if (len > DBGB_MAXPARTS * DBGB_ARGSIZE)
+            len = DBGB_MAXPARTS * DBGB_ARGSIZE;
+        buf = (char *)malloc (len + 1);
+        if (buf == NULL) {
+            DBGB_UNLOCK;
+            return;
+            }
+        vsnprintf (buf, len + 1, fmt, arglist);
+        }
+    if (len < 0)
+        len = 0;
+    _debug_bin_store_text (&hdr, buf, (size_t)len);
+    if (buf != stackbuf)
+        free (buf);
+    }
+#if !defined(DBGB_THREADED)
+if (!sim_is_running)                                    /* keep file current at the prompt */
+    _debug_bin_drain ();
+#endif
+DBGB_UNLOCK;
+}
+
+/* Text written directly to the debug file while binary records are
+   being written.  Returns FALSE when it should be written to the file. */
+
+static t_bool _sim_debug_binary_text (const char *buf, size_t len)
+{
+DEBUG_BREC hdr;
+
+if (!debug_bin_active)
+    return FALSE;
+if (len == 0)
+    return TRUE;
+_debug_bin_header (&hdr);
+hdr.flags |= DBGB_F_RAW;
+DBGB_LOCK;
+_debug_bin_store_text (&hdr, buf, len);
+#if !defined(DBGB_THREADED)
+if (!sim_is_running)                                    /* keep file current at the prompt */
+    _debug_bin_drain ();
+#endif
+DBGB_UNLOCK;
+return TRUE;
+}
+
+/* Start binary debug output to sim_deb */
+
+t_stat sim_debug_binary_start (void)
+{
+DEBUG_FHDR hdr;
+DEBUG_BRING *ring;
+
+memset (&hdr, 0, sizeof (hdr));
+hdr.version = DBGB_VERSION;
+hdr.byteorder = 0x01020304;
+hdr.recsize = (uint32)sizeof (DEBUG_FREC);
+hdr.switches = (uint32)sim_deb_switches;
+if (sim_PC) {
+    hdr.pc_radix = sim_PC->radix;
+    hdr.pc_width = sim_PC->width;
+    hdr.pc_format = sim_PC->flags & REG_FMT;
+    strlcpy (hdr.pc_name, sim_PC->name, sizeof (hdr.pc_name));
+    }
+hdr.base_sec = (t_uint64)sim_deb_basetime.tv_sec;
+hdr.base_nsec = (uint32)sim_deb_basetime.tv_nsec;
+strlcpy (hdr.sim_name, sim_name, sizeof (hdr.sim_name));
+#if defined(DBGB_THREADED)
+_debug_bin_stop_writer ();                              /* the writer owns the heads and strings */
+pthread_mutex_lock (&debug_bin_lock);                   /* rings come and go */
+#endif
+DBGB_LOCK;
+for (ring = debug_bin_rings; ring != NULL; ring = ring->next)
+    ring->head = ring->tail;                            /* discard stale records */
+#if defined(DBGB_THREADED)
+pthread_mutex_unlock (&debug_bin_lock);
+#endif
+free (debug_bin_strs);
+free (debug_bin_ids);
+debug_bin_strs = NULL;
+debug_bin_ids = NULL;
+debug_bin_strsize = debug_bin_strcount = 0;
+++debug_bin_gen;                                        /* interned format ids are stale */
+debug_bin_records = debug_bin_text = debug_bin_stalls = debug_bin_dropped = 0;
+_debug_bin_entry (DBGB_E_HEADER);
+fwrite (&hdr, sizeof (hdr), 1, sim_deb);
+DBGB_UNLOCK;
+#if defined(DBGB_THREADED)
+if (!debug_bin_key_valid)
+    debug_bin_key_valid = (pthread_key_create (&debug_bin_key, _debug_bin_thread_exit) == 0);
+if (!debug_bin_running) {
+    pthread_attr_t attr;
+
+    debug_bin_running = TRUE;
+    pthread_attr_init (&attr);
+    pthread_attr_setscope (&attr, PTHREAD_SCOPE_SYSTEM);
+    if (pthread_create (&debug_bin_writer, &attr, _debug_bin_writer, NULL) != 0)
+        debug_bin_running = FALSE;
+    pthread_attr_destroy (&attr);
+    if (!debug_bin_running)
+        return sim_messagef (SCPE_IERR, "Can't start binary debug writer\n");
+    }
+#endif
+debug_bin_active = TRUE;
+return SCPE_OK;
+}
+
+/* Stop binary debug output, writing any pending records */
+
+void sim_debug_binary_stop (void)
+{
+debug_bin_active = FALSE;                               /* direct text to the file again */
+#if defined(DBGB_THREADED)
+_debug_bin_stop_writer ();
+#endif
+DBGB_LOCK;
+if (sim_deb)
+    _debug_bin_drain ();
+DBGB_UNLOCK;
+}
+
+/* Write pending records to the file */
+
+static void _sim_debug_binary_flush (void)
+{
+#if defined(DBGB_THREADED)
+int32 waits = 0;
+DEBUG_BRING *ring;
+t_bool pending = TRUE;
+
+while (pending && debug_bin_running && (waits++ < 1000)) {
+    pending = debug_bin_busy;
+    pthread_mutex_lock (&debug_bin_lock);               /* the writer releases rings */
+    for (ring = debug_bin_rings; ring != NULL; ring = ring->next)
+        if (ring->head != ring->tail)
+            pending = TRUE;
+    pthread_mutex_unlock (&debug_bin_lock);
+    if (pending)
+        sim_os_ms_sleep (1);
+    }
+#else
+DBGB_LOCK;
+_debug_bin_drain ();
+DBGB_UNLOCK;
+#endif
+}
+
+void sim_debug_binary_show (FILE *st)
+{
+fprintf (st, "   Debug messages are written as binary records (SHOW DEBUG DECODE renders them)\n");
+fprintf (st, "      Records written:        %" LL_FMT "u (%" LL_FMT "u as text)\n", (LL_TYPE)debug_bin_records, (LL_TYPE)debug_bin_text);
+fprintf (st, "      Strings written:        %u\n", debug_bin_strcount);
+if (debug_bin_stalls)
+    fprintf (st, "      Waits for ring space:   %u\n", debug_bin_stalls);
+if (debug_bin_dropped)
+    fprintf (st, "      Records dropped:        %u\n", debug_bin_dropped);
+}
+
+/* Decode a binary debug file
+
+   The output matches what the same messages would have produced in a text
+   debug file, apart from the duplicate line summaries.
+*/
+
+typedef struct {
+    DEBUG_FHDR      hdr;                                /* current file header */
+    char            **strs;                             /* string table by id */
+    uint32          strcount;
+    char            *text;                              /* message being assembled */
+    size_t          textlen, textsize;
+    t_bool          unterm;                             /* last line unterminated */
+    } DEBUG_DECODE;
+
+static t_bool _debug_dec_append (DEBUG_DECODE *dc, const char *data, size_t len)
+{
+if (dc->textlen + len + 1 > dc->textsize) {
+    char *ntext = (char *)realloc (dc->text, dc->textsize + len + 1024);
+
+    if (ntext == NULL)
+        return FALSE;
+    dc->text = ntext;
+    dc->textsize += len + 1024;
+    }
+memcpy (dc->text + dc->textlen, data, len);
+dc->textlen += len;
+dc->text[dc->textlen] = '\0';
+return TRUE;
+}
+
+static const char *_debug_dec_str (DEBUG_DECODE *dc, uint32 id)
+{
+if ((id == 0) || (id > dc->strcount) || (dc->strs[id - 1] == NULL))
+    return "?";
+return dc->strs[id - 1];
+}
+
+static t_uint64 _debug_dec_val (const DEBUG_FREC *rec, size_t *off)
+{
+t_uint64 val = 0;
+
+if (*off + sizeof (val) <= rec->len)
+    memcpy (&val, &rec->args[*off], sizeof (val));
+*off += sizeof (val);
+return val;
+}
+
+/* Expand a format and the arguments captured for it */
+
+static void _debug_dec_format (DEBUG_DECODE *dc, const DEBUG_FREC *rec)
+{
+const char *fmt = _debug_dec_str (dc, rec->fmt);
+const char *cp;
+DEBUG_BSPEC spec;
+size_t off = 0;
+char cfmt[64];
+char buf[512];
+
+while ((cp = strchr (fmt, '%')) != NULL) {
+    const char *next;
+    int width = 0, prec = -1;
+    size_t n;
+
+    _debug_dec_append (dc, fmt, cp - fmt);
+    if ((next = _debug_bin_spec (cp, &spec)) == NULL)
+        break;
+    fmt = next;
+    if (spec.conv == '%') {
+        _debug_dec_append (dc, "%", 1);
+        continue;
+        }
+    if (spec.star_width)
+        width = (int)(t_int64)_debug_dec_val (rec, &off);
+    if (spec.star_prec)
+        prec = (int)(t_int64)_debug_dec_val (rec, &off);
+    else
+        prec = spec.prec;
+    n = MIN (spec.flagslen, sizeof (cfmt) - 16);
+    cfmt[0] = '%';
+    memcpy (cfmt + 1, spec.flags, n);
+    n += 1;
+    if (spec.star_width)
+        n += sprintf (cfmt + n, "%d", width);
+    if ((prec >= 0) && (spec.conv != 's'))
+        n += sprintf (cfmt + n, ".%d", prec);
+    switch (spec.conv) {
+        case 'd': case 'i':
+            sprintf (cfmt + n, "%s%c", LL_FMT, spec.conv);
+            snprintf (buf, sizeof (buf), cfmt, (LL_TYPE)(t_int64)_debug_dec_val (rec, &off));
+            break;
+        case 'o': case 'u': case 'x': case 'X':
+            sprintf (cfmt + n, "%s%c", LL_FMT, spec.conv);
+            snprintf (buf, sizeof (buf), cfmt, (unsigned LL_TYPE)_debug_dec_val (rec, &off));
+            break;
+        case 'c':
+            strcpy (cfmt + n, "c");
+            snprintf (buf, sizeof (buf), cfmt, (int)_debug_dec_val (rec, &off));
+            break;
+        case 'p':
+            strcpy (cfmt + n, "p");
+            snprintf (buf, sizeof (buf), cfmt, (void *)(uintptr_t)_debug_dec_val (rec, &off));
+            break;
+        case 's': {
+            uint16 slen = 0;
+            char sval[DBGB_ARGSIZE + 1];
+
+            if (off + sizeof (slen) <= rec->len)
+                memcpy (&slen, &rec->args[off], sizeof (slen));
+            off += sizeof (slen);
+            if (off + slen > rec->len)
+                slen = (off < rec->len) ? (uint16)(rec->len - off) : 0;
+            memcpy (sval, &rec->args[off], slen);
+            sval[slen] = '\0';
+            off += slen;
+            strcpy (cfmt + n, "s");
+            snprintf (buf, sizeof (buf), cfmt, sval);
+            break;
+            }
+        default: {                                      /* floating point */
+            double dval = 0;
+
+            if (off + sizeof (dval) <= rec->len)
+                memcpy (&dval, &rec->args[off], sizeof (dval));
+            off += sizeof (dval);
+            sprintf (cfmt + n, "%c", spec.conv);
+            snprintf (buf, sizeof (buf), cfmt, dval);
+            break;
+            }
+        }
+    buf[sizeof (buf) - 1] = '\0';
+    _debug_dec_append (dc, buf, strlen (buf));
+    }
+_debug_dec_append (dc, fmt, strlen (fmt));
+}
+
+/* Write a complete message with debug prefixes, as _sim_vdebug does */
+
+static void _debug_dec_output (DEBUG_DECODE *dc, const DEBUG_FREC *rec, FILE *st)
+{
+char prefix[256 + MAX_WIDTH];
+char tim_t[32] = "";
+char pc_s[MAX_WIDTH + 40] = "";
+size_t i, j;
+
+if (dc->hdr.switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
+    struct timespec when;
+
+    when.tv_sec = (time_t)rec->sec;
+    when.tv_nsec = (long)rec->nsec;
+    if (dc->hdr.switches & SWMASK ('R')) {
+        struct timespec base;
+
+        base.tv_sec = (time_t)dc->hdr.base_sec;
+        base.tv_nsec = (long)dc->hdr.base_nsec;
+        sim_timespec_diff (&when, &when, &base);
+        }
+    if (dc->hdr.switches & SWMASK ('T')) {
+        time_t tnow = (time_t)when.tv_sec;
+        struct tm *now = localtime (&tnow);
+
+        if (now)
+            sprintf (tim_t, "%02d:%02d:%02d.%03d ", now->tm_hour, now->tm_min, now->tm_sec, (int)(when.tv_nsec/1000000));
+        }
+    if (dc->hdr.switches & SWMASK ('A'))
+        sprintf (tim_t, "%" LL_FMT "d.%03d ", (LL_TYPE)(when.tv_sec), (int)(when.tv_nsec/1000000));
+    }
+if ((dc->hdr.switches & SWMASK ('P')) && dc->hdr.pc_name[0]) {
+    sprintf (pc_s, "-%s:", dc->hdr.pc_name);
+    sprint_val (&pc_s[strlen (pc_s)], (t_value)rec->pc, dc->hdr.pc_radix ? dc->hdr.pc_radix : 16,
+                MIN (dc->hdr.pc_width, MAX_WIDTH), dc->hdr.pc_format);
+    }
+snprintf (prefix, sizeof (prefix), "DBG(%s%.0f%s)%s> %s %s: ", tim_t, rec->gtime, pc_s,
+          (rec->flags & DBGB_F_THREAD) ? "+" : "", _debug_dec_str (dc, rec->dev), _debug_dec_str (dc, rec->verb));
+for (i = j = 0; i < dc->textlen; ++i) {
+    if (dc->text[i] == '\n') {
+        if ((i != j) || (i == 0)) {
+            if (!dc->unterm)
+                fputs (prefix, st);
+            fwrite (&dc->text[j], 1, i - j, st);
+            fputs ("\r\n", st);
+            }
+        dc->unterm = FALSE;
+        j = i + 1;
+        }
+    }
+if (i > j) {
+    if (!dc->unterm)
+        fputs (prefix, st);
+    fwrite (&dc->text[j], 1, i - j, st);
+    }
+if (dc->textlen)
+    dc->unterm = (dc->text[dc->textlen - 1] != '\n');
+dc->textlen = 0;
+}
+
+t_stat sim_debug_decode (FILE *st, const char *filename)
+{
+FILE *f;
+DEBUG_DECODE dc;
+DEBUG_FREC rec;
+int c;
+uint32 i;
+t_bool have_header = FALSE;
+t_stat r = SCPE_OK;
+
+if ((f = sim_fopen (filename, "rb")) == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open debug file: %s\n", filename);
+memset (&dc, 0, sizeof (dc));
+while ((c = fgetc (f)) != EOF) {
+    char magic[DBGB_MAGIC_LEN];
+
+    if (c != 0) {                                       /* text written directly */
+        fputc (c, st);
+        continue;
+        }
+    magic[0] = 0;
+    if ((fread (&magic[1], 1, DBGB_MAGIC_LEN - 1, f) != DBGB_MAGIC_LEN - 1) ||
+        (memcmp (magic, DBGB_MAGIC, DBGB_MAGIC_LEN) != 0)) {
+        r = sim_messagef (SCPE_FMT, "Invalid binary debug entry at offset %" LL_FMT "d\n", (LL_TYPE)sim_ftell (f));
+        break;
+        }
+    c = fgetc (f);
+    if (c == DBGB_E_HEADER) {
+        if ((fread (&dc.hdr, sizeof (dc.hdr), 1, f) != 1) ||
+            (dc.hdr.version != DBGB_VERSION) ||
+            (dc.hdr.byteorder != 0x01020304) ||
+            (dc.hdr.recsize != sizeof (DEBUG_FREC))) {
+            r = sim_messagef (SCPE_INCOMP, "Binary debug file %s was written by an incompatible host or version\n", filename);
+            break;
+            }
+        for (i = 0; i < dc.strcount; i++)               /* new string table */
+            free (dc.strs[i]);
+        dc.strcount = 0;
+        dc.unterm = FALSE;
+        have_header = TRUE;
+        continue;
+        }
+    if (!have_header) {
+        r = sim_messagef (SCPE_FMT, "Missing binary debug header in %s\n", filename);
+        break;
+        }
+    if (c == DBGB_E_STRING) {
+        uint32 id, len;
+        char *str;
+
+        if ((fread (&id, sizeof (id), 1, f) != 1) ||
+            (fread (&len, sizeof (len), 1, f) != 1) ||
+            (id == 0) || (id > 0x1000000) ||
+            ((str = (char *)malloc (len + 1)) == NULL)) {
+            r = SCPE_FMT;
+            break;
+            }
+        if (fread (str, 1, len, f) != len) {
+            free (str);
+            r = SCPE_FMT;
+            break;
+            }
+        str[len] = '\0';
+        if (id > dc.strcount) {
+            char **nstrs = (char **)realloc (dc.strs, id * sizeof (*dc.strs));
+
+            if (nstrs == NULL) {
+                free (str);
+                r = SCPE_MEM;
+                break;
+                }
+            dc.strs = nstrs;
+            while (dc.strcount < id)
+                dc.strs[dc.strcount++] = NULL;
+            }
+        free (dc.strs[id - 1]);
+        dc.strs[id - 1] = str;
+        continue;
+        }
+    if ((c != DBGB_E_RECORD) ||
+        (fread (&rec, sizeof (rec), 1, f) != 1) ||
+        (rec.len > DBGB_ARGSIZE)) {
+        r = sim_messagef (SCPE_FMT, "Invalid binary debug record in %s\n", filename);
+        break;
+        }
+    if (rec.flags & DBGB_F_RAW) {                       /* text written directly */
+        fwrite (rec.args, 1, rec.len, st);
+        continue;
+        }
+    if (rec.type == DBGB_T_TEXT)
+        _debug_dec_append (&dc, (const char *)rec.args, rec.len);
+    else
+        _debug_dec_format (&dc, &rec);
+    if (!(rec.flags & DBGB_F_MORE))
+        _debug_dec_output (&dc, &rec, st);
+    }
+fclose (f);
+for (i = 0; i < dc.strcount; i++)
+    free (dc.strs[i]);
+free (dc.strs);
+free (dc.text);
+return r;
+}
+
+/* Debug command */
+
+t_stat debug_cmd (int32 flg, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+CONST char *svptr;
+DEVICE *dptr;
+
+GET_SWITCHES (cptr);                                    /* get switches */
+cptr = get_glyph (svptr = cptr, gbuf, 0);               /* get next glyph */
+if ((dptr = find_dev (gbuf)))                           /* device match? */
+return set_dev_debug (dptr, NULL, flg, *cptr ? cptr : NULL);
+cptr = svptr;
+if (flg)
+    return sim_set_debon (0, cptr);
+else
+    return sim_set_deboff (0, cptr);
+}
+
+/* Breakpoint commands */
+
+t_stat brk_cmd (int32 flg, CONST char *cptr)
+{
+GET_SWITCHES (cptr);                                    /* get switches */
+return ssh_break (NULL, cptr, flg);                     /* call common code */
+}
+
+t_stat ssh_break (FILE *st, const char *cptr, int32 flg)
+{
+char gbuf[CBUFSIZE], *aptr, abuf[4*CBUFSIZE];
+CONST char *tptr, *t1ptr;
+DEVICE *dptr = sim_dflt_dev;
+UNIT *uptr;
+t_stat r;
+t_addr lo, hi, max;
+int32 cnt;
+
+if (sim_brk_types == 0)
+    return sim_messagef (SCPE_NOFNC, "No breakpoint support in this simulator\n");
+if (dptr == NULL)
+    return SCPE_IERR;
+uptr = dptr->units;
+if (uptr == NULL)
+    return SCPE_IERR;
+max = uptr->capac - 1;
+abuf[sizeof(abuf)-1] = '\0';
+strlcpy (abuf, cptr, sizeof(abuf));
+if ((aptr = strchr (abuf, ';'))) {                      /* ;action? */
+    cptr += aptr - abuf + 1;
+    if (flg != SSH_ST)                                  /* only on SET */
+        return sim_messagef (SCPE_ARG, "Invalid argument: %s\n", cptr);
+    *aptr++ = 0;                                        /* separate strings */
+    if ((cptr > sim_sub_instr_buf) && ((size_t)(cptr - sim_sub_instr_buf) < sim_sub_instr_size))
+        aptr = &sim_sub_instr[sim_sub_instr_off[cptr - sim_sub_instr_buf]]; /* get un-substituted string */
+    }
+cptr = abuf;
+if (*cptr == 0) {                                       /* no argument? */
+    lo = (t_addr) get_rval (sim_PC, 0);                 /* use PC */
+    return ssh_break_one (st, flg, lo, 0, aptr);
+    }
+while (*cptr) {
+    cptr = get_glyph (cptr, gbuf, ',');
+    tptr = get_range (dptr, gbuf, &lo, &hi, dptr->aradix, max, 0);
+    if (tptr == NULL)
+        return sim_messagef (SCPE_ARG, "Invalid address specifier: %s\n", gbuf);
+    if (*tptr == '[') {
+        cnt = (int32) strtotv (tptr + 1, &t1ptr, 10);
+        if ((tptr == t1ptr) || (*t1ptr != ']') || (flg != SSH_ST))
+            return sim_messagef (SCPE_ARG, "Invalid repeat count specifier: %s\n", tptr + 1);
+        tptr = t1ptr + 1;
+        }
+    else cnt = 0;
+    if (*tptr != 0)
+        return sim_messagef (SCPE_ARG, "Unexpected argument: %s\n", tptr);
+    if ((lo == 0) && (hi == max)) {
+        if (flg == SSH_CL)
+            sim_brk_clrall (sim_switches);
+        else
+            if (flg == SSH_SH)
+                sim_brk_showall (st, sim_switches);
+            else
+                return SCPE_ARG;
+        }
+    else {
+        for ( ; lo <= hi; lo = lo + 1) {
+            r = ssh_break_one (st, flg, lo, cnt, aptr);
+            if (r != SCPE_OK)
+                return r;
+            }
+        }
+    }
+return SCPE_OK;
+}
+
+t_stat ssh_break_one (FILE *st, int32 flg, t_addr lo, int32 cnt, CONST char *aptr)
+{
+if (!sim_brk_types)
+    return sim_messagef (SCPE_NOFNC, "No breakpoint support in this simulator\n");
+switch (flg) {
+
+    case SSH_ST:
+        return sim_brk_set (lo, sim_switches, cnt, aptr);
+        break;
+
+    case SSH_CL:
+        return sim_brk_clr (lo, sim_switches);
+        break;
+
+    case SSH_SH:
+        return sim_brk_show (st, lo, sim_switches);
+        break;
+
+    default:
+        return SCPE_ARG;
     }
 }
 
@@ -8520,9 +10152,167 @@ return uptr->uname = strcpy ((char *)malloc (1 + strlen (uname)), uname);
 }
 
 
+/* Save and restore a memory image
+
+   A memory-like unit whose device provides a membase routine is saved as
+   an image of the host memory array rather than as one examined value per
+   address.  The image is written in SRPAGSIZ pages, each preceded by a tag
+   byte.  Pages which are all zero or which repeat the preceding page are
+   written as just the tag.  Page data is written in little endian order in
+   units of the memory element width, so save files remain portable between
+   hosts, and is restored directly into the memory array.
+
+   An incremental save (SAVE -I) also writes just the tag for pages which
+   have not been written since the base snapshot was saved or restored.
+   The CPU marks the pages it writes in the sim_mem_dirty page map (see
+   SIM_MEM_DIRTY in scp.h) while that map is active.  Only one memory image,
+   the first one saved or restored, is tracked; other images are always
+   saved in full.
+*/
+
+static t_stat sim_save_image (FILE *sfile, const uint8 *image, size_t bytes, size_t width, const uint32 *dirty)
+{
+uint8 *zero;
+const uint8 *prev = NULL;
+uint32 wid = (uint32)width;
+uint32 pagsiz = SRPAGSIZ;
+t_uint64 size = (t_uint64)bytes;
+size_t off;
+
+if ((width == 0) || (bytes % width) || (SRPAGSIZ % width))
+    return SCPE_IERR;
+if ((zero = (uint8 *)calloc (1, SRPAGSIZ)) == NULL)
+    return SCPE_MEM;
+sim_fwrite (&wid, sizeof (wid), 1, sfile);              /* element width */
+sim_fwrite (&pagsiz, sizeof (pagsiz), 1, sfile);        /* page size */
+sim_fwrite (&size, sizeof (size), 1, sfile);            /* image size */
+for (off = 0; off < bytes; off += SRPAGSIZ) {
+    size_t len = MIN (SRPAGSIZ, bytes - off);
+    size_t pg = off / SRPAGSIZ;
+
+    if (dirty && !(dirty[pg >> 5] & (1u << (pg & 0x1F))))/* unchanged from base? */
+        fputc (SR_PAGE_BASE, sfile);
+    else if (memcmp (image + off, zero, len) == 0)      /* all zero? */
+        fputc (SR_PAGE_ZERO, sfile);
+    else if (prev && (memcmp (image + off, prev, len) == 0)) /* same as prior? */
+        fputc (SR_PAGE_DUP, sfile);
+    else {
+        fputc (SR_PAGE_DATA, sfile);
+        sim_fwrite (image + off, width, len / width, sfile);
+        }
+    prev = image + off;
+    }
+free (zero);
+return ferror (sfile) ? SCPE_IOERR : SCPE_OK;
+}
+
+static t_stat sim_rest_image (FILE *rfile, uint8 *image, size_t bytes, size_t width, t_bool delta)
+{
+uint32 wid, pagsiz;
+t_uint64 size;
+size_t off;
+
+if ((sim_fread (&wid, sizeof (wid), 1, rfile) == 0) ||
+    (sim_fread (&pagsiz, sizeof (pagsiz), 1, rfile) == 0) ||
+    (sim_fread (&size, sizeof (size), 1, rfile) == 0))
+    return SCPE_IOERR;
+if ((wid != width) || (size != (t_uint64)bytes) ||
+    (pagsiz == 0) || (pagsiz % wid))
+    return sim_messagef (SCPE_INCOMP, "Incompatible memory image: width %u, size %.0f - expected width %u, size %.0f\n",
+                         (uint32)wid, (double)size, (uint32)width, (double)bytes);
+for (off = 0; off < bytes; off += pagsiz) {
+    size_t len = MIN (pagsiz, bytes - off);
+
+    switch (fgetc (rfile)) {
+        case SR_PAGE_ZERO:
+            memset (image + off, 0, len);
+            break;
+        case SR_PAGE_DUP:
+            if (off == 0)
+                return SCPE_IOERR;
+            memcpy (image + off, image + off - pagsiz, len);
+            break;
+        case SR_PAGE_DATA:
+            if (sim_fread (image + off, width, len / width, rfile) != len / width)
+                return SCPE_IOERR;
+            break;
+        case SR_PAGE_BASE:                              /* restored from base */
+            if (!delta)
+                return SCPE_IOERR;
+            break;
+        default:                                        /* invalid tag or EOF */
+            return SCPE_IOERR;
+        }
+    }
+return SCPE_OK;
+}
+
+/* Start tracking the pages written to a memory image
+
+   Called once a snapshot has been saved or restored, with the size of the
+   tracked memory image (or 0 if there is none).  Dirty pages are then
+   relative to that snapshot.
+*/
+
+static void sim_mem_track (size_t bytes)
+{
+size_t words = (((bytes + SRPAGSIZ - 1) / SRPAGSIZ) + 31) / 32;
+
+if ((bytes == 0) || ((t_addr)bytes != sim_mem_dirty_limit)) {
+    free (sim_mem_dirty);
+    sim_mem_dirty = NULL;
+    sim_mem_dirty_limit = 0;
+    if ((bytes == 0) ||
+        ((sim_mem_dirty = (uint32 *)malloc (words * sizeof (*sim_mem_dirty))) == NULL))
+        return;
+    sim_mem_dirty_limit = (t_addr)bytes;
+    }
+memset (sim_mem_dirty, 0, words * sizeof (*sim_mem_dirty));
+}
+
+/* Mark a range of a memory image dirty (for bulk writes to memory) */
+
+void sim_mem_dirty_range (t_addr ba, t_addr bytes)
+{
+t_addr pg;
+
+if ((sim_mem_dirty == NULL) || (bytes == 0))
+    return;
+for (pg = ba >> SIM_MEM_PAGE_SHIFT; pg <= ((ba + bytes - 1) >> SIM_MEM_PAGE_SHIFT); pg++)
+    SIM_MEM_DIRTY (pg << SIM_MEM_PAGE_SHIFT);
+}
+
+/* Check whether a save file holds the snapshot dirty pages are tracked against */
+
+static t_bool sim_save_is_base (const char *fname)
+{
+FILE *f;
+char buf[CBUFSIZE];
+uint32 rtime;
+int32 i;
+t_bool match = FALSE;
+
+if ((sr_stamp[0] == 0) || (strcmp (fname, sr_stamp_file) != 0) ||
+    ((f = sim_fopen (fname, "rb")) == NULL))
+    return FALSE;
+if ((read_line (buf, sizeof (buf), f) != NULL) &&       /* version */
+    (strcmp (buf, save_ver42) == 0)) {
+    for (i = 0; (i < 5) && (read_line (buf, sizeof (buf), f) != NULL); i++)
+        ;                                               /* name, options, time */
+    if ((i == 5) &&
+        (sim_fread (&rtime, sizeof (rtime), 1, f) == 1) &&
+        (read_line (buf, sizeof (buf), f) != NULL) &&   /* git commit id */
+        (read_line (buf, sizeof (buf), f) != NULL))     /* snapshot stamp */
+        match = (strcmp (buf, sr_stamp) == 0);
+    }
+fclose (f);
+return match;
+}
+
 /* Save command
 
    sa[ve] filename              save state to specified file
+   sa[ve] -i base filename      save changes since base to specified file
 */
 
 t_stat save_cmd (int32 flag, CONST char *cptr)
@@ -8530,26 +10320,48 @@ t_stat save_cmd (int32 flag, CONST char *cptr)
 FILE *sfile;
 t_stat r;
 char gbuf[4*CBUFSIZE];
+char bbuf[4*CBUFSIZE];
 
 GET_SWITCHES (cptr);                                    /* get switches */
 if (*cptr == 0)                                         /* must be more */
     return SCPE_2FARG;
+if (sim_switches & SWMASK ('I')) {                      /* incremental? */
+    cptr = get_glyph_nc (cptr, bbuf, 0);                /* get base file name */
+    if (*cptr == 0)                                     /* must be more */
+        return SCPE_2FARG;
+    }
 gbuf[sizeof(gbuf)-1] = '\0';
 strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
+if (sim_switches & SWMASK ('I')) {
+    if (strcmp (bbuf, gbuf) == 0)
+        return sim_messagef (SCPE_ARG, "Incremental save can't replace its base: %s\n", gbuf);
+    if (!sim_save_is_base (bbuf))
+        return sim_messagef (SCPE_ARG, "%s is not the most recent snapshot saved or restored\n", bbuf);
+    sr_base = bbuf;
+    }
 if ((sfile = sim_fopen (gbuf, "r+b")) == NULL) {    /* try existing file */
-    if ((sfile = sim_fopen (gbuf, "wb")) == NULL)   /* create new empty file */
+    if ((sfile = sim_fopen (gbuf, "wb")) == NULL) { /* create new empty file */
+        sr_base = NULL;
         return SCPE_OPENERR;
+        }
     }
 r = sim_save (sfile);
+sr_base = NULL;
 fclose (sfile);
+if (r == SCPE_OK)                                       /* changes now relative to this file */
+    strlcpy (sr_stamp_file, gbuf, sizeof (sr_stamp_file));
 return r;
 }
 
 t_stat sim_save (FILE *sfile)
 {
 void *mbuf;
-int32 l, t;
+uint8 *image;
+size_t bytes, width;
+size_t tracked = 0;
+char stamp[CBUFSIZE];
+int32 l, t, fmt;
 uint32 i, j, device_count;
 t_addr k, high;
 t_value val;
@@ -8581,6 +10393,11 @@ fprintf (sfile, "git commit id: %8.8s\n", S_xstr(SIM_GIT_COMMIT_ID));
 #else
 fprintf (sfile, "git commit id: unknown\n");
 #endif
+sprintf (stamp, "%X-%X-%X", (uint32)time (NULL), sim_os_msec (), sim_rtime);
+fprintf (sfile, "%s\n%s\n%s\n",
+    stamp,                                              /* [V4.2] snapshot stamp */
+    sr_base ? sr_stamp : "",                            /* [V4.2] base snapshot stamp */
+    sr_base ? sr_base : "");                            /* [V4.2] base snapshot file */
 
 for (device_count = 0; sim_devices[device_count]; device_count++);/* count devices */
 for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru devices */
@@ -8632,6 +10449,20 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
              (dptr->examine != NULL) &&
              ((high = uptr->capac) != 0)) {             /* memory-like unit? */
             WRITE_I (high);                             /* [V2.5] write size */
+            image = (dptr->membase != NULL) ? (uint8 *)dptr->membase (uptr, &bytes, &width) : NULL;
+            fmt = (image != NULL) ? SR_FMT_IMAGE : SR_FMT_WORDS;
+            WRITE_I (fmt);                              /* [V4.1] memory format */
+            if (image != NULL) {                        /* memory image available? */
+                t_bool track = (tracked == 0);          /* first image is tracked */
+
+                r = sim_save_image (sfile, image, bytes, width,
+                                    (track && sr_base && ((t_addr)bytes == sim_mem_dirty_limit)) ? sim_mem_dirty : NULL);
+                if (r != SCPE_OK)
+                    return r;
+                if (track)
+                    tracked = bytes;
+                continue;                               /* next unit */
+                }
             sz = SZ_D (dptr);
             if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
                 fclose (sfile);
@@ -8687,7 +10518,11 @@ if (!ferror (sfile)) {
         return SCPE_IOERR;                              /* done! */
     sim_set_fsize (sfile, (t_addr)pos);                 /* truncate the save file */
     }
-return (ferror (sfile))? SCPE_IOERR: SCPE_OK;           /* error during save? */
+if (ferror (sfile))                                     /* error during save? */
+    return SCPE_IOERR;
+sim_mem_track (tracked);                                /* track changes from here */
+strlcpy (sr_stamp, stamp, sizeof (sr_stamp));
+return SCPE_OK;
 }
 
 /* Restore command
@@ -8711,6 +10546,8 @@ if ((rfile = sim_fopen (gbuf, "rb")) == NULL)
     return SCPE_OPENERR;
 r = sim_rest (rfile);
 fclose (rfile);
+if (r == SCPE_OK)                                       /* changes now relative to this file */
+    strlcpy (sr_stamp_file, gbuf, sizeof (sr_stamp_file));
 return r;
 }
 
@@ -8722,13 +10559,19 @@ UNIT **attunits = NULL;
 int32 *attswitches = NULL;
 int32 attcnt = 0;
 void *mbuf = NULL;
-int32 j, blkcnt, limit, unitno, time, flg;
+uint8 *image;
+size_t bytes, width;
+size_t tracked = 0;
+char stamp[CBUFSIZE], bstamp[CBUFSIZE], bname[CBUFSIZE];
+int32 j, blkcnt, limit, unitno, time, flg, fmt;
 uint32 us, depth;
 t_addr k, high, old_capac;
 t_value val, max;
 t_stat r;
 size_t sz;
-t_bool v40, v35, v32;
+t_bool v42, v41, v40, v35, v32;
+t_bool delta = FALSE;
+int32 saved_switches = sim_switches;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
@@ -8749,14 +10592,19 @@ sim_switches &= ~(SWMASK ('F') | SWMASK ('D') | SWMASK ('Q'));  /* remove digest
     goto Cleanup_Return;                                                \
     }
 
+sr_stamp[0] = stamp[0] = '\0';                          /* tracked snapshot no longer valid */
 if (fstat (fileno (rfile), &rstat)) {
     r = SCPE_IOERR;
     goto Cleanup_Return;
     }
 READ_S (buf);                                           /* [V2.5+] read version */
 sim_debug (SIM_DBG_RESTORE, &sim_scp_dev, "version=%s\n", buf);
-v40 = v35 = v32 = FALSE;
-if (strcmp (buf, save_ver40) == 0)                      /* version 4.0? */
+v42 = v41 = v40 = v35 = v32 = FALSE;
+if (strcmp (buf, save_ver42) == 0)                      /* version 4.2? */
+    v42 = v41 = v40 = v35 = v32 = TRUE;
+else if (strcmp (buf, save_ver41) == 0)                 /* version 4.1? */
+    v41 = v40 = v35 = v32 = TRUE;
+else if (strcmp (buf, save_ver40) == 0)                 /* version 4.0? */
     v40 = v35 = v32 = TRUE;
 else if (strcmp (buf, save_ver35) == 0)                 /* version 3.5? */
     v35 = v32 = TRUE;
@@ -8766,7 +10614,7 @@ else if (strcmp (buf, save_ver30) != 0) {               /* version 3.0? */
     sim_printf ("Invalid file version: %s\n", buf);
     return SCPE_INCOMP;
     }
-if ((strcmp (buf, save_ver40) != 0) && (!sim_quiet) && (!suppress_warning)) {
+if ((strcmp (buf, save_vercur) != 0) && (!sim_quiet) && (!suppress_warning)) {
     sim_printf ("warning - attempting to restore a saved simulator image in %s image format.\n", buf);
     warned = TRUE;
     }
@@ -8809,6 +10657,40 @@ if (v40) {
 #undef S_xstr
 #endif
     }
+if (v42) {
+    READ_S (stamp);                                     /* [V4.2+] snapshot stamp */
+    READ_S (bstamp);                                    /* [V4.2+] base snapshot stamp */
+    READ_S (bname);                                     /* [V4.2+] base snapshot file */
+    if (bname[0] != '\0') {                             /* incremental save? */
+        FILE *bfile;
+
+        if (sr_chain >= SR_MAXCHAIN) {
+            sim_printf ("Incremental save chain too long: %s\n", bname);
+            r = SCPE_INCOMP;
+            goto Cleanup_Return;
+            }
+        if ((bfile = sim_fopen (bname, "rb")) == NULL) {
+            sim_printf ("Can't open base snapshot: %s\n", bname);
+            r = SCPE_OPENERR;
+            goto Cleanup_Return;
+            }
+        sim_debug (SIM_DBG_RESTORE, &sim_scp_dev, "base=%s\n", bname);
+        sim_switches = saved_switches;                  /* restore base the same way */
+        ++sr_chain;
+        r = sim_rest (bfile);                           /* restore base first */
+        --sr_chain;
+        fclose (bfile);
+        if (r != SCPE_OK)
+            goto Cleanup_Return;
+        if (strcmp (sr_stamp, bstamp) != 0) {
+            sim_printf ("Base snapshot %s doesn't match this incremental save\n", bname);
+            r = SCPE_INCOMP;
+            goto Cleanup_Return;
+            }
+        sr_stamp[0] = '\0';
+        delta = TRUE;
+        }
+    }
 if (!dont_detach_attach)
     detach_all (0, 0);                                  /* Detach everything to start from a consistent state */
 else {
@@ -8944,6 +10826,23 @@ for ( ;; ) {                                            /* device loop */
                     fprint_capac (sim_log, dptr, uptr);
                 sim_printf ("\n");
                 }
+            if (v41) {
+                READ_I (fmt);                           /* [V4.1+] memory format */
+                if (fmt == SR_FMT_IMAGE) {              /* memory image? */
+                    image = (dptr->membase != NULL) ? (uint8 *)dptr->membase (uptr, &bytes, &width) : NULL;
+                    if (image == NULL) {
+                        sim_printf ("Can't restore memory image: %s%d\n", sim_dname (dptr), unitno);
+                        r = SCPE_INCOMP;
+                        goto Cleanup_Return;
+                        }
+                    r = sim_rest_image (rfile, image, bytes, width, delta);
+                    if (r != SCPE_OK)
+                        goto Cleanup_Return;
+                    if (tracked == 0)                   /* first image is tracked */
+                        tracked = bytes;
+                    continue;                           /* next unit */
+                    }
+                }
             sz = SZ_D (dptr);                           /* allocate buffer */
             if ((mbuf = realloc (mbuf, SRBSIZ * sz)) == NULL) {
                 r = SCPE_MEM;
@@ -9052,6 +10951,10 @@ for (j=0, r = SCPE_OK; j<attcnt; j++) {
     attnames[j] = NULL;
     }
 Cleanup_Return:
+if (r == SCPE_OK) {                                     /* track changes from here */
+    sim_mem_track (tracked);
+    strlcpy (sr_stamp, stamp, sizeof (sr_stamp));
+    }
 free (mbuf);
 for (j=0; j < attcnt; j++)
     free (attnames[j]);
@@ -11854,6 +13757,7 @@ return buf;
         sim_atime               return absolute time for an entry
         sim_gtime               return global time
         sim_qcount              return event queue entry count
+        sim_qunit               return an entry on the event queue
 
    Asynchronous events are set up by queueing a unit data structure
    to the event queue with a timeout (in simulator units, relative
@@ -11863,8 +13767,18 @@ return buf;
    and to see if further events need to be processed, or sim_interval
    reset to count the next one.
 
-   The event queue is maintained in clock order; entry timeouts are
-   RELATIVE to the time in the previous entry.
+   The event queue is maintained as a binary min-heap ordered by the
+   absolute due time of each entry (q_time).  Entries due at the same
+   time are ordered by their insertion sequence (q_seq), so they are
+   dispatched first in, first out.  Each queued unit remembers its
+   heap slot in q_index, which makes insertion and removal O(log n)
+   regardless of how many units are active.
+
+   sim_clock_queue always points at the heap root (the next entry
+   due), and only the root's time field is maintained: it holds the
+   delay until that entry fires as of the last UPDATE_SIM_TIME.  The
+   next field of every queued unit is QUEUE_LIST_END, so a non NULL
+   next still means "on a queue".
 
    sim_process_event - process event
 
@@ -11875,6 +13789,156 @@ return buf;
                         or 0 (SCPE_OK) if no exceptions
 */
 
+/* Event queue heap primitives */
+
+static t_bool _sim_clock_before (UNIT *a, UNIT *b)
+{
+if (a->q_time != b->q_time)
+    return (a->q_time < b->q_time);
+return ((int32)(a->q_seq - b->q_seq) < 0);
+}
+
+static int _sim_clock_compare (const void *pa, const void *pb)
+{
+UNIT *a = *(UNIT * const *)pa;
+UNIT *b = *(UNIT * const *)pb;
+
+if (a == b)
+    return 0;
+return _sim_clock_before (a, b) ? -1 : 1;
+}
+
+static t_bool _sim_clock_is_queued (UNIT *uptr)
+{
+return ((uptr->q_index > 0) &&
+        (uptr->q_index <= sim_clock_heap_count) &&
+        (sim_clock_heap[uptr->q_index] == uptr));
+}
+
+static void _sim_clock_heap_set (int32 idx, UNIT *uptr)
+{
+sim_clock_heap[idx] = uptr;
+uptr->q_index = idx;
+}
+
+static void _sim_clock_heap_up (int32 idx)
+{
+UNIT *uptr = sim_clock_heap[idx];
+
+while (idx > 1) {
+    int32 parent = idx >> 1;
+
+    if (!_sim_clock_before (uptr, sim_clock_heap[parent]))
+        break;
+    _sim_clock_heap_set (idx, sim_clock_heap[parent]);
+    idx = parent;
+    }
+_sim_clock_heap_set (idx, uptr);
+}
+
+static void _sim_clock_heap_down (int32 idx)
+{
+UNIT *uptr = sim_clock_heap[idx];
+
+while (1) {
+    int32 child = idx << 1;
+
+    if (child > sim_clock_heap_count)
+        break;
+    if ((child < sim_clock_heap_count) &&
+        _sim_clock_before (sim_clock_heap[child + 1], sim_clock_heap[child]))
+        ++child;
+    if (!_sim_clock_before (sim_clock_heap[child], uptr))
+        break;
+    _sim_clock_heap_set (idx, sim_clock_heap[child]);
+    idx = child;
+    }
+_sim_clock_heap_set (idx, uptr);
+}
+
+/* Event queue time line position as of the last UPDATE_SIM_TIME */
+
+static double _sim_clock_now (void)
+{
+if (sim_clock_queue == QUEUE_LIST_END)
+    return 0.0;
+return sim_clock_queue->q_time - sim_clock_queue->time;
+}
+
+/* Reestablish sim_clock_queue and its delay after the heap root may have changed */
+
+static void _sim_clock_root_update (double now)
+{
+if (sim_clock_heap_count == 0) {
+    sim_clock_queue = QUEUE_LIST_END;
+    return;
+    }
+sim_clock_queue = sim_clock_heap[1];
+sim_clock_queue->time = (int32)(sim_clock_queue->q_time - now);
+}
+
+static void _sim_clock_sample_depth (void)
+{
+sim_queue_depth_sum += sim_clock_heap_count;
+if (sim_clock_heap_count > sim_queue_depth_max)
+    sim_queue_depth_max = sim_clock_heap_count;
+}
+
+static t_stat _sim_clock_insert (UNIT *uptr, int32 event_time)
+{
+double now = _sim_clock_now ();
+
+if (sim_clock_heap_count + 1 >= sim_clock_heap_size) {
+    int32 new_size = (sim_clock_heap_size == 0) ? 64 : 2 * sim_clock_heap_size;
+    UNIT **new_heap = (UNIT **)realloc (sim_clock_heap, new_size * sizeof (*new_heap));
+
+    if (new_heap == NULL)
+        return SCPE_MEM;
+    sim_clock_heap = new_heap;
+    sim_clock_heap_size = new_size;
+    }
+uptr->q_time = now + event_time;
+uptr->q_seq = sim_clock_seq++;
+uptr->next = QUEUE_LIST_END;                            /* flag as queued */
+uptr->time = event_time;
+_sim_clock_heap_set (++sim_clock_heap_count, uptr);
+_sim_clock_heap_up (sim_clock_heap_count);
+_sim_clock_root_update (now);
+++sim_queue_inserts;
+_sim_clock_sample_depth ();
+return SCPE_OK;
+}
+
+static void _sim_clock_remove (UNIT *uptr, double now)
+{
+int32 idx = uptr->q_index;
+UNIT *last = sim_clock_heap[sim_clock_heap_count--];
+
+if (idx <= sim_clock_heap_count) {                      /* vacated slot not at end? */
+    _sim_clock_heap_set (idx, last);
+    if ((idx > 1) && _sim_clock_before (last, sim_clock_heap[idx >> 1]))
+        _sim_clock_heap_up (idx);
+    else
+        _sim_clock_heap_down (idx);
+    }
+uptr->q_index = 0;
+uptr->next = NULL;                                      /* hygiene */
+uptr->time = 0;
+_sim_clock_root_update (now);
+}
+
+/* Entry which follows the heap root in dispatch order */
+
+static UNIT *_sim_clock_second (void)
+{
+if (sim_clock_heap_count < 2)
+    return QUEUE_LIST_END;
+if ((sim_clock_heap_count > 2) &&
+    _sim_clock_before (sim_clock_heap[3], sim_clock_heap[2]))
+    return sim_clock_heap[3];
+return sim_clock_heap[2];
+}
+
 t_stat sim_process_event (void)
 {
 UNIT *uptr;
@@ -11908,9 +13972,9 @@ if (sim_interval < 0) {
     UPDATE_SIM_TIME;                          /* update sim time */
     sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "Processing event for %s with sim_interval = %d, event time = %.0f\n", 
         sim_uname (sim_clock_queue), sim_interval_catchup, sim_gtime ());
-    if (sim_clock_queue->next != QUEUE_LIST_END)
-        sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "- Next event for %s after = %d\n", 
-            sim_uname (sim_clock_queue->next), sim_clock_queue->next->time);
+    if (_sim_clock_second () != QUEUE_LIST_END)
+        sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "- Next event for %s after = %.0f\n", 
+            sim_uname (_sim_clock_second ()), _sim_clock_second ()->q_time - sim_clock_queue->q_time);
     sim_time -= sim_clock_queue->time;
     sim_rtime -= sim_clock_queue->time;
     }
@@ -11918,9 +13982,9 @@ else
     sim_interval_catchup = 0;
 do {
     uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
-    uptr->next = NULL;                                  /* hygiene */
-    uptr->time = 0;
+    _sim_clock_sample_depth ();
+    ++sim_queue_dispatches;
+    _sim_clock_remove (uptr, uptr->q_time);             /* remove first, now is its due time */
     if (sim_clock_queue != QUEUE_LIST_END) {
         if (sim_interval_catchup < 0)
             sim_interval = -sim_interval_catchup;
@@ -12001,8 +14065,7 @@ return _sim_activate (uptr, event_time);
 
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
-UNIT *cptr, *prvptr;
-int32 accum;
+t_stat r;
 
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
@@ -12011,25 +14074,9 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, &sim_scp_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
-prvptr = NULL;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (event_time < (accum + cptr->time))
-        break;
-    accum = accum + cptr->time;
-    prvptr = cptr;
-    }
-if (prvptr == NULL) {                                   /* insert at head */
-    cptr = uptr->next = sim_clock_queue;
-    sim_clock_queue = uptr;
-    }
-else {
-    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
-    prvptr->next = uptr;
-    }
-uptr->time = event_time - accum;
-if (cptr != QUEUE_LIST_END)
-    cptr->time = cptr->time - uptr->time;
+r = _sim_clock_insert (uptr, event_time);
+if (r != SCPE_OK)
+    return r;
 sim_interval = sim_clock_queue->time;
 return SCPE_OK;
 }
@@ -12129,8 +14176,6 @@ return sim_timer_activate_after (uptr, usec_delay);
 
 t_stat sim_cancel (UNIT *uptr)
 {
-UNIT *cptr, *nptr;
-
 AIO_VALIDATE(uptr);
 if ((uptr->cancel) && uptr->cancel (uptr))
     return SCPE_OK;
@@ -12144,25 +14189,11 @@ if (!sim_is_active (uptr))
     return SCPE_OK;
 UPDATE_SIM_TIME;                                        /* update sim time */
 sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Canceling Event for %s\n", sim_uname(uptr));
-nptr = QUEUE_LIST_END;
-
-if (sim_clock_queue == uptr) {
-    nptr = sim_clock_queue = uptr->next;
-    uptr->next = NULL;                                  /* hygiene */
-    }
-else {
-    for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-        if (cptr->next == uptr) {
-            nptr = cptr->next = uptr->next;
-            uptr->next = NULL;                          /* hygiene */
-            break;                                      /* end queue scan */
-            }
-        }
+if (_sim_clock_is_queued (uptr)) {
+    _sim_clock_sample_depth ();
+    ++sim_queue_cancels;
+    _sim_clock_remove (uptr, _sim_clock_now ());
     }
-if (nptr != QUEUE_LIST_END)
-    nptr->time += (uptr->next) ? 0 : uptr->time;
-if (!uptr->next)
-    uptr->time = 0;
 uptr->usecs_remaining = 0;
 if (sim_clock_queue != QUEUE_LIST_END)
     sim_interval = sim_clock_queue->time;
@@ -12202,21 +14233,12 @@ return (((uptr->next) || AIO_IS_ACTIVE(uptr) || ((uptr->dynflags & UNIT_TMR_UNIT
 
 int32 _sim_activate_queue_time (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return accum + 1;
-    }
-return 0;
+if (!_sim_clock_is_queued (uptr))
+    return 0;
+accum = (sim_interval > 0) ? sim_interval : 0;
+return accum + (int32)(uptr->q_time - sim_clock_queue->q_time) + 1;
 }
 
 int32 _sim_activate_time (UNIT *uptr)
@@ -12241,7 +14263,6 @@ return _sim_activate_time (uptr);
 
 double sim_activate_time_usecs (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 double result;
 
@@ -12249,18 +14270,10 @@ AIO_VALIDATE(uptr);
 result = sim_timer_activate_time_usecs (uptr);
 if (result >= 0)
     return result;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return 1.0 + uptr->usecs_remaining + ((1000000.0 * accum) / sim_timer_inst_per_sec ());
-    }
-return 0.0;
+accum = _sim_activate_queue_time (uptr);
+if (accum == 0)
+    return 0.0;
+return 1.0 + uptr->usecs_remaining + ((1000000.0 * (accum - 1)) / sim_timer_inst_per_sec ());
 }
 
 /* sim_gtime - return global time
@@ -12294,13 +14307,24 @@ return sim_rtime;
 
 int32 sim_qcount (void)
 {
-int32 cnt;
-UNIT *uptr;
+return sim_clock_heap_count;
+}
 
-cnt = 0;
-for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
-    cnt++;
-return cnt;
+/* sim_qunit - return an event queue entry
+
+   Inputs:
+        idx     =       entry index (0 to sim_qcount () - 1)
+   Outputs:
+        uptr    =       queued unit, NULL if idx is out of range
+
+   Entries are returned in heap order, not dispatch order.
+*/
+
+UNIT *sim_qunit (int32 idx)
+{
+if ((idx < 0) || (idx >= sim_clock_heap_count))
+    return NULL;
+return sim_clock_heap[idx + 1];
 }
 
 /* Breakpoint package.  This module replaces the VM-implemented one
@@ -12868,6 +14892,15 @@ return msg;
         buf                     the buffer of output data which has been produced
         buf_ins                 the buffer insertion point for the next output data
         buf_size                the buffer size
+        match_next              the literal match automaton transition table
+        match_rule              the lowest numbered rule matched in each state
+        match_state             the current literal match automaton state
+
+   The literal (non regex) match strings of all rules are combined into a
+   single Aho-Corasick automaton which is advanced by each byte of output
+   data, so the cost of checking output doesn't depend on the number or the
+   length of the literal rules.  Regular expression rules are still
+   evaluated against the buffer of output data.
 
    The package contains the following public routines:
 
@@ -12979,8 +15012,10 @@ free (ep->match);                                       /* deallocate match stri
 free (ep->match_pattern);                               /* deallocate the display format match string */
 free (ep->act);                                         /* deallocate action */
 #if defined(USE_REGEX)
-if (ep->switches & EXP_TYP_REGEX)
+if (ep->switches & EXP_TYP_REGEX) {
     pcre_free (ep->regex);                              /* release compiled regex */
+    free (ep->ovector);                                 /* release match offsets */
+    }
 #endif
 exp->size -= 1;                                         /* decrement count */
 for (i=ep-exp->rules; i<exp->size; i++)                 /* shuffle up remaining rules */
@@ -12989,6 +15024,7 @@ if (exp->size == 0) {                                   /* No rules left? */
     free (exp->rules);
     exp->rules = NULL;
     }
+exp->match_valid = FALSE;                               /* rebuild literal matcher */
 return SCPE_OK;
 }
 
@@ -13014,8 +15050,10 @@ for (i=0; i<exp->size; i++) {
     free (exp->rules[i].match_pattern);                 /* deallocate display format match string */
     free (exp->rules[i].act);                           /* deallocate action */
 #if defined(USE_REGEX)
-    if (exp->rules[i].switches & EXP_TYP_REGEX)
+    if (exp->rules[i].switches & EXP_TYP_REGEX) {
         pcre_free (exp->rules[i].regex);                /* release compiled regex */
+        free (exp->rules[i].ovector);                   /* release match offsets */
+        }
 #endif
     }
 free (exp->rules);
@@ -13023,8 +15061,18 @@ exp->rules = NULL;
 exp->size = 0;
 free (exp->buf);
 exp->buf = NULL;
+#if defined(USE_REGEX)
+free (exp->rbuf);
+exp->rbuf = NULL;
+#endif
 exp->buf_size = 0;
 exp->buf_data = exp->buf_ins = 0;
+free (exp->match_next);
+exp->match_next = NULL;
+free (exp->match_rule);
+exp->match_rule = NULL;
+exp->match_state = 0;
+exp->match_valid = FALSE;
 return SCPE_OK;
 }
 
@@ -13108,6 +15156,12 @@ if (switches & EXP_TYP_REGEX) {
     match_buf[strlen(match)-2] = '\0';
     ep->regex = pcre_compile ((char *)match_buf, (switches & EXP_TYP_REGEX_I) ? PCRE_CASELESS : 0, &errmsg, &erroffset, NULL);
     (void)pcre_fullinfo(ep->regex, NULL, PCRE_INFO_CAPTURECOUNT, &ep->re_nsub);
+    ep->ovector = (int *)malloc (3 * (ep->re_nsub + 1) * sizeof (*ep->ovector));
+    if (ep->ovector == NULL) {
+        sim_exp_clr_tab (exp, ep);                      /* clear it */
+        free (match_buf);
+        return SCPE_MEM;
+        }
 #endif
     free (match_buf);
     match_buf = NULL;
@@ -13143,9 +15197,13 @@ for (i=0; i<exp->size; i++) {
     uint32 compare_size = (exp->rules[i].switches & EXP_TYP_REGEX) ? MAX(10 * strlen(ep->match_pattern), 1024) : exp->rules[i].size;
     if (compare_size >= exp->buf_size) {
         exp->buf = (uint8 *)realloc (exp->buf, compare_size + 2); /* Extra byte to null terminate regex compares */
+#if defined(USE_REGEX)
+        exp->rbuf = (char *)realloc (exp->rbuf, compare_size + 2);
+#endif
         exp->buf_size = compare_size + 1;
         }
     }
+exp->match_valid = FALSE;                               /* rebuild literal matcher */
 return SCPE_OK;
 }
 
@@ -13221,54 +15279,158 @@ for (i=0; i < exp->size; i++)
 return SCPE_OK;
 }
 
+/* Build the literal match automaton
+
+   The match strings of the literal rules are entered into a trie which is
+   then completed breadth first into a full transition table, so that each
+   byte of output data advances the automaton with one table lookup.  Each
+   state records the lowest numbered rule whose match string is a suffix of
+   the data leading to that state, which gives the same rule precedence as
+   comparing the rules one at a time.  Output data which is still available
+   for matching is replayed through the new automaton so that a rule added
+   while data is pending sees the same data it would have before.
+*/
+
+static t_stat _sim_exp_build_matcher (EXPECT *exp)
+{
+int32 i, c, head, tail, states = 1, max_states = 1;
+int32 *next, *rule, *fail, *queue;
+uint32 n;
+
+for (i=0; i < exp->size; i++)
+    if (!(exp->rules[i].switches & EXP_TYP_REGEX))
+        max_states += exp->rules[i].size;
+next = (int32 *)malloc (max_states * 256 * sizeof (*next));
+rule = (int32 *)malloc (max_states * sizeof (*rule));
+fail = (int32 *)calloc (max_states, sizeof (*fail));
+queue = (int32 *)malloc (max_states * sizeof (*queue));
+if ((next == NULL) || (rule == NULL) || (fail == NULL) || (queue == NULL)) {
+    free (next);
+    free (rule);
+    free (fail);
+    free (queue);
+    return SCPE_MEM;
+    }
+for (i=0; i < max_states * 256; i++)
+    next[i] = -1;                                       /* no transition yet */
+for (i=0; i < max_states; i++)
+    rule[i] = -1;                                       /* no rule matched */
+for (i=0; i < exp->size; i++) {                         /* enter match strings into trie */
+    EXPTAB *ep = &exp->rules[i];
+    int32 state = 0;
+
+    if (ep->switches & EXP_TYP_REGEX)
+        continue;
+    for (n=0; n < ep->size; n++) {
+        int32 *tp = &next[state * 256 + ep->match[n]];
+
+        if (*tp < 0)
+            *tp = states++;
+        state = *tp;
+        }
+    if (rule[state] < 0)                                /* first rule with this string? */
+        rule[state] = i;
+    }
+head = tail = 0;
+for (c=0; c < 256; c++) {                               /* root state transitions */
+    if (next[c] < 0)
+        next[c] = 0;
+    else
+        queue[tail++] = next[c];
+    }
+while (head < tail) {                                   /* complete remaining states */
+    int32 state = queue[head++];
+    int32 fstate = fail[state];
+
+    if ((rule[fstate] >= 0) &&                          /* suffix matches a lower rule? */
+        ((rule[state] < 0) || (rule[fstate] < rule[state])))
+        rule[state] = rule[fstate];
+    for (c=0; c < 256; c++) {
+        int32 *tp = &next[state * 256 + c];
+
+        if (*tp < 0)
+            *tp = next[fstate * 256 + c];
+        else {
+            fail[*tp] = next[fstate * 256 + c];
+            queue[tail++] = *tp;
+            }
+        }
+    }
+free (fail);
+free (queue);
+free (exp->match_next);
+free (exp->match_rule);
+exp->match_next = next;
+exp->match_rule = rule;
+exp->match_state = 0;
+for (n=exp->buf_data; n > 0; n--)                       /* replay unmatched data */
+    exp->match_state = next[exp->match_state * 256 + exp->buf[(exp->buf_ins + exp->buf_size - n) % exp->buf_size]];
+exp->match_valid = TRUE;
+sim_debug (exp->dbit, exp->dptr, "Expect literal matcher built with %d states\n", states);
+return SCPE_OK;
+}
+
 /* Test for expect match */
 
 t_stat sim_exp_check (EXPECT *exp, uint8 data)
 {
-int32 i;
+int32 i, match;
 EXPTAB *ep = NULL;
 int regex_checks = 0;
-char *tstr = NULL;
+t_bool rules_changed;
+#if defined (USE_REGEX)
+char *cbuf = NULL;
+size_t cbuf_len = 0;
+#endif
 
 if ((!exp) || (!exp->rules))                            /* Anying to check? */
     return SCPE_OK;
 
+rules_changed = !exp->match_valid;
+if (rules_changed && (_sim_exp_build_matcher (exp) != SCPE_OK))
+    return SCPE_MEM;
 exp->buf[exp->buf_ins++] = data;                        /* Save new data */
 exp->buf[exp->buf_ins] = '\0';                          /* Nul terminate for RegEx match */
 if (exp->buf_data < exp->buf_size)
     ++exp->buf_data;                                    /* Record amount of data in buffer */
+exp->match_state = exp->match_next[exp->match_state * 256 + data];
+match = exp->match_rule[exp->match_state];              /* literal rule matched? */
+if (match < 0)
+    match = exp->size;
 
-for (i=0; i < exp->size; i++) {
+for (i=0; i < match; i++) {                             /* check preceding regex rules */
     ep = &exp->rules[i];
     if (ep->switches & EXP_TYP_REGEX) {
 #if defined (USE_REGEX)
-        int *ovector = NULL;
         int rc;
-        char *cbuf = (char *)exp->buf;
         static size_t sim_exp_match_sub_count = 0;
 
-        if (tstr)
-            cbuf = tstr;
-        else {
+        ++regex_checks;
+        if ((data == 0) && !rules_changed)              /* NULs don't change regex input */
+            continue;
+        if (cbuf == NULL) {
+            cbuf = (char *)exp->buf;
+            cbuf_len = exp->buf_ins;
             if (strlen ((char *)exp->buf) != exp->buf_ins) { /* Nul characters in buffer? */
-                size_t off;
+                size_t off, len;
 
-                tstr = (char *)malloc (exp->buf_ins + 1);
-                tstr[0] = '\0';
-                for (off=0; off < exp->buf_ins; off += 1 + strlen ((char *)&exp->buf[off]))
-                    strcpy (&tstr[strlen (tstr)], (char *)&exp->buf[off]);
-                cbuf = tstr;
+                cbuf_len = 0;
+                for (off=0; off < exp->buf_ins; off += 1 + len) {
+                    len = strlen ((char *)&exp->buf[off]);
+                    memcpy (&exp->rbuf[cbuf_len], &exp->buf[off], len);
+                    cbuf_len += len;
+                    }
+                exp->rbuf[cbuf_len] = '\0';
+                cbuf = exp->rbuf;
                 }
             }
-        ++regex_checks;
-        ovector = (int *)malloc (3 * (ep->re_nsub + 1) * sizeof (*ovector));
         if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
             char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
             sim_debug (exp->dbit, exp->dptr, "Checking String: %s\n", estr);
             sim_debug (exp->dbit, exp->dptr, "Against RegEx Match Rule: %s\n", ep->match_pattern);
             free (estr);
             }
-        rc = pcre_exec (ep->regex, NULL, cbuf, exp->buf_ins, 0, PCRE_NOTBOL, ovector, 3 * (ep->re_nsub + 1));
+        rc = pcre_exec (ep->regex, NULL, cbuf, (int)cbuf_len, 0, PCRE_NOTBOL, ep->ovector, 3 * (ep->re_nsub + 1));
         if (rc >= 0) {
             size_t j;
             char *buf = (char *)malloc (1 + exp->buf_ins);
@@ -13277,8 +15439,8 @@ for (i=0; i < exp->size; i++) {
                 char env_name[32];
 
                 sprintf (env_name, "_EXPECT_MATCH_GROUP_%d", (int)j);
-                memcpy (buf, &cbuf[ovector[2 * j]], ovector[2 * j + 1] - ovector[2 * j]);
-                buf[ovector[2 * j + 1] - ovector[2 * j]] = '\0';
+                memcpy (buf, &cbuf[ep->ovector[2 * j]], ep->ovector[2 * j + 1] - ep->ovector[2 * j]);
+                buf[ep->ovector[2 * j + 1] - ep->ovector[2 * j]] = '\0';
                 setenv (env_name, buf, 1);      /* Make the match and substrings available as environment variables */
                 sim_debug (exp->dbit, exp->dptr, "%s=%s\n", env_name, buf);
                 }
@@ -13289,64 +15451,14 @@ for (i=0; i < exp->size; i++) {
                 setenv (env_name, "", 1);      /* Remove previous extra environment variables */
                 }
             sim_exp_match_sub_count = ep->re_nsub;
-            free (ovector);
-            ovector = NULL;
             free (buf);
             break;
             }
-        free (ovector);
 #endif
         }
-    else {
-        if (exp->buf_data < ep->size)                           /* Too little data to match yet? */
-            continue;                                           /* Yes, Try next one. */
-        if (exp->buf_ins < ep->size) {                          /* Match might stradle end of buffer */
-            /* 
-             * First compare the newly deposited data at the beginning 
-             * of buffer with the end of the match string
-             */
-            if (exp->buf_ins) {
-                if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                    char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
-                    char *mstr = sim_encode_quoted_string (&ep->match[ep->size-exp->buf_ins], exp->buf_ins);
-
-                    sim_debug (exp->dbit, exp->dptr, "Checking String[0:%d]: %s\n", exp->buf_ins, estr);
-                    sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                    free (estr);
-                    free (mstr);
-                    }
-                if (memcmp (exp->buf, &ep->match[ep->size-exp->buf_ins], exp->buf_ins)) /* Tail Match? */
-                    continue;                                   /* Nope, Try next one. */
-                }
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->size-exp->buf_ins);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size-exp->buf_ins);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_size-(ep->size-exp->buf_ins), ep->size-exp->buf_ins, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
-                }
-            if (memcmp (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->match, ep->size-exp->buf_ins)) /* Front Match? */
-                continue;                                       /* Nope, Try next one. */
-            break;
-            }
-        else {
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_ins-ep->size], ep->size);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_ins-ep->size, ep->size, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
-                }
-            if (memcmp (&exp->buf[exp->buf_ins-ep->size], ep->match, ep->size)) /* Whole string match? */
-                continue;                                       /* Nope, Try next one. */
-            break;
-            }
-        }
     }
+if (i < exp->size)                                      /* regex or literal rule matched */
+    ep = &exp->rules[i];
 if (exp->buf_ins == exp->buf_size) {                    /* At end of match buffer? */
     if (regex_checks) {
         /* When processing regular expressions, let the match buffer fill 
@@ -13396,8 +15508,8 @@ if (i != exp->size) {                                   /* Found? */
         }
     /* Matched data is no longer available for future matching */
     exp->buf_data = exp->buf_ins = 0;
+    exp->match_state = 0;
     }
-free (tstr);
 return SCPE_OK;
 }
 
@@ -13599,6 +15711,8 @@ static void _sim_debug_write_flush (const char *buf, size_t len, t_bool flush)
 {
 char *eol;
 
+if (_sim_debug_binary_text (buf, len))              /* binary records keep it in order */
+    return;
 if (sim_deb_switches & SWMASK ('F')) {              /* filtering disabled? */
     if (len > 0)
         _debug_fwrite (buf, len);                   /* output now. */
@@ -13693,6 +15807,12 @@ if (sim_deb == NULL)                                    /* no debug? */
 
 _sim_debug_write_flush ("", 0, TRUE);
 
+if (sim_deb_switches & SWMASK ('C')) {                  /* binary records? */
+    _sim_debug_binary_flush ();
+    fflush (sim_deb);
+    return SCPE_OK;
+    }
+
 if (sim_deb == sim_log) {                               /* debug is log */
     fflush (sim_deb);                                   /* fflush is the best we can do */
     return SCPE_OK;
@@ -14024,6 +16144,11 @@ return stat | ((stat != SCPE_OK) ? SCPE_NOMESSAGE : 0);
    incurring call overhead. */
 void _sim_vdebug (uint32 dbits, DEVICE* dptr, UNIT *uptr, const char* fmt, va_list arglist)
 {
+if (sim_deb && dptr && (sim_deb_switches & SWMASK ('C')) &&
+    ((dptr->dctrl | (uptr ? uptr->dctrl : 0)) & dbits)) {
+    _sim_debug_binary (dbits, dptr, uptr, fmt, arglist);
+    return;
+    }
 if (sim_deb && dptr && ((dptr->dctrl | (uptr ? uptr->dctrl : 0)) & dbits)) {
     TMLN *saved_oline = sim_oline;
     char stackbuf[STACKBUFSIZE];
@@ -16330,6 +18455,218 @@ sim_printf ("Unit %s fired at %.0f\n", sim_uname (uptr), sim_gtime ());
 return SCPE_OK;
 }
 
+static UNIT *scp_test_fired[4];
+static uint32 scp_test_fired_count;
+
+static t_stat sim_scp_order_svc (UNIT *uptr)
+{
+if (scp_test_fired_count < sizeof (scp_test_fired) / sizeof (scp_test_fired[0]))
+    scp_test_fired[scp_test_fired_count++] = uptr;
+return SCPE_OK;
+}
+
+static const char *_test_exp_feed (EXPECT *exp, const char *data)
+{
+const char *matched;
+
+setenv ("_EXPECT_MATCH_PATTERN", "", 1);
+while (*data) {
+    sim_exp_check (exp, (uint8)*data++);
+    matched = getenv ("_EXPECT_MATCH_PATTERN");
+    if (matched && *matched)
+        break;
+    }
+sim_cancel (&sim_expect_unit);                          /* discard scheduled stop */
+matched = getenv ("_EXPECT_MATCH_PATTERN");
+return (matched && *matched) ? matched : "";
+}
+
+static t_stat test_scp_expect_matching (void)
+{
+EXPECT exp;
+static const char *rules[] = {"\"ogin:\"", "\"login:\"", "\"Password:\"", "\"abcd\"", "\"bc\"", NULL};
+static const struct {
+    const char *data;
+    const char *add_rule;                               /* rule added after data */
+    const char *matched;
+    } tests[] = {
+        {"Welcome\r\nlogin:",   NULL,           "\"ogin:\""},   /* lower numbered rule wins */
+        {"user\r\nPassword:",   NULL,           "\"Password:\""},
+        {"xabc",                NULL,           "\"bc\""},      /* match via a failure link */
+        {"Pass",                NULL,           ""},
+        {"",                    "\"Passw\"",    ""},
+        {"w",                   NULL,           "\"Passw\""},   /* pending data seen by new rule */
+        {"w",                   NULL,           ""},            /* matched data isn't reused */
+        {NULL}};
+int i;
+t_stat r = SCPE_OK;
+
+sim_exp_init (&exp);
+exp.dptr = &sim_scp_dev;
+for (i = 0; rules[i]; i++)
+    if (SCPE_OK != sim_exp_set (&exp, rules[i], 0, 0, EXP_TYP_PERSIST, NULL))
+        return sim_messagef (SCPE_IERR, "sim_exp_set(%s) failed\n", rules[i]);
+for (i = 0; (r == SCPE_OK) && tests[i].data; i++) {
+    const char *matched = _test_exp_feed (&exp, tests[i].data);
+
+    if (strcmp (matched, tests[i].matched))
+        r = sim_messagef (SCPE_IERR, "Expect test %d matched '%s' - expected '%s'\n", i, matched, tests[i].matched);
+    if (tests[i].add_rule && (SCPE_OK != sim_exp_set (&exp, tests[i].add_rule, 0, 0, EXP_TYP_PERSIST, NULL)))
+        r = sim_messagef (SCPE_IERR, "sim_exp_set(%s) failed\n", tests[i].add_rule);
+    }
+sim_exp_clrall (&exp);
+setenv ("_EXPECT_MATCH_PATTERN", "", 1);
+return r;
+}
+
+#if defined(DBGB_THREADED)
+static DEBUG_BRING *test_debug_thread_ring;
+
+static void *_test_debug_thread (void *arg)
+{
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "from thread %d\n", 1);
+test_debug_thread_ring = debug_bin_ring;
+return NULL;
+}
+
+static t_bool _test_debug_ring_listed (DEBUG_BRING *ring)
+{
+DEBUG_BRING *r;
+
+pthread_mutex_lock (&debug_bin_lock);
+for (r = debug_bin_rings; (r != NULL) && (r != ring); r = r->next)
+    ;
+pthread_mutex_unlock (&debug_bin_lock);
+return (r != NULL);
+}
+#endif
+
+static void _test_debug_messages (void)
+{
+static char longstr[301];
+static char bytes[] = {'a', 'b', 'c'};
+char *fmt;
+int i;
+
+memset (longstr, 'x', sizeof (longstr) - 1);
+for (i = 0; i < 2; i++) {                           /* formats freed after use */
+    if ((fmt = (char *)malloc (32)) == NULL)
+        break;
+    sprintf (fmt, "built format %d %%d\n", i);
+    sim_debug (SIM_DBG_SAVE, &sim_scp_dev, fmt, 10 + i);
+    strcpy (fmt, "overwritten %d\n");
+    free (fmt);
+    }
+fprintf (sim_deb, "DBG(direct)> text written directly\n");
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "int %d %5u %-4x| %08X %o %c\n", -42, 42u, 0xab, 0xdeadbeef, 8, 'q');
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "wide %lld %llu %ld %hd %zu\n", -1234567890123LL, 18446744073709551615ULL, -7L, (short)-3, (size_t)99);
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "float %.3f %e %g %%\n", 3.14159, 1.5e10, 0.25);
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "strings [%s] [%10s] [%-6s] [%.2s] [%*d] [%.*s]\n", "abc", "right", "left", "truncated", 6, 17, 2, "xyz");
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "bytes [%.*s]\n", (int)sizeof (bytes), bytes);
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "partial ");
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "line %d\n", 2);
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "first\nsecond\n");
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "long [%s]\n", longstr);
+sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "many %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+           1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27);
+#if defined(DBGB_THREADED)
+if (1) {                                            /* message from a thread which exits */
+    pthread_t thread;
+
+    _sim_debug_binary_flush ();                     /* write this thread's messages first */
+    test_debug_thread_ring = NULL;
+    if (pthread_create (&thread, NULL, _test_debug_thread, NULL) == 0)
+        pthread_join (thread, NULL);
+    }
+#endif
+}
+
+/* Debug lines written by _test_debug_messages to a file */
+
+static int _test_debug_lines (const char *filename, char lines[][512], int max)
+{
+FILE *f = sim_fopen (filename, "r");
+char buf[512];
+int count = 0;
+
+if (f == NULL)
+    return -1;
+while ((count < max) && fgets (buf, sizeof (buf), f))
+    if (strncmp (buf, "DBG(", 4) == 0)
+        strlcpy (lines[count++], buf, sizeof (lines[0]));
+fclose (f);
+return count;
+}
+
+static t_stat test_debug_binary (void)
+{
+static const char *text_file = "TestDebug.log";
+static const char *bin_file = "TestDebug.bin";
+static const char *decoded_file = "TestDebug.txt";
+static char text_lines[20][512];
+static char decoded_lines[20][512];
+int32 saved_switches = sim_switches;
+int32 saved_quiet = sim_quiet;
+uint32 saved_dctrl = sim_scp_dev.dctrl;
+int text_count, decoded_count, i;
+FILE *f;
+t_stat r = SCPE_OK;
+
+if (sim_deb != NULL)                                /* don't disturb active debugging */
+    return SCPE_OK;
+sim_printf ("Testing binary debug records:\n");
+sim_quiet = 1;
+sim_scp_dev.dctrl |= SIM_DBG_SAVE;
+sim_switches = SWMASK ('N');
+if (sim_set_debon (0, text_file) == SCPE_OK) {
+    _test_debug_messages ();
+    _sim_debug_flush ();                            /* write the held duplicate filter line */
+    sim_set_deboff (0, NULL);
+    }
+sim_switches = SWMASK ('N') | SWMASK ('C');
+if (sim_set_debon (0, bin_file) == SCPE_OK) {
+    _test_debug_messages ();
+#if defined(DBGB_THREADED)
+    if (1) {                                        /* exited thread's ring is released */
+        for (i = 0; (i < 1000) && _test_debug_ring_listed (test_debug_thread_ring); i++)
+            sim_os_ms_sleep (1);                    /* writer drains and releases it */
+        if ((test_debug_thread_ring == NULL) || _test_debug_ring_listed (test_debug_thread_ring))
+            r = sim_messagef (SCPE_IERR, "Exited thread's binary debug ring wasn't released\n");
+        }
+#endif
+    sim_set_deboff (0, NULL);
+    }
+sim_switches = SWMASK ('N') | SWMASK ('C') | SWMASK ('B');
+if (sim_set_debon (0, "1 TestDebug.buf") == SCPE_OK)
+    r = sim_messagef (SCPE_IERR, "Binary debug records accepted with a memory buffer\n");
+sim_switches = SWMASK ('C');
+if (sim_set_debon (0, "STDOUT") == SCPE_OK)
+    r = sim_messagef (SCPE_IERR, "Binary debug records accepted to STDOUT\n");
+if (sim_deb)
+    sim_set_deboff (0, NULL);
+sim_switches = saved_switches;
+sim_quiet = saved_quiet;
+sim_scp_dev.dctrl = saved_dctrl;
+if ((f = sim_fopen (decoded_file, "w")) == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't create %s\n", decoded_file);
+if (sim_debug_decode (f, bin_file) != SCPE_OK)
+    r = sim_messagef (SCPE_IERR, "Can't decode %s\n", bin_file);
+fclose (f);
+text_count = _test_debug_lines (text_file, text_lines, 20);
+decoded_count = _test_debug_lines (decoded_file, decoded_lines, 20);
+if ((text_count < 10) || (text_count != decoded_count))
+    r = sim_messagef (SCPE_IERR, "Decoded %d debug lines - expected %d\n", decoded_count, text_count);
+for (i = 0; (r == SCPE_OK) && (i < text_count); i++)
+    if (strcmp (text_lines[i], decoded_lines[i]) != 0)
+        r = sim_messagef (SCPE_IERR, "Decoded debug line %d: %s - expected: %s", i, decoded_lines[i], text_lines[i]);
+(void)remove (text_file);
+(void)remove (bin_file);
+(void)remove (decoded_file);
+if (r == SCPE_OK)
+    sim_printf ("  %d debug lines decoded identically\n", text_count);
+return r;
+}
+
 static t_stat test_scp_event_sequencing (void)
 {
 DEVICE *dptr = &sim_scp_dev;
@@ -16422,6 +18759,48 @@ for (i = 0, active = 0; i < dptr->numunits; i++) {
     }
 if (active != 1)
     return sim_messagef (SCPE_IERR, "unexpected count %d of active/queued units - expected %d\n", active, 1);
+/* queue units in reverse time order and cancel one from the middle of the queue */
+while (sim_clock_queue != QUEUE_LIST_END)
+    sim_cancel (sim_clock_queue);
+sim_interval = 0;
+for (i = 0; i < dptr->numunits; i++) {
+    r = sim_activate (&dptr->units[i], 10 * (dptr->numunits - i));
+    if (SCPE_OK != r)
+        return sim_messagef (SCPE_IERR, "sim_activate() unexpected result: %s\n", sim_error_text (r));
+    }
+if (sim_clock_queue != &dptr->units[dptr->numunits - 1])
+    return sim_messagef (SCPE_IERR, "unexpected event queue head: %s\n", sim_uname (sim_clock_queue));
+sim_cancel (&dptr->units[1]);
+if ((sim_qcount () != (int32)(dptr->numunits - 1)) || sim_is_active (&dptr->units[1]))
+    return sim_messagef (SCPE_IERR, "sim_cancel() failed to remove %s from event queue\n", sim_uname (&dptr->units[1]));
+for (i = 0; i < dptr->numunits; i++) {
+    int32 t = sim_activate_time (&dptr->units[i]);
+    int32 expected = (i == 1) ? 0 : (int32)(10 * (dptr->numunits - i) + 1);
+
+    if (t != expected)
+        return sim_messagef (SCPE_IERR, "sim_activate_time() unexpected result for unit %d: %d - expected %d\n", i, t, expected);
+    }
+/* events due at the same time must be dispatched in the order they were queued */
+r = sim_activate (&dptr->units[1], 10 * (dptr->numunits - 2));
+if (SCPE_OK != r)
+    return sim_messagef (SCPE_IERR, "sim_activate() unexpected result: %s\n", sim_error_text (r));
+for (i = 0; i < dptr->numunits; i++)
+    dptr->units[i].action = sim_scp_order_svc;
+scp_test_fired_count = 0;
+while (sim_clock_queue != QUEUE_LIST_END) {
+    sim_interval = 0;
+    r = sim_process_event ();
+    if (r != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "sim_process_event() unexpected result: %s\n", sim_error_text (r));
+    }
+for (i = 0; i < dptr->numunits; i++) {
+    UNIT *expected = &dptr->units[dptr->numunits - 1 - i];
+
+    if ((i >= scp_test_fired_count) || (scp_test_fired[i] != expected))
+        return sim_messagef (SCPE_IERR, "unexpected event dispatch order at %d - expected %s\n", i, sim_uname (expected));
+    }
+if (sim_qcount () != 0)
+    return sim_messagef (SCPE_IERR, "unexpected count %d of queued units - expected 0\n", sim_qcount ());
 sim_set_deb_switches (start_deb_switches);
 return r;
 }
@@ -16470,6 +18849,14 @@ if ((strcmp (gbuf, "ALL") == 0) || (strcmp (gbuf, "SCP") == 0)) {
         return sim_messagef (SCPE_IERR, "SCP argument parsing test failed\n");
     if (test_scp_event_sequencing () != SCPE_OK)
         return sim_messagef (SCPE_IERR, "SCP event sequencing test failed\n");
+    if (test_scp_expect_matching () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "SCP expect matching test failed\n");
+    if (test_debug_binary () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "SCP binary debug test failed\n");
+    if (sim_timer_idle_sleep_test () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "Timer idle sleep test failed\n");
+    if (vid_framebuffer_test () != SCPE_OK)
+        return sim_messagef (SCPE_IERR, "Video framebuffer test failed\n");
 }
 for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
     t_stat tstat = SCPE_OK;
@@ -16477,7 +18864,8 @@ for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
 
     if ((strcmp (gbuf, "ALL") != 0) && (strcmp (gbuf, dptr->name) != 0))
         continue;
-    if (DEV_TYPE(dptr) == 0) {
+    if ((DEV_TYPE(dptr) == 0) &&
+        ((i != 0) || (sim_vm_test == NULL))) {
         sim_printf ("Skipping %s - non library device type\n", dptr->name);
         continue;                       /* skip unspecified devices */
         }
@@ -16504,6 +18892,8 @@ for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
                 tstat = tmxr_sock_test (dptr, cptr);
                 break;
             default:
+                if ((i == 0) && (sim_vm_test != NULL))  /* CPU tests */
+                    tstat = sim_vm_test (dptr, cptr);
                 break;
             }
         if (was_disabled)
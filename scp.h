@@ -152,6 +152,7 @@ t_stat sim_run_boot_prep (int32 flag);
 double sim_gtime (void);
 uint32 sim_grtime (void);
 int32 sim_qcount (void);
+UNIT *sim_qunit (int32 idx);
 t_stat attach_unit (UNIT *uptr, CONST char *cptr);
 t_stat detach_unit (UNIT *uptr);
 t_stat assign_device (DEVICE *dptr, const char *cptr);
@@ -257,6 +258,10 @@ void sim_debug_bits_hdr (uint32 dbits, DEVICE* dptr, const char *header,
     BITFIELD* bitdefs, uint32 before, uint32 after, int terminate);
 void sim_debug_bits (uint32 dbits, DEVICE* dptr, BITFIELD* bitdefs,
     uint32 before, uint32 after, int terminate);
+t_stat sim_debug_binary_start (void);
+void sim_debug_binary_stop (void);
+void sim_debug_binary_show (FILE *st);
+t_stat sim_debug_decode (FILE *st, const char *filename);
 #if defined (__DECC) && defined (__VMS) && (defined (__VAX) || (__DECC_VER < 60590001))
 #define CANT_USE_MACRO_VA_ARGS 1
 #endif
@@ -335,11 +340,28 @@ extern BRKTYPTAB *sim_brk_type_desc;                    /* type descriptions */
 extern const char *sim_prog_name;                       /* executable program name */
 extern FILE *stdnul;
 extern t_bool sim_asynch_enabled;
+extern uint32 *sim_mem_dirty;                           /* memory image dirty page map */
+extern t_addr sim_mem_dirty_limit;                      /* bytes covered by dirty page map */
 #if defined(SIM_ASYNCH_IO)
 int sim_aio_update_queue (void);
 void sim_aio_activate (ACTIVATE_API caller, UNIT *uptr, int32 event_time);
+void sim_aio_ring_init (void);
 #endif
 
+/* Memory image dirty page tracking (SAVE -I)
+
+   Memory write paths mark the page holding byte offset ba of the memory
+   image their device's membase routine returns.  Tracking is active only
+   while sim_mem_dirty is non NULL.
+*/
+
+#define SIM_MEM_PAGE_SHIFT  12                          /* tracked page size (log2) */
+#define SIM_MEM_DIRTY(ba)                                                       \
+    ((void)((sim_mem_dirty != NULL) && (((t_addr)(ba)) < sim_mem_dirty_limit) &&\
+            (sim_mem_dirty[((t_addr)(ba)) >> (SIM_MEM_PAGE_SHIFT + 5)] |=       \
+                (1u << ((((t_addr)(ba)) >> SIM_MEM_PAGE_SHIFT) & 0x1F)))))
+void sim_mem_dirty_range (t_addr ba, t_addr bytes);
+
 /* VM interface */
 
 extern char sim_name[64];
@@ -377,6 +399,7 @@ extern t_bool (*sim_vm_fprint_stopped) (FILE *st, t_stat reason);
 extern t_value (*sim_vm_pc_value) (void);
 extern t_bool (*sim_vm_is_subroutine_call) (t_addr **ret_addrs);
 extern void (*sim_vm_reg_update) (REG *rptr, uint32 idx, t_value prev_val, t_value new_val);
+extern t_stat (*sim_vm_test) (DEVICE *dptr, CONST char *cptr);
 extern const char **sim_clock_precalibrate_commands;
 extern int32 sim_vm_initial_ips;                        /* base estimate of simulated instructions per second */
 extern const char *sim_vm_interval_units;               /* Simulator can change this - default "instructions" */
@@ -2314,7 +2314,7 @@ sim_deb_switches = switches &
                     SWMASK ('T') | SWMASK ('A') | 
                     SWMASK ('F') | SWMASK ('N') |
                     SWMASK ('B') | SWMASK ('E') |
-                    SWMASK ('D') );                 /* save debug switches */
+                    SWMASK ('D') | SWMASK ('C') );  /* save debug switches */
 return old_deb_switches;
 }
 
@@ -2338,7 +2338,19 @@ if (sim_switches & SWMASK ('B')) {
 cptr = get_glyph_nc (cptr, gbuf, 0);                    /* get file name */
 if (*cptr != 0)                                         /* now eol? */
     return SCPE_2MARG;
-r = sim_open_logfile (gbuf, FALSE, &sim_deb, &sim_deb_ref);
+if (sim_switches & SWMASK ('C')) {                      /* binary records? */
+    char fbuf[CBUFSIZE];
+
+    if (sim_switches & SWMASK ('B'))
+        return sim_messagef (SCPE_ARG, "Binary debug records can't be written to a memory buffer\n");
+    get_glyph (gbuf, fbuf, 0);
+    if ((strcmp (fbuf, "STDOUT") == 0) || (strcmp (fbuf, "STDERR") == 0) ||
+        (strcmp (fbuf, "LOG") == 0) || (strcmp (fbuf, "DEBUG") == 0))
+        return sim_messagef (SCPE_ARG, "Binary debug records must be written to a file\n");
+    }
+if (sim_deb_switches & SWMASK ('C'))                    /* binary records active? */
+    sim_debug_binary_stop ();                           /* write them before switching */
+r = sim_open_logfile (gbuf, (sim_switches & SWMASK ('C')) != 0, &sim_deb, &sim_deb_ref);
 
 if (r != SCPE_OK)
     return r;
@@ -2372,6 +2384,8 @@ if (sim_deb_switches & SWMASK ('E'))
 if (sim_deb_switches & SWMASK ('B'))
     sim_messagef (SCPE_OK, "   Debug messages will be written to a %u MB circular memory buffer\n", 
                                 (unsigned int)buffer_size);
+if (sim_deb_switches & SWMASK ('C'))
+    sim_messagef (SCPE_OK, "   Debug messages will be written as binary records\n");
 time(&now);
 if (!sim_quiet) {
     fprintf (sim_deb, "Debug output to \"%s\" at %s", sim_logfile_name (sim_deb, sim_deb_ref), ctime(&now));
@@ -2386,6 +2400,15 @@ if (sim_deb_switches & SWMASK ('B')) {
     sim_debug_buffer_offset = sim_debug_buffer_inuse = 0;
     memset (sim_deb_buffer, 0, sim_deb_buffer_size);
     }
+if (sim_deb_switches & SWMASK ('C')) {
+    r = sim_debug_binary_start ();
+    if (r != SCPE_OK) {
+        sim_close_logfile (&sim_deb_ref);
+        sim_deb = NULL;
+        sim_deb_switches = 0;
+        return r;
+        }
+    }
 
 return SCPE_OK;
 }
@@ -2398,6 +2421,8 @@ if (cptr && (*cptr != 0))                               /* now eol? */
     return SCPE_2MARG;
 if (sim_deb == NULL)                                    /* no debug? */
     return SCPE_OK;
+if (sim_deb_switches & SWMASK ('C'))                    /* binary records? */
+    sim_debug_binary_stop ();                           /* write pending records */
 if (sim_deb_switches & SWMASK ('B')) {
     size_t offset = (sim_debug_buffer_inuse == sim_deb_buffer_size) ? sim_debug_buffer_offset : 0;
     const char *bufmsg = "Circular Buffer Contents follow here:\n\n";
@@ -2429,8 +2454,32 @@ t_stat sim_show_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST cha
 {
 int32 i;
 
-if (cptr && (*cptr != 0))
+if (cptr && (*cptr != 0)) {
+    char gbuf[CBUFSIZE];
+
+    cptr = get_glyph (cptr, gbuf, 0);
+    if (strcmp (gbuf, "DECODE") == 0) {                 /* render binary debug file */
+        char fname[CBUFSIZE];
+        FILE *ofile = st;
+        t_stat r;
+
+        if (*cptr == 0)
+            return SCPE_2FARG;
+        cptr = get_glyph_nc (cptr, fname, 0);
+        if (*cptr != 0) {                               /* output file? */
+            cptr = get_glyph_nc (cptr, gbuf, 0);
+            if (*cptr != 0)
+                return SCPE_2MARG;
+            if ((ofile = sim_fopen (gbuf, "w")) == NULL)
+                return sim_messagef (SCPE_OPENERR, "Can't open output file: %s\n", gbuf);
+            }
+        r = sim_debug_decode (ofile, fname);
+        if (ofile != st)
+            fclose (ofile);
+        return r;
+        }
     return SCPE_2MARG;
+    }
 if (sim_deb) {
     fprintf (st, "Debug output enabled to \"%s\"\n", 
                  sim_logfile_name (sim_deb, sim_deb_ref));
@@ -2444,6 +2493,8 @@ if (sim_deb) {
         fprintf (st, "   Debug messages are not being filtered to summarize duplicate lines\n");
     if (sim_deb_switches & SWMASK ('E'))
         fprintf (st, "   Debug messages containing blob data in EBCDIC will display in readable form\n");
+    if (sim_deb_switches & SWMASK ('C'))
+        sim_debug_binary_show (st);
     for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
         t_bool unit_debug = FALSE;
         uint32 unit;
@@ -435,8 +435,9 @@ typedef uint32          t_addr;
 #define SCPE_FSSIZE     (SCPE_BASE + 49)                /* File System size larger than disk size */
 #define SCPE_RUNTIME    (SCPE_BASE + 50)                /* Run Time Limit Exhausted */
 #define SCPE_INCOMPDSK  (SCPE_BASE + 51)                /* Incompatible Disk Container */
+#define SCPE_QFULL      (SCPE_BASE + 52)                /* Request queue full */
 
-#define SCPE_MAX_ERR    (SCPE_BASE + 51)                /* Maximum SCPE Error Value */
+#define SCPE_MAX_ERR    (SCPE_BASE + 52)                /* Maximum SCPE Error Value */
 #define SCPE_KFLAG      0x10000000                      /* tti data flag */
 #define SCPE_BREAK      0x20000000                      /* tti break flag */
 #define SCPE_NOMESSAGE  0x40000000                      /* message display supression flag */
@@ -536,6 +537,8 @@ struct DEVICE {
     const char          *(*description)(DEVICE *dptr);  /* Device Description */
     BRKTYPTAB           *brk_types;                     /* Breakpoint types */
     void                *type_ctx;                      /* Device Type/Library Context */
+    void                *(*membase)(UNIT *up, size_t *bytes, size_t *width);
+                                                        /* memory image for SAVE/RESTORE */
     };
 
 /* Device flags */
@@ -613,6 +616,7 @@ struct UNIT {
     uint16              us9;                            /* device specific */
     uint16              us10;                           /* device specific */
     uint32              disk_type;                      /* Disk specific info */
+    uint32              disk_cache;                     /* Disk specific info (sector cache KB) */
     void                *tmxr;                          /* TMXR linkage */
     uint32              recsize;                        /* Tape specific info */
     t_addr              tape_eom;                       /* Tape specific info */
@@ -621,6 +625,9 @@ struct UNIT {
     char                *uname;                         /* Unit name */
     DEVICE              *dptr;                          /* DEVICE linkage (backpointer) */
     uint32              dctrl;                          /* debug control */
+    int32               q_index;                        /* event queue heap slot (0 if not queued) */
+    uint32              q_seq;                          /* event queue insertion sequence */
+    double              q_time;                         /* event queue due time */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
@@ -678,6 +685,8 @@ struct UNIT {
 #define UNIT_TM_POLL        0000002         /* TMXR Polling unit */
 #define UNIT_NO_FIO         0000004         /* fileref is NOT a FILE * */
 #define UNIT_DISK_CHK       0000010         /* disk data debug checking (sim_disk) */
+#define UNIT_DISK_CACHE_WB  0000020         /* disk sector cache is write back (sim_disk) */
+#define UNIT_TAPE_IDX       0000040         /* Tape record index is kept in a sidecar file (sim_tape) */
 #define UNIT_TMR_UNIT       0000200         /* Unit registered as a calibrated timer */
 #define UNIT_TAPE_MRK       0000400         /* Tape Unit Tapemark */
 #define UNIT_TAPE_PNU       0001000         /* Tape Unit Position Not Updated */
@@ -848,6 +857,7 @@ struct EXPTAB {
 #if defined(USE_REGEX)
     pcre                *regex;                         /* compiled regular expression */
     int                 re_nsub;                        /* regular expression sub expression count */
+    int                 *ovector;                       /* regular expression match offsets */
 #endif
     char                *act;                           /* action string */
     };
@@ -863,6 +873,13 @@ struct EXPECT {
     uint32              buf_ins;                        /* buffer insertion point for the next output data */
     uint32              buf_size;                       /* buffer size */
     uint32              buf_data;                       /* count of data in buffer */
+#if defined(USE_REGEX)
+    char                *rbuf;                          /* buffer data without NULs for regex matching */
+#endif
+    int32               *match_next;                    /* literal match automaton transitions */
+    int32               *match_rule;                    /* lowest literal rule matched in each state */
+    int32               match_state;                    /* current literal match automaton state */
+    t_bool              match_valid;                    /* literal match automaton reflects rules */
     };
 
 /* Send Context */
@@ -1252,10 +1269,13 @@ extern int32 sim_asynch_inst_latency;
 #undef USE_AIO_INTRINSICS
 #endif
 #ifdef USE_AIO_INTRINSICS
-/* This approach uses intrinsics to manage access to the link list head     */
-/* sim_asynch_queue.  This implementation is a completely lock free design  */
-/* which avoids the potential ABA issues.                                   */
-#define AIO_QUEUE_MODE "Lock free asynchronous event queue"
+/* This approach uses intrinsics to manage a bounded multiple producer,     */
+/* single consumer ring of pending asynchronous events.  Producer threads   */
+/* claim a ring slot with a compare and swap on the ring tail and the       */
+/* simulator thread drains the ring in batches without taking any lock.     */
+/* When the ring is full, events overflow onto the mutex protected          */
+/* sim_asynch_queue list.                                                   */
+#define AIO_QUEUE_MODE "Lock free bounded MPSC asynchronous event ring"
 #define AIO_INIT                                                  \
     do {                                                          \
       sim_asynch_main_threadid = pthread_self();                  \
@@ -1263,6 +1283,7 @@ extern int32 sim_asynch_inst_latency;
          This allows NULL in an entry's a_next pointer to         \
          indicate that the entry is not currently in any list */  \
       sim_asynch_queue = QUEUE_LIST_END;                          \
+      sim_aio_ring_init ();                                       \
       } while (0)
 #define AIO_CLEANUP                                               \
     do {                                                          \
@@ -1274,17 +1295,18 @@ extern int32 sim_asynch_inst_latency;
       pthread_cond_destroy(&sim_tmxr_poll_cond);                  \
       } while (0)
 #ifdef _WIN32
+#define AIO_MEMORY_BARRIER MemoryBarrier()
 #elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
 #define InterlockedCompareExchangePointer(Destination, Exchange, Comparand) __sync_val_compare_and_swap(Destination, Comparand, Exchange)
+#define InterlockedCompareExchange(Destination, Exchange, Comparand) __sync_val_compare_and_swap(Destination, Comparand, Exchange)
+#define AIO_MEMORY_BARRIER __sync_synchronize()
 #elif defined(__DECC_VER)
 #define InterlockedCompareExchangePointer(Destination, Exchange, Comparand) (void *)((int32)_InterlockedCompareExchange64(Destination, Exchange, Comparand))
+#define InterlockedCompareExchange(Destination, Exchange, Comparand) _InterlockedCompareExchange(Destination, Exchange, Comparand)
+#define AIO_MEMORY_BARRIER __MB()
 #else
 #error "Implementation of function InterlockedCompareExchangePointer() is needed to build with USE_AIO_INTRINSICS"
 #endif
-#define AIO_ILOCK AIO_LOCK
-#define AIO_IUNLOCK AIO_UNLOCK
-#define AIO_QUEUE_VAL (UNIT *)(InterlockedCompareExchangePointer((void * volatile *)&sim_asynch_queue, (void *)sim_asynch_queue, NULL))
-#define AIO_QUEUE_SET(newval, oldval) (UNIT *)(InterlockedCompareExchangePointer((void * volatile *)&sim_asynch_queue, (void *)newval, oldval))
 #define AIO_UPDATE_QUEUE sim_aio_update_queue ()
 #define AIO_ACTIVATE(caller, uptr, event_time)                                   \
     if (!pthread_equal ( pthread_self(), sim_asynch_main_threadid )) {           \
@@ -1319,34 +1341,11 @@ extern int32 sim_asynch_inst_latency;
       pthread_mutex_destroy(&sim_tmxr_poll_lock);                 \
       pthread_cond_destroy(&sim_tmxr_poll_cond);                  \
       } while (0)
-#define AIO_ILOCK AIO_LOCK
-#define AIO_IUNLOCK AIO_UNLOCK
-#define AIO_QUEUE_VAL sim_asynch_queue
-#define AIO_QUEUE_SET(newval, oldval) ((sim_asynch_queue = newval),oldval)
 #define AIO_UPDATE_QUEUE sim_aio_update_queue ()
-#define AIO_ACTIVATE(caller, uptr, event_time)                         \
-    if (!pthread_equal ( pthread_self(), sim_asynch_main_threadid )) { \
-      sim_debug (SIM_DBG_AIO_QUEUE, sim_dflt_dev, "Queueing Asynch event for %s after %d instructions\n", sim_uname(uptr), event_time);\
-      AIO_LOCK;                                                        \
-      if (uptr->a_next) {                       /* already queued? */  \
-        uptr->a_activate_call = sim_activate_abs;                      \
-      } else {                                                         \
-        uptr->a_next = sim_asynch_queue;                               \
-        uptr->a_event_time = event_time;                               \
-        uptr->a_activate_call = (ACTIVATE_API)&caller;                 \
-        sim_asynch_queue = uptr;                                       \
-      }                                                                \
-      if (sim_idle_wait) {                                             \
-        if (sim_deb) {  /* only while debug do lock/unlock overhead */ \
-          AIO_UNLOCK;                                                  \
-          sim_debug (TIMER_DBG_IDLE, &sim_timer_dev, "waking due to event on %s after %d instructions\n", sim_uname(uptr), event_time);\
-          AIO_LOCK;                                                    \
-          }                                                            \
-        pthread_cond_signal (&sim_asynch_wake);                        \
-        }                                                              \
-      AIO_UNLOCK;                                                      \
-      sim_asynch_check = 0;                                            \
-      return SCPE_OK;                                                  \
+#define AIO_ACTIVATE(caller, uptr, event_time)                                   \
+    if (!pthread_equal ( pthread_self(), sim_asynch_main_threadid )) {           \
+      sim_aio_activate ((ACTIVATE_API)caller, uptr, event_time);                 \
+      return SCPE_OK;                                                            \
     } else (void)0
 #endif /* USE_AIO_INTRINSICS */
 #define AIO_VALIDATE(uptr)                                             \
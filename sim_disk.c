@@ -87,6 +87,11 @@ Internal routines:
 #include <pthread.h>
 #endif
 
+#if defined (__linux__) || defined (__APPLE__) || defined (__CYGWIN__) || defined (__FreeBSD__) || defined(__NetBSD__) || defined (__OpenBSD__)
+#define SIM_DISK_MMAP                       /* Memory mapped container access available */
+#include <sys/mman.h>
+#endif
+
 /* Newly created SIMH (and possibly RAW) disk containers       */
 /* will have this data as the last 512 bytes of the container  */
 /* It will not be considered part of the data in the container */
@@ -149,6 +154,21 @@ return value;
 }
 #endif
 
+#if defined SIM_ASYNCH_IO
+/* An asynchronous request queued to the shared disk I/O engine */
+#define DISK_IO_RING_SIZE   32              /* Outstanding requests per unit */
+
+struct disk_io_request {
+    int                 dop;                /* operation */
+    t_lba               lba;
+    uint8               *buf;
+    t_seccnt            *rsects;
+    t_seccnt            sects;
+    DISK_PCALLBACK      callback;
+    t_stat              io_status;
+    };
+#endif
+
 struct disk_context {
     t_offset            container_size;     /* Size of the data portion (of the pseudo disk) */
     t_offset            highwater;          /* Furthest written sector in the disk */
@@ -167,57 +187,65 @@ struct disk_context {
     uint32              write_count;        /* Number of write operations performed */
     struct simh_disk_footer
                         *footer;
+    struct disk_cache   *cache;             /* Sector cache (SET <unit> CACHE) */
+    uint8               *map_base;          /* Memory mapped container data (ATTACH -P) */
+    size_t              map_size;           /* Bytes of container data mapped */
 #if defined _WIN32
     HANDLE              disk_handle;        /* OS specific Raw device handle */
 #endif
 #if defined SIM_ASYNCH_IO
     int                 asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
-    pthread_mutex_t     lock;
-    pthread_t           io_thread;          /* I/O Thread Id */
-    pthread_mutex_t     io_lock;
-    pthread_cond_t      io_cond;
-    pthread_cond_t      io_done;
-    pthread_cond_t      startup_cond;
-    int                 io_dop;
-    uint8               *buf;
-    t_seccnt            *rsects;
-    t_seccnt            sects;
-    t_lba               lba;
-    DISK_PCALLBACK      callback;
-    t_stat              io_status;
+    UNIT                *uptr;              /* Unit (for I/O engine worker threads) */
+    struct disk_io_request
+                        io_ring[DISK_IO_RING_SIZE];/* Outstanding request ring */
+    uint32              io_tail;            /* Next request slot to fill (main thread) */
+    uint32              io_head;            /* Next request to perform (engine) */
+    uint32              io_done;            /* Next completion to deliver (main thread) */
+    volatile t_bool     io_active;          /* Requests not yet performed (read without the lock) */
+    t_bool              io_busy;            /* Engine worker performing a request */
+    t_bool              io_queued;          /* On the engine ready list */
+    struct disk_context *io_ready_next;     /* Engine ready list linkage */
 #endif
     };
 
 #define disk_ctx up8                        /* Field in Unit structure which points to the disk_context */
 
 #if defined SIM_ASYNCH_IO
+/* Shared asynchronous disk I/O engine
+
+   Asynchronous requests from all disk units are performed by a pool of
+   worker threads shared by every unit which has asynchronous I/O
+   enabled.  The pool has one worker for each such unit, as many threads
+   as the former dedicated per unit I/O threads, so requests to different
+   units proceed in parallel however many units are attached.
+
+   Each unit has a ring of submitted requests, which lets a caller submit
+   a request before an earlier one has completed.  The requests for any
+   one unit are still performed in the order they were submitted, one at
+   a time, since the container formats are accessed via stdio (and VHD
+   metadata) which have no atomic positioned transfer.  The existing
+   controllers submit one request per unit at a time, so the ring adds
+   no transfer overlap for them.  A request submitted while a unit's
+   ring is full is not queued: sim_disk_rdsect_a and sim_disk_wrsect_a
+   return SCPE_QFULL (and sim_disk_isavailable_a FALSE) without calling
+   the callback, since the ring only drains as completions are
+   delivered by the caller's thread.
+
+   When a request completes, the worker activates the unit and the
+   completion callbacks are delivered, in submission order, in the
+   context of the main simulator thread by _disk_completion_dispatch.
+*/
+
 #define AIO_CALLSETUP                                               \
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
                                                                     \
 if ((!callback) || !ctx->asynch_io)
 
-#define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
-    if (ctx->asynch_io) {                                       \
-        struct disk_context *ctx =                              \
-                      (struct disk_context *)uptr->disk_ctx;    \
-                                                                \
-        pthread_mutex_lock (&ctx->io_lock);                     \
-                                                                \
-        sim_debug_unit (ctx->dbit, uptr,                        \
-      "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d)\n",\
-                op, (int)(uptr - ctx->dptr->units), _lba, _sects);\
-                                                                \
-        if (ctx->callback)                                      \
-            abort(); /* horrible mistake, stop */               \
-        ctx->io_dop = op;                                       \
-        ctx->lba = _lba;                                        \
-        ctx->buf = _buf;                                        \
-        ctx->sects = _sects;                                    \
-        ctx->rsects = _rsects;                                  \
-        ctx->callback = _callback;                              \
-        pthread_cond_signal (&ctx->io_cond);                    \
-        pthread_mutex_unlock (&ctx->io_lock);                   \
+#define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback, _busy) \
+    if (ctx->asynch_io && (_callback)) {                        \
+        if (!_disk_io_submit (uptr, op, _lba, _buf, _rsects, _sects, _callback))\
+            r = (_busy);                                        \
         }                                                       \
     else                                                        \
         if (_callback)                                          \
@@ -229,83 +257,170 @@ if ((!callback) || !ctx->asynch_io)
 #define DOP_WSEC  2             /* sim_disk_wrsect_a */
 #define DOP_IAVL  3             /* sim_disk_isavailable_a */
 
+static pthread_mutex_t disk_io_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t disk_io_work = PTHREAD_COND_INITIALIZER;  /* requests ready */
+static pthread_cond_t disk_io_idle = PTHREAD_COND_INITIALIZER;  /* requests performed */
+static pthread_t *disk_io_workers = NULL;
+static int disk_io_worker_size = 0;                 /* worker table size */
+static int disk_io_worker_count = 0;                /* running worker threads */
+static int disk_io_unit_count = 0;                  /* units with asynch I/O enabled */
+static t_bool disk_io_shutdown = FALSE;
+static struct disk_context *disk_io_ready_head = NULL;  /* units with requests to perform */
+static struct disk_context *disk_io_ready_tail = NULL;
+
+/* Queue a unit with requests to perform to the engine ready list
+   (called with disk_io_lock held) */
+static void _disk_io_ready (struct disk_context *ctx)
+{
+if (ctx->io_queued || ctx->io_busy || (ctx->io_head == ctx->io_tail))
+    return;
+ctx->io_queued = TRUE;
+ctx->io_ready_next = NULL;
+if (disk_io_ready_tail)
+    disk_io_ready_tail->io_ready_next = ctx;
+else
+    disk_io_ready_head = ctx;
+disk_io_ready_tail = ctx;
+pthread_cond_signal (&disk_io_work);
+}
+
 static void *
 _disk_io(void *arg)
 {
-UNIT* volatile uptr = (UNIT*)arg;
-struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-
 /* Boost Priority for this I/O thread vs the CPU instruction execution
    thread which in general won't be readily yielding the processor when
    this thread needs to run */
 sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
 
-sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d) starting\n", (int)(uptr - ctx->dptr->units));
+pthread_mutex_lock (&disk_io_lock);
+while (!disk_io_shutdown) {
+    struct disk_context *ctx;
+    struct disk_io_request *req;
+    UNIT *uptr;
+    t_stat status = SCPE_OK;
 
-pthread_mutex_lock (&ctx->io_lock);
-pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
-while (ctx->asynch_io) {
-    pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-    if (ctx->io_dop == DOP_DONE)
-        break;
-    pthread_mutex_unlock (&ctx->io_lock);
-    switch (ctx->io_dop) {
+    if (disk_io_ready_head == NULL) {
+        pthread_cond_wait (&disk_io_work, &disk_io_lock);
+        continue;
+        }
+    ctx = disk_io_ready_head;
+    disk_io_ready_head = ctx->io_ready_next;
+    if (disk_io_ready_head == NULL)
+        disk_io_ready_tail = NULL;
+    ctx->io_queued = FALSE;
+    ctx->io_busy = TRUE;
+    uptr = ctx->uptr;
+    req = &ctx->io_ring[ctx->io_head % DISK_IO_RING_SIZE];
+    pthread_mutex_unlock (&disk_io_lock);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d, dop=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), req->dop, req->lba, req->sects);
+    switch (req->dop) {
         case DOP_RSEC:
-            ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            status = sim_disk_rdsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_WSEC:
-            ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            status = sim_disk_wrsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_IAVL:
-            ctx->io_status = sim_disk_isavailable (uptr);
+            status = sim_disk_isavailable (uptr);
             break;
         }
-    pthread_mutex_lock (&ctx->io_lock);
-    ctx->io_dop = DOP_DONE;
-    pthread_cond_signal (&ctx->io_done);
+    pthread_mutex_lock (&disk_io_lock);
+    req->io_status = status;
+    ++ctx->io_head;
+    ctx->io_busy = FALSE;
+    if (ctx->io_head == ctx->io_tail)
+        ctx->io_active = FALSE;
+    _disk_io_ready (ctx);                   /* more requests for this unit? */
+    pthread_cond_broadcast (&disk_io_idle);
+    pthread_mutex_unlock (&disk_io_lock);
     sim_activate (uptr, ctx->asynch_io_latency);
+    pthread_mutex_lock (&disk_io_lock);
     }
-pthread_mutex_unlock (&ctx->io_lock);
-
-sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d) exiting\n", (int)(uptr - ctx->dptr->units));
-
+pthread_mutex_unlock (&disk_io_lock);
 return NULL;
 }
 
+/* Wait for the engine to perform all of a unit's submitted requests */
+static void _disk_io_drain (struct disk_context *ctx)
+{
+pthread_mutex_lock (&disk_io_lock);
+while (ctx->io_busy || (ctx->io_head != ctx->io_tail))
+    pthread_cond_wait (&disk_io_idle, &disk_io_lock);
+pthread_mutex_unlock (&disk_io_lock);
+}
+
 /* This routine is called in the context of the main simulator thread before
    processing events for any unit. It is only called when an asynchronous
    thread has called sim_activate() to activate a unit.  The job of this
    routine is to put the unit in proper condition to digest what may have
    occurred in the asynchrconous thread.
-  
-   Since disk processing only handles a single I/O at a time to a
-   particular disk device (due to using stdio for the SimH Disk format
-   and stdio doesn't have an atomic seek+(read|write) operation),
-   we have the opportunity to possibly detect improper attempts to
-   issue multiple concurrent I/O requests. */
+
+   Completion callbacks for all requests which have been performed are
+   delivered here in the order the requests were submitted. */
 static void _disk_completion_dispatch (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-DISK_PCALLBACK callback = ctx->callback;
 
-sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop, (void *)(ctx->callback));
+if (ctx == NULL)                                        /* detached? */
+    return;
+sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, completions=%d)\n", (int)(uptr - ctx->dptr->units), (int)(ctx->io_head - ctx->io_done));
+
+pthread_mutex_lock (&disk_io_lock);
+while (ctx->io_done != ctx->io_head) {
+    struct disk_io_request *req = &ctx->io_ring[ctx->io_done % DISK_IO_RING_SIZE];
+    DISK_PCALLBACK callback = req->callback;
+    t_stat status = req->io_status;
+
+    ++ctx->io_done;
+    pthread_mutex_unlock (&disk_io_lock);
+    if (callback)
+        callback (uptr, status);
+    pthread_mutex_lock (&disk_io_lock);
+    if (uptr->disk_ctx != ctx)                          /* detached by callback? */
+        break;
+    }
+pthread_mutex_unlock (&disk_io_lock);
+}
 
-if (ctx->io_dop != DOP_DONE)
-    abort();                                            /* horribly wrong, stop */
+/* Submit a request to the engine (main thread), returns FALSE if the
+   unit's ring is full */
+static t_bool _disk_io_submit (UNIT *uptr, int dop, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects, DISK_PCALLBACK callback)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_io_request *req;
 
-if (ctx->callback && ctx->io_dop == DOP_DONE) {
-    ctx->callback = NULL;
-    callback (uptr, ctx->io_status);
+sim_debug_unit (ctx->dbit, uptr, "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d, outstanding=%d)\n",
+                dop, (int)(uptr - ctx->dptr->units), lba, sects, (int)(ctx->io_tail - ctx->io_done));
+
+if ((ctx->io_tail - ctx->io_done) >= DISK_IO_RING_SIZE) {  /* ring full? */
+    sim_debug_unit (ctx->dbit, uptr, "sim_disk AIO_CALL(unit=%d) - request ring full\n", (int)(uptr - ctx->dptr->units));
+    return FALSE;
     }
+pthread_mutex_lock (&disk_io_lock);
+req = &ctx->io_ring[ctx->io_tail % DISK_IO_RING_SIZE];
+req->dop = dop;
+req->lba = lba;
+req->buf = buf;
+req->rsects = rsects;
+req->sects = sects;
+req->callback = callback;
+req->io_status = SCPE_OK;
+++ctx->io_tail;
+ctx->io_active = TRUE;
+_disk_io_ready (ctx);
+pthread_mutex_unlock (&disk_io_lock);
+return TRUE;
 }
 
 static t_bool _disk_is_active (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_bool active;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
-    return (ctx->io_dop != DOP_DONE);
+    active = ctx->io_active;                            /* polled often, so no lock */
+    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, outstanding=%d)\n", (int)(uptr - ctx->dptr->units), (int)(ctx->io_tail - ctx->io_head));
+    return active;
     }
 return FALSE;
 }
@@ -315,19 +430,15 @@ static t_bool _disk_cancel (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
-    if (ctx->asynch_io) {
-        pthread_mutex_lock (&ctx->io_lock);
-        while (ctx->io_dop != DOP_DONE)
-            pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
-        pthread_mutex_unlock (&ctx->io_lock);
-        }
+    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, outstanding=%d)\n", (int)(uptr - ctx->dptr->units), (int)(ctx->io_tail - ctx->io_head));
+    if (ctx->asynch_io)
+        _disk_io_drain (ctx);
     }
 return FALSE;
 }
 #else
 #define AIO_CALLSETUP
-#define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
+#define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback, _busy) \
     if (_callback)                                              \
         (_callback) (uptr, r);
 #endif
@@ -342,6 +453,7 @@ static FILE *sim_vhd_disk_merge (const char *szVHDPath, char **ParentVHD);
 static int sim_vhd_disk_close (FILE *f);
 static void sim_vhd_disk_flush (FILE *f);
 static t_offset sim_vhd_disk_size (FILE *f);
+static FILE *sim_vhd_disk_fixed_file (FILE *f);
 static t_stat sim_vhd_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
 static t_stat sim_vhd_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
 static t_stat sim_vhd_disk_clearerr (UNIT *uptr);
@@ -362,6 +474,13 @@ static t_stat sim_os_disk_info_raw (FILE *f, uint32 *sector_size, uint32 *remova
 static char *HostPathToVhdPath (const char *szHostPath, char *szVhdPath, size_t VhdPathSize);
 static char *VhdPathToHostPath (const char *szVhdPath, char *szHostPath, size_t HostPathSize);
 static t_offset get_filesystem_size (UNIT *uptr, t_bool *readonly);
+static t_stat _sim_disk_rdsect_container (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
+static t_stat _sim_disk_wrsect_container (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
+static t_stat _disk_cache_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
+static t_stat _disk_cache_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
+static t_stat _disk_cache_flush (UNIT *uptr);
+static t_stat _disk_cache_apply (UNIT *uptr);
+static t_stat _disk_cache_release (UNIT *uptr);
 
 struct sim_disk_fmt {
     const char          *name;                          /* name */
@@ -512,7 +631,7 @@ t_bool sim_disk_isavailable_a (UNIT *uptr, DISK_PCALLBACK callback)
 t_bool r = FALSE;
 AIO_CALLSETUP
     r = sim_disk_isavailable (uptr);
-AIO_CALL(DOP_IAVL, 0, NULL, NULL, 0, callback);
+AIO_CALL(DOP_IAVL, 0, NULL, NULL, 0, callback, FALSE);
 return r;
 }
 
@@ -584,25 +703,43 @@ sim_printf ("%s", msg);
 return SCPE_NOFNC;
 #else
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-pthread_attr_t attr;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_set_async(unit=%d)\n", (int)(uptr - ctx->dptr->units));
 
-ctx->asynch_io = sim_asynch_enabled;
+ctx->uptr = uptr;
 ctx->asynch_io_latency = latency;
-if (ctx->asynch_io) {
-    pthread_mutex_init (&ctx->io_lock, NULL);
-    pthread_cond_init (&ctx->io_cond, NULL);
-    pthread_cond_init (&ctx->io_done, NULL);
-    pthread_cond_init (&ctx->startup_cond, NULL);
-    pthread_attr_init(&attr);
-    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
-    pthread_mutex_lock (&ctx->io_lock);
-    pthread_create (&ctx->io_thread, &attr, _disk_io, (void *)uptr);
-    pthread_attr_destroy(&attr);
-    pthread_cond_wait (&ctx->startup_cond, &ctx->io_lock); /* Wait for thread to stabilize */
-    pthread_mutex_unlock (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->startup_cond);
+if (sim_asynch_enabled && !ctx->asynch_io) {
+    pthread_mutex_lock (&disk_io_lock);
+    ctx->asynch_io = TRUE;
+    ++disk_io_unit_count;
+    disk_io_shutdown = FALSE;
+    /* One worker per asynchronous unit */
+    while (disk_io_worker_count < disk_io_unit_count) {
+        pthread_attr_t attr;
+        int stat;
+
+        if (disk_io_worker_count == disk_io_worker_size) {
+            int nsize = disk_io_worker_size ? 2 * disk_io_worker_size : 8;
+            pthread_t *nworkers = (pthread_t *)realloc (disk_io_workers, nsize * sizeof (*nworkers));
+
+            if (nworkers == NULL)
+                break;
+            disk_io_workers = nworkers;
+            disk_io_worker_size = nsize;
+            }
+        pthread_attr_init (&attr);
+        pthread_attr_setscope (&attr, PTHREAD_SCOPE_SYSTEM);
+        stat = pthread_create (&disk_io_workers[disk_io_worker_count], &attr, _disk_io, NULL);
+        pthread_attr_destroy (&attr);
+        if (stat != 0)
+            break;
+        ++disk_io_worker_count;
+        }
+    if (disk_io_worker_count == 0) {                    /* no engine? */
+        ctx->asynch_io = FALSE;                         /* stay synchronous */
+        --disk_io_unit_count;
+        }
+    pthread_mutex_unlock (&disk_io_lock);
     }
 uptr->a_check_completion = _disk_completion_dispatch;
 uptr->a_is_active = _disk_is_active;
@@ -626,16 +763,130 @@ if (!ctx) return SCPE_UNATT;
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_clr_async(unit=%d)\n", (int)(uptr - ctx->dptr->units));
 
 if (ctx->asynch_io) {
-    pthread_mutex_lock (&ctx->io_lock);
-    ctx->asynch_io = 0;
-    pthread_cond_signal (&ctx->io_cond);
-    pthread_mutex_unlock (&ctx->io_lock);
-    pthread_join (ctx->io_thread, NULL);
-    pthread_mutex_destroy (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->io_cond);
-    pthread_cond_destroy (&ctx->io_done);
+    _disk_io_drain (ctx);                   /* let outstanding requests finish */
+    pthread_mutex_lock (&disk_io_lock);
+    ctx->asynch_io = FALSE;
+    if (--disk_io_unit_count == 0) {        /* last asynch unit? */
+        int i, workers = disk_io_worker_count;
+
+        disk_io_shutdown = TRUE;            /* stop the engine */
+        pthread_cond_broadcast (&disk_io_work);
+        pthread_mutex_unlock (&disk_io_lock);
+        for (i = 0; i < workers; i++)
+            pthread_join (disk_io_workers[i], NULL);
+        pthread_mutex_lock (&disk_io_lock);
+        free (disk_io_workers);
+        disk_io_workers = NULL;
+        disk_io_worker_size = 0;
+        disk_io_worker_count = 0;
+        }
+    pthread_mutex_unlock (&disk_io_lock);
+    }
+return SCPE_OK;
+#endif
+}
+
+/* Memory mapped container access
+
+   When a SIMH format or fixed VHD container (or a RAW format container
+   which is a plain file) is attached with -P, the data portion of the
+   container which exists at attach time is mapped into memory.  Transfers within the mapped region are copies to or
+   from the mapping, without stdio seeks, transfers and buffering.
+   Transfers which extend beyond the mapped region (i.e. into a sparse
+   container which hasn't been written to its full size) use the normal
+   container access paths.  Modified data is written to the container
+   with msync when the simulator stops, when the unit is reset and when
+   it is detached.  If the container can't be mapped, the ATTACH -P
+   fails and the unit is left detached.
+*/
+
+static t_bool _disk_map_covers (UNIT *uptr, t_lba lba, t_seccnt sects, t_bool write)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+return (ctx->map_base != NULL) &&
+       (!write || !(uptr->flags & UNIT_RO)) &&
+       (((((t_offset)lba) + sects) * ctx->sector_size) <= (t_offset)ctx->map_size);
+}
+
+static t_stat _disk_map_attach (UNIT *uptr)
+{
+#if defined (SIM_DISK_MMAP)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+FILE *f = NULL;
+int fd = -1;
+struct stat statb;
+t_offset size = 0;
+void *base;
+
+if (ctx->map_base)                                      /* already mapped? */
+    return SCPE_OK;
+switch (DK_GET_FMT (uptr)) {                            /* case on format */
+    case DKUF_F_STD:                                    /* SIMH format */
+        f = uptr->fileref;
+        size = sim_fsize_ex (f);
+        if ((size != (t_offset)-1) && ctx->footer)
+            size -= sizeof (*ctx->footer);              /* data precedes the footer */
+        break;
+    case DKUF_F_VHD:                                    /* VHD format */
+        f = sim_vhd_disk_fixed_file (uptr->fileref);
+        size = ctx->container_size;
+        break;
+    case DKUF_F_RAW:                                    /* RAW format */
+        fd = (int)((long)uptr->fileref);                /* raw handle is a descriptor */
+        if ((fstat (fd, &statb) != 0) ||                /* only map plain files */
+            !S_ISREG (statb.st_mode))
+            fd = -1;
+        else
+            size = sim_os_disk_size_raw (uptr->fileref);
+        break;
+    default:
+        break;
+    }
+if (f != NULL) {
+    fflush (f);                                         /* write any buffered data */
+    fd = fileno (f);
     }
+if (fd < 0)
+    return sim_messagef (SCPE_NOFNC, "%s: Memory mapped access requires a SIMH format, fixed VHD or RAW container file\n", sim_uname (uptr));
+if ((size == (t_offset)-1) || (size > ctx->container_size))
+    size = ctx->container_size;
+size -= size % ctx->sector_size;                        /* whole sectors */
+if ((size <= 0) || ((t_offset)((size_t)size) != size))
+    return sim_messagef (SCPE_NOFNC, "%s: No container data can be memory mapped\n", sim_uname (uptr));
+base = mmap (NULL, (size_t)size, (uptr->flags & UNIT_RO) ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+if (base == MAP_FAILED)
+    return sim_messagef (SCPE_OPENERR, "%s: Can't memory map %s: %s\n", sim_uname (uptr), uptr->filename, strerror (errno));
+ctx->map_base = (uint8 *)base;
+ctx->map_size = (size_t)size;
+sim_debug_unit (ctx->dbit, uptr, "_disk_map_attach(unit=%d) - %u sectors mapped\n", (int)(uptr - ctx->dptr->units), (uint32)(size / ctx->sector_size));
 return SCPE_OK;
+#else
+return sim_messagef (SCPE_NOFNC, "%s: Memory mapped disk access is not available on this host\n", sim_uname (uptr));
+#endif
+}
+
+static void _disk_map_flush (UNIT *uptr)
+{
+#if defined (SIM_DISK_MMAP)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx && ctx->map_base && !(uptr->flags & UNIT_RO))
+    msync (ctx->map_base, ctx->map_size, MS_SYNC);
+#endif
+}
+
+static void _disk_map_detach (UNIT *uptr)
+{
+#if defined (SIM_DISK_MMAP)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if ((ctx == NULL) || (ctx->map_base == NULL))
+    return;
+_disk_map_flush (uptr);
+munmap (ctx->map_base, ctx->map_size);
+ctx->map_base = NULL;
+ctx->map_size = 0;
 #endif
 }
 
@@ -686,10 +937,7 @@ return SCPE_OK;
 
 t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
-t_stat r;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint32 f = DK_GET_FMT (uptr);
-t_seccnt sread = 0;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
 
@@ -701,7 +949,27 @@ if ((sects == 1) &&                                     /* Single sector reads *
         *sectsread = 1;
     return SCPE_OK;                                     /* return success */
     }
+if (ctx->cache)                                         /* sector cache? */
+    return _disk_cache_rdsect (uptr, lba, buf, sectsread, sects);
+return _sim_disk_rdsect_container (uptr, lba, buf, sectsread, sects);
+}
+
+/* Read Sectors from the container (bypassing any sector cache) */
+
+static t_stat _sim_disk_rdsect_container (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+t_stat r;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+t_seccnt sread = 0;
 
+if (_disk_map_covers (uptr, lba, sects, FALSE)) {       /* memory mapped? */
+    memcpy (buf, ctx->map_base + ((size_t)lba) * ctx->sector_size, sects * ctx->sector_size);
+    if (sectsread)
+        *sectsread = sects;
+    sim_buf_swap_data (buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
+    return SCPE_OK;
+    }
 if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
     ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
      (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1)))) ||
@@ -753,7 +1021,7 @@ t_stat sim_disk_rdsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread
 t_stat r = SCPE_OK;
 AIO_CALLSETUP
     r = sim_disk_rdsect (uptr, lba, buf, sectsread, sects);
-AIO_CALL(DOP_RSEC, lba, buf, sectsread, sects, callback);
+AIO_CALL(DOP_RSEC, lba, buf, sectsread, sects, callback, SCPE_QFULL);
 return r;
 }
 
@@ -787,10 +1055,6 @@ return SCPE_OK;
 t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint32 f = DK_GET_FMT (uptr);
-t_stat r;
-uint8 *tbuf = NULL;
-t_seccnt written = 0;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
 
@@ -826,6 +1090,34 @@ if (uptr->dynflags & UNIT_DISK_CHK) {
             }
         }
     }
+if (ctx->cache)                                         /* sector cache? */
+    return _disk_cache_wrsect (uptr, lba, buf, sectswritten, sects);
+return _sim_disk_wrsect_container (uptr, lba, buf, sectswritten, sects);
+}
+
+/* Write Sectors to the container (bypassing any sector cache) */
+
+static t_stat _sim_disk_wrsect_container (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+t_stat r;
+uint8 *tbuf = NULL;
+t_seccnt written = 0;
+
+if (sectswritten)
+    *sectswritten = 0;
+if (_disk_map_covers (uptr, lba, sects, TRUE)) {        /* memory mapped? */
+    t_offset end_write = (((t_offset)lba) + sects) * ctx->sector_size;
+
+    sim_buf_copy_swapped (ctx->map_base + ((size_t)lba) * ctx->sector_size, buf, 
+                          ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
+    if (sectswritten)
+        *sectswritten = sects;
+    if (ctx->highwater < end_write)
+        ctx->highwater = end_write;
+    return SCPE_OK;
+    }
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
         r = _sim_disk_wrsect (uptr, lba, buf, &written, sects);
@@ -900,10 +1192,490 @@ t_stat sim_disk_wrsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswrit
 t_stat r = SCPE_OK;
 AIO_CALLSETUP
     r =  sim_disk_wrsect (uptr, lba, buf, sectswritten, sects);
-AIO_CALL(DOP_WSEC, lba, buf, sectswritten, sects, callback);
+AIO_CALL(DOP_WSEC, lba, buf, sectswritten, sects, callback, SCPE_QFULL);
 return r;
 }
 
+/* Sector cache
+
+   A unit may keep recently used sectors in memory (SET <unit> CACHE).
+   Cached sectors are held in simulator byte order, exactly as they are
+   returned by sim_disk_rdsect, so a hit costs a single copy and hot
+   file system structures (directories, index files, page files) are
+   served without touching the container.  Blocks are replaced in least
+   recently used order.
+
+   In WRITETHROUGH mode (the default) written sectors are written to
+   the container immediately and also kept in the cache.  In WRITEBACK
+   mode written sectors are only kept in the cache and are written to
+   the container when they are evicted, when the simulator stops, or
+   when the unit is detached.  Runs of adjacent dirty sectors are
+   written to the container in a single transfer.
+
+   The cache settings are kept in the unit (disk_cache holds the size in
+   KB, and the UNIT_DISK_CACHE_WB dynamic flag selects WRITEBACK) and a
+   cache is allocated when the unit is attached.
+
+   A dirty sector is never discarded.  If writing it back fails when it
+   would be evicted, it stays in the cache and the transfer that needed
+   the block fails instead.  The write back is retried on the next
+   eviction or flush.
+*/
+
+#define DISK_CACHE_DEFAULT      (16*1024*1024)  /* CACHE with no size */
+#define DISK_CACHE_MIN_BLOCKS   64              /* smallest cache */
+#define DISK_CACHE_MAX_RUN      128             /* sectors per write back transfer */
+
+struct disk_cache_block {
+    t_lba                   lba;
+    t_bool                  dirty;              /* not yet written to the container */
+    struct disk_cache_block *hash_next;         /* hash chain */
+    struct disk_cache_block *prev;              /* LRU list (most recent first) */
+    struct disk_cache_block *next;
+    uint8                   data[1];            /* sector_size bytes */
+    };
+
+struct disk_cache {
+    t_offset                size;               /* configured size (bytes) */
+    t_bool                  writeback;          /* WRITEBACK mode */
+    uint32                  sector_size;
+    uint32                  max_blocks;
+    uint32                  blocks;             /* blocks allocated */
+    uint32                  dirty;              /* dirty blocks */
+    uint32                  hash_mask;
+    struct disk_cache_block **hash;
+    struct disk_cache_block *head;              /* most recently used */
+    struct disk_cache_block *tail;              /* least recently used */
+    uint8                   *run_buf;           /* write back transfer buffer */
+    t_uint64                read_hits;          /* sectors read from the cache */
+    t_uint64                read_misses;        /* sectors read from the container */
+    t_uint64                writes;             /* sectors written */
+    t_uint64                writebacks;         /* dirty sectors written back */
+    t_uint64                writeback_xfers;    /* container writes performing write back */
+    t_uint64                evictions;
+    };
+
+#define DISK_CACHE_SIZE(u)      (((t_offset)(u)->disk_cache) * 1024)   /* configured size (bytes, 0 = no cache) */
+#define DISK_CACHE_WRITEBACK(u) (((u)->dynflags & UNIT_DISK_CACHE_WB) != 0)
+
+static struct disk_cache_block *_disk_cache_find (struct disk_cache *cache, t_lba lba)
+{
+struct disk_cache_block *blk = cache->hash[lba & cache->hash_mask];
+
+while (blk && (blk->lba != lba))
+    blk = blk->hash_next;
+return blk;
+}
+
+static void _disk_cache_unlink (struct disk_cache *cache, struct disk_cache_block *blk)
+{
+if (blk->prev)
+    blk->prev->next = blk->next;
+else
+    cache->head = blk->next;
+if (blk->next)
+    blk->next->prev = blk->prev;
+else
+    cache->tail = blk->prev;
+blk->prev = blk->next = NULL;
+}
+
+static void _disk_cache_link (struct disk_cache *cache, struct disk_cache_block *blk)
+{
+blk->prev = NULL;
+blk->next = cache->head;
+if (cache->head)
+    cache->head->prev = blk;
+else
+    cache->tail = blk;
+cache->head = blk;
+}
+
+static void _disk_cache_touch (struct disk_cache *cache, struct disk_cache_block *blk)
+{
+if (cache->head == blk)
+    return;
+_disk_cache_unlink (cache, blk);
+_disk_cache_link (cache, blk);
+}
+
+static void _disk_cache_unhash (struct disk_cache *cache, struct disk_cache_block *blk)
+{
+struct disk_cache_block **pblk = &cache->hash[blk->lba & cache->hash_mask];
+
+while (*pblk && (*pblk != blk))
+    pblk = &(*pblk)->hash_next;
+if (*pblk)
+    *pblk = blk->hash_next;
+blk->hash_next = NULL;
+}
+
+/* Write a dirty block, along with any adjacent dirty blocks, to the container */
+
+static t_stat _disk_cache_write_run (UNIT *uptr, struct disk_cache_block *blk)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+struct disk_cache_block *b;
+t_lba first = blk->lba;
+t_lba lba;
+t_seccnt count, written = 0, i;
+t_stat r;
+
+while ((first > 0) && 
+       ((blk->lba - first) < (DISK_CACHE_MAX_RUN - 1)) &&
+       (b = _disk_cache_find (cache, first - 1)) && 
+       b->dirty)
+    --first;
+for (lba = first, count = 0; count < DISK_CACHE_MAX_RUN; lba++, count++) {
+    b = _disk_cache_find (cache, lba);
+    if ((b == NULL) || (!b->dirty))
+        break;
+    memcpy (cache->run_buf + count * cache->sector_size, b->data, cache->sector_size);
+    }
+r = _sim_disk_wrsect_container (uptr, first, cache->run_buf, &written, count);
+sim_debug_unit (ctx->dbit, uptr, "_disk_cache_write_run(unit=%d, lba=0x%X, sects=%d) - %s\n", (int)(uptr - ctx->dptr->units), first, count, sim_error_text (r));
+++cache->writeback_xfers;
+if (r != SCPE_OK)
+    return r;
+for (i = 0; i < written; i++) {
+    b = _disk_cache_find (cache, first + i);
+    b->dirty = FALSE;
+    --cache->dirty;
+    ++cache->writebacks;
+    }
+return (written == count) ? SCPE_OK : SCPE_IOERR;
+}
+
+/* Get a block for an lba not in the cache, evicting the least recently used block if necessary */
+
+static struct disk_cache_block *_disk_cache_alloc (UNIT *uptr, t_lba lba, t_stat *stat)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+struct disk_cache_block *blk = NULL;
+struct disk_cache_block **pblk;
+
+if (cache->blocks < cache->max_blocks) {
+    blk = (struct disk_cache_block *)malloc (sizeof (*blk) + cache->sector_size - 1);
+    if (blk)
+        ++cache->blocks;
+    }
+if (blk == NULL) {
+    blk = cache->tail;
+    if (blk == NULL) {
+        *stat = SCPE_MEM;
+        return NULL;
+        }
+    if (blk->dirty) {
+        t_stat r = _disk_cache_write_run (uptr, blk);
+
+        if (blk->dirty) {                       /* write back failed? */
+            *stat = (r != SCPE_OK) ? r : SCPE_IOERR;
+            return NULL;                        /* keep the data, refuse the eviction */
+            }
+        }
+    _disk_cache_unhash (cache, blk);
+    _disk_cache_unlink (cache, blk);
+    ++cache->evictions;
+    }
+blk->lba = lba;
+blk->dirty = FALSE;
+pblk = &cache->hash[lba & cache->hash_mask];
+blk->hash_next = *pblk;
+*pblk = blk;
+_disk_cache_link (cache, blk);
+return blk;
+}
+
+static t_stat _disk_cache_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+uint32 ss = cache->sector_size;
+t_seccnt done = 0;
+t_stat r = SCPE_OK;
+
+while (done < sects) {
+    struct disk_cache_block *blk = _disk_cache_find (cache, lba + done);
+    t_seccnt run, got = 0, i;
+
+    if (blk) {                                          /* hit? */
+        memcpy (buf + done * ss, blk->data, ss);
+        _disk_cache_touch (cache, blk);
+        ++cache->read_hits;
+        ++done;
+        continue;
+        }
+    for (run = 1; (done + run < sects) && !_disk_cache_find (cache, lba + done + run); run++)
+        ;                                               /* size of missing run */
+    r = _sim_disk_rdsect_container (uptr, lba + done, buf + done * ss, &got, run);
+    cache->read_misses += run;
+    for (i = 0; i < got; i++) {                         /* the data is already in buf, */
+        t_stat ar;                                      /* so failing to cache it is harmless */
+
+        blk = _disk_cache_alloc (uptr, lba + done + i, &ar);
+        if (blk == NULL)
+            break;
+        memcpy (blk->data, buf + (done + i) * ss, ss);
+        }
+    done += got;
+    if ((r != SCPE_OK) || (got < run))
+        break;
+    }
+if (sectsread)
+    *sectsread = done;
+return r;
+}
+
+static t_stat _disk_cache_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+uint32 ss = cache->sector_size;
+t_seccnt written = sects, i;
+t_stat r = SCPE_OK;
+
+if (!cache->writeback)
+    r = _sim_disk_wrsect_container (uptr, lba, buf, &written, sects);
+for (i = 0; i < written; i++) {
+    struct disk_cache_block *blk = _disk_cache_find (cache, lba + i);
+
+    if (blk)
+        _disk_cache_touch (cache, blk);
+    else {
+        blk = _disk_cache_alloc (uptr, lba + i, &r);
+        if (blk == NULL) {
+            written = i;
+            break;
+            }
+        }
+    memcpy (blk->data, buf + i * ss, ss);
+    if (cache->writeback && !blk->dirty) {
+        blk->dirty = TRUE;
+        ++cache->dirty;
+        }
+    }
+cache->writes += written;
+if (sectswritten)
+    *sectswritten = written;
+return r;
+}
+
+static int _disk_cache_lba_compare (const void *pa, const void *pb)
+{
+const struct disk_cache_block *a = *(const struct disk_cache_block * const *)pa;
+const struct disk_cache_block *b = *(const struct disk_cache_block * const *)pb;
+
+return (a->lba < b->lba) ? -1 : ((a->lba > b->lba) ? 1 : 0);
+}
+
+/* Write all dirty blocks to the container in lba order */
+
+static t_stat _disk_cache_flush (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx ? ctx->cache : NULL;
+struct disk_cache_block **dirty, *blk;
+uint32 i, count = 0;
+t_stat r = SCPE_OK;
+
+if ((cache == NULL) || (cache->dirty == 0))
+    return SCPE_OK;
+dirty = (struct disk_cache_block **)malloc (cache->dirty * sizeof (*dirty));
+if (dirty == NULL)
+    return SCPE_MEM;
+for (blk = cache->head; blk && (count < cache->dirty); blk = blk->next)
+    if (blk->dirty)
+        dirty[count++] = blk;
+qsort (dirty, count, sizeof (*dirty), _disk_cache_lba_compare);
+for (i = 0; i < count; i++) {
+    if (dirty[i]->dirty) {
+        t_stat wr = _disk_cache_write_run (uptr, dirty[i]);
+
+        if (wr != SCPE_OK)
+            r = wr;
+        }
+    }
+free (dirty);
+if (r != SCPE_OK)
+    sim_printf ("%s: Error writing cached sectors to %s: %s\n", sim_uname (uptr), uptr->filename, sim_error_text (r));
+return r;
+}
+
+/* Write back and free a unit's sector cache */
+
+static t_stat _disk_cache_release (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx ? ctx->cache : NULL;
+struct disk_cache_block *blk;
+t_stat r;
+
+if (cache == NULL)
+    return SCPE_OK;
+r = _disk_cache_flush (uptr);
+while ((blk = cache->head)) {
+    cache->head = blk->next;
+    free (blk);
+    }
+free (cache->hash);
+free (cache->run_buf);
+free (cache);
+ctx->cache = NULL;
+return r;
+}
+
+/* Make a unit's sector cache match its cache settings */
+
+static t_stat _disk_cache_apply (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset size = DISK_CACHE_SIZE (uptr);
+t_bool writeback = DISK_CACHE_WRITEBACK (uptr);
+struct disk_cache *cache;
+uint32 buckets;
+t_stat r = SCPE_OK;
+
+if (ctx == NULL)
+    return SCPE_OK;
+#if defined (SIM_ASYNCH_IO)
+_disk_io_drain (ctx);                                   /* let outstanding requests finish */
+#endif
+if (ctx->cache && (ctx->cache->size == size)) {         /* only the mode changed? */
+    if (ctx->cache->writeback && !writeback)
+        r = _disk_cache_flush (uptr);
+    ctx->cache->writeback = writeback;
+    return r;
+    }
+r = _disk_cache_release (uptr);
+if (size == 0)
+    return r;
+cache = (struct disk_cache *)calloc (1, sizeof (*cache));
+if (cache == NULL)
+    return SCPE_MEM;
+cache->size = size;
+cache->writeback = writeback;
+cache->sector_size = ctx->sector_size;
+cache->max_blocks = (uint32)((size / ctx->sector_size < 0x7FFFFFFF) ? size / ctx->sector_size : 0x7FFFFFFF);
+if (cache->max_blocks < DISK_CACHE_MIN_BLOCKS)
+    cache->max_blocks = DISK_CACHE_MIN_BLOCKS;
+for (buckets = DISK_CACHE_MIN_BLOCKS; (buckets < cache->max_blocks / 2) && (buckets < 0x40000000); buckets <<= 1)
+    ;
+cache->hash_mask = buckets - 1;
+cache->hash = (struct disk_cache_block **)calloc (buckets, sizeof (*cache->hash));
+cache->run_buf = (uint8 *)malloc (DISK_CACHE_MAX_RUN * ctx->sector_size);
+if ((cache->hash == NULL) || (cache->run_buf == NULL)) {
+    free (cache->hash);
+    free (cache->run_buf);
+    free (cache);
+    return SCPE_MEM;
+    }
+ctx->cache = cache;
+sim_debug_unit (ctx->dbit, uptr, "_disk_cache_apply(unit=%d) - %u blocks, %s\n", (int)(uptr - ctx->dptr->units), cache->max_blocks, writeback ? "writeback" : "writethrough");
+return r;
+}
+
+/* Set sector cache
+
+   val = DKCACHE_ON             CACHE{=size}    size in bytes with a K, M or G
+                                                suffix, or megabytes
+         DKCACHE_OFF            NOCACHE
+         DKCACHE_WRITEBACK      WRITEBACK
+         DKCACHE_WRITETHROUGH   WRITETHROUGH
+*/
+
+t_stat sim_disk_set_cache (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+t_offset size = DISK_CACHE_DEFAULT;
+
+if (val == DKCACHE_ON) {
+    if ((cptr != NULL) && (*cptr != 0)) {
+        CONST char *tptr;
+        t_value num = strtotv (cptr, &tptr, 10);
+
+        if (tptr == cptr)
+            return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cptr);
+        switch (toupper (*tptr)) {
+            case 'K':
+                size = ((t_offset)num) * 1024;
+                ++tptr;
+                break;
+            case 'G':
+                size = ((t_offset)num) * 1024 * 1024 * 1024;
+                ++tptr;
+                break;
+            case 'M':
+                ++tptr;
+                /* fall through */
+            default:
+                size = ((t_offset)num) * 1024 * 1024;
+                break;
+            }
+        if ((*tptr != 0) || (size == 0) || ((size / 1024) > 0xFFFFFFFF))
+            return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cptr);
+        }
+    }
+else
+    if ((cptr != NULL) && (*cptr != 0))
+        return SCPE_ARG;
+switch (val) {
+    case DKCACHE_OFF:
+        uptr->disk_cache = 0;
+        break;
+    case DKCACHE_ON:
+        uptr->disk_cache = (uint32)(size / 1024);
+        if (uptr->disk_cache == 0)                      /* less than 1KB? */
+            uptr->disk_cache = 1;
+        break;
+    case DKCACHE_WRITEBACK:
+        uptr->dynflags |= UNIT_DISK_CACHE_WB;
+        break;
+    case DKCACHE_WRITETHROUGH:
+        uptr->dynflags &= ~UNIT_DISK_CACHE_WB;
+        break;
+    default:
+        return SCPE_IERR;
+    }
+if (!(uptr->flags & UNIT_ATT))                          /* allocated when attached */
+    return SCPE_OK;
+return _disk_cache_apply (uptr);
+}
+
+/* Show sector cache */
+
+t_stat sim_disk_show_cache (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ((uptr->flags & UNIT_ATT) && ctx) ? ctx->cache : NULL;
+t_uint64 reads;
+
+if (uptr->disk_cache == 0) {
+    fprintf (st, "%s: no sector cache\n", sim_uname (uptr));
+    return SCPE_OK;
+    }
+fprintf (st, "%s: %s byte %s sector cache", sim_uname (uptr), sim_fmt_numeric ((double)DISK_CACHE_SIZE (uptr)), DISK_CACHE_WRITEBACK (uptr) ? "writeback" : "writethrough");
+if (cache == NULL) {
+    fprintf (st, " (allocated when attached)\n");
+    return SCPE_OK;
+    }
+fprintf (st, "\n");
+reads = cache->read_hits + cache->read_misses;
+fprintf (st, "  Blocks in use:   %s", sim_fmt_numeric ((double)cache->blocks));
+fprintf (st, " of %s (%u bytes each)\n", sim_fmt_numeric ((double)cache->max_blocks), cache->sector_size);
+fprintf (st, "  Hit rate:        %.1f%%", reads ? (100.0 * cache->read_hits) / reads : 0.0);
+fprintf (st, " (%s of", sim_fmt_numeric ((double)cache->read_hits));
+fprintf (st, " %s sectors read)\n", sim_fmt_numeric ((double)reads));
+fprintf (st, "  Sectors written: %s\n", sim_fmt_numeric ((double)cache->writes));
+fprintf (st, "  Dirty:           %s bytes\n", sim_fmt_numeric ((double)cache->dirty * cache->sector_size));
+if (cache->writeback_xfers) {
+    fprintf (st, "  Written back:    %s sectors", sim_fmt_numeric ((double)cache->writebacks));
+    fprintf (st, " in %s transfers\n", sim_fmt_numeric ((double)cache->writeback_xfers));
+    }
+fprintf (st, "  Evictions:       %s\n", sim_fmt_numeric ((double)cache->evictions));
+return SCPE_OK;
+}
+
 t_stat sim_disk_unload (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
@@ -951,10 +1723,16 @@ uint32 f = DK_GET_FMT (uptr);
 #if defined (SIM_ASYNCH_IO)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
-sim_disk_clr_async (uptr);
-if (sim_asynch_enabled)
-    sim_disk_set_async (uptr, ctx->asynch_io_latency);
+if (ctx->asynch_io && sim_asynch_enabled)              /* asynch mode unchanged? */
+    _disk_io_drain (ctx);                               /* just wait for outstanding requests */
+else {                                                  /* mode changed (or synchronous) */
+    sim_disk_clr_async (uptr);
+    if (sim_asynch_enabled)
+        sim_disk_set_async (uptr, ctx->asynch_io_latency);
+    }
 #endif
+_disk_cache_flush (uptr);                               /* write back cached sectors */
+_disk_map_flush (uptr);                                 /* write back mapped container data */
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
         fflush (uptr->fileref);
@@ -2571,6 +3349,7 @@ FILE *(*create_function)(const char *filename, t_offset desiredsize) = NULL;
 t_stat (*storage_function)(FILE *file, uint32 *sector_size, uint32 *removable, uint32 *is_cdrom) = NULL;
 t_bool created = FALSE, copied = FALSE, autosized = FALSE;
 t_bool auto_format = FALSE;
+t_bool memory_map = ((sim_switches & SWMASK ('P')) != 0);
 t_offset container_size, filesystem_size, current_unit_size;
 size_t tmp_size = 1;
 
@@ -3285,7 +4064,7 @@ if (container_size && (container_size != (t_offset)-1)) {
     }
 
 if ((uptr->flags & UNIT_RO) == 0) {
-    t_bool readonly;
+    t_bool readonly = FALSE;
     int32 saved_quiet = sim_quiet;
 
     sim_quiet = 1;
@@ -3331,6 +4110,17 @@ if (uptr->flags & UNIT_BUFABLE) {                       /* buffer in memory? */
     memcpy (uptr->filebuf2, uptr->filebuf, (size_t)ctx->container_size);/* save initial contents */
     uptr->flags |= UNIT_BUF;                            /* mark as buffered */
     }
+else {
+    if (memory_map) {
+        t_stat r = _disk_map_attach (uptr);             /* map container data */
+
+        if (r != SCPE_OK) {                             /* explicitly requested, so fail */
+            sim_disk_detach (uptr);
+            return r;
+            }
+        }
+    _disk_cache_apply (uptr);                           /* allocate any sector cache */
+    }
 
 return SCPE_OK;
 }
@@ -3387,6 +4177,14 @@ uptr->filebuf = NULL;
 free (uptr->filebuf2);
 uptr->filebuf2 = NULL;
 
+if (ctx->cache) {
+#if defined (SIM_ASYNCH_IO)
+    _disk_io_drain (ctx);                               /* let outstanding requests finish */
+#endif
+    _disk_cache_release (uptr);                         /* write back cached sectors */
+    }
+_disk_map_detach (uptr);                                /* write back and unmap container data */
+
 update_disk_footer (uptr);                              /* Update meta data if highwater has changed */
 
 auto_format = ctx->auto_format;
@@ -3534,6 +4332,8 @@ fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk\
 fprintf (st, "    -O          Override consistency checks when attaching differencing disks\n");
 fprintf (st, "                which have unexpected parent disk GUID or timestamps\n\n");
 fprintf (st, "    -U          Fix inconsistencies which are overridden by the -O switch\n");
+fprintf (st, "    -P          Access the container data through a memory mapping (SIMH\n");
+fprintf (st, "                format, fixed VHD or RAW format plain file containers)\n");
 if (strstr (sim_name, "-10") == NULL) {
     fprintf (st, "    -Y          Answer Yes to prompt to overwrite last track (on disk create)\n");
     fprintf (st, "    -N          Answer No to prompt to overwrite last track (on disk create)\n");
@@ -4642,6 +5442,11 @@ static t_offset sim_vhd_disk_size (FILE *f)
 return (t_offset)-1;
 }
 
+static FILE *sim_vhd_disk_fixed_file (FILE *f)
+{
+return NULL;
+}
+
 static t_stat sim_vhd_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
 *sectsread = 0;
@@ -5605,6 +6410,17 @@ VHDHANDLE hVHD = (VHDHANDLE)f;
 return (t_offset)(NtoHll (hVHD->Footer.CurrentSize));
 }
 
+/* The underlying file of a fixed VHD, whose data starts at offset 0 */
+
+static FILE *sim_vhd_disk_fixed_file (FILE *f)
+{
+VHDHANDLE hVHD = (VHDHANDLE)f;
+
+if ((NULL == hVHD) || (NtoHl (hVHD->Footer.DiskType) != VHD_DT_Fixed))
+    return NULL;
+return hVHD->File;
+}
+
 
 #include <stdlib.h>
 #include <time.h>
@@ -6734,6 +7550,18 @@ struct disk_test_coverage {
     uint32 *data;
     };
 
+#if defined (SIM_ASYNCH_IO)
+static uint32 disk_test_completions;
+static t_stat disk_test_status;
+
+static void sim_disk_test_io_complete (UNIT *uptr, t_stat status)
+{
+++disk_test_completions;
+if (status != SCPE_OK)
+    disk_test_status = status;
+}
+#endif
+
 static t_stat sim_disk_test_exercise (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
@@ -6832,6 +7660,141 @@ if (!(uptr->flags & UNIT_RO)) { /* Only test drives open Read/Write - Read Only
             r = SCPE_IERR;
             }
         }
+#if defined (SIM_ASYNCH_IO)
+    if ((r == SCPE_OK) && sim_asynch_enabled && (c->total_sectors >= 4)) { /* Several asynchronous reads outstanding at once */
+        const uint32 requests = 4;
+        t_seccnt sectors_per_request = c->max_xfer_sectors / requests;
+        t_seccnt sectors_read[4];
+        uint32 i, j, waits;
+
+        sim_disk_set_async (uptr, 0);
+        if ((t_lba)(sectors_per_request * requests) > c->total_sectors)
+            sectors_per_request = (t_seccnt)(c->total_sectors / requests);
+        memset (c->data, 0, sectors_per_request * requests * ctx->sector_size);
+        disk_test_completions = 0;
+        disk_test_status = SCPE_OK;
+        for (i = 0; i < requests; i++)
+            sim_disk_rdsect_a (uptr, i * sectors_per_request, 
+                               (uint8 *)(c->data + i * sectors_per_request * uint32s_per_sector), 
+                               &sectors_read[i], sectors_per_request, sim_disk_test_io_complete);
+        for (waits = 0; (disk_test_completions < requests) && (waits < 10000); waits++) {
+            AIO_UPDATE_QUEUE;
+            if (disk_test_completions < requests)
+                sim_os_ms_sleep (1);
+            }
+        sim_cancel (uptr);
+        sim_disk_clr_async (uptr);
+        if ((disk_test_completions != requests) || (disk_test_status != SCPE_OK)) {
+            sim_printf ("Asynchronous reads: %u of %u completed - %s\n", disk_test_completions, requests, sim_error_text (disk_test_status));
+            r = SCPE_IERR;
+            }
+        for (i = 0; (i < requests * sectors_per_request * uint32s_per_sector) && (r == SCPE_OK); i++) {
+            j = i / uint32s_per_sector;
+            if ((sectors_read[j / sectors_per_request] != sectors_per_request) || (c->data[i] != j)) {
+                sim_printf ("Asynchronous read of sector %u(0x%X) returned unexpected data at offset 0x%X: 0x%08X\n", 
+                            j, j, i % uint32s_per_sector, c->data[i]);
+                r = SCPE_IERR;
+                }
+            }
+        if (r == SCPE_OK)
+            sim_printf("Asynchronous Reading OK\n");
+        }
+#endif
+    if ((r == SCPE_OK) && (c->total_sectors >= 2 * DISK_CACHE_MIN_BLOCKS)) { /* Write back sector cache smaller than the data */
+        uint32 saved_cache = uptr->disk_cache;
+        uint32 saved_dynflags = uptr->dynflags;
+        t_seccnt sectors = 2 * DISK_CACHE_MIN_BLOCKS;
+        t_seccnt sectors_read = 0, sectors_written = 0;
+        t_uint64 hits = 0;
+        t_lba lba;
+        uint32 i;
+
+        uptr->disk_cache = (DISK_CACHE_MIN_BLOCKS * ctx->sector_size) / 1024;
+        uptr->dynflags |= UNIT_DISK_CACHE_WB;
+        r = _disk_cache_apply (uptr);
+        for (lba = sectors; (lba-- > 0) && (r == SCPE_OK); ) { /* complement each sector, in reverse order */
+            for (i = 0; i < uint32s_per_sector; i++)
+                c->data[i] = ~lba;
+            r = sim_disk_wrsect (uptr, lba, (uint8 *)c->data, &sectors_written, 1);
+            }
+        if (r == SCPE_OK)
+            r = sim_disk_rdsect (uptr, 0, (uint8 *)c->data, &sectors_read, sectors);
+        for (i = 0; (i < sectors * uint32s_per_sector) && (r == SCPE_OK); i++) {
+            if ((sectors_read != sectors) || (c->data[i] != ~(i / uint32s_per_sector))) {
+                sim_printf ("Cached read of sector %u returned unexpected data: 0x%08X\n", i / uint32s_per_sector, c->data[i]);
+                r = SCPE_IERR;
+                }
+            }
+        for (i = 0; i < sectors * uint32s_per_sector; i++)  /* restore original contents */
+            c->data[i] = i / uint32s_per_sector;
+        if (r == SCPE_OK)
+            r = sim_disk_wrsect (uptr, 0, (uint8 *)c->data, &sectors_written, sectors);
+        if (ctx->cache)
+            hits = ctx->cache->read_hits;
+        uptr->disk_cache = saved_cache;
+        uptr->dynflags = (uptr->dynflags & ~UNIT_DISK_CACHE_WB) | (saved_dynflags & UNIT_DISK_CACHE_WB);
+        if (SCPE_OK != _disk_cache_apply (uptr))        /* write back and release */
+            r = SCPE_IERR;
+        if ((r == SCPE_OK) && (hits != DISK_CACHE_MIN_BLOCKS)) {
+            sim_printf ("Sector cache read hits: %u, expected %u\n", (uint32)hits, DISK_CACHE_MIN_BLOCKS);
+            r = SCPE_IERR;
+            }
+        memset (c->data, 0, sectors * ctx->sector_size);
+        if (r == SCPE_OK)
+            r = _sim_disk_rdsect_container (uptr, 0, (uint8 *)c->data, &sectors_read, sectors);
+        for (i = 0; (i < sectors * uint32s_per_sector) && (r == SCPE_OK); i++) {
+            if (c->data[i] != i / uint32s_per_sector) {
+                sim_printf ("Written back sector %u contains unexpected data: 0x%08X\n", i / uint32s_per_sector, c->data[i]);
+                r = SCPE_IERR;
+                }
+            }
+        if (r == SCPE_OK)
+            sim_printf("Sector Cache OK\n");
+        }
+#if defined (SIM_DISK_MMAP)
+    if ((r == SCPE_OK) &&                               /* Memory mapped container access */
+        ((DK_GET_FMT (uptr) == DKUF_F_STD) || 
+         ((DK_GET_FMT (uptr) == DKUF_F_VHD) && sim_vhd_disk_fixed_file (uptr->fileref)))) {
+        t_seccnt sectors = (c->total_sectors < c->max_xfer_sectors) ? (t_seccnt)c->total_sectors : c->max_xfer_sectors;
+        t_seccnt sectors_read = 0, sectors_written = 0;
+        uint32 i;
+
+        r = _disk_map_attach (uptr);
+        if ((r == SCPE_OK) && !_disk_map_covers (uptr, 0, sectors, TRUE)) {
+            sim_printf ("Memory mapping doesn't cover the first %u sectors\n", sectors);
+            r = SCPE_IERR;
+            }
+        for (i = 0; i < sectors * uint32s_per_sector; i++)
+            c->data[i] = ~(i / uint32s_per_sector);
+        if (r == SCPE_OK)
+            r = sim_disk_wrsect (uptr, 0, (uint8 *)c->data, &sectors_written, sectors);
+        memset (c->data, 0, sectors * ctx->sector_size);
+        if (r == SCPE_OK)
+            r = sim_disk_rdsect (uptr, 0, (uint8 *)c->data, &sectors_read, sectors);
+        for (i = 0; (i < sectors * uint32s_per_sector) && (r == SCPE_OK); i++) {
+            if ((sectors_read != sectors) || (c->data[i] != ~(i / uint32s_per_sector))) {
+                sim_printf ("Memory mapped read of sector %u returned unexpected data: 0x%08X\n", i / uint32s_per_sector, c->data[i]);
+                r = SCPE_IERR;
+                }
+            }
+        for (i = 0; i < sectors * uint32s_per_sector; i++)  /* restore original contents */
+            c->data[i] = i / uint32s_per_sector;
+        if (r == SCPE_OK)
+            r = sim_disk_wrsect (uptr, 0, (uint8 *)c->data, &sectors_written, sectors);
+        _disk_map_detach (uptr);
+        memset (c->data, 0, sectors * ctx->sector_size);
+        if (r == SCPE_OK)
+            r = sim_disk_rdsect (uptr, 0, (uint8 *)c->data, &sectors_read, sectors);
+        for (i = 0; (i < sectors * uint32s_per_sector) && (r == SCPE_OK); i++) {
+            if (c->data[i] != i / uint32s_per_sector) {
+                sim_printf ("Memory mapped write of sector %u wrote unexpected data: 0x%08X\n", i / uint32s_per_sector, c->data[i]);
+                r = SCPE_IERR;
+                }
+            }
+        if (r == SCPE_OK)
+            sim_printf("Memory Mapped Access OK\n");
+        }
+#endif
     if (r == SCPE_OK) { /* If still good, then do EOF and beyond boundary test */
         t_offset current_unit_size = ((t_offset)uptr->capac)*ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? ctx->sector_size : 1);
         t_seccnt sectors_read, sectors_to_read;
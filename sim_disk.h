@@ -65,6 +65,13 @@ typedef uint32          t_lba;                          /* disk logical block ad
 
 #define DKSE_OK         0                               /* no error */
 
+/* Sector cache settings (sim_disk_set_cache val) */
+
+#define DKCACHE_OFF             0                       /* no sector cache */
+#define DKCACHE_ON              1                       /* sector cache {=size} */
+#define DKCACHE_WRITEBACK       2                       /* defer container writes */
+#define DKCACHE_WRITETHROUGH    3                       /* write container immediately */
+
 typedef void (*DISK_PCALLBACK)(UNIT *unit, t_stat status);
 
 /* Prototypes */
@@ -114,6 +121,8 @@ t_stat sim_disk_set_fmt (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_disk_show_fmt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat sim_disk_set_capac (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_disk_show_capac (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat sim_disk_set_cache (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat sim_disk_show_cache (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat sim_disk_set_asynch (UNIT *uptr, int latency);
 t_stat sim_disk_clr_asynch (UNIT *uptr);
 t_stat sim_disk_reset (UNIT *uptr);
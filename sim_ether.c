@@ -1923,6 +1923,9 @@ _eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine);
 static void
 _eth_error(ETH_DEV* dev, const char* where);
 
+static t_stat
+_eth_close_port(int eth_api, pcap_t *pcap, SOCKET pcap_fd);
+
 #if defined(HAVE_SLIRP_NETWORK)
 static void _slirp_callback (void *opaque, const unsigned char *buf, int len)
 {
@@ -1935,6 +1938,104 @@ _eth_callback((u_char *)opaque, &header, buf);
 #endif
 
 #if defined (USE_READER_THREAD)
+/* Packet rings
+
+   Received packets are passed from the reader thread to the simulator
+   thread, and packets to be transmitted from the simulator thread to the
+   writer thread, through rings of packet buffers which are allocated when
+   the device is opened.  A packet is built in place in the next free
+   buffer of a ring and published by advancing the ring's tail; the
+   consumer uses it in place and releases it by advancing the head.  The
+   producer only writes the tail and the consumer only writes the head, so
+   neither needs a lock.  When the receive ring is full, the new packet is
+   dropped and counted as lost.  A packet to transmit is never dropped:
+   when the transmit ring is full, it is queued, along with any which
+   follow it, in an allocated overflow queue under the writer lock, and
+   the writer thread sends that queue once the ring has been emptied.
+
+   Loopback responses are transmitted from the reader thread, so the
+   transmit ring has two producers which serialize on the writer lock.
+*/
+
+#if defined (AIO_MEMORY_BARRIER)
+#define ETH_RING_BARRIER AIO_MEMORY_BARRIER
+#else
+static pthread_mutex_t _eth_ring_fence = PTHREAD_MUTEX_INITIALIZER;
+#define ETH_RING_BARRIER                                \
+    do {                                                \
+      pthread_mutex_lock (&_eth_ring_fence);            \
+      pthread_mutex_unlock (&_eth_ring_fence);          \
+      } while (0)
+#endif
+
+static t_stat _eth_ring_init (ETH_RING *ring, uint32 size)
+{
+memset (ring, 0, sizeof (*ring));
+ring->pool = (ETH_PACK *)calloc (size, sizeof (*ring->pool));
+if (ring->pool == NULL)
+  return SCPE_MEM;
+ring->size = size;
+return SCPE_OK;
+}
+
+static void _eth_ring_destroy (ETH_RING *ring)
+{
+free (ring->pool);
+memset (ring, 0, sizeof (*ring));
+}
+
+/* Producer: next free buffer, or NULL if the ring is full */
+
+static ETH_PACK *_eth_ring_fill (ETH_RING *ring)
+{
+if ((ring->pool == NULL) || (ETH_RING_COUNT (ring) >= ring->size)) {
+  ++ring->loss;
+  return NULL;
+  }
+return &ring->pool[ring->tail & (ring->size - 1)];
+}
+
+/* Producer: publish the buffer returned by _eth_ring_fill */
+
+static void _eth_ring_commit (ETH_RING *ring)
+{
+uint32 count;
+
+ETH_RING_BARRIER;                       /* contents visible before the buffer is */
+ring->tail = ring->tail + 1;
+count = ETH_RING_COUNT (ring);
+if (count > ring->high)
+  ring->high = count;
+}
+
+/* Consumer: oldest published buffer, or NULL if the ring is empty */
+
+static ETH_PACK *_eth_ring_next (ETH_RING *ring)
+{
+if (ETH_RING_COUNT (ring) == 0)
+  return NULL;
+ETH_RING_BARRIER;                       /* contents read after the buffer is seen */
+return &ring->pool[ring->head & (ring->size - 1)];
+}
+
+/* Consumer: return the buffer returned by _eth_ring_next to the producer */
+
+static void _eth_ring_release (ETH_RING *ring)
+{
+ETH_RING_BARRIER;                       /* contents used before the buffer is reused */
+ring->head = ring->head + 1;
+}
+
+#if defined (USE_BPF)
+/* Consumer: discard all published buffers */
+
+static void _eth_ring_flush (ETH_RING *ring)
+{
+ETH_RING_BARRIER;
+ring->head = ring->tail;
+}
+#endif
+
 static void *
 _eth_reader(void *arg)
 {
@@ -2091,9 +2192,7 @@ while (dev->handle) {
     if ((status > 0) && (dev->asynch_io)) {
       int wakeup_needed;
 
-      pthread_mutex_lock (&dev->lock);
-      wakeup_needed = (dev->read_queue.count != 0);
-      pthread_mutex_unlock (&dev->lock);
+      wakeup_needed = (ETH_RING_COUNT (&dev->read_ring) != 0);
       if (wakeup_needed) {
         sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
         sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
@@ -2122,11 +2221,29 @@ sim_debug(dev->dbit, dev->dptr, "Reader Thread Exiting\n");
 return NULL;
 }
 
+/* Delay the next transmission if packets are being sent in a burst */
+
+static void _eth_write_throttle (ETH_DEV* dev)
+{
+uint32 packet_delta_time;
+
+if (dev->throttle_delay == ETH_THROT_DISABLED_DELAY)
+  return;
+packet_delta_time = sim_os_msec() - dev->throttle_packet_time;
+dev->throttle_events <<= 1;
+dev->throttle_events += (packet_delta_time < dev->throttle_time) ? 1 : 0;
+if ((dev->throttle_events & dev->throttle_mask) == dev->throttle_mask) {
+  sim_os_ms_sleep (dev->throttle_delay);
+  ++dev->throttle_count;
+  }
+dev->throttle_packet_time = sim_os_msec();
+}
+
 static void *
 _eth_writer(void *arg)
 {
 ETH_DEV* volatile dev = (ETH_DEV*)arg;
-ETH_WRITE_REQUEST *request = NULL;
+ETH_PACK *request;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which in general won't be readily yielding the processor when 
@@ -2137,39 +2254,37 @@ sim_debug(dev->dbit, dev->dptr, "Writer Thread Starting\n");
 
 pthread_mutex_lock (&dev->writer_lock);
 while (dev->handle) {
-  pthread_cond_wait (&dev->writer_cond, &dev->writer_lock);
-  while (NULL != (request = dev->write_requests)) {
+  if ((ETH_RING_COUNT (&dev->write_ring) == 0) && (dev->write_overflow == NULL)) {
+    pthread_cond_wait (&dev->writer_cond, &dev->writer_lock);
+    continue;
+    }
+  pthread_mutex_unlock (&dev->writer_lock);
+  while (NULL != (request = _eth_ring_next (&dev->write_ring))) {
     if (dev->handle == NULL)      /* Shutting down? */
       break;
-    /* Pull buffer off request list */
-    dev->write_requests = request->next;
-    pthread_mutex_unlock (&dev->writer_lock);
 
-    if (dev->throttle_delay != ETH_THROT_DISABLED_DELAY) {
-      uint32 packet_delta_time = sim_os_msec() - dev->throttle_packet_time;
-      dev->throttle_events <<= 1;
-      dev->throttle_events += (packet_delta_time < dev->throttle_time) ? 1 : 0;
-      if ((dev->throttle_events & dev->throttle_mask) == dev->throttle_mask) {
-        sim_os_ms_sleep (dev->throttle_delay);
-        ++dev->throttle_count;
-        }
-      dev->throttle_packet_time = sim_os_msec();
-      }
-    dev->write_status = _eth_write(dev, &request->packet, NULL);
+    _eth_write_throttle (dev);
+    dev->write_status = _eth_write(dev, request, NULL);
 
+    /* Return buffer to the ring */
+    _eth_ring_release (&dev->write_ring);
+    }
+  pthread_mutex_lock (&dev->writer_lock);
+  /* Packets which overflowed the ring follow everything in it */
+  while (dev->handle && (ETH_RING_COUNT (&dev->write_ring) == 0) && dev->write_overflow) {
+    ETH_WRITE_REQUEST *overflow = dev->write_overflow;
+
+    dev->write_overflow = overflow->next;
+    if (dev->write_overflow == NULL)
+      dev->write_overflow_last = NULL;
+    --dev->write_overflow_count;
+    pthread_mutex_unlock (&dev->writer_lock);
+    _eth_write_throttle (dev);
+    dev->write_status = _eth_write(dev, &overflow->packet, NULL);
+    free (overflow);
     pthread_mutex_lock (&dev->writer_lock);
-    /* Put buffer on free buffer list */
-    request->next = dev->write_buffers;
-    dev->write_buffers = request;
-    request = NULL;
     }
   }
-/* If we exited these loops with a request allocated, */
-/* avoid buffer leaking by putting it on free buffer list */
-if (request) {
-  request->next = dev->write_buffers;
-  dev->write_buffers = request;
-  }
 pthread_mutex_unlock (&dev->writer_lock);
 
 sim_debug(dev->dbit, dev->dptr, "Writer Thread Exiting\n");
@@ -2188,9 +2303,7 @@ int wakeup_needed;
 
 dev->asynch_io = 1;
 dev->asynch_io_latency = latency;
-pthread_mutex_lock (&dev->lock);
-wakeup_needed = (dev->read_queue.count != 0);
-pthread_mutex_unlock (&dev->lock);
+wakeup_needed = (ETH_RING_COUNT (&dev->read_ring) != 0);
 if (wakeup_needed) {
   sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
   sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
@@ -2585,7 +2698,17 @@ dev->dbit = dbit;
 if (1) {
   pthread_attr_t attr;
 
-  ethq_init (&dev->read_queue, 200);         /* initialize FIFO queue */
+  if ((_eth_ring_init (&dev->read_ring, ETH_READ_RING_SIZE) != SCPE_OK) ||
+      (_eth_ring_init (&dev->write_ring, ETH_WRITE_RING_SIZE) != SCPE_OK)) {
+    _eth_ring_destroy (&dev->read_ring);
+    _eth_ring_destroy (&dev->write_ring);
+    _eth_close_port (dev->eth_api, (pcap_t *)dev->handle, dev->fd_handle);
+    free (dev->name);
+    eth_zero (dev);
+    return sim_messagef (SCPE_MEM, "Eth: can't allocate packet buffers\n");
+    }
+  dev->write_overflow = dev->write_overflow_last = NULL;
+  dev->write_overflow_count = dev->write_overflow_high = 0;
   pthread_mutex_init (&dev->lock, NULL);
   pthread_mutex_init (&dev->writer_lock, NULL);
   pthread_mutex_init (&dev->self_lock, NULL);
@@ -2664,23 +2787,23 @@ dev->have_host_nic_phy_addr = 0;
 #if defined (USE_READER_THREAD)
 pthread_join (dev->reader_thread, NULL);
 pthread_mutex_destroy (&dev->lock);
+pthread_mutex_lock (&dev->writer_lock);
 pthread_cond_signal (&dev->writer_cond);
+pthread_mutex_unlock (&dev->writer_lock);
 pthread_join (dev->writer_thread, NULL);
 pthread_mutex_destroy (&dev->self_lock);
 pthread_mutex_destroy (&dev->writer_lock);
 pthread_cond_destroy (&dev->writer_cond);
-if (1) {
-  ETH_WRITE_REQUEST *buffer;
-   while (NULL != (buffer = dev->write_buffers)) {
-    dev->write_buffers = buffer->next;
-    free(buffer);
-    }
-  while (NULL != (buffer = dev->write_requests)) {
-    dev->write_requests = buffer->next;
-    free(buffer);
-    }
+_eth_ring_destroy (&dev->write_ring);    /* release packet buffers */
+_eth_ring_destroy (&dev->read_ring);
+while (dev->write_overflow) {            /* and any unsent overflow */
+  ETH_WRITE_REQUEST *overflow = dev->write_overflow;
+
+  dev->write_overflow = overflow->next;
+  free (overflow);
   }
-ethq_destroy (&dev->read_queue);         /* release FIFO queue */
+dev->write_overflow_last = NULL;
+dev->write_overflow_count = 0;
 #endif
 
 _eth_close_port (dev->eth_api, pcap, pcap_fd);
@@ -3114,8 +3237,8 @@ return ((status == 0) ? SCPE_OK : SCPE_IOERR);
 t_stat eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
 {
 #ifdef USE_READER_THREAD
-ETH_WRITE_REQUEST *request;
-int write_queue_size = 1;
+ETH_PACK *request;
+t_stat status;
 
 /* make sure device exists */
 if ((!dev) || (dev->eth_api == ETH_API_NONE)) return SCPE_UNATT;
@@ -3123,48 +3246,51 @@ if ((!dev) || (dev->eth_api == ETH_API_NONE)) return SCPE_UNATT;
 if (packet->len > sizeof (packet->msg)) /* packet ovesized? */
     return SCPE_IERR;                   /* that's no good! */
 
-/* Get a buffer */
+/* Build the packet in the next transmit buffer (the ring keeps packets */
+/* in the order they were presented here) and awaken the writer thread. */
+/* Once the ring has filled, packets are queued behind it in allocated */
+/* buffers until the writer thread has sent everything ahead of them */
 pthread_mutex_lock (&dev->writer_lock);
-if (NULL != (request = dev->write_buffers))
-  dev->write_buffers = request->next;
-pthread_mutex_unlock (&dev->writer_lock);
-if (NULL == request)
-  request = (ETH_WRITE_REQUEST *)malloc(sizeof(*request));
-
-/* Copy buffer contents */
-request->packet.len = packet->len;
-request->packet.used = packet->used;
-request->packet.status = packet->status;
-request->packet.crc_len = packet->crc_len;
-memcpy(request->packet.msg, packet->msg, packet->len);
-
-/* Insert buffer at the end of the write list (to make sure that */
-/* packets make it to the wire in the order they were presented here) */
-pthread_mutex_lock (&dev->writer_lock);
-request->next = NULL;
-if (dev->write_requests) {
-  ETH_WRITE_REQUEST *last_request = dev->write_requests;
-
-  ++write_queue_size;
-  while (last_request->next) {
-    last_request = last_request->next;
-    ++write_queue_size;
-    }
-  last_request->next = request;
+status = dev->write_status;             /* status from some prior write */
+if ((dev->write_overflow == NULL) &&
+    (ETH_RING_COUNT (&dev->write_ring) < dev->write_ring.size)) {
+  request = _eth_ring_fill (&dev->write_ring);
+  request->len = packet->len;
+  request->used = packet->used;
+  request->status = packet->status;
+  request->crc_len = packet->crc_len;
+  memcpy(request->msg, packet->msg, packet->len);
+  _eth_ring_commit (&dev->write_ring);
   }
-else
-    dev->write_requests = request;
-if (write_queue_size > dev->write_queue_peak)
-  dev->write_queue_peak = write_queue_size;
-pthread_mutex_unlock (&dev->writer_lock);
+else {
+  ETH_WRITE_REQUEST *overflow = (ETH_WRITE_REQUEST *)malloc (sizeof (*overflow));
 
-/* Awaken writer thread to perform actual write */
+  if (overflow == NULL) {
+    pthread_mutex_unlock (&dev->writer_lock);
+    return SCPE_MEM;
+    }
+  overflow->next = NULL;
+  overflow->packet.oversize = NULL;
+  overflow->packet.len = packet->len;
+  overflow->packet.used = packet->used;
+  overflow->packet.status = packet->status;
+  overflow->packet.crc_len = packet->crc_len;
+  memcpy(overflow->packet.msg, packet->msg, packet->len);
+  if (dev->write_overflow_last)
+    dev->write_overflow_last->next = overflow;
+  else
+    dev->write_overflow = overflow;
+  dev->write_overflow_last = overflow;
+  if (++dev->write_overflow_count > dev->write_overflow_high)
+    dev->write_overflow_high = dev->write_overflow_count;
+  }
 pthread_cond_signal (&dev->writer_cond);
+pthread_mutex_unlock (&dev->writer_lock);
 
 /* Return with a status from some prior write */
 if (routine)
-  (routine)(dev->write_status);
-return dev->write_status;
+  (routine)(status);
+return status;
 #else
 return _eth_write(dev, packet, routine);
 #endif
@@ -3766,34 +3892,34 @@ if (bpf_used ? to_me : (to_me && !from_me)) {
     return;  
 #if defined (USE_READER_THREAD)
   if (1) {
-    int crc_len = 0;
-    uint8 crc_data[4];
+    ETH_PACK *pack = _eth_ring_fill (&dev->read_ring);
     uint32 len = header->len;
-    u_char *moved_data = NULL;
 
-    if (header->len < ETH_MIN_PACKET) {   /* Pad runt packets before CRC append */
-      moved_data = (u_char *)malloc(ETH_MIN_PACKET);
-      memcpy(moved_data, data, len);
-      memset(moved_data + len, 0, ETH_MIN_PACKET-len);
+    if (pack == NULL) {                   /* No free buffer? */
+      eth_packet_trace (dev, data, len, "rcv dropped - queue full");
+      return;
+      }
+    /* Build the packet in place in the receive buffer */
+    memcpy(pack->msg, data, len);
+    if (len < ETH_MIN_PACKET) {           /* Pad runt packets before CRC append */
+      memset(&pack->msg[len], 0, ETH_MIN_PACKET-len);
       len = ETH_MIN_PACKET;
-      data = moved_data;
       }
 
     /* If necessary, fix IP header checksums for packets originated locally */
     /* but were presumed to be traversing a NIC which was going to handle that task */
     /* This must be done before any needed CRC calculation */
-    _eth_fix_ip_xsum_offload(dev, (const u_char*)data, len);
-    
-    if (dev->need_crc)
-      crc_len = eth_get_packet_crc32_data(data, len, crc_data);
+    _eth_fix_ip_xsum_offload(dev, pack->msg, len);
 
-    eth_packet_trace (dev, data, len, "rcvqd");
+    pack->len = len;
+    pack->used = 0;
+    pack->status = 0;
+    pack->crc_len = (dev->need_crc) ? eth_add_packet_crc32(pack->msg, len) : 0;
 
-    pthread_mutex_lock (&dev->lock);
-    ethq_insert_data(&dev->read_queue, ETH_ITM_NORMAL, data, 0, len, crc_len, crc_data, 0);
+    eth_packet_trace (dev, pack->msg, len, "rcvqd");
+
+    _eth_ring_commit (&dev->read_ring);
     ++dev->packets_received;
-    pthread_mutex_unlock (&dev->lock);
-    free(moved_data);
     }
 #else /* !USE_READER_THREAD */
   /* set data in passed read packet */
@@ -3931,16 +4057,17 @@ if (status < 0) {
 #else /* USE_READER_THREAD */
 
   status = 0;
-  pthread_mutex_lock (&dev->lock);
-  if (dev->read_queue.count > 0) {
-    ETH_ITEM* item = &dev->read_queue.item[dev->read_queue.head];
-    packet->len = item->packet.len;
-    packet->crc_len = item->packet.crc_len;
-    memcpy(packet->msg, item->packet.msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
-    status = 1;
-    ethq_remove(&dev->read_queue);
-  }
-  pthread_mutex_unlock (&dev->lock);  
+  if (1) {
+    ETH_PACK *pack = _eth_ring_next (&dev->read_ring);
+
+    if (pack) {
+      packet->len = pack->len;
+      packet->crc_len = pack->crc_len;
+      memcpy(packet->msg, pack->msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
+      status = 1;
+      _eth_ring_release (&dev->read_ring);
+      }
+    }
   if ((status) && (routine))
     routine(0);
 #endif
@@ -4206,9 +4333,7 @@ if (dev->eth_api == ETH_API_PCAP) {
     pcap_freecode(&bpf);
     }
 #ifdef USE_READER_THREAD
-  pthread_mutex_lock (&dev->lock);
-  ethq_clear (&dev->read_queue); /* Empty FIFO Queue when filter list changes */
-  pthread_mutex_unlock (&dev->lock);
+  _eth_ring_flush (&dev->read_ring); /* Empty receive ring when filter list changes */
 #endif
   }
 #endif /* USE_BPF */
@@ -4257,10 +4382,15 @@ if (dev->asynch_io)
   fprintf(st, "  Interrupt Latency:       %d uSec\n", dev->asynch_io_latency);
 if (dev->throttle_count)
   fprintf(st, "  Throttle Delays:         %d\n", dev->throttle_count);
-fprintf(st, "  Read Queue: Count:       %d\n", dev->read_queue.count);
-fprintf(st, "  Read Queue: High:        %d\n", dev->read_queue.high);
-fprintf(st, "  Read Queue: Loss:        %d\n", dev->read_queue.loss);
-fprintf(st, "  Peak Write Queue Size:   %d\n", dev->write_queue_peak);
+fprintf(st, "  Read Queue: Size:        %d\n", (int)dev->read_ring.size);
+fprintf(st, "  Read Queue: Count:       %d\n", (int)ETH_RING_COUNT (&dev->read_ring));
+fprintf(st, "  Read Queue: High:        %d\n", (int)dev->read_ring.high);
+fprintf(st, "  Read Queue: Loss:        %d\n", (int)dev->read_ring.loss);
+fprintf(st, "  Write Queue: Size:       %d\n", (int)dev->write_ring.size);
+fprintf(st, "  Write Queue: Count:      %d\n", (int)ETH_RING_COUNT (&dev->write_ring));
+fprintf(st, "  Write Queue: High:       %d\n", (int)dev->write_ring.high);
+fprintf(st, "  Write Queue: Overflow:   %d\n", (int)dev->write_overflow_count);
+fprintf(st, "  Write Queue: Ovfl High:  %d\n", (int)dev->write_overflow_high);
 #endif
 if (dev->error_needs_reset)
   fprintf(st, "  In Error Needs Reset:    True\n");
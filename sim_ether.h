@@ -247,6 +247,25 @@ typedef void (*ETH_PCALLBACK)(int status);
 typedef struct eth_list ETH_LIST;
 typedef struct eth_queue ETH_QUE;
 typedef struct eth_item ETH_ITEM;
+
+/* Packet ring between a reader or writer thread and the simulator thread.
+   The packet buffers are allocated when the device is opened and are filled
+   and drained in place; head is only advanced by the consumer and tail only
+   by the producer. */
+struct eth_ring {
+  uint32              size;                             /* buffers in pool (power of 2) */
+  volatile uint32     head;                             /* next buffer to consume */
+  volatile uint32     tail;                             /* next buffer to fill */
+  uint32              high;                             /* peak depth */
+  uint32              loss;                             /* packets dropped, ring full */
+  ETH_PACK*           pool;                             /* packet buffers */
+};
+typedef struct eth_ring ETH_RING;
+#define ETH_RING_COUNT(r)     ((uint32)((r)->tail - (r)->head))
+#define ETH_READ_RING_SIZE    256                       /* received packet buffers */
+#define ETH_WRITE_RING_SIZE   256                       /* transmit packet buffers */
+
+/* Packet to transmit which didn't fit in a full transmit ring */
 struct eth_write_request {
   struct eth_write_request *next;
   ETH_PACK packet;
@@ -313,16 +332,18 @@ struct eth_device {
 #if defined (USE_READER_THREAD)
   int           asynch_io;                              /* Asynchronous Interrupt scheduling enabled */
   int           asynch_io_latency;                      /* instructions to delay pending interrupt */
-  ETH_QUE       read_queue;
+  ETH_RING      read_ring;                              /* received packets */
   pthread_mutex_t     lock;
   pthread_t     reader_thread;                          /* Reader Thread Id */
   pthread_t     writer_thread;                          /* Writer Thread Id */
   pthread_mutex_t     writer_lock;
   pthread_mutex_t     self_lock;
   pthread_cond_t      writer_cond;
-  ETH_WRITE_REQUEST *write_requests;
-  int write_queue_peak;
-  ETH_WRITE_REQUEST *write_buffers;
+  ETH_RING      write_ring;                             /* packets to transmit */
+  ETH_WRITE_REQUEST*  write_overflow;                   /* packets queued behind a full ring */
+  ETH_WRITE_REQUEST*  write_overflow_last;              /* last packet in the overflow queue */
+  uint32        write_overflow_count;                   /* packets in the overflow queue */
+  uint32        write_overflow_high;                    /* peak overflow queue depth */
   t_stat write_status;
 #endif
 };
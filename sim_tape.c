@@ -86,6 +86,7 @@
    sim_tape_show_capac  show tape capacity
    sim_tape_set_dens    set tape density
    sim_tape_show_dens   show tape density
+   sim_tape_set_index   enable or disable the record index sidecar file
    sim_tape_error_text  the textual description of a tape status
    sim_tape_set_async   enable asynchronous operation
    sim_tape_clr_async   disable asynchronous operation
@@ -100,6 +101,9 @@
 #if defined SIM_ASYNCH_IO
 #include <pthread.h>
 #endif
+#if !defined (_WIN32)
+#include <fcntl.h>
+#endif
 
 static struct sim_tape_fmt {
     const char          *name;                          /* name */
@@ -139,11 +143,30 @@ static t_addr sim_tape_tpc_fnd (UNIT *uptr, t_addr *map);
 static void sim_tape_data_trace (UNIT *uptr, const uint8 *data, size_t len, const char* txt, int detail, uint32 reason);
 static t_stat tape_erase_fwd (UNIT *uptr, t_mtrlnt gap_size);
 static t_stat tape_erase_rev (UNIT *uptr, t_mtrlnt gap_size);
+static void _sim_tape_index_load (UNIT *uptr);
+static void _sim_tape_index_free (UNIT *uptr);
+static void _sim_tape_index_truncate (UNIT *uptr, t_addr pos);
+static t_bool _sim_tape_index_sprecsf (UNIT *uptr, uint32 count, uint32 *skipped, t_stat *st);
+static t_bool _sim_tape_index_sprecsr (UNIT *uptr, uint32 count, uint32 *skipped, t_stat *st);
+static void _sim_tape_stream_init (UNIT *uptr);
+static void _sim_tape_readahead (UNIT *uptr);
 
 struct tape_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
     uint32              dbit;               /* debugging bit for trace */
     uint32              auto_format;        /* Format determined dynamically */
+    t_addr              *idx_pos;           /* Record index: object start positions (idx_count + 1 entries) */
+    uint32              *idx_tmk;           /* Record index: object numbers of the tape marks */
+    uint32              idx_count;          /* Record index: objects indexed */
+    uint32              idx_tmks;           /* Record index: tape marks indexed */
+    uint32              idx_size;           /* Record index: allocated position entries */
+    uint32              idx_tmk_size;       /* Record index: allocated tape mark entries */
+    t_bool              idx_done;           /* Record index: scan has stopped */
+    t_bool              idx_eom;            /* Record index: scan reached the end of medium */
+    t_bool              idx_saved;          /* Record index: sidecar file describes the image */
+    char                *stream_buf;        /* Host file stdio buffer */
+    t_addr              ra_start;           /* Host read ahead window start */
+    t_addr              ra_end;             /* Host read ahead window end */
 #if defined SIM_ASYNCH_IO
     t_bool              asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
@@ -613,6 +636,60 @@ if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
     fflush (uptr->fileref);
 }
 
+/* Image file streaming
+
+   Records are read and written one at a time, with a seek to the current
+   position before each, and the metadata and data of a record are separate
+   reads or writes.  The image file is given a large stdio buffer, so that
+   a run of records is read with a single host read, seeks within the
+   buffered data are free, and records being written are collected into
+   large sequential host writes.  Buffered records are written out when a
+   tape mark is written, when the tape is rewound, and when the simulator
+   stops or the unit is detached.
+
+   While records are being read forward, the host is also told which part
+   of the image will be read next, so that it can be brought into the host
+   file cache while the simulator works on the records already read.  With
+   asynchronous I/O enabled, this is done on the unit's I/O thread.
+*/
+
+#define TAPE_STREAM_SIZE    (256 * 1024)                /* image file stdio buffer */
+#define TAPE_READAHEAD_SIZE (4 * 1024 * 1024)           /* host read ahead window */
+
+static void _sim_tape_stream_init (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if ((MT_GET_FMT (uptr) >= MTUF_F_ANSI) || (uptr->fileref == NULL))
+    return;
+ctx->stream_buf = (char *)malloc (TAPE_STREAM_SIZE);
+if ((ctx->stream_buf != NULL) &&
+    (setvbuf (uptr->fileref, ctx->stream_buf, _IOFBF, TAPE_STREAM_SIZE) != 0)) {
+    free (ctx->stream_buf);                             /* keep the default buffer */
+    ctx->stream_buf = NULL;
+    }
+}
+
+static void _sim_tape_readahead (UNIT *uptr)
+{
+#if defined (POSIX_FADV_WILLNEED)
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_addr start = uptr->pos;
+
+if ((start >= ctx->ra_start) && (start < ctx->ra_end)) {/* within the window? */
+    if ((start + TAPE_READAHEAD_SIZE / 2) < ctx->ra_end)
+        return;                                         /* still well ahead */
+    start = ctx->ra_end;                                /* extend the window */
+    }
+else
+    ctx->ra_start = start;                              /* start a new window */
+if ((t_addr)(off_t)start != start)                      /* beyond host offsets? */
+    return;
+(void)posix_fadvise (fileno (uptr->fileref), (off_t)start, TAPE_READAHEAD_SIZE, POSIX_FADV_WILLNEED);
+ctx->ra_end = start + TAPE_READAHEAD_SIZE;
+#endif
+}
+
 static const char *_sim_tape_format_name (UNIT *uptr)
 {
 int32 f = MT_GET_FMT (uptr);
@@ -925,6 +1002,7 @@ uptr->tape_ctx = ctx = (struct tape_context *)calloc(1, sizeof(struct tape_conte
 ctx->dptr = dptr;                                       /* save DEVICE pointer */
 ctx->dbit = dbit;                                       /* save debug bit */
 ctx->auto_format = auto_format;                         /* save that we auto selected format */
+_sim_tape_stream_init (uptr);                           /* buffer the image file */
 
 switch (MT_GET_FMT (uptr)) {                            /* case on format */
 
@@ -957,6 +1035,8 @@ if (r == SCPE_OK) {
 
     sim_tape_rewind (uptr);
 
+    _sim_tape_index_load (uptr);
+
 #if defined (SIM_ASYNCH_IO)
     sim_tape_set_async (uptr, completion_delay);
 #endif
@@ -1024,6 +1104,9 @@ uptr->tape_eom = 0;
 uptr->pos = 0;
 MT_CLR_PNU (uptr);
 MT_CLR_INMRK (uptr);                                    /* Not within a TAR tapemark */
+_sim_tape_index_free (uptr);
+if (ctx)
+    free (ctx->stream_buf);                             /* file is closed, release its buffer */
 free (uptr->tape_ctx);
 uptr->tape_ctx = NULL;
 uptr->io_flush = NULL;
@@ -1939,6 +2022,7 @@ if (f < MTUF_F_ANSI) {
         uptr->pos = opos;
         return sim_tape_ioerr (uptr);
         }
+    _sim_tape_readahead (uptr);                         /* keep the host reading ahead */
     }
 else {
     MEMORY_TAPE *tape = (MEMORY_TAPE *)uptr->fileref;
@@ -2071,6 +2155,7 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
 if (sbc == 0)                                           /* nothing to do? */
     return MTSE_OK;
+_sim_tape_index_truncate (uptr, uptr->pos);             /* objects from here on change */
 if (sim_tape_seek (uptr, uptr->pos))                    /* set pos */
     return MTSE_IOERR;
 switch (f) {                                            /* case on format */
@@ -2129,6 +2214,7 @@ size_t   rdcnt;
 t_bool   replacing_record;
 
 memset (&awshdr, 0, sizeof (t_awshdr));
+_sim_tape_index_truncate (uptr, uptr->pos); /* objects from here on change */
 if (sim_tape_seek (uptr, uptr->pos))        /* set pos */
     return MTSE_IOERR;
 rdcnt = sim_fread (&awshdr, sizeof (t_awslnt), 3, uptr->fileref);
@@ -2177,6 +2263,7 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
+_sim_tape_index_truncate (uptr, uptr->pos);             /* objects from here on change */
 (void)sim_tape_seek (uptr, uptr->pos);                  /* set pos */
 (void)sim_fwrite (&dat, sizeof (t_mtrlnt), 1, uptr->fileref);
 if (ferror (uptr->fileref)) {                           /* error? */
@@ -2195,17 +2282,22 @@ return MTSE_OK;
 t_stat sim_tape_wrtmk (UNIT *uptr)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_stat st;
 
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_wrtmk(unit=%d)\n", (int)(uptr-ctx->dptr->units));
 if (MT_GET_FMT (uptr) == MTUF_F_P7B) {                  /* P7B? */
     uint8 buf = P7B_EOF;                                /* eof mark */
-    return sim_tape_wrrecf (uptr, &buf, 1);             /* write char */
+    st = sim_tape_wrrecf (uptr, &buf, 1);               /* write char */
     }
-if (MT_GET_FMT (uptr) == MTUF_F_AWS)                    /* AWS? */
-    return sim_tape_aws_wrdata (uptr, NULL, 0);
-return sim_tape_wrdata (uptr, MTR_TMK);
+else if (MT_GET_FMT (uptr) == MTUF_F_AWS)               /* AWS? */
+    st = sim_tape_aws_wrdata (uptr, NULL, 0);
+else
+    st = sim_tape_wrdata (uptr, MTR_TMK);
+if (st == MTSE_OK)
+    fflush (uptr->fileref);                             /* write out buffered records */
+return st;
 }
 
 t_stat sim_tape_wrtmk_a (UNIT *uptr, TAPE_PCALLBACK callback)
@@ -2232,6 +2324,7 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
 if (MT_GET_FMT (uptr) == MTUF_F_P7B)                    /* cant do P7B */
     return MTSE_FMT;
 if (MT_GET_FMT (uptr) == MTUF_F_AWS) {
+    _sim_tape_index_truncate (uptr, uptr->pos);         /* the remainder is discarded */
     sim_set_fsize (uptr->fileref, uptr->pos);
     result = MTSE_OK;
     }
@@ -2426,6 +2519,8 @@ else if (sim_tape_wrp (uptr))                           /* otherwise if the unit
 else if (gap_size == 0 || format != MTUF_F_STD)         /* otherwise if zero length or gaps aren't supported */
     return MTSE_OK;                                     /*   then take no action */
 
+_sim_tape_index_truncate (uptr, uptr->pos);             /* the gap replaces the objects from here on */
+
 file_size = sim_fsize (uptr->fileref);                  /* get the file size */
 
 if (sim_tape_seek (uptr, uptr->pos)) {                  /* position the tape; if it fails */
@@ -2628,6 +2723,8 @@ else if ((gap_size == 0) || (format != MTUF_F_STD))     /* otherwise if the gap
 
 gap_pos = uptr->pos;                                    /* save the starting position */
 
+_sim_tape_index_truncate (uptr, (gap_pos > gap_size) ? gap_pos - gap_size : 0);   /* the gap replaces the preceding objects */
+
 if (gap_size == meta_size) {                            /* if the request is for a single metadatum */
     if (sim_tape_bot (uptr))                            /*   then if the unit is positioned at the BOT */
         return MTSE_BOT;                                /*     then erasing backward is not possible */
@@ -2859,7 +2956,7 @@ return r;
 t_stat sim_tape_sprecsf (UNIT *uptr, uint32 count, uint32 *skipped)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
-t_stat st;
+t_stat st = MTSE_OK;
 t_mtrlnt tbc;
 
 *skipped = 0;
@@ -2867,6 +2964,8 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsf(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
+if (_sim_tape_index_sprecsf (uptr, count, skipped, &st))/* done using the record index? */
+    return st;
 while (*skipped < count) {                              /* loopo */
     st = sim_tape_sprecf (uptr, &tbc);                  /* spc rec */
     if (st != MTSE_OK)
@@ -2956,7 +3055,7 @@ return r;
 t_stat sim_tape_sprecsr (UNIT *uptr, uint32 count, uint32 *skipped)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
-t_stat st;
+t_stat st = MTSE_OK;
 t_mtrlnt tbc;
 
 *skipped = 0;
@@ -2964,6 +3063,8 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsr(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
+if (_sim_tape_index_sprecsr (uptr, count, skipped, &st))/* done using the record index? */
+    return st;
 while (*skipped < count) {                              /* loopo */
     st = sim_tape_sprecr (uptr, &tbc);                  /* spc rec rev */
     if (st != MTSE_OK)
@@ -3210,6 +3311,8 @@ if (uptr->flags & UNIT_ATT) {
     }
 uptr->pos = 0;
 if (uptr->flags & UNIT_ATT) {
+    if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
+        fflush (uptr->fileref);                         /* write out buffered records */
     (void)sim_tape_seek (uptr, uptr->pos);
     }
 MT_CLR_PNU (uptr);
@@ -3472,6 +3575,412 @@ free (recbuf);
 return objc;
 }
 
+/* Tape record index
+
+   Spacing over records and files reads the metadata of every object between
+   the starting and the final tape position.  For the SIMH, E11 and AWS
+   formats, the first request to space over more than one record builds a
+   table of the starting position of every object on the tape, and later space
+   requests (including the file spacing and sim_tape_position routines, which
+   are layered on sim_tape_sprecsf and sim_tape_sprecsr) are resolved with a
+   binary search of the table and a single seek.
+
+   The table covers the image from the beginning of tape up to the end of
+   medium, or up to the first object whose extent isn't exactly its metadata
+   and data (an erase gap or an invalid record).  Spacing beyond the indexed
+   objects proceeds record by record.  A write discards the indexed objects
+   which begin at or after the written position; the table is extended again
+   when it is next needed.
+
+   When enabled with SET <unit> INDEX, a complete table of a large image is
+   saved in a sidecar file (the image file name with ".idx" appended) which
+   also records the image size and modification time.  Attaching the
+   unchanged image later loads the table rather than building it again.  The
+   sidecar is deleted the first time the image is written.  No sidecar is
+   created for an image attached read only or write locked.
+*/
+
+#define TAPE_IDX_EXT        ".idx"                      /* sidecar file name extension */
+#define TAPE_IDX_MAGIC      "SIMHTIDX"                  /* sidecar file signature */
+#define TAPE_IDX_MAGIC_LEN  8
+#define TAPE_IDX_VERSION    1
+#define TAPE_IDX_MIN_SAVE   1024                        /* fewest objects worth a sidecar file */
+#define TAPE_IDX_ALLOC      4096                        /* initial table entries */
+
+static t_bool _sim_tape_index_supported (UNIT *uptr)
+{
+uint32 f = MT_GET_FMT (uptr);
+
+return ((f == MTUF_F_STD) || (f == MTUF_F_E11) || (f == MTUF_F_AWS));
+}
+
+static void _sim_tape_index_name (UNIT *uptr, char *name, size_t size)
+{
+strlcpy (name, uptr->filename, size);
+strlcat (name, TAPE_IDX_EXT, size);
+}
+
+static void _sim_tape_index_free (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx == NULL)
+    return;
+free (ctx->idx_pos);
+free (ctx->idx_tmk);
+ctx->idx_pos = NULL;
+ctx->idx_tmk = NULL;
+ctx->idx_count = ctx->idx_tmks = 0;
+ctx->idx_size = ctx->idx_tmk_size = 0;
+ctx->idx_done = ctx->idx_eom = ctx->idx_saved = FALSE;
+}
+
+/* Append an object ending at next_pos to the table */
+
+static t_bool _sim_tape_index_add (struct tape_context *ctx, t_addr next_pos, t_bool tape_mark)
+{
+if (ctx->idx_count + 1 == ctx->idx_size) {
+    t_addr *pos = (t_addr *)realloc (ctx->idx_pos, 2 * ctx->idx_size * sizeof (*pos));
+
+    if (pos == NULL)
+        return FALSE;
+    ctx->idx_pos = pos;
+    ctx->idx_size = 2 * ctx->idx_size;
+    }
+if (tape_mark) {
+    if (ctx->idx_tmks == ctx->idx_tmk_size) {
+        uint32 size = (ctx->idx_tmk_size == 0) ? TAPE_IDX_ALLOC : 2 * ctx->idx_tmk_size;
+        uint32 *tmk = (uint32 *)realloc (ctx->idx_tmk, size * sizeof (*tmk));
+
+        if (tmk == NULL)
+            return FALSE;
+        ctx->idx_tmk = tmk;
+        ctx->idx_tmk_size = size;
+        }
+    ctx->idx_tmk[ctx->idx_tmks++] = ctx->idx_count;
+    }
+ctx->idx_pos[++ctx->idx_count] = next_pos;
+return TRUE;
+}
+
+/* Save a complete table in the sidecar file */
+
+static void _sim_tape_index_save (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+char name[CBUFSIZE];
+struct stat statb;
+uint32 hdr[5];
+t_offset image[2];
+FILE *f;
+
+if ((!(uptr->dynflags & UNIT_TAPE_IDX)) || sim_tape_wrp (uptr) ||
+    (!ctx->idx_eom) || (ctx->idx_count < TAPE_IDX_MIN_SAVE) ||
+    (fstat (fileno (uptr->fileref), &statb) != 0))
+    return;
+_sim_tape_index_name (uptr, name, sizeof (name));
+f = fopen (name, "wb");
+if (f == NULL) {
+    sim_debug_unit (MTSE_DBG_POS, uptr, "index: can't create %s - %s\n", name, strerror (errno));
+    return;
+    }
+hdr[0] = TAPE_IDX_VERSION;
+hdr[1] = MT_GET_FMT (uptr);
+hdr[2] = sizeof (t_addr);
+hdr[3] = ctx->idx_count;
+hdr[4] = ctx->idx_tmks;
+image[0] = sim_fsize_ex (uptr->fileref);
+image[1] = (t_offset)statb.st_mtime;
+(void)fwrite (TAPE_IDX_MAGIC, 1, TAPE_IDX_MAGIC_LEN, f);
+(void)sim_fwrite (hdr, sizeof (hdr[0]), 5, f);
+(void)sim_fwrite (image, sizeof (image[0]), 2, f);
+(void)sim_fwrite (ctx->idx_pos, sizeof (t_addr), ctx->idx_count + 1, f);
+(void)sim_fwrite (ctx->idx_tmk, sizeof (uint32), ctx->idx_tmks, f);
+if (ferror (f)) {
+    fclose (f);
+    (void)remove (name);
+    return;
+    }
+fclose (f);
+ctx->idx_saved = TRUE;
+sim_debug_unit (MTSE_DBG_POS, uptr, "index: saved %u objects in %s\n", ctx->idx_count, name);
+}
+
+/* Load the table from a sidecar file which matches the attached image */
+
+static void _sim_tape_index_load (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+char name[CBUFSIZE];
+char magic[TAPE_IDX_MAGIC_LEN];
+struct stat statb;
+uint32 hdr[5];
+t_offset image[2];
+t_addr *pos = NULL;
+uint32 *tmk = NULL;
+uint32 i;
+t_bool ok;
+FILE *f;
+
+if ((ctx == NULL) || (!(uptr->dynflags & UNIT_TAPE_IDX)) ||
+    (!_sim_tape_index_supported (uptr)) ||
+    (fstat (fileno (uptr->fileref), &statb) != 0))
+    return;
+_sim_tape_index_name (uptr, name, sizeof (name));
+f = fopen (name, "rb");
+if (f == NULL)
+    return;
+ok = ((fread (magic, 1, sizeof (magic), f) == sizeof (magic)) &&
+      (memcmp (magic, TAPE_IDX_MAGIC, sizeof (magic)) == 0) &&
+      (sim_fread (hdr, sizeof (hdr[0]), 5, f) == 5) &&
+      (sim_fread (image, sizeof (image[0]), 2, f) == 2) &&
+      (hdr[0] == TAPE_IDX_VERSION) &&
+      (hdr[1] == (uint32)MT_GET_FMT (uptr)) &&
+      (hdr[2] == sizeof (t_addr)) &&
+      (hdr[4] <= hdr[3]) &&
+      (image[0] == sim_fsize_ex (uptr->fileref)) &&
+      (image[1] == (t_offset)statb.st_mtime));
+if (ok) {
+    pos = (t_addr *)malloc ((hdr[3] + 1) * sizeof (*pos));
+    tmk = (uint32 *)malloc ((hdr[4] + 1) * sizeof (*tmk));
+    ok = ((pos != NULL) && (tmk != NULL) &&
+          (sim_fread (pos, sizeof (t_addr), hdr[3] + 1, f) == hdr[3] + 1) &&
+          (sim_fread (tmk, sizeof (uint32), hdr[4], f) == hdr[4]) &&
+          (pos[0] == 0) && ((t_offset)pos[hdr[3]] <= image[0]));
+    for (i = 0; ok && (i < hdr[3]); i++)                /* positions must ascend */
+        ok = (pos[i] < pos[i + 1]);
+    for (i = 0; ok && (i < hdr[4]); i++)                /* as must the tape marks */
+        ok = (tmk[i] < hdr[3]) && ((i == 0) || (tmk[i - 1] < tmk[i]));
+    }
+fclose (f);
+if (!ok) {
+    free (pos);
+    free (tmk);
+    sim_debug_unit (MTSE_DBG_POS, uptr, "index: ignoring stale or invalid %s\n", name);
+    return;
+    }
+_sim_tape_index_free (uptr);
+ctx->idx_pos = pos;
+ctx->idx_tmk = tmk;
+ctx->idx_count = hdr[3];
+ctx->idx_tmks = hdr[4];
+ctx->idx_size = hdr[3] + 1;
+ctx->idx_tmk_size = hdr[4] + 1;
+ctx->idx_done = ctx->idx_eom = ctx->idx_saved = TRUE;
+sim_debug_unit (MTSE_DBG_POS, uptr, "index: loaded %u objects, %u tape marks from %s\n", ctx->idx_count, ctx->idx_tmks, name);
+}
+
+/* Enable (val = 1) or disable (val = 0) the sidecar file of a unit */
+
+t_stat sim_tape_set_index (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+struct tape_context *ctx;
+
+if (uptr == NULL)
+    return SCPE_IERR;
+if (cptr != NULL)
+    return SCPE_ARG;
+if (val == 0) {
+    uptr->dynflags &= ~UNIT_TAPE_IDX;
+    return SCPE_OK;
+    }
+uptr->dynflags |= UNIT_TAPE_IDX;
+ctx = (struct tape_context *)uptr->tape_ctx;
+if ((ctx != NULL) && (uptr->flags & UNIT_ATT) && ctx->idx_eom && !ctx->idx_saved)
+    _sim_tape_index_save (uptr);                        /* save an already complete table */
+return SCPE_OK;
+}
+
+/* Extend the table by scanning forward from the last indexed object (to EOM) */
+
+static void _sim_tape_index_extend (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 f = MT_GET_FMT (uptr);
+t_addr saved_pos = uptr->pos;
+t_addr saved_eom = uptr->tape_eom;
+uint32 saved_pnu = uptr->dynflags & UNIT_TAPE_PNU;
+t_addr start, size;
+t_mtrlnt bc, sbc;
+t_stat st;
+
+if (ctx->idx_pos == NULL) {
+    ctx->idx_pos = (t_addr *)malloc (TAPE_IDX_ALLOC * sizeof (*ctx->idx_pos));
+    if (ctx->idx_pos == NULL) {
+        ctx->idx_done = TRUE;
+        return;
+        }
+    ctx->idx_size = TAPE_IDX_ALLOC;
+    ctx->idx_count = ctx->idx_tmks = 0;
+    ctx->idx_pos[0] = 0;
+    }
+uptr->pos = ctx->idx_pos[ctx->idx_count];
+while (1) {
+    start = uptr->pos;
+    st = sim_tape_rdlntf (uptr, &bc);
+    if ((st != MTSE_OK) && (st != MTSE_TMK)) {
+        ctx->idx_eom = ((st == MTSE_EOM) && (uptr->pos == start));
+        break;
+        }
+    sbc = MTR_L (bc);
+    if (f == MTUF_F_AWS)
+        size = sizeof (t_awshdr) + sbc;
+    else if (st == MTSE_TMK)
+        size = sizeof (t_mtrlnt);
+    else
+        size = 2 * sizeof (t_mtrlnt) + ((f == MTUF_F_STD) ? ((sbc + 1) & ~1) : sbc);
+    if ((uptr->pos - start != size) ||                  /* erase gap or other irregularity? */
+        ((st == MTSE_TMK) && (sbc != 0)) ||
+        (!_sim_tape_index_add (ctx, uptr->pos, (st == MTSE_TMK))))
+        break;                                          /* the index ends here */
+    }
+ctx->idx_done = TRUE;
+uptr->pos = saved_pos;
+uptr->tape_eom = saved_eom;
+uptr->dynflags = (uptr->dynflags & ~UNIT_TAPE_PNU) | saved_pnu;
+(void)sim_tape_seek (uptr, uptr->pos);
+sim_debug_unit (MTSE_DBG_POS, uptr, "index: %u objects, %u tape marks indexed through pos: %" T_ADDR_FMT "u%s\n",
+                ctx->idx_count, ctx->idx_tmks, ctx->idx_pos[ctx->idx_count], ctx->idx_eom ? " (EOM)" : "");
+if (ctx->idx_eom && !ctx->idx_saved)
+    _sim_tape_index_save (uptr);
+}
+
+/* Discard the objects which don't end at or before a write position */
+
+static void _sim_tape_index_truncate (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 lo, hi, mid;
+
+if (ctx == NULL)
+    return;
+if (ctx->idx_saved) {                                   /* sidecar no longer describes the image */
+    char name[CBUFSIZE];
+
+    _sim_tape_index_name (uptr, name, sizeof (name));
+    (void)remove (name);
+    ctx->idx_saved = FALSE;
+    }
+ctx->idx_done = ctx->idx_eom = FALSE;
+if (ctx->idx_pos == NULL)
+    return;
+for (lo = 0, hi = ctx->idx_count; lo < hi; ) {          /* find the last object starting at or before pos */
+    mid = hi - (hi - lo) / 2;
+    if (ctx->idx_pos[mid] <= pos)
+        lo = mid;
+    else
+        hi = mid - 1;
+    }
+ctx->idx_count = lo;
+while ((ctx->idx_tmks > 0) && (ctx->idx_tmk[ctx->idx_tmks - 1] >= lo))
+    --ctx->idx_tmks;
+}
+
+/* Locate the current position in the table, extending it first if needed.
+   Returns TRUE with the object number starting at the current position and
+   the number of tape marks which precede it. */
+
+static t_bool _sim_tape_index_locate (UNIT *uptr, uint32 count, uint32 *obj, uint32 *tmks)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 lo, hi, mid;
+
+if ((ctx == NULL) || (count == 0) || !_sim_tape_index_supported (uptr))
+    return FALSE;
+if ((!ctx->idx_done) && (count > 1) &&                  /* multiple record space beyond the table? */
+    ((ctx->idx_pos == NULL) || (uptr->pos >= ctx->idx_pos[ctx->idx_count])))
+    _sim_tape_index_extend (uptr);
+if (ctx->idx_pos == NULL)
+    return FALSE;
+for (lo = 0, hi = ctx->idx_count; lo < hi; ) {          /* find the first object starting at or after pos */
+    mid = lo + (hi - lo) / 2;
+    if (ctx->idx_pos[mid] < uptr->pos)
+        lo = mid + 1;
+    else
+        hi = mid;
+    }
+if (ctx->idx_pos[lo] != uptr->pos)                      /* not at an object boundary? */
+    return FALSE;
+*obj = lo;
+for (lo = 0, hi = ctx->idx_tmks; lo < hi; ) {           /* count the tape marks before it */
+    mid = lo + (hi - lo) / 2;
+    if (ctx->idx_tmk[mid] < *obj)
+        lo = mid + 1;
+    else
+        hi = mid;
+    }
+*tmks = lo;
+return TRUE;
+}
+
+/* Space records forward with the index.
+
+   Returns TRUE with the operation status in st if the index completed the
+   operation.  Otherwise returns FALSE with the tape positioned at the end of
+   the indexed objects and the records spaced so far in skipped, and the
+   caller spaces the remaining records individually.
+*/
+
+static t_bool _sim_tape_index_sprecsf (UNIT *uptr, uint32 count, uint32 *skipped, t_stat *st)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 obj, tmks, next, recs;
+
+if (!_sim_tape_index_locate (uptr, count, &obj, &tmks) || (obj == ctx->idx_count))
+    return FALSE;
+next = (tmks < ctx->idx_tmks) ? ctx->idx_tmk[tmks] : ctx->idx_count;
+recs = next - obj;                                      /* records before the next tape mark */
+MT_CLR_PNU (uptr);
+if (count <= recs) {
+    *skipped = count;
+    uptr->pos = ctx->idx_pos[obj + count];
+    *st = MTSE_OK;
+    }
+else {
+    *skipped = recs;
+    if (next < ctx->idx_count) {                        /* stop after the tape mark */
+        uptr->pos = ctx->idx_pos[next + 1];
+        *st = MTSE_TMK;
+        }
+    else
+        uptr->pos = ctx->idx_pos[next];
+    }
+(void)sim_tape_seek (uptr, uptr->pos);
+sim_debug_unit (MTSE_DBG_POS, uptr, "index: spaced %u records forward to pos: %" T_ADDR_FMT "u\n", *skipped, uptr->pos);
+return ((count <= recs) || (next < ctx->idx_count));
+}
+
+/* Space records reverse with the index (as for _sim_tape_index_sprecsf) */
+
+static t_bool _sim_tape_index_sprecsr (UNIT *uptr, uint32 count, uint32 *skipped, t_stat *st)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 obj, tmks, prev, recs;
+
+if (MT_TST_PNU (uptr) ||                                /* the first reverse space just clears PNU */
+    !_sim_tape_index_locate (uptr, count, &obj, &tmks) || (obj == 0))
+    return FALSE;
+prev = (tmks > 0) ? ctx->idx_tmk[tmks - 1] + 1 : 0;
+recs = obj - prev;                                      /* records after the previous tape mark */
+if (count <= recs) {
+    *skipped = count;
+    uptr->pos = ctx->idx_pos[obj - count];
+    *st = MTSE_OK;
+    }
+else {
+    *skipped = recs;
+    if (tmks > 0) {                                     /* stop before the tape mark */
+        uptr->pos = ctx->idx_pos[prev - 1];
+        *st = MTSE_TMK;
+        }
+    else
+        uptr->pos = ctx->idx_pos[0];
+    }
+(void)sim_tape_seek (uptr, uptr->pos);
+sim_debug_unit (MTSE_DBG_POS, uptr, "index: spaced %u records reverse to pos: %" T_ADDR_FMT "u\n", *skipped, uptr->pos);
+return ((count <= recs) || (tmks > 0));
+}
+
 const char *sim_tape_error_text (t_stat stat)
 {
 const char *mtse_errors[] = {
@@ -4323,6 +4832,192 @@ return SCPE_OK;
 
 #include <setjmp.h>
 
+/* Build a tape of many small files and check that positioning through the
+   record index (built on first use and later loaded from the sidecar file)
+   lands on the expected records */
+
+#define IDX_TEST_FILES      40
+#define IDX_TEST_RECORDS    30
+
+static t_stat sim_tape_test_index_check (UNIT *uptr, uint32 file, uint32 record)
+{
+uint8 buf[128];
+t_mtrlnt bc;
+t_stat st;
+
+st = sim_tape_rdrecf (uptr, buf, &bc, sizeof (buf));
+if ((st != MTSE_OK) || (buf[0] != file) || (buf[1] != record))
+    return sim_messagef (SCPE_IERR, "Expected file %u record %u, got status %s file %u record %u\n",
+                                    file, record, sim_tape_error_text (st), buf[0], buf[1]);
+return SCPE_OK;
+}
+
+static t_stat sim_tape_test_index (UNIT *uptr, const char *format)
+{
+struct tape_context *ctx;
+char name[64], idx_name[80];
+char args[128];
+uint8 buf[128];
+uint32 file, record, skipped, recsskipped, objsskipped;
+uint32 trailer = (strcmp (format, "aws") == 0) ? 1 : 0;/* AWS writes a tape mark after the last object */
+uint32 objects = IDX_TEST_FILES * (IDX_TEST_RECORDS + 1) + 1 + trailer;
+t_stat st;
+FILE *f;
+
+sprintf (name, "TapeTestIndex.%s", format);
+sprintf (idx_name, "%s%s", name, TAPE_IDX_EXT);
+(void)remove (name);
+(void)remove (idx_name);
+sprintf (args, "%s %s", format, name);
+sim_tape_detach (uptr);
+sim_switches = SWMASK ('F') | SWMASK ('N');
+st = sim_tape_attach_ex (uptr, args, 0, 0);
+sim_switches = 0;
+if (st != SCPE_OK)
+    return st;
+for (file = 0; file < IDX_TEST_FILES; file++) {
+    for (record = 0; record < IDX_TEST_RECORDS; record++) {
+        memset (buf, (int)(file + record), sizeof (buf));
+        buf[0] = (uint8)file;
+        buf[1] = (uint8)record;
+        if (sim_tape_wrrecf (uptr, buf, 20 + ((7 * file + record) % 51)) != MTSE_OK)
+            return sim_messagef (SCPE_IERR, "Can't write %s\n", name);
+        }
+    sim_tape_wrtmk (uptr);
+    }
+sim_tape_wrtmk (uptr);
+sim_tape_detach (uptr);
+
+sim_tape_set_index (uptr, 1, NULL, NULL);
+sim_switches = SWMASK ('F') | SWMASK ('R');         /* no sidecar for a read only attach */
+st = sim_tape_attach_ex (uptr, args, 0, 0);
+sim_switches = 0;
+if (st != SCPE_OK)
+    return st;
+ctx = (struct tape_context *)uptr->tape_ctx;
+if ((sim_tape_spfilef (uptr, 100, &skipped) != MTSE_EOM) || (!ctx->idx_eom) || (ctx->idx_saved))
+    return sim_messagef (SCPE_IERR, "%s: read only space files forward to EOM failed\n", name);
+sim_tape_detach (uptr);
+f = fopen (idx_name, "rb");
+if (f != NULL) {
+    fclose (f);
+    return sim_messagef (SCPE_IERR, "%s: %s created for a read only attach\n", name, idx_name);
+    }
+
+sim_switches = SWMASK ('F');
+st = sim_tape_attach_ex (uptr, args, 0, 0);
+sim_switches = 0;
+if (st != SCPE_OK)
+    return st;
+ctx = (struct tape_context *)uptr->tape_ctx;
+sim_tape_rewind (uptr);
+if ((sim_tape_spfilef (uptr, 10, &skipped) != MTSE_OK) || (skipped != 10) ||
+    (sim_tape_test_index_check (uptr, 10, 0) != SCPE_OK))
+    return sim_messagef (SCPE_IERR, "%s: space 10 files forward failed\n", name);
+if ((ctx->idx_count != objects) || (!ctx->idx_eom) || (!ctx->idx_saved))
+    return sim_messagef (SCPE_IERR, "%s: index has %u objects, expected %u\n", name, ctx->idx_count, objects);
+if ((sim_tape_sprecsf (uptr, 5, &skipped) != MTSE_OK) || (skipped != 5) ||
+    (sim_tape_test_index_check (uptr, 10, 6) != SCPE_OK))
+    return sim_messagef (SCPE_IERR, "%s: space 5 records forward failed\n", name);
+if ((sim_tape_sprecsf (uptr, 1000, &skipped) != MTSE_TMK) || (skipped != IDX_TEST_RECORDS - 7) ||
+    (sim_tape_test_index_check (uptr, 11, 0) != SCPE_OK))
+    return sim_messagef (SCPE_IERR, "%s: space records forward to a tape mark failed\n", name);
+if ((sim_tape_sprecsr (uptr, 1000, &skipped) != MTSE_TMK) || (skipped != 1) ||
+    (sim_tape_sprecsr (uptr, 3, &skipped) != MTSE_OK) || (skipped != 3) ||
+    (sim_tape_test_index_check (uptr, 10, IDX_TEST_RECORDS - 3) != SCPE_OK))
+    return sim_messagef (SCPE_IERR, "%s: space records reverse failed\n", name);
+if ((sim_tape_spfiler (uptr, 3, &skipped) != MTSE_OK) || (skipped != 3) ||
+    (sim_tape_rdrecf (uptr, buf, &recsskipped, sizeof (buf)) != MTSE_TMK) ||
+    (sim_tape_test_index_check (uptr, 8, 0) != SCPE_OK))
+    return sim_messagef (SCPE_IERR, "%s: space 3 files reverse failed\n", name);
+if ((sim_tape_sprecsr (uptr, 10000, &skipped) != MTSE_TMK) || (skipped != 1) ||
+    (sim_tape_spfiler (uptr, 100, &skipped) != MTSE_BOT) || (skipped != 7) || (!sim_tape_bot (uptr)))
+    return sim_messagef (SCPE_IERR, "%s: space files reverse to BOT failed\n", name);
+if ((sim_tape_position (uptr, MTPOS_M_REW, 3, &recsskipped, 25, &skipped, &objsskipped) != MTSE_OK) ||
+    (skipped != 25) || (recsskipped != 3) ||
+    (sim_tape_test_index_check (uptr, 25, 3) != SCPE_OK))
+    return sim_messagef (SCPE_IERR, "%s: position to file 25 record 3 failed\n", name);
+if ((sim_tape_spfilef (uptr, 100, &skipped) != MTSE_EOM) || (skipped != IDX_TEST_FILES - 25 + 1 + trailer))
+    return sim_messagef (SCPE_IERR, "%s: space files forward to EOM failed\n", name);
+sim_tape_detach (uptr);
+
+sim_switches = SWMASK ('F');                        /* reattach and use the saved index */
+st = sim_tape_attach_ex (uptr, args, 0, 0);
+sim_switches = 0;
+if (st != SCPE_OK)
+    return st;
+ctx = (struct tape_context *)uptr->tape_ctx;
+if ((!ctx->idx_saved) || (ctx->idx_count != objects))
+    return sim_messagef (SCPE_IERR, "%s: index not loaded from %s\n", name, idx_name);
+if ((sim_tape_spfilef (uptr, IDX_TEST_FILES - 1, &skipped) != MTSE_OK) ||
+    (sim_tape_test_index_check (uptr, IDX_TEST_FILES - 1, 0) != SCPE_OK))
+    return sim_messagef (SCPE_IERR, "%s: space files forward with the loaded index failed\n", name);
+sim_tape_rewind (uptr);                             /* rewrite the second file */
+if ((sim_tape_spfilef (uptr, 1, &skipped) != MTSE_OK) ||
+    (sim_tape_wrrecf (uptr, buf, 40) != MTSE_OK) || (sim_tape_wrtmk (uptr) != MTSE_OK))
+    return sim_messagef (SCPE_IERR, "%s: rewriting the tape failed\n", name);
+f = fopen (idx_name, "rb");
+if (f != NULL)
+    fclose (f);
+if ((ctx->idx_saved) || (ctx->idx_count != IDX_TEST_RECORDS + 1) || (f != NULL))
+    return sim_messagef (SCPE_IERR, "%s: index not discarded when the tape was written\n", name);
+sim_tape_rewind (uptr);
+if ((sim_tape_spfilef (uptr, 2, &skipped) != MTSE_OK) || (skipped != 2) ||
+    (sim_tape_sprecsr (uptr, 10, &skipped) != MTSE_TMK) || (skipped != 0) ||
+    (sim_tape_sprecsr (uptr, 10, &skipped) != MTSE_TMK) || (skipped != 1))
+    return sim_messagef (SCPE_IERR, "%s: spacing over the rewritten file failed\n", name);
+sim_tape_detach (uptr);
+sim_tape_set_index (uptr, 0, NULL, NULL);
+(void)remove (name);
+(void)remove (idx_name);
+return SCPE_OK;
+}
+
+#define STREAM_TEST_RECORDS 200
+
+static t_stat sim_tape_test_stream (UNIT *uptr)
+{
+struct tape_context *ctx;
+const char *name = "TapeTestStream.tap";
+uint8 buf[128];
+uint32 record;
+t_mtrlnt bc;
+t_offset size = STREAM_TEST_RECORDS * (sizeof (buf) + 2 * sizeof (t_mtrlnt)) + sizeof (t_mtrlnt);
+t_stat st;
+
+(void)remove (name);
+sim_tape_detach (uptr);
+sim_switches = SWMASK ('F') | SWMASK ('N');
+st = sim_tape_attach_ex (uptr, "SIMH TapeTestStream.tap", 0, 0);
+sim_switches = 0;
+if (st != SCPE_OK)
+    return st;
+ctx = (struct tape_context *)uptr->tape_ctx;
+if (ctx->stream_buf == NULL)
+    return sim_messagef (SCPE_IERR, "%s: image file is not buffered\n", name);
+for (record = 0; record < STREAM_TEST_RECORDS; record++) {
+    memset (buf, (int)record, sizeof (buf));
+    if (sim_tape_wrrecf (uptr, buf, sizeof (buf)) != MTSE_OK)
+        return sim_messagef (SCPE_IERR, "Can't write %s\n", name);
+    }
+if ((sim_tape_wrtmk (uptr) != MTSE_OK) || (sim_fsize_name_ex (name) != size))
+    return sim_messagef (SCPE_IERR, "%s: records not written out at a tape mark\n", name);
+sim_tape_rewind (uptr);
+for (record = 0; record < STREAM_TEST_RECORDS; record++) {
+    st = sim_tape_rdrecf (uptr, buf, &bc, sizeof (buf));
+    if ((st != MTSE_OK) || (bc != sizeof (buf)) ||
+        (buf[0] != (uint8)record) || (buf[sizeof (buf) - 1] != (uint8)record))
+        return sim_messagef (SCPE_IERR, "%s: record %u read back incorrectly\n", name, record);
+    }
+if ((sim_tape_rdrecf (uptr, buf, &bc, sizeof (buf)) != MTSE_TMK) ||
+    (sim_tape_sprecsr (uptr, 10, &record) != MTSE_TMK) ||
+    (sim_tape_rdrecf (uptr, buf, &bc, sizeof (buf)) != MTSE_TMK))
+    return sim_messagef (SCPE_IERR, "%s: tape mark not read back\n", name);
+sim_tape_detach (uptr);
+(void)remove (name);
+return SCPE_OK;
+}
+
 t_stat sim_tape_test (DEVICE *dptr, const char *cptr)
 {
 int32 saved_switches = sim_switches;
@@ -4393,6 +5088,18 @@ SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1", "e11", 0
 sim_switches = saved_switches;
 SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1", "simh", 0));
 
+sim_switches = saved_switches;
+SIM_TEST(sim_tape_test_index (dptr->units, "simh"));
+
+sim_switches = saved_switches;
+SIM_TEST(sim_tape_test_index (dptr->units, "e11"));
+
+sim_switches = saved_switches;
+SIM_TEST(sim_tape_test_index (dptr->units, "aws"));
+
+sim_switches = saved_switches;
+SIM_TEST(sim_tape_test_stream (dptr->units));
+
 sim_switches = saved_switches;
 if ((sim_switches & SWMASK ('D')) == 0)
     SIM_TEST(sim_tape_test_remove_tape_files (dptr->units, "TapeTestFile1"));
@@ -230,6 +230,7 @@ t_stat sim_tape_set_capac (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_tape_show_capac (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat sim_tape_set_dens (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_tape_show_dens (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat sim_tape_set_index (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_tape_density_supported (char *string, size_t string_size, int32 valid_bits);
 const char *sim_tape_error_text (t_stat stat);
 t_stat sim_tape_set_asynch (UNIT *uptr, int latency);
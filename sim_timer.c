@@ -72,9 +72,13 @@
    sim_os_msec  -           return elapsed time in msec
    sim_os_sleep -           sleep specified number of seconds
    sim_os_ms_sleep -        sleep specified number of milliseconds
+   sim_os_us_sleep -        sleep specified number of microseconds
    sim_idle_ms_sleep -      sleep specified number of milliseconds
                             or until awakened by an asynchronous
                             event
+   sim_idle_us_sleep -      sleep specified number of microseconds
+                            or until awakened by an asynchronous
+                            event
    sim_timespec_diff        subtract two timespec values
    sim_timer_activate_after schedule unit for specific time
    sim_timer_activate_time  determine activation time
@@ -107,6 +111,7 @@
 #endif
 
 uint32 sim_idle_ms_sleep (unsigned int msec);
+uint32 sim_idle_us_sleep (uint32 usec);
 
 /* MS_MIN_GRANULARITY exists here so that timing behavior for hosts systems  */
 /* with slow clock ticks can be assessed and tested without actually having  */
@@ -170,6 +175,8 @@ double sim_time_at_sim_prompt =  0;                 /* time spent processing com
 static uint32 sim_idle_rate_ms = 0;                 /* Minimum Sleep time */
 static uint32 sim_os_sleep_min_ms = 0;
 static uint32 sim_os_sleep_inc_ms = 0;
+static uint32 sim_os_sleep_min_us = 0;              /* Minimum microsecond sleep, 0 if not measured */
+static t_bool sim_idle_tickless = FALSE;            /* Idle with microsecond waits */
 static uint32 sim_os_clock_resoluton_ms = 0;
 static uint32 sim_os_tick_hz = 0;
 static uint32 sim_idle_stable = SIM_IDLE_STDFLT;
@@ -323,13 +330,100 @@ sim_timespec_diff (&delta_time, &done_time, &start_time);
 delta_ms = (uint32)((delta_time.tv_sec * 1000) + ((delta_time.tv_nsec + 500000) / 1000000));
 return delta_ms;
 }
+
+uint32 sim_idle_us_sleep (uint32 usec)
+{
+struct timespec start_time, end_time, done_time, delta_time;
+t_bool timedout = FALSE;
+
+clock_gettime(CLOCK_REALTIME, &start_time);
+end_time = start_time;
+end_time.tv_sec += (usec/1000000);
+end_time.tv_nsec += 1000*(usec%1000000);
+if (end_time.tv_nsec >= 1000000000) {
+  end_time.tv_sec += end_time.tv_nsec/1000000000;
+  end_time.tv_nsec = end_time.tv_nsec%1000000000;
+  }
+pthread_mutex_lock (&sim_asynch_lock);
+sim_idle_wait = TRUE;
+if (pthread_cond_timedwait (&sim_asynch_wake, &sim_asynch_lock, &end_time))
+    timedout = TRUE;
+else
+    sim_asynch_check = 0;                 /* force check of asynch queue now */
+sim_idle_wait = FALSE;
+pthread_mutex_unlock (&sim_asynch_lock);
+clock_gettime(CLOCK_REALTIME, &done_time);
+if (!timedout) {
+    AIO_UPDATE_QUEUE;
+    }
+sim_timespec_diff (&delta_time, &done_time, &start_time);
+return (uint32)((delta_time.tv_sec * 1000000) + ((delta_time.tv_nsec + 500) / 1000));
+}
 #else
 uint32 sim_idle_ms_sleep (unsigned int msec)
 {
 return sim_os_ms_sleep (msec);
 }
+
+uint32 sim_idle_us_sleep (uint32 usec)
+{
+return sim_os_us_sleep (usec);
+}
+#endif
+
+/* Unit test of sim_idle_us_sleep: an undisturbed sleep lasts about the
+   requested time and, with asynchronous I/O, a signal of sim_asynch_wake
+   (as sim_activate from another thread does) ends the sleep early. */
+
+#define IDLE_TEST_SLEEP_US      20000                   /* undisturbed sleep */
+#define IDLE_TEST_WAKE_US       5000000                 /* sleep which gets woken */
+#define IDLE_TEST_WAKE_MAX_US   1000000                 /* longest acceptable woken sleep */
+
+#if defined(SIM_ASYNCH_IO)
+static void *_sim_idle_test_waker (void *arg)
+{
+uint32 start = sim_os_msec ();
+t_bool woke = FALSE;
+
+while ((!woke) && ((sim_os_msec () - start) < 2 * (IDLE_TEST_WAKE_US / 1000))) {
+    sim_os_ms_sleep (5);
+    pthread_mutex_lock (&sim_asynch_lock);
+    if (sim_idle_wait) {                                /* sleeper waiting? */
+        pthread_cond_signal (&sim_asynch_wake);         /* wake it */
+        woke = TRUE;
+        }
+    pthread_mutex_unlock (&sim_asynch_lock);
+    }
+return NULL;
+}
+#endif
+
+t_stat sim_timer_idle_sleep_test (void)
+{
+uint32 start, elapsed_ms, slept_us;
+#if defined(SIM_ASYNCH_IO)
+pthread_t waker;
 #endif
 
+start = sim_os_msec ();
+slept_us = sim_idle_us_sleep (IDLE_TEST_SLEEP_US);
+elapsed_ms = sim_os_msec () - start;
+if ((slept_us < (3 * IDLE_TEST_SLEEP_US) / 4) || (slept_us > 100 * IDLE_TEST_SLEEP_US) ||
+    (elapsed_ms < (3 * IDLE_TEST_SLEEP_US) / 4000))
+    return sim_messagef (SCPE_IERR, "sim_idle_us_sleep (%u) returned %u usecs after %u ms\n", IDLE_TEST_SLEEP_US, slept_us, elapsed_ms);
+#if defined(SIM_ASYNCH_IO)
+if (pthread_create (&waker, NULL, _sim_idle_test_waker, NULL) != 0)
+    return sim_messagef (SCPE_IERR, "Can't create idle test thread\n");
+start = sim_os_msec ();
+slept_us = sim_idle_us_sleep (IDLE_TEST_WAKE_US);
+elapsed_ms = sim_os_msec () - start;
+pthread_join (waker, NULL);
+if ((slept_us > IDLE_TEST_WAKE_MAX_US) || (elapsed_ms > IDLE_TEST_WAKE_MAX_US / 1000))
+    return sim_messagef (SCPE_IERR, "sim_idle_us_sleep (%u) wasn't woken early: %u usecs after %u ms\n", IDLE_TEST_WAKE_US, slept_us, elapsed_ms);
+#endif
+return SCPE_OK;
+}
+
 /* Mark the need for the sim_os_set_thread_priority routine, */
 /* allowing the feature and/or platform dependent code to provide it */
 #define NEED_THREAD_PRIORITY
@@ -453,6 +547,11 @@ sys$waitfr (2);
 return sim_os_msec () - stime;
 }
 
+uint32 sim_os_us_sleep (uint32 usec)
+{
+return 1000 * sim_os_ms_sleep ((usec + 999) / 1000);
+}
+
 #ifdef NEED_CLOCK_GETTIME
 int clock_gettime(int clk_id, struct timespec *tp)
 {
@@ -524,6 +623,11 @@ Sleep (msec);
 return sim_os_msec () - stime;
 }
 
+uint32 sim_os_us_sleep (uint32 usec)
+{
+return 1000 * sim_os_ms_sleep ((usec + 999) / 1000);
+}
+
 #if defined(NEED_CLOCK_GETTIME)
 int clock_gettime(int clk_id, struct timespec *tp)
 {
@@ -603,6 +707,20 @@ treq.tv_nsec = (milliseconds % MILLIS_PER_SEC) * NANOS_PER_MILLI;
 return sim_os_msec () - stime;
 }
 
+uint32 sim_os_us_sleep (uint32 usec)
+{
+struct timeval start, done;
+struct timezone foo;
+struct timespec treq;
+
+gettimeofday (&start, &foo);
+treq.tv_sec = usec / 1000000;
+treq.tv_nsec = (usec % 1000000) * 1000;
+(void) nanosleep (&treq, NULL);
+gettimeofday (&done, &foo);
+return (uint32)(((done.tv_sec - start.tv_sec) * 1000000) + (done.tv_usec - start.tv_usec));
+}
+
 #if defined(NEED_THREAD_PRIORITY)
 #undef NEED_THREAD_PRIORITY
 #include <sys/time.h>
@@ -1123,6 +1241,8 @@ if (sim_idle_enab) {
     fprintf (st, "Idling:                         Enabled\n");
     fprintf (st, "Time before Idling starts:      %d seconds\n", sim_idle_stable);
     }
+if (sim_idle_tickless)
+    fprintf (st, "Tickless Idling:                Enabled, shortest wait %d usecs\n", sim_os_sleep_min_us);
 if (sim_throt_type != SIM_THROT_NONE) {
     sim_show_throt (st, NULL, uptr, val, desc);
     }
@@ -1368,6 +1488,27 @@ fprintf (st, "Calibrated Ticks%s", sim_catchup_ticks ? " with Catchup Ticks" : "
 return SCPE_OK;
 }
 
+/* Set/Clear tickless idling
+
+   The first time tickless idling is enabled, the shortest microsecond
+   sleep the host delivers is measured; shorter waits aren't idled.
+*/
+
+t_stat sim_timer_set_tickless (int32 flag, CONST char *cptr)
+{
+if (flag && (sim_os_sleep_min_us == 0)) {
+    uint32 i, tot = 0;
+
+    sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+    for (i = 0; i < sleep1Samples; ++i)
+        tot += sim_idle_us_sleep (1);
+    sim_os_set_thread_priority (PRIORITY_NORMAL);
+    sim_os_sleep_min_us = MAX (1, tot / sleep1Samples);
+    }
+sim_idle_tickless = (flag != 0);
+return SCPE_OK;
+}
+
 /* Set idle calibration threshold */
 
 t_stat sim_timer_set_idle_pct (int32 flag, CONST char *cptr)
@@ -1444,6 +1585,8 @@ static CTAB set_timer_tab[] = {
 #endif
     { "CATCHUP",    &sim_timer_set_catchup,  1 },
     { "NOCATCHUP",  &sim_timer_set_catchup,  0 },
+    { "TICKLESS",   &sim_timer_set_tickless, 1 },
+    { "NOTICKLESS", &sim_timer_set_tickless, 0 },
     { "CALIB",      &sim_timer_set_idle_pct, 0 },
     { "STOP",       &sim_timer_set_stop, 0 },
     { NULL, NULL, 0 }
@@ -1539,13 +1682,20 @@ return SCPE_OK;
 
    Or
         w = ms_to_wait / ms_per_wait
+
+   In tickless mode (SET CLOCK TICKLESS) the wait is computed and taken in
+   microseconds, so waits shorter than the host's millisecond sleep
+   granularity, such as the remainder of a 1ms simulated clock tick, can
+   still be idled.  The wait ends early if an asynchronous event arrives.
 */
 
 t_bool sim_idle (uint32 tmr, int sin_cyc)
 {
-uint32 w_ms, w_idle, act_ms;
+uint32 w_ms, w_us, w_idle, act_ms, act_us;
 int32 act_cyc;
 static t_bool in_nowait = FALSE;
+static uint32 idled_us = 0;                             /* idle usecs not yet counted in ms */
+t_bool tickless = sim_idle_tickless && (sim_os_sleep_min_us != 0);
 double cyc_since_idle;
 RTC *rtc = &rtcs[tmr];
 
@@ -1610,43 +1760,70 @@ if ((sim_idle_rate_ms == 0) || (sim_idle_cyc_ms == 0)) {/* not possible? */
     return FALSE;
     }
 w_ms = (uint32) sim_interval / sim_idle_cyc_ms;         /* ms to wait */
-/* When the host system has a clock tick which is less frequent than the    */
-/* simulated system's clock, idling will cause delays which will miss       */
-/* simulated clock ticks.  To accomodate this, and still allow idling, if   */
-/* the simulator acknowledges the processing of clock ticks, then catchup   */
-/* ticks can be used to make up for missed ticks. */
-if (rtc->clock_catchup_eligible)
-    w_idle = (sim_interval * 1000) / rtc->currd;        /* 1000 * pending fraction of tick */
-else
-    w_idle = (w_ms * 1000) / sim_idle_rate_ms;          /* 1000 * intervals to wait */
-if ((w_idle < 500) || (w_ms == 0)) {                    /* shorter than 1/2 the interval or */
-    sim_interval -= sin_cyc;                            /* minimal sleep time? */
-    if (!in_nowait)
-        sim_debug (DBG_IDL, &sim_timer_dev, "no wait, too short: %d usecs\n", w_idle);
-    in_nowait = TRUE;
-    return FALSE;
+w_us = (uint32) (((t_uint64) sim_interval * 1000) / sim_idle_cyc_ms);/* usecs to wait */
+if (tickless) {
+    if (w_us < sim_os_sleep_min_us) {                   /* shorter than the host can sleep? */
+        sim_interval -= sin_cyc;
+        if (!in_nowait)
+            sim_debug (DBG_IDL, &sim_timer_dev, "no wait, too short: %d usecs\n", w_us);
+        in_nowait = TRUE;
+        return FALSE;
+        }
+    }
+else {
+    /* When the host system has a clock tick which is less frequent than the    */
+    /* simulated system's clock, idling will cause delays which will miss       */
+    /* simulated clock ticks.  To accomodate this, and still allow idling, if   */
+    /* the simulator acknowledges the processing of clock ticks, then catchup   */
+    /* ticks can be used to make up for missed ticks. */
+    if (rtc->clock_catchup_eligible)
+        w_idle = (sim_interval * 1000) / rtc->currd;    /* 1000 * pending fraction of tick */
+    else
+        w_idle = (w_ms * 1000) / sim_idle_rate_ms;      /* 1000 * intervals to wait */
+    if ((w_idle < 500) || (w_ms == 0)) {                /* shorter than 1/2 the interval or */
+        sim_interval -= sin_cyc;                        /* minimal sleep time? */
+        if (!in_nowait)
+            sim_debug (DBG_IDL, &sim_timer_dev, "no wait, too short: %d usecs\n", w_idle);
+        in_nowait = TRUE;
+        return FALSE;
+        }
+    }
+if (w_ms > 1000) {                                      /* too long a wait (runaway calibration) */
+    if (tickless)                                       /* w_idle isn't computed when tickless */
+        sim_debug (DBG_TIK, &sim_timer_dev, "waiting too long: w_ms=%d msecs, w_us=%d usecs, sim_interval=%d, rtc->currd=%d\n", w_ms, w_us, sim_interval, rtc->currd);
+    else
+        sim_debug (DBG_TIK, &sim_timer_dev, "waiting too long: w_ms=%d msecs, w_idle=%d usecs, sim_interval=%d, rtc->currd=%d\n", w_ms, w_idle, sim_interval, rtc->currd);
     }
-if (w_ms > 1000)                                        /* too long a wait (runaway calibration) */
-    sim_debug (DBG_TIK, &sim_timer_dev, "waiting too long: w_ms=%d usecs, w_idle=%d usecs, sim_interval=%d, rtc->currd=%d\n", w_ms, w_idle, sim_interval, rtc->currd);
 in_nowait = FALSE;
 if (sim_clock_queue == QUEUE_LIST_END)
-    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d ms - pending event in %d %s\n", w_ms, sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d usecs - pending event in %d %s\n", tickless ? w_us : 1000 * w_ms, sim_interval, sim_vm_interval_units);
 else
-    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d ms - pending event on %s in %d %s\n", w_ms, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d usecs - pending event on %s in %d %s\n", tickless ? w_us : 1000 * w_ms, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
 cyc_since_idle = sim_gtime() - sim_idle_end_time;       /* time since prior idle */
-act_ms = sim_idle_ms_sleep (w_ms);                      /* wait */
-rtc->clock_time_idled += act_ms;
-act_cyc = act_ms * sim_idle_cyc_ms;
-if (cyc_since_idle > sim_idle_cyc_sleep)
-    act_cyc -= sim_idle_cyc_sleep / 2;                  /* account for half an interval's worth of cycles */
-else
-    act_cyc -= (int32)cyc_since_idle;                   /* acount for cycles executed */
+if (tickless) {
+    act_us = sim_idle_us_sleep (w_us);                  /* wait */
+    idled_us += act_us;
+    act_ms = idled_us / 1000;
+    idled_us = idled_us % 1000;
+    rtc->clock_time_idled += act_ms;
+    act_cyc = (int32) (((t_uint64) act_us * sim_idle_cyc_ms) / 1000);
+    }
+else {
+    act_ms = sim_idle_ms_sleep (w_ms);                  /* wait */
+    act_us = 1000 * act_ms;
+    rtc->clock_time_idled += act_ms;
+    act_cyc = act_ms * sim_idle_cyc_ms;
+    if (cyc_since_idle > sim_idle_cyc_sleep)
+        act_cyc -= sim_idle_cyc_sleep / 2;              /* account for half an interval's worth of cycles */
+    else
+        act_cyc -= (int32)cyc_since_idle;               /* acount for cycles executed */
+    }
 sim_interval = sim_interval - act_cyc;                  /* count down sim_interval to reflect idle period */
 sim_idle_end_time = sim_gtime();                        /* save idle completed time */
 if (sim_clock_queue == QUEUE_LIST_END)
-    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %d ms - pending event in %d %s\n", act_ms, sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %d usecs - pending event in %d %s\n", act_us, sim_interval, sim_vm_interval_units);
 else
-    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %d ms - pending event on %s in %d %s\n", act_ms, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
+    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %d usecs - pending event on %s in %d %s\n", act_us, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
 return TRUE;
 }
 
@@ -132,6 +132,7 @@ void sim_throt_cancel (void);
 uint32 sim_os_msec (void);
 void sim_os_sleep (unsigned int sec);
 uint32 sim_os_ms_sleep (unsigned int msec);
+uint32 sim_os_us_sleep (uint32 usec);
 uint32 sim_os_ms_sleep_init (void);
 void sim_start_timer_services (void);
 void sim_stop_timer_services (void);
@@ -153,6 +154,7 @@ void sim_timer_precalibrate_execution_rate (void);
 int32 sim_rtcn_tick_size (int32 tmr);
 int32 sim_rtcn_calibrated_tmr (void);
 t_bool sim_timer_idle_capable (uint32 *host_ms_sleep_1, uint32 *host_tick_ms);
+t_stat sim_timer_idle_sleep_test (void);
 #define PRIORITY_BELOW_NORMAL  -1
 #define PRIORITY_NORMAL         0
 #define PRIORITY_ABOVE_NORMAL   1
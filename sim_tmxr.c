@@ -343,6 +343,10 @@
 
 #include <ctype.h>
 #include <math.h>
+#if defined(__linux__) && !defined(DONT_USE_EPOLL)
+#define TMXR_EPOLL 1
+#include <sys/epoll.h>
+#endif
 
 /* Telnet protocol constants - negatives are for init'ing signed char data */
 
@@ -482,12 +486,71 @@ static u_char mantra[] = {                  /* Telnet Option Negotiation Mantra
 
 #define TMXR_LINE_DISABLED (-1)
 
+#if defined(SIM_ASYNCH_MUX) && defined(TMXR_EPOLL)
+static volatile uint32 tmxr_poll_gen = 0;               /* line descriptor changes (see _tmxr_poll) */
+#define TMXR_POLL_CHANGED ++tmxr_poll_gen
+#else
+#define TMXR_POLL_CHANGED
+#endif
+
 /* Local routines */
 static void tmxr_setup_framer(TMLN *line, ETH_PACK *packet, int len);
 static int  tmxr_framer_read (TMLN *line, char *buf, int nbytes);
 static int  tmxr_framer_write (TMLN *line, const char *buf, int32 length);
 
 static void tmxr_add_to_open_list (TMXR* mux);
+static void tmxr_evt_add_line (TMLN *lp);
+static void tmxr_evt_del_line (TMLN *lp);
+static void tmxr_evt_rescan (TMLN *lp);
+static void tmxr_evt_close (TMXR *mp);
+static void tmxr_tx_mark (TMLN *lp);
+static void tmxr_tx_close (TMXR *mp);
+
+/* Return the receive buffer size for a line.
+
+   A size given with RcvBuffer= for the line takes precedence over one given
+   for the multiplexer.  Otherwise buffered lines use the output buffer size
+   and unbuffered lines use the TMXR_RXBUF default.
+*/
+
+static int32 tmxr_rx_bufsize (TMLN *lp)
+{
+if (lp->rxbfsz)                                         /* line specific size? */
+    return lp->rxbfsz;
+if (lp->mp && lp->mp->rxbuffered)                       /* multiplexer size? */
+    return lp->mp->rxbuffered;
+return lp->txbfd ? lp->txbsz : TMXR_RXBUF;              /* buffered lines match output */
+}
+
+/* Receive buffer ring.
+
+   The receive buffer is a ring: tmxr_poll_rx inserts at rxbpi and
+   tmxr_getc_ln removes at rxbpr, each wrapping to zero at rxbsz, so a
+   line is refilled as soon as it has space rather than only once the
+   simulator has consumed all of its earlier input.  TMXR_GUARD bytes
+   are always left free, which keeps a full ring distinct from an empty
+   one.  Each read fills a contiguous free region, so newly received
+   data is never split by the wrap while Telnet commands are removed.
+   Datagram lines hold a single datagram and are only read when empty.
+*/
+
+static int32 tmxr_rx_count (const TMLN *lp)
+{
+return lp->rxbpi - lp->rxbpr + ((lp->rxbpi < lp->rxbpr) ? lp->rxbsz : 0);
+}
+
+static int32 tmxr_rx_space (TMLN *lp)
+{
+int32 space = lp->rxbsz - TMXR_GUARD - tmxr_rx_count (lp);  /* free, less the guard */
+int32 run;                                              /* contiguous free */
+
+if (lp->rxbpi >= lp->rxbpr)
+    run = lp->rxbsz - lp->rxbpi;
+else
+    run = lp->rxbpr - lp->rxbpi;
+return (run < space) ? run : space;
+}
+
 
 /* Initialize the line state.
 
@@ -514,7 +577,7 @@ if (lp->mp && (!lp->mp->buffered) && (!lp->txbfd)) {
     lp->txbfd = 0;
     lp->txbsz = TMXR_MAXBUF;
     lp->txb = (char *)realloc (lp->txb, lp->txbsz);
-    lp->rxbsz = TMXR_MAXBUF;
+    lp->rxbsz = tmxr_rx_bufsize (lp);
     lp->rxb = (char *)realloc(lp->rxb, lp->rxbsz);
     lp->rbr = (char *)realloc(lp->rbr, lp->rxbsz);
     }
@@ -790,22 +853,258 @@ return written;
 }
 
 
-/* Remove a character from the read buffer.
+/* Find the extent of received data needing no Telnet processing.
 
-   The character at position "p" in the read buffer associated with line "lp" is
-   removed by moving all of the following received characters down one position.
-   The receive break status array is adjusted accordingly.
+   Returns the number of characters, starting at position "p" in the read
+   buffer associated with line "lp", which precede the next IAC (or the next
+   CR when a CR pad character must be stripped).  The search is done with
+   memchr, which the C library implements with word-at-a-time or vector
+   comparisons, so ordinary data is passed over in bulk.
 */
 
-static void tmxr_rmvrc (TMLN *lp, int32 p)
+static int32 tmxr_clean_run (const TMLN *lp, int32 p)
 {
-for ( ; p < lp->rxbpi; p++) {                           /* work from "p" through end of buffer */
-    lp->rxb[p] = lp->rxb[p + 1];                        /* slide following character down */
-    lp->rbr[p] = lp->rbr[p + 1];                        /* adjust break status too */
+const char *start = &lp->rxb[p];
+size_t len = (size_t)(lp->rxbpi - p);
+const char *cp;
+
+cp = (const char *)memchr (start, TN_IAC, len);         /* find next IAC */
+if (cp)
+    len = (size_t)(cp - start);
+if (lp->dstb) {                                         /* CR pad stripping? */
+    cp = (const char *)memchr (start, TN_CR, len);      /* find next CR */
+    if (cp)
+        len = (size_t)(cp - start);
     }
+return (int32)len;
+}
+
+
+/* Remove Telnet protocol from newly received data
+
+   Inputs:
+        *lp     =       pointer to terminal line descriptor
+        j       =       receive buffer position of the new data
+   Outputs:     none
+
+   The new data is filtered in a single pass.  Characters which are kept are
+   compacted down to the insert point "w", so removing Telnet commands doesn't
+   move the rest of the buffer.  Runs of ordinary data are located with
+   tmxr_clean_run and copied as a block.
+*/
+
+static void tmxr_rx_telnet (TMLN *lp, int32 j)
+{
+int32 w = j;                                            /* filtered data insert point */
+
+while (j < lp->rxbpi) {                                 /* loop thru char */
+    u_char tmp;
+    t_bool keep = FALSE;                                /* assume char is removed */
 
-lp->rbr[p] = 0;                                         /* clear potential break from vacated slot */
-lp->rxbpi = lp->rxbpi - 1;                              /* drop buffer insert index */
+    if (lp->tsta == TNS_NORM) {                         /* normal? */
+        int32 run = tmxr_clean_run (lp, j);             /* length of plain data */
+
+        if (run > 0) {
+            if (w != j) {                               /* data moved? */
+                memmove (&lp->rxb[w], &lp->rxb[j], run);
+                memmove (&lp->rbr[w], &lp->rbr[j], run);
+                }
+            w = w + run;
+            j = j + run;
+            if (j == lp->rxbpi)                         /* all data examined? */
+                break;
+            }
+        }
+    tmp = (u_char)lp->rxb[j];                           /* get char */
+    switch (lp->tsta) {                                 /* case tlnt state */
+
+    case TNS_NORM:                                      /* normal */
+        if (tmp == TN_IAC) {                            /* IAC? */
+            lp->tsta = TNS_IAC;                         /* change state */
+            break;                                      /* remove char */
+            }
+        if ((tmp == TN_CR) && lp->dstb)                 /* CR, no bin */
+            lp->tsta = TNS_CRPAD;                       /* skip pad char */
+        keep = TRUE;
+        break;
+
+    case TNS_IAC:                                       /* IAC prev */
+        if (tmp == TN_IAC) {                            /* IAC + IAC */
+            lp->tsta = TNS_NORM;                        /* treat as normal */
+            keep = TRUE;                                /* keep IAC */
+            break;
+            }
+        if (tmp == TN_BRK) {                            /* IAC + BRK? */
+            lp->tsta = TNS_NORM;                        /* treat as normal */
+            lp->rxb[j] = 0;                             /* char is null */
+            lp->rbr[j] = 1;                             /* flag break */
+            keep = TRUE;
+            break;
+            }
+        switch (tmp) {
+        case TN_WILL:                                   /* IAC + WILL? */
+            lp->tsta = TNS_WILL;
+            break;
+        case TN_WONT:                                   /* IAC + WONT? */
+            lp->tsta = TNS_WONT;
+            break;
+        case TN_DO:                                     /* IAC + DO? */
+            lp->tsta = TNS_DO;
+            break;
+        case TN_DONT:                                   /* IAC + DONT? */
+            lp->tsta = TNS_SKIP;                        /* IAC + other */
+            break;
+        case TN_GA: case TN_EL:                         /* IAC + other 2 byte types */
+        case TN_EC: case TN_AYT:    
+        case TN_AO: case TN_IP:
+        case TN_NOP: 
+            lp->tsta = TNS_NORM;                        /* ignore */
+            break;
+        case TN_SB:                                     /* IAC + SB sub-opt negotiation */
+        case TN_DATAMK:                                 /* IAC + data mark */
+        case TN_SE:                                     /* IAC + SE sub-opt end */
+            lp->tsta = TNS_NORM;                        /* ignore */
+            break;
+            }
+        break;                                          /* remove char */
+
+    case TNS_WILL:                                      /* IAC+WILL prev */
+        if ((tmp == TN_STATUS) || 
+            (tmp == TN_TIMING) || 
+            (tmp == TN_NAOCRD) || 
+            (tmp == TN_NAOHTS) || 
+            (tmp == TN_NAOHTD) || 
+            (tmp == TN_NAOFFD) || 
+            (tmp == TN_NAOVTS) || 
+            (tmp == TN_NAOVTD) || 
+            (tmp == TN_NAOLFD) || 
+            (tmp == TN_EXTEND) || 
+            (tmp == TN_LOGOUT) || 
+            (tmp == TN_BM)     || 
+            (tmp == TN_DET)    || 
+            (tmp == TN_SENDLO) || 
+            (tmp == TN_TERMTY) || 
+            (tmp == TN_ENDREC) || 
+            (tmp == TN_TUID)   || 
+            (tmp == TN_OUTMRK) || 
+            (tmp == TN_TTYLOC) || 
+            (tmp == TN_3270)   || 
+            (tmp == TN_X3PAD)  || 
+            (tmp == TN_NAWS)   || 
+            (tmp == TN_TERMSP) || 
+            (tmp == TN_TOGFLO) || 
+            (tmp == TN_XDISPL) || 
+            (tmp == TN_ENVIRO) || 
+            (tmp == TN_AUTH)   || 
+            (tmp == TN_ENCRYP) || 
+            (tmp == TN_NEWENV) || 
+            (tmp == TN_TN3270) || 
+            (tmp == TN_CHARST) || 
+            (tmp == TN_COMPRT) || 
+            (tmp == TN_KERMIT)) {
+            /* Reject (DONT) these 'uninteresting' options only one time to avoid loops */
+            if (0 == (lp->telnet_sent_opts[tmp] & TNOS_DONT)) {
+                lp->notelnet = TRUE;                            /* Temporarily disable so */
+                tmxr_putc_ln (lp, TN_IAC);                      /* IAC gets injected bare */
+                lp->notelnet = FALSE;
+                tmxr_putc_ln (lp, TN_DONT); 
+                tmxr_putc_ln (lp, tmp); 
+                lp->telnet_sent_opts[tmp] |= TNOS_DONT;/* Record DONT sent */
+                }
+            }
+        /* fall through */
+    case TNS_WONT:                       /* IAC+WILL/WONT prev */
+        if (tmp == TN_BIN) {                            /* BIN? */
+            if (lp->tsta == TNS_WILL) {
+                lp->dstb = 0;
+                }
+            else {
+                lp->dstb = 1;
+                }
+            }
+        lp->tsta = TNS_NORM;                            /* next normal */
+        break;                                          /* remove it */
+
+    /* Negotiation with the HP terminal emulator "QCTerm" is not working.
+       QCTerm says "WONT BIN" but sends bare CRs.  RFC 854 says:
+
+         Note that "CR LF" or "CR NUL" is required in both directions
+         (in the default ASCII mode), to preserve the symmetry of the
+         NVT model.  ...The protocol requires that a NUL be inserted
+         following a CR not followed by a LF in the data stream.
+
+       Until full negotiation is implemented, we work around the problem
+       by checking the character following the CR in non-BIN mode and
+       strip it only if it is LF or NUL.  This should not affect
+       conforming clients.
+    */
+
+    case TNS_CRPAD:                                     /* only LF or NUL should follow CR */
+        lp->tsta = TNS_NORM;                            /* next normal */
+        if ((tmp == TN_LF) ||                           /* CR + LF ? */
+            (tmp == TN_NUL))                            /* CR + NUL? */
+            break;                                      /* remove it */
+        continue;                                       /* examine char as normal */
+
+    case TNS_DO:                                        /* pending DO request */
+        if ((tmp == TN_STATUS) || 
+            (tmp == TN_TIMING) || 
+            (tmp == TN_NAOCRD) || 
+            (tmp == TN_NAOHTS) || 
+            (tmp == TN_NAOHTD) || 
+            (tmp == TN_NAOFFD) || 
+            (tmp == TN_NAOVTS) || 
+            (tmp == TN_NAOVTD) || 
+            (tmp == TN_NAOLFD) || 
+            (tmp == TN_EXTEND) || 
+            (tmp == TN_LOGOUT) || 
+            (tmp == TN_BM)     || 
+            (tmp == TN_DET)    || 
+            (tmp == TN_SENDLO) || 
+            (tmp == TN_TERMTY) || 
+            (tmp == TN_ENDREC) || 
+            (tmp == TN_TUID)   || 
+            (tmp == TN_OUTMRK) || 
+            (tmp == TN_TTYLOC) || 
+            (tmp == TN_3270)   || 
+            (tmp == TN_X3PAD)  || 
+            (tmp == TN_NAWS)   || 
+            (tmp == TN_TERMSP) || 
+            (tmp == TN_TOGFLO) || 
+            (tmp == TN_XDISPL) || 
+            (tmp == TN_ENVIRO) || 
+            (tmp == TN_AUTH)   || 
+            (tmp == TN_ENCRYP) || 
+            (tmp == TN_NEWENV) || 
+            (tmp == TN_TN3270) || 
+            (tmp == TN_CHARST) || 
+            (tmp == TN_COMPRT) || 
+            (tmp == TN_KERMIT)) {
+            /* Reject (WONT) these 'uninteresting' options only one time to avoid loops */
+            if (0 == (lp->telnet_sent_opts[tmp] & TNOS_WONT)) {
+                lp->notelnet = TRUE;                            /* Temporarily disable so */
+                tmxr_putc_ln (lp, TN_IAC);                      /* IAC gets injected bare */
+                lp->notelnet = FALSE;
+                tmxr_putc_ln (lp, TN_WONT); 
+                tmxr_putc_ln (lp, tmp); 
+                if (lp->conn)                                   /* Still connected ? */
+                    lp->telnet_sent_opts[tmp] |= TNOS_WONT;/* Record WONT sent */
+                }
+            }
+        /* fall through */
+    case TNS_SKIP: default:                             /* skip char */
+        lp->tsta = TNS_NORM;                            /* next normal */
+        break;                                          /* remove char */
+        }                                               /* end case state */
+    if (keep) {
+        lp->rxb[w] = lp->rxb[j];
+        lp->rbr[w] = lp->rbr[j];
+        w = w + 1;
+        }
+    j = j + 1;                                          /* advance j */
+    }                                                   /* end while char */
+memset (&lp->rbr[w], 0, lp->rxbpi - w);                 /* clear vacated break status */
+lp->rxbpi = w;                                          /* drop removed chars */
 }
 
 
@@ -935,6 +1234,8 @@ if (mp->logfiletmpl[0])                                 /* logfile info */
     sprintf (growstring(&tptr, 7 + strlen (mp->logfiletmpl)), ",Log=%s", mp->logfiletmpl);
 if (mp->buffered)
     sprintf (growstring(&tptr, 10 + 10), ",Buffered=%d", mp->buffered);
+if (mp->rxbuffered)
+    sprintf (growstring(&tptr, 11 + 10), ",RcvBuffer=%d", mp->rxbuffered);
 while ((*tptr == ',') || (*tptr == ' '))
     memmove (tptr, tptr+1, strlen(tptr+1)+1);
 for (i=0; i<mp->lines; ++i) {
@@ -995,6 +1296,8 @@ if (lp->destination || lp->port || lp->txlogname || (lp->conn == TMXR_LINE_DISAB
         sprintf (growstring(&tptr, 32), ",Buffered=%d", lp->txbsz);
     if (!lp->txbfd && (lp->mp->buffered > 0))
         sprintf (growstring(&tptr, 32), ",UnBuffered");
+    if (lp->rxbfsz)
+        sprintf (growstring(&tptr, 32), ",RcvBuffer=%d", lp->rxbfsz);
     if (lp->mp->datagram != lp->datagram)
         sprintf (growstring(&tptr, 8), ",%s", lp->datagram ? "UDP" : "TCP");
     if (lp->mp->packet != lp->packet)
@@ -1227,6 +1530,7 @@ if (mp->master) {
                 lp = mp->ldsc + i;                          /* get line desc */
                 lp->conn = TRUE;                            /* record connection */
                 lp->sock = newsock;                         /* save socket */
+                tmxr_evt_add_line (lp);                     /* track input events */
                 lp->ipad = address;                         /* ip address */
                 tmxr_init_line (lp);                        /* init line */
                 lp->notelnet = mp->notelnet;                /* apply mux default telnet setting */
@@ -1295,6 +1599,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                             lp->conn = TRUE;                    /* record connection */
                             lp->sock = lp->connecting;          /* it now looks normal */
                             lp->connecting = 0;
+                            tmxr_evt_add_line (lp);
                             lp->ipad = (char *)realloc (lp->ipad, 1+strlen (lp->destination));
                             strcpy (lp->ipad, lp->destination);
                             lp->cnms = sim_os_msec ();
@@ -1358,12 +1663,14 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                                 tmxr_debug_connect_line (lp, msg);
                                 sim_close_sock (lp->connecting);    /* abort our as yet unconnnected socket */
                                 lp->connecting = 0;
+                                TMXR_POLL_CHANGED;
                                 }
                             }
                         if (lp->conn == FALSE) {                    /* is the line available? */
                             if ((!lp->modem_control) || (lp->modembits & TMXR_MDM_DTR)) {
                                 lp->conn = TRUE;                    /* record connection */
                                 lp->sock = newsock;                 /* save socket */
+                                tmxr_evt_add_line (lp);             /* track input events */
                                 lp->ipad = address;                 /* ip address */
                                 tmxr_init_line (lp);                /* init line */
                                 if (!lp->notelnet) {
@@ -1436,6 +1743,7 @@ if (lp->serport) {
     if (closeserial) {
         sim_close_serial (lp->serport);
         lp->serport = 0;
+        tmxr_evt_rescan (lp);
         lp->ser_connect_pending = FALSE;
         free (lp->destination);
         lp->destination = NULL;
@@ -1453,6 +1761,7 @@ if (lp->serport) {
     }
 else                                                    /* Telnet connection */
     if (lp->sock) {
+        tmxr_evt_del_line (lp);                         /* stop tracking input events */
         sim_close_sock (lp->sock);                      /* close socket */
         free (lp->telnet_sent_opts);
         lp->telnet_sent_opts = NULL;
@@ -1855,6 +2164,7 @@ else {
             lp->conn = TRUE;                            /* record connection */
             lp->sock = lp->mp->ring_sock;               /* save socket */
             lp->mp->ring_sock = INVALID_SOCKET;
+            tmxr_evt_add_line (lp);
             lp->ipad = lp->mp->ring_ipad;               /* ip address */
             lp->mp->ring_ipad = NULL;
             lp->mp->ring_start_time = 0;
@@ -1968,6 +2278,7 @@ DEVICE *dptr = (lp->dptr ? lp->dptr : (lp->mp ? lp->mp->dptr : NULL));
 if (lp->loopback == (enable_loopback != FALSE))
     return SCPE_OK;                 /* Nothing to do */
 lp->loopback = (enable_loopback != FALSE);
+tmxr_evt_rescan (lp);
 if (lp->loopback) {
     lp->lpbsz = lp->rxbsz;
     lp->lpb = (char *)realloc(lp->lpb, lp->lpbsz);
@@ -2075,7 +2386,7 @@ if (((lp->conn || lp->txbfd) && lp->rcve) &&            /* (conn or buffered) &
     ((!lp->rxbps) ||                                    /* (!rate limited || enough time passed)? */
      (sim_gtime_now >= lp->rxnexttime))) {
     if (!sim_send_poll_data (&lp->send, &val)) {        /* injected input characters available? */
-        j = lp->rxbpi - lp->rxbpr;                      /* # input chrs */
+        j = tmxr_rx_count (lp);                         /* # input chrs */
         if (j) {                                        /* any? */
             tmp = lp->rxb[lp->rxbpr];                   /* get char */
             val = TMXR_VALID | (tmp & 0377);            /* valid + chr */
@@ -2084,6 +2395,8 @@ if (((lp->conn || lp->txbfd) && lp->rcve) &&            /* (conn or buffered) &
                 val = val | SCPE_BREAK;                 /* indicate to caller */
                 }
             lp->rxbpr = lp->rxbpr + 1;                  /* adv pointer */
+            if (lp->rxbpr == lp->rxbsz)                 /* wrap */
+                lp->rxbpr = 0;
             }
         }
     }                                                   /* end if conn */
@@ -2143,8 +2456,8 @@ while (TMXR_VALID & (c = tmxr_getc_ln (lp))) {
            delivery, for TCP lines, we read the packet length from the data stream.
            So, here we stuff packet size into head of packet buffer so it looks like
            it was delivered by TCP and the below return logic doesn't have to worry */
-        lp->rxpb[lp->rxpboffset++] = (uint8)(((1 + lp->rxbpi - lp->rxbpr) >> 8) & 0xFF);
-        lp->rxpb[lp->rxpboffset++] = (uint8)((1 + lp->rxbpi - lp->rxbpr) & 0xFF);
+        lp->rxpb[lp->rxpboffset++] = (uint8)(((1 + tmxr_rx_count (lp)) >> 8) & 0xFF);
+        lp->rxpb[lp->rxpboffset++] = (uint8)((1 + tmxr_rx_count (lp)) & 0xFF);
         }
     lp->rxpb[lp->rxpboffset++] = c & 0xFF;
     if (lp->rxpboffset >= (2 + fc_size)) {
@@ -2166,34 +2479,214 @@ if (lp->conn)
 return SCPE_LOST;
 }
 
+/* Input event tracking
+
+   When the host provides a scalable readiness interface (epoll on Linux),
+   each multiplexer keeps an event descriptor on which the sockets of its
+   connected lines are registered.  tmxr_poll_rx then visits only the
+   lines whose sockets have input pending, plus the lines whose input
+   does not arrive on a line socket (serial ports, loopback and framer
+   lines), so the cost of a receive poll depends on the number of active
+   lines rather than the number of configured lines.  Elsewhere, or if the
+   event descriptor can't be used, every line is visited on each poll.
+
+   Line sockets are registered when a connection is established and
+   removed when the line is reset.  The non socket line list is rebuilt
+   whenever a line's serial port, loopback or framer state changes.
+*/
+
+#if defined(TMXR_EPOLL)
+static t_bool tmxr_evt_open (TMXR *mp)
+{
+if (mp->evt_failed)
+    return FALSE;
+if (mp->evt_fd == 0) {
+    int fd = epoll_create (1);
+
+    if (fd <= 0) {
+        if (fd == 0)
+            close (fd);
+        mp->evt_failed = TRUE;
+        sim_debug (TMXR_DBG_TRC, mp->dptr, "Input events unavailable, polling all lines\n");
+        return FALSE;
+        }
+    mp->evt_fd = fd;
+    mp->evt_rescan = TRUE;
+    }
+return TRUE;
+}
+#endif
+
+static void tmxr_evt_add_line (TMLN *lp)
+{
+#if defined(TMXR_EPOLL)
+TMXR *mp = lp->mp;
+struct epoll_event ev;
+
+TMXR_POLL_CHANGED;
+if ((mp == NULL) || (lp->sock == 0) || (lp->evt_sock == lp->sock) ||
+    (!tmxr_evt_open (mp)))
+    return;
+tmxr_evt_del_line (lp);
+memset (&ev, 0, sizeof (ev));
+ev.events = EPOLLIN;
+ev.data.u32 = (uint32)(lp - mp->ldsc);
+if (epoll_ctl (mp->evt_fd, EPOLL_CTL_ADD, lp->sock, &ev) == 0)
+    lp->evt_sock = lp->sock;
+else {                                      /* can't track line, revert to polling all lines */
+    sim_debug (TMXR_DBG_TRC, mp->dptr, "Can't register line %d for input events, errno=%d\n", (int)(lp - mp->ldsc), errno);
+    tmxr_evt_close (mp);
+    mp->evt_failed = TRUE;
+    }
+#endif
+}
+
+static void tmxr_evt_del_line (TMLN *lp)
+{
+#if defined(TMXR_EPOLL)
+TMXR_POLL_CHANGED;
+if (lp->evt_sock) {
+    if (lp->mp && lp->mp->evt_fd) {
+        struct epoll_event ev;
+
+        memset (&ev, 0, sizeof (ev));
+        epoll_ctl (lp->mp->evt_fd, EPOLL_CTL_DEL, lp->evt_sock, &ev);
+        }
+    lp->evt_sock = 0;
+    }
+#endif
+}
+
+static void tmxr_evt_rescan (TMLN *lp)
+{
+TMXR_POLL_CHANGED;
+if (lp->mp)
+    lp->mp->evt_rescan = TRUE;
+}
+
+static void tmxr_evt_close (TMXR *mp)
+{
+int32 i;
+
+for (i = 0; i < mp->lines; i++)
+    mp->ldsc[i].evt_sock = 0;
+#if defined(TMXR_EPOLL)
+if (mp->evt_fd)
+    close (mp->evt_fd);
+#endif
+mp->evt_fd = 0;
+mp->evt_failed = FALSE;
+free (mp->evt_lines);
+mp->evt_lines = NULL;
+free (mp->evt_events);
+mp->evt_events = NULL;
+mp->evt_size = mp->evt_scan_count = 0;
+}
+
+/* Collect the lines a receive poll should visit in mp->evt_lines
+
+   Returns the number of lines collected, or -1 if every line must be visited.
+*/
+
+static int32 tmxr_evt_ready_lines (TMXR *mp)
+{
+#if defined(TMXR_EPOLL)
+struct epoll_event *events;
+int32 i, count, ready;
+
+if (!tmxr_evt_open (mp))
+    return -1;
+if (mp->evt_rescan || (mp->evt_size != mp->lines)) {
+    if (mp->evt_size != mp->lines) {
+        free (mp->evt_lines);
+        free (mp->evt_events);
+        mp->evt_lines = (int32 *)malloc (2 * mp->lines * sizeof (*mp->evt_lines));
+        mp->evt_events = malloc (mp->lines * sizeof (struct epoll_event));
+        if ((mp->evt_lines == NULL) || (mp->evt_events == NULL)) {
+            tmxr_evt_close (mp);
+            mp->evt_failed = TRUE;
+            return -1;
+            }
+        mp->evt_size = mp->lines;
+        }
+    mp->evt_scan_count = 0;
+    for (i = 0; i < mp->lines; i++) {
+        TMLN *lp = mp->ldsc + i;
+
+        if (lp->serport || lp->loopback || lp->framer)
+            mp->evt_lines[mp->evt_scan_count++] = i;
+        if (lp->sock && (lp->evt_sock != lp->sock))
+            tmxr_evt_add_line (lp);             /* not yet registered */
+        }
+    if (mp->evt_failed)
+        return -1;
+    mp->evt_rescan = FALSE;
+    }
+++mp->evt_pass;
+for (count = 0; count < mp->evt_scan_count; count++)
+    mp->ldsc[mp->evt_lines[count]].evt_pass = mp->evt_pass;
+events = (struct epoll_event *)mp->evt_events;
+ready = epoll_wait (mp->evt_fd, events, mp->lines, 0);
+for (i = 0; i < ready; i++) {
+    uint32 ln = events[i].data.u32;
+    TMLN *lp;
+
+    if (ln >= (uint32)mp->lines)
+        continue;
+    lp = mp->ldsc + ln;
+    if ((lp->evt_pass == mp->evt_pass) ||   /* already collected? */
+        (lp->sock == 0) || (lp->sock != lp->evt_sock))
+        continue;
+    lp->evt_pass = mp->evt_pass;
+    mp->evt_lines[count++] = (int32)ln;
+    }
+return count;
+#else
+return -1;
+#endif
+}
+
 /* Poll for input
 
    Inputs:
         *mp     =       pointer to terminal multiplexer descriptor
    Outputs:     none
+
+   Implementation note:
+
+    1. A line's receive buffer is a ring which is refilled whenever it
+       has space (see tmxr_rx_space).  The buffer indexes are reset when
+       a visited line's buffer is found empty, so reads are as large as
+       possible.  Lines which aren't visited keep their indexes until the
+       buffer is drained by tmxr_getc_ln, which resets them.
 */
 
 void tmxr_poll_rx (TMXR *mp)
 {
-int32 i, nbytes, j;
+int32 i, k, nbytes, j, count, space;
+int32 *visit = NULL;
 TMLN *lp;
 
 tmxr_debug_trace (mp, "tmxr_poll_rx()");
-for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
+count = tmxr_evt_ready_lines (mp);                      /* lines with input activity */
+if (count >= 0)
+    visit = mp->evt_lines;
+else
+    count = mp->lines;                                  /* unknown, visit all lines */
+for (k = 0; k < count; k++) {                           /* loop thru lines */
+    i = visit ? visit[k] : k;
     lp = mp->ldsc + i;                                  /* get line desc */
     if (!(lp->sock || lp->serport || lp->loopback || lp->framer) || 
         !(lp->rcve))                                    /* skip if not connected */
         continue;
 
+    if (lp->rxbpi == lp->rxbpr)                         /* buf empty? */
+        lp->rxbpi = lp->rxbpr = 0;                      /* reset pointers */
     nbytes = 0;
-    if (lp->rxbpi == 0)                                 /* need input? */
-        nbytes = tmxr_read (lp,                         /* yes, read */
-            lp->rxbsz - TMXR_GUARD);                    /* leave spc for Telnet cruft */
-    else {
-        if (lp->tsta)                                   /* in Telnet seq? */
-            nbytes = tmxr_read (lp,                     /* yes, read to end */
-                                    lp->rxbsz - lp->rxbpi);
-        }
+    space = tmxr_rx_space (lp);                         /* contiguous room, less guard */
+    if ((space > 0) &&                                  /* room for input and */
+        (!lp->datagram || (lp->rxbpi == 0)))            /* a datagram fits whole? */
+        nbytes = tmxr_read (lp, space);                 /* read */
 
     if (nbytes < 0) {                                   /* line error? */
         if (!lp->datagram) {                            /* ignore errors reading UDP sockets */
@@ -2214,204 +2707,17 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
 /* Examine new data, remove TELNET cruft before making input available */
 
         if (!lp->notelnet) {                            /* Are we looking for telnet interpretation? */
-            for (; j < lp->rxbpi; ) {                   /* loop thru char */
-                u_char tmp = (u_char)lp->rxb[j];        /* get char */
-                switch (lp->tsta) {                     /* case tlnt state */
-
-                case TNS_NORM:                          /* normal */
-                    if (tmp == TN_IAC) {                /* IAC? */
-                        lp->tsta = TNS_IAC;             /* change state */
-                        tmxr_rmvrc (lp, j);             /* remove char */
-                        break;
-                        }
-                    if ((tmp == TN_CR) && lp->dstb)     /* CR, no bin */
-                        lp->tsta = TNS_CRPAD;           /* skip pad char */
-                    j = j + 1;                          /* advance j */
-                    break;
-
-                case TNS_IAC:                           /* IAC prev */
-                    if (tmp == TN_IAC) {                /* IAC + IAC */
-                        lp->tsta = TNS_NORM;            /* treat as normal */
-                        j = j + 1;                      /* advance j */
-                        break;                          /* keep IAC */
-                        }
-                    if (tmp == TN_BRK) {                /* IAC + BRK? */
-                        lp->tsta = TNS_NORM;            /* treat as normal */
-                        lp->rxb[j] = 0;                 /* char is null */
-                        lp->rbr[j] = 1;                 /* flag break */
-                        j = j + 1;                      /* advance j */
-                        break;
-                        }
-                    switch (tmp) {
-                    case TN_WILL:                       /* IAC + WILL? */
-                        lp->tsta = TNS_WILL;
-                        break;
-                    case TN_WONT:                       /* IAC + WONT? */
-                        lp->tsta = TNS_WONT;
-                        break;
-                    case TN_DO:                         /* IAC + DO? */
-                        lp->tsta = TNS_DO;
-                        break;
-                    case TN_DONT:                       /* IAC + DONT? */
-                        lp->tsta = TNS_SKIP;            /* IAC + other */
-                        break;
-                    case TN_GA: case TN_EL:             /* IAC + other 2 byte types */
-                    case TN_EC: case TN_AYT:    
-                    case TN_AO: case TN_IP:
-                    case TN_NOP: 
-                        lp->tsta = TNS_NORM;            /* ignore */
-                        break;
-                    case TN_SB:                         /* IAC + SB sub-opt negotiation */
-                    case TN_DATAMK:                     /* IAC + data mark */
-                    case TN_SE:                         /* IAC + SE sub-opt end */
-                        lp->tsta = TNS_NORM;            /* ignore */
-                        break;
-                        }
-                    tmxr_rmvrc (lp, j);                 /* remove char */
-                    break;
-
-                case TNS_WILL:                          /* IAC+WILL prev */
-                    if ((tmp == TN_STATUS) || 
-                        (tmp == TN_TIMING) || 
-                        (tmp == TN_NAOCRD) || 
-                        (tmp == TN_NAOHTS) || 
-                        (tmp == TN_NAOHTD) || 
-                        (tmp == TN_NAOFFD) || 
-                        (tmp == TN_NAOVTS) || 
-                        (tmp == TN_NAOVTD) || 
-                        (tmp == TN_NAOLFD) || 
-                        (tmp == TN_EXTEND) || 
-                        (tmp == TN_LOGOUT) || 
-                        (tmp == TN_BM)     || 
-                        (tmp == TN_DET)    || 
-                        (tmp == TN_SENDLO) || 
-                        (tmp == TN_TERMTY) || 
-                        (tmp == TN_ENDREC) || 
-                        (tmp == TN_TUID)   || 
-                        (tmp == TN_OUTMRK) || 
-                        (tmp == TN_TTYLOC) || 
-                        (tmp == TN_3270)   || 
-                        (tmp == TN_X3PAD)  || 
-                        (tmp == TN_NAWS)   || 
-                        (tmp == TN_TERMSP) || 
-                        (tmp == TN_TOGFLO) || 
-                        (tmp == TN_XDISPL) || 
-                        (tmp == TN_ENVIRO) || 
-                        (tmp == TN_AUTH)   || 
-                        (tmp == TN_ENCRYP) || 
-                        (tmp == TN_NEWENV) || 
-                        (tmp == TN_TN3270) || 
-                        (tmp == TN_CHARST) || 
-                        (tmp == TN_COMPRT) || 
-                        (tmp == TN_KERMIT)) {
-                        /* Reject (DONT) these 'uninteresting' options only one time to avoid loops */
-                        if (0 == (lp->telnet_sent_opts[tmp] & TNOS_DONT)) {
-                            lp->notelnet = TRUE;                /* Temporarily disable so */
-                            tmxr_putc_ln (lp, TN_IAC);          /* IAC gets injected bare */
-                            lp->notelnet = FALSE;
-                            tmxr_putc_ln (lp, TN_DONT); 
-                            tmxr_putc_ln (lp, tmp); 
-                            lp->telnet_sent_opts[tmp] |= TNOS_DONT;/* Record DONT sent */
-                            }
-                        }
-                    /* fall through */
-                case TNS_WONT:           /* IAC+WILL/WONT prev */
-                    if (tmp == TN_BIN) {                /* BIN? */
-                        if (lp->tsta == TNS_WILL) {
-                            lp->dstb = 0;
-                            }
-                        else {
-                            lp->dstb = 1;
-                            }
-                        }
-                    tmxr_rmvrc (lp, j);                 /* remove it */
-                    lp->tsta = TNS_NORM;                /* next normal */
-                    break;
-
-                /* Negotiation with the HP terminal emulator "QCTerm" is not working.
-                   QCTerm says "WONT BIN" but sends bare CRs.  RFC 854 says:
-
-                     Note that "CR LF" or "CR NUL" is required in both directions
-                     (in the default ASCII mode), to preserve the symmetry of the
-                     NVT model.  ...The protocol requires that a NUL be inserted
-                     following a CR not followed by a LF in the data stream.
-
-                   Until full negotiation is implemented, we work around the problem
-                   by checking the character following the CR in non-BIN mode and
-                   strip it only if it is LF or NUL.  This should not affect
-                   conforming clients.
-                */
-
-                case TNS_CRPAD:                         /* only LF or NUL should follow CR */
-                    lp->tsta = TNS_NORM;                /* next normal */
-                    if ((tmp == TN_LF) ||               /* CR + LF ? */
-                        (tmp == TN_NUL))                /* CR + NUL? */
-                        tmxr_rmvrc (lp, j);             /* remove it */
-                    break;
-
-                case TNS_DO:                            /* pending DO request */
-                    if ((tmp == TN_STATUS) || 
-                        (tmp == TN_TIMING) || 
-                        (tmp == TN_NAOCRD) || 
-                        (tmp == TN_NAOHTS) || 
-                        (tmp == TN_NAOHTD) || 
-                        (tmp == TN_NAOFFD) || 
-                        (tmp == TN_NAOVTS) || 
-                        (tmp == TN_NAOVTD) || 
-                        (tmp == TN_NAOLFD) || 
-                        (tmp == TN_EXTEND) || 
-                        (tmp == TN_LOGOUT) || 
-                        (tmp == TN_BM)     || 
-                        (tmp == TN_DET)    || 
-                        (tmp == TN_SENDLO) || 
-                        (tmp == TN_TERMTY) || 
-                        (tmp == TN_ENDREC) || 
-                        (tmp == TN_TUID)   || 
-                        (tmp == TN_OUTMRK) || 
-                        (tmp == TN_TTYLOC) || 
-                        (tmp == TN_3270)   || 
-                        (tmp == TN_X3PAD)  || 
-                        (tmp == TN_NAWS)   || 
-                        (tmp == TN_TERMSP) || 
-                        (tmp == TN_TOGFLO) || 
-                        (tmp == TN_XDISPL) || 
-                        (tmp == TN_ENVIRO) || 
-                        (tmp == TN_AUTH)   || 
-                        (tmp == TN_ENCRYP) || 
-                        (tmp == TN_NEWENV) || 
-                        (tmp == TN_TN3270) || 
-                        (tmp == TN_CHARST) || 
-                        (tmp == TN_COMPRT) || 
-                        (tmp == TN_KERMIT)) {
-                        /* Reject (WONT) these 'uninteresting' options only one time to avoid loops */
-                        if (0 == (lp->telnet_sent_opts[tmp] & TNOS_WONT)) {
-                            lp->notelnet = TRUE;                /* Temporarily disable so */
-                            tmxr_putc_ln (lp, TN_IAC);          /* IAC gets injected bare */
-                            lp->notelnet = FALSE;
-                            tmxr_putc_ln (lp, TN_WONT); 
-                            tmxr_putc_ln (lp, tmp); 
-                            if (lp->conn)                       /* Still connected ? */
-                                lp->telnet_sent_opts[tmp] |= TNOS_WONT;/* Record WONT sent */
-                            }
-                        }
-                    /* fall through */
-                case TNS_SKIP: default:                 /* skip char */
-                    tmxr_rmvrc (lp, j);                 /* remove char */
-                    lp->tsta = TNS_NORM;                /* next normal */
-                    break;
-                    }                                   /* end case state */
-                }                                       /* end for char */
-            if (nbytes != (lp->rxbpi-lp->rxbpr)) {
-                tmxr_debug (TMXR_DBG_RCV, lp, "Remaining", &(lp->rxb[lp->rxbpr]), lp->rxbpi-lp->rxbpr);
+            tmxr_rx_telnet (lp, j);
+            if (nbytes != (lp->rxbpi - j)) {
+                tmxr_debug (TMXR_DBG_RCV, lp, "Remaining", &(lp->rxb[j]), lp->rxbpi - j);
                 }
             }
+        if (lp->rxbpi == lp->rxbsz)                     /* filled to the end? */
+            lp->rxbpi = 0;                              /* wrap */
         }                                               /* end else nbytes */
-    }                                                   /* end for lines */
-for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
-    lp = mp->ldsc + i;                                  /* get line desc */
     if (lp->rxbpi == lp->rxbpr)                         /* if buf empty, */
         lp->rxbpi = lp->rxbpr = 0;                      /* reset pointers */
-    }                                                   /* end for */
+    }                                                   /* end for lines */
 }
 
 
@@ -2428,10 +2734,10 @@ if (speed) {
         if (sim_gtime () < lp->rxnexttime)  /* too soon? */
             return 0;
         else
-            return ((lp->rxbpi - lp->rxbpr + ((lp->rxbpi < lp->rxbpr)? lp->rxbsz : 0)) > 0) ? 1 : 0;
+            return (tmxr_rx_count (lp) > 0) ? 1 : 0;
         }
     }
-return (lp->rxbpi - lp->rxbpr + ((lp->rxbpi < lp->rxbpr)? lp->rxbsz : 0));
+return tmxr_rx_count (lp);
 }
 
 /* Return count of available characters ready to be read for line */
@@ -2443,7 +2749,7 @@ return tmxr_rqln_bare (lp, TRUE);
 
 int32 tmxr_input_pending_ln (TMLN *lp)
 {
-return (lp->rxbpi - lp->rxbpr);
+return tmxr_rx_count (lp);
 }
 
 
@@ -2467,6 +2773,7 @@ if ((lp->conn == FALSE) &&                              /* no conn & not buffere
     ++lp->txdrp;                                        /* lost */
     return SCPE_LOST;
     }
+tmxr_tx_mark (lp);                                      /* output (or a stall) for tmxr_poll_tx */
 tmxr_debug_trace_line (lp, "tmxr_putc_ln()");
 #define TXBUF_AVAIL(lp) ((lp->serport ? 2: lp->txbsz) - tmxr_tqln (lp))
 #define TXBUF_CHAR(lp, c) {                               \
@@ -2555,6 +2862,7 @@ if (!lp->datagram) {
 memcpy (lp->txpb + pktlen_size + fc_size, buf, size);
 lp->txppsize = size + pktlen_size + fc_size;
 lp->txppoffset = 0;
+tmxr_tx_mark (lp);
 tmxr_debug (TMXR_DBG_PXMT, lp, "Sending Packet", (char *)&lp->txpb[pktlen_size+fc_size], size);
 ++lp->txpcnt;
 while ((lp->txppoffset < lp->txppsize) && 
@@ -2564,25 +2872,109 @@ tmxr_send_buffered_data (lp);
 return (lp->conn || lp->loopback) ? SCPE_OK : SCPE_LOST;
 }
 
+/* Transmit activity tracking
+
+   Each multiplexer keeps a list of the lines which may need attention
+   from tmxr_poll_tx: lines with buffered output or a pending packet, or
+   whose transmission is disabled until buffer space or character time
+   is available.  A line is put on the list when output is stored for it
+   (or stalls), and tmxr_poll_tx removes it once it is idle, so the cost
+   of a transmit poll depends on the number of lines with output rather
+   than the number of configured lines.
+*/
+
+static void tmxr_tx_mark (TMLN *lp)
+{
+TMXR *mp = lp->mp;
+
+if ((mp == NULL) || lp->tx_listed || mp->tx_failed)
+    return;
+if (mp->tx_size != mp->lines) {                         /* lines changed? */
+    int32 i;
+
+    free (mp->tx_lines);
+    mp->tx_lines = (int32 *)malloc (mp->lines * sizeof (*mp->tx_lines));
+    if (mp->tx_lines == NULL) {
+        mp->tx_failed = TRUE;                           /* poll all lines */
+        mp->tx_size = mp->tx_count = 0;
+        return;
+        }
+    mp->tx_size = mp->lines;
+    for (i = 0; i < mp->lines; i++) {                   /* list every line once */
+        mp->ldsc[i].tx_listed = TRUE;
+        mp->tx_lines[i] = i;
+        }
+    mp->tx_count = mp->lines;
+    return;
+    }
+lp->tx_listed = TRUE;
+mp->tx_lines[mp->tx_count++] = (int32)(lp - mp->ldsc);
+}
+
+static void tmxr_tx_close (TMXR *mp)
+{
+int32 i;
+
+for (i = 0; i < mp->tx_size; i++)
+    mp->ldsc[i].tx_listed = FALSE;
+free (mp->tx_lines);
+mp->tx_lines = NULL;
+mp->tx_size = mp->tx_count = 0;
+mp->tx_failed = FALSE;
+}
+
 /* Poll for output
 
    Inputs:
         *mp     =       pointer to terminal multiplexer descriptor
    Outputs:
         none
+
+   Implementation note:
+
+    1. Only the lines on the multiplexer's transmit list are visited (see
+       tmxr_tx_mark).  Lines stored to while the list is being visited are
+       added at its end and visited by the same poll.  With SIM_ASYNCH_MUX
+       every line is visited, since an idle connected line with input
+       pending activates its receive unit here.
 */
 
 void tmxr_poll_tx (TMXR *mp)
 {
-int32 i, nbytes;
+int32 i, k, nbytes;
 TMLN *lp;
 double sim_gtime_now = sim_gtime ();
+#if defined(SIM_ASYNCH_MUX)
+t_bool all = TRUE;
+#else
+t_bool all = mp->tx_failed || (mp->tx_size != mp->lines);
+#endif
 
 tmxr_debug_trace (mp, "tmxr_poll_tx()");
-for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
+k = 0;
+while (k < (all ? mp->lines : mp->tx_count)) {          /* loop thru lines */
+    i = all ? k : mp->tx_lines[k];
     lp = mp->ldsc + i;                                  /* get line desc */
-    if ((!lp->conn) && (!lp->txbfd))                    /* skip if !conn and !buffered */
+    if (((!lp->conn) && (!lp->txbfd)) ||                /* !conn and !buffered */
+        ((lp->xmte != 0) &&                             /*   or idle (xmt enabled, */
+         (lp->txbpi == lp->txbpr) &&                    /*   nothing buffered */
+         (lp->txppoffset >= lp->txppsize))) {           /*   and no packet pending)? */
+        if (!all) {                                     /* take line off the list */
+            lp->tx_listed = FALSE;
+            mp->tx_lines[k] = mp->tx_lines[--mp->tx_count];
+            continue;
+            }
+#if !defined(SIM_ASYNCH_MUX)
+        ++k;
         continue;
+#else
+        if ((!lp->conn) && (!lp->txbfd)) {              /* skip if !conn and !buffered */
+            ++k;
+            continue;
+            }
+#endif
+        }
+    ++k;
     nbytes = tmxr_send_buffered_data (lp);              /* buffered bytes */
     if (nbytes == 0) {                                  /* buf empty? enab line */
 #if defined(SIM_ASYNCH_MUX)
@@ -2708,6 +3100,7 @@ if (lp->framer) {
     free (lp->framer->eth);
     free (lp->framer);
     lp->framer = NULL;
+    tmxr_evt_rescan (lp);
     }
 if (close_listener && lp->master) {
     sim_close_sock (lp->master);
@@ -2733,6 +3126,7 @@ if (lp->serport) {                          /* close current serial connection *
     sim_control_serial (lp->serport, 0, TMXR_MDM_DTR|TMXR_MDM_RTS, NULL);/* drop DTR and RTS */
     sim_close_serial (lp->serport);
     lp->serport = 0;
+    tmxr_evt_rescan (lp);
     free (lp->serconfig);
     lp->serconfig = NULL;
     free (lp->destination);
@@ -2905,7 +3299,7 @@ int32 i, line, nextline = -1;
 char tbuf[CBUFSIZE], listen[CBUFSIZE], destination[CBUFSIZE], 
      logfiletmpl[CBUFSIZE], buffered[CBUFSIZE], hostport[CBUFSIZE], 
      port[CBUFSIZE], option[CBUFSIZE], speed[CBUFSIZE], dev_name[CBUFSIZE],
-     acl[CBUFSIZE];
+     acl[CBUFSIZE], rcvbuffer[CBUFSIZE];
 char framer[CBUFSIZE],fr_eth[CBUFSIZE];
 int num;
 int8 fr_mode;
@@ -2942,6 +3336,7 @@ while (*tptr) {
     memset(listen,      '\0', sizeof(listen));
     memset(destination, '\0', sizeof(destination));
     memset(buffered,    '\0', sizeof(buffered));
+    memset(rcvbuffer,   '\0', sizeof(rcvbuffer));
     memset(port,        '\0', sizeof(port));
     memset(acl,         '\0', sizeof(acl));
     memset(option,      '\0', sizeof(option));
@@ -2952,6 +3347,8 @@ while (*tptr) {
     packet = mp->packet;
     if (mp->buffered)
         sprintf(buffered, "%d", mp->buffered);
+    if (mp->rxbuffered)
+        sprintf(rcvbuffer, "%d", mp->rxbuffered);
     if (line != -1) {
         notelnet = listennotelnet = mp->notelnet;
         nomessage = listennomessage = mp->nomessage;
@@ -3005,6 +3402,15 @@ while (*tptr) {
                     }
                 continue;
                 }
+            if (0 == MATCH_CMD (gbuf, "RCVBUFFER")) {
+                if ((NULL == cptr) || ('\0' == *cptr))
+                    return sim_messagef (SCPE_2FARG, "Missing RcvBuffer Specifier\n");
+                i = (int32) get_uint (cptr, 10, 1024*1024, &r);
+                if (r || ((i != 0) && (i < TMXR_MAXBUF)))   /* 0 selects the default */
+                    return sim_messagef (SCPE_ARG, "Invalid RcvBuffer Specifier: %s\n", cptr);
+                sprintf(rcvbuffer, "%d", i);
+                continue;
+                }
             if (0 == MATCH_CMD (gbuf, "NOLOG")) {
                 if ((NULL != cptr) && ('\0' != *cptr))
                     return sim_messagef (SCPE_2MARG, "Unexpected NoLog Specifier: %s\n", cptr);
@@ -3282,19 +3688,21 @@ while (*tptr) {
                 }
             }
         mp->buffered = atoi(buffered);
+        mp->rxbuffered = atoi(rcvbuffer);
         for (i = 0; i < mp->lines; i++) { /* initialize line buffers */
             lp = mp->ldsc + i;
             if (mp->buffered) {
                 lp->txbsz = mp->buffered;
                 lp->txbfd = 1;
-                lp->rxbsz = mp->buffered;
                 }
             else {
                 lp->txbsz = TMXR_MAXBUF;
                 lp->txbfd = 0;
-                lp->rxbsz = TMXR_MAXBUF;
                 }
+            lp->rxbfsz = 0;
+            lp->rxbsz = tmxr_rx_bufsize (lp);
             lp->txbpi = lp->txbpr = 0;
+            lp->rxbpi = lp->rxbpr = 0;
             lp->txb = (char *)realloc(lp->txb, lp->txbsz);
             lp->rxb = (char *)realloc(lp->rxb, lp->rxbsz);
             lp->rbr = (char *)realloc(lp->rbr, lp->rxbsz);
@@ -3347,6 +3755,7 @@ while (*tptr) {
                     sim_control_serial (lp->serport, 0, TMXR_MDM_DTR|TMXR_MDM_RTS, NULL);/* drop DTR and RTS */
                     sim_close_serial (lp->serport);
                     lp->serport = 0;
+                    tmxr_evt_rescan (lp);
                     free (lp->serconfig);
                     lp->serconfig = NULL;
                     }
@@ -3386,6 +3795,7 @@ while (*tptr) {
                 strcpy (lp->destination, destination);
                 lp->mp = mp;
                 lp->serport = serport;
+                tmxr_evt_rescan (lp);
                 lp->ser_connect_pending = TRUE;
                 lp->notelnet = TRUE;
                 tmxr_init_line (lp);                        /* init the line state */
@@ -3484,6 +3894,7 @@ while (*tptr) {
                 }
             lp = &mp->ldsc[line];
             lp->framer = framer_s;
+            tmxr_evt_rescan (lp);
             lp->datagram = lp->notelnet = TRUE;
             /* Remember these parameters for later; the framer is
              * started separately; in the DMC/DMP emulation this is
@@ -3510,14 +3921,17 @@ while (*tptr) {
                 }
             }
         if (buffered[0] == '\0') {
-            lp->rxbsz = lp->txbsz = TMXR_MAXBUF;
+            lp->txbsz = TMXR_MAXBUF;
             lp->txbfd = 0;
             }
         else {
-            lp->rxbsz = lp->txbsz = atoi(buffered);
+            lp->txbsz = atoi(buffered);
             lp->txbfd = 1;
             }
+        lp->rxbfsz = (atoi(rcvbuffer) != mp->rxbuffered) ? atoi(rcvbuffer) : 0;
+        lp->rxbsz = tmxr_rx_bufsize (lp);
         lp->txbpi = lp->txbpr = 0;
+        lp->rxbpi = lp->rxbpr = 0;
         lp->txb = (char *)realloc (lp->txb, lp->txbsz);
         lp->rxb = (char *)realloc(lp->rxb, lp->rxbsz);
         lp->rbr = (char *)realloc(lp->rbr, lp->rxbsz);
@@ -3561,6 +3975,7 @@ while (*tptr) {
                 lp->destination = (char *)malloc(1+strlen(destination));
                 strcpy (lp->destination, destination);
                 lp->serport = serport;
+                tmxr_evt_rescan (lp);
                 lp->ser_connect_pending = TRUE;
                 lp->notelnet = TRUE;
                 tmxr_init_line (lp);                        /* init the line state */
@@ -3731,16 +4146,38 @@ pthread_cond_t      sim_tmxr_startup_cond;
 int32               sim_tmxr_poll_count = 0;
 t_bool              sim_tmxr_poll_running = FALSE;
 
+/* Asynchronous multiplexer polling thread
+
+   The thread waits for input on the master, line, connecting and serial
+   descriptors of all open multiplexers and activates the units which own
+   the descriptors with activity.  On Linux the descriptors are registered
+   on an epoll descriptor, which is only rebuilt when the set of
+   descriptors changes, so a wait costs the same however many lines are
+   configured and isn't limited to FD_SETSIZE descriptors.  Elsewhere the
+   descriptors are waited for with select().
+*/
+
 static void *
 _tmxr_poll(void *arg)
 {
+#if !defined(TMXR_EPOLL)
 struct timeval timeout;
+#endif
 int timeout_usec;
 DEVICE *dptr = tmxr_open_devices[0]->dptr;
 UNIT **units = NULL;
 UNIT **activated = NULL;
 SOCKET *sockets = NULL;
+char *ready = NULL;
+int size = 0;
 int wait_count = 0;
+#if defined(TMXR_EPOLL)
+int epfd = -1;
+struct epoll_event *events = NULL;
+SOCKET *registered = NULL;                      /* descriptors registered on epfd */
+int registered_count = 0;
+uint32 registered_gen = 0;
+#endif
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which, in general, won't be readily yielding the processor when 
@@ -3749,17 +4186,18 @@ sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - starting\n");
 
-units = (UNIT **)calloc(FD_SETSIZE, sizeof(*units));
-activated = (UNIT **)calloc(FD_SETSIZE, sizeof(*activated));
-sockets = (SOCKET *)calloc(FD_SETSIZE, sizeof(*sockets));
 timeout_usec = 1000000;
 pthread_mutex_lock (&sim_tmxr_poll_lock);
 pthread_cond_signal (&sim_tmxr_startup_cond);   /* Signal we're ready to go */
 while (sim_asynch_enabled) {
-    int i, j, status, select_errno;
+    int i, j, status, select_errno, needed;
+#if defined(TMXR_EPOLL)
+    uint32 gen;
+#else
     fd_set readfds, errorfds;
-    int socket_count;
     SOCKET max_socket_fd;
+#endif
+    int socket_count;
     TMXR *mp;
     DEVICE *d;
 
@@ -3778,17 +4216,31 @@ while (sim_asynch_enabled) {
         pthread_cond_wait (&sim_tmxr_poll_cond, &sim_tmxr_poll_lock);
         sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - continuing with timeout of %dms\n", timeout_usec/1000);
         }
-    FD_ZERO (&readfds);
-    FD_ZERO (&errorfds);
-    for (i=max_socket_fd=socket_count=0; i<tmxr_open_device_count; ++i) {
+    for (i=needed=0; i<tmxr_open_device_count; ++i)
+        needed += 1 + 4 * tmxr_open_devices[i]->lines;
+    if (needed > size) {                        /* grow descriptor tables */
+        size = needed;
+        units = (UNIT **)realloc (units, size * sizeof (*units));
+        activated = (UNIT **)realloc (activated, size * sizeof (*activated));
+        sockets = (SOCKET *)realloc (sockets, size * sizeof (*sockets));
+        ready = (char *)realloc (ready, size * sizeof (*ready));
+#if defined(TMXR_EPOLL)
+        events = (struct epoll_event *)realloc (events, size * sizeof (*events));
+        registered = (SOCKET *)realloc (registered, size * sizeof (*registered));
+        if ((events == NULL) || (registered == NULL))
+            break;
+#endif
+        if ((units == NULL) || (activated == NULL) || (sockets == NULL) || (ready == NULL))
+            break;
+        }
+#if defined(TMXR_EPOLL)
+    gen = tmxr_poll_gen;                        /* descriptors as of now */
+#endif
+    for (i=socket_count=0; i<tmxr_open_device_count; ++i) {
         mp = tmxr_open_devices[i];
         if ((mp->master) && (mp->uptr->dynflags&UNIT_TM_POLL)) {
             units[socket_count] = mp->uptr;
             sockets[socket_count] = mp->master;
-            FD_SET (mp->master, &readfds);
-            FD_SET (mp->master, &errorfds);
-            if (mp->master > max_socket_fd)
-                max_socket_fd = mp->master;
             ++socket_count;
             }
         for (j=0; j<mp->lines; ++j) {
@@ -3797,10 +4249,6 @@ while (sim_asynch_enabled) {
                 if (units[socket_count] == NULL)
                     units[socket_count] = mp->uptr;
                 sockets[socket_count] = mp->ldsc[j].sock;
-                FD_SET (mp->ldsc[j].sock, &readfds);
-                FD_SET (mp->ldsc[j].sock, &errorfds);
-                if (mp->ldsc[j].sock > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].sock;
                 ++socket_count;
                 }
 #if !defined(_WIN32) && !defined(VMS)
@@ -3809,51 +4257,89 @@ while (sim_asynch_enabled) {
                 if (units[socket_count] == NULL)
                     units[socket_count] = mp->uptr;
                 sockets[socket_count] = mp->ldsc[j].serport;
-                FD_SET (mp->ldsc[j].serport, &readfds);
-                FD_SET (mp->ldsc[j].serport, &errorfds);
-                if (mp->ldsc[j].serport > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].serport;
                 ++socket_count;
                 }
 #endif
             if (mp->ldsc[j].connecting) {
                 units[socket_count] = mp->uptr;
                 sockets[socket_count] = mp->ldsc[j].connecting;
-                FD_SET (mp->ldsc[j].connecting, &readfds);
-                FD_SET (mp->ldsc[j].connecting, &errorfds);
-                if (mp->ldsc[j].connecting > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].connecting;
                 ++socket_count;
                 }
             if (mp->ldsc[j].master) {
                 units[socket_count] = mp->uptr;
                 sockets[socket_count] = mp->ldsc[j].master;
-                FD_SET (mp->ldsc[j].master, &readfds);
-                FD_SET (mp->ldsc[j].master, &errorfds);
-                if (mp->ldsc[j].master > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].master;
                 ++socket_count;
                 }
             }
         }
+#if defined(TMXR_EPOLL)
+    if ((epfd < 0) || (gen != registered_gen) ||        /* descriptors changed? */
+        (socket_count != registered_count) ||
+        (memcmp (sockets, registered, socket_count * sizeof (*sockets)) != 0)) {
+        if (epfd >= 0)
+            close (epfd);
+        epfd = epoll_create (1);
+        if (epfd < 0) {
+            sim_printf ("epoll_create() failed, errno=%d - %s\r\n", errno, strerror(errno));
+            abort();
+            }
+        for (i=0; i<socket_count; ++i) {
+            struct epoll_event ev;
+
+            memset (&ev, 0, sizeof (ev));
+            ev.events = EPOLLIN | EPOLLPRI;
+            ev.data.u32 = (uint32)i;
+            epoll_ctl (epfd, EPOLL_CTL_ADD, sockets[i], &ev);   /* a duplicate reports via its first entry */
+            }
+        memcpy (registered, sockets, socket_count * sizeof (*sockets));
+        registered_count = socket_count;
+        registered_gen = gen;
+        sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - registered %d descriptors\n", socket_count);
+        }
+#else
+    FD_ZERO (&readfds);
+    FD_ZERO (&errorfds);
+    for (i=max_socket_fd=0; i<socket_count; ++i) {
+        FD_SET (sockets[i], &readfds);
+        FD_SET (sockets[i], &errorfds);
+        if (sockets[i] > max_socket_fd)
+            max_socket_fd = sockets[i];
+        }
+#endif
     pthread_mutex_unlock (&sim_tmxr_poll_lock);
     if (timeout_usec > 1000000)
         timeout_usec = 1000000;
-    timeout.tv_sec = timeout_usec/1000000;
-    timeout.tv_usec = timeout_usec%1000000;
     select_errno = 0;
     if (socket_count == 0) {
         sim_os_ms_sleep (timeout_usec/1000);
         status = 0;
         }
-    else
+    else {
+#if defined(TMXR_EPOLL)
+        status = epoll_wait (epfd, events, socket_count, timeout_usec/1000);
+#else
+        timeout.tv_sec = timeout_usec/1000000;
+        timeout.tv_usec = timeout_usec%1000000;
         status = select (1+(int)max_socket_fd, &readfds, NULL, &errorfds, &timeout);
+#endif
+        }
     select_errno = errno;
+    if (status > 0) {                           /* note descriptors with activity */
+        memset (ready, 0, socket_count);
+#if defined(TMXR_EPOLL)
+        for (i=0; i<status; ++i)
+            if (events[i].data.u32 < (uint32)socket_count)
+                ready[events[i].data.u32] = 1;
+#else
+        for (i=0; i<socket_count; ++i)
+            ready[i] = (FD_ISSET(sockets[i], &readfds) || FD_ISSET(sockets[i], &errorfds));
+#endif
+        }
     wait_count=0;
     pthread_mutex_lock (&sim_tmxr_poll_lock);
     switch (status) {
         case 0:     /* timeout */
-            for (i=max_socket_fd=socket_count=0; i<tmxr_open_device_count; ++i) {
+            for (i=0; i<tmxr_open_device_count; ++i) {
                 mp = tmxr_open_devices[i];
                 if (mp->master) {
                     if (!mp->uptr->a_polling_now) {
@@ -3897,14 +4383,17 @@ while (sim_asynch_enabled) {
             wait_count = 0;
             if (select_errno == EINTR)
                 break;
+#if defined(TMXR_EPOLL)
+            sim_printf ("epoll_wait() returned -1, errno=%d - %s\r\n", select_errno, strerror(select_errno));
+#else
             sim_printf ("select() returned -1, errno=%d - %s\r\n", select_errno, strerror(select_errno));
+#endif
             abort();
             break;
         default:
             wait_count = 0;
             for (i=0; i<socket_count; ++i) {
-                if (FD_ISSET(sockets[i], &readfds) || 
-                    FD_ISSET(sockets[i], &errorfds)) {
+                if (ready[i]) {
                     /* More than one socket can be associated with the 
                        same unit.  Only activate one time */
                     for (j=0; j<wait_count; ++j)
@@ -3937,9 +4426,16 @@ while (sim_asynch_enabled) {
     sim_tmxr_poll_count += wait_count;
     }
 pthread_mutex_unlock (&sim_tmxr_poll_lock);
+#if defined(TMXR_EPOLL)
+if (epfd >= 0)
+    close (epfd);
+free(events);
+free(registered);
+#endif
 free(units);
 free(activated);
 free(sockets);
+free(ready);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - exiting\n");
 
@@ -4526,6 +5022,8 @@ if (mp->modem_control)
     fprintf(st, ", ModemControl=enabled");
 if (mp->buffered)
     fprintf(st, ", Buffered=%d", mp->buffered);
+if (mp->rxbuffered)
+    fprintf(st, ", RcvBuffer=%d", mp->rxbuffered);
 for (j = 1; j < mp->lines; j++)
     if (o_uptr != mp->ldsc[j].o_uptr)
         break;
@@ -4722,6 +5220,8 @@ if (mp->ring_sock != INVALID_SOCKET) {
     mp->ring_ipad = NULL;
     mp->ring_start_time = 0;
     }
+tmxr_evt_close (mp);                                    /* release input event tracking */
+tmxr_tx_close (mp);                                     /* and the transmit list */
 _tmxr_remove_from_open_list (mp);
 return SCPE_OK;
 }
@@ -4965,6 +5465,11 @@ if (single_line) {          /* Single Line Multiplexer */
     fprintf (st, "Line buffering can be disabled for the %s device with:\n\n", dptr->name);
     fprintf (st, "   sim> ATTACH %s NoBuffer\n\n", dptr->name);
     fprintf (st, "The default buffer size is 32k bytes, the max buffer size is 1024k bytes\n\n");
+    fprintf (st, "The size of the input buffer for the %s device can be changed with:\n\n", dptr->name);
+    fprintf (st, "   sim> ATTACH %s RcvBuffer=bufsize\n\n", dptr->name);
+    fprintf (st, "The default input buffer size is %d bytes (or the Buffer size when line\n", TMXR_RXBUF);
+    fprintf (st, "buffering is enabled), the range is 256 bytes to 1024k bytes and\n");
+    fprintf (st, "RcvBuffer=0 restores the default\n\n");
     fprintf (st, "The outbound traffic the %s device can be logged to a file with:\n", dptr->name);
     fprintf (st, "   sim> ATTACH %s Log=LogFileName\n\n", dptr->name);
     fprintf (st, "File logging can be disabled for the %s device with:\n\n", dptr->name);
@@ -5000,6 +5505,14 @@ else {
         fprintf (st, "Line buffering for all lines on the %s device can be disabled with:\n\n", dptr->name);
     fprintf (st, "   sim> ATTACH %s NoBuffer\n\n", dptr->name);
     fprintf (st, "The default buffer size is 32k bytes, the max buffer size is 1024k bytes\n\n");
+    fprintf (st, "The size of the input buffer for all lines on the %s device can be\n", dptr->name);
+    fprintf (st, "changed with:\n\n");
+    fprintf (st, "   sim> ATTACH %s RcvBuffer=bufsize\n\n", dptr->name);
+    fprintf (st, "or for a specific line with:\n\n");
+    fprintf (st, "   sim> ATTACH %s Line=n,RcvBuffer=bufsize\n\n", dptr->name);
+    fprintf (st, "The default input buffer size is %d bytes (or the Buffer size when line\n", TMXR_RXBUF);
+    fprintf (st, "buffering is enabled), the range is 256 bytes to 1024k bytes and\n");
+    fprintf (st, "RcvBuffer=0 restores the default\n\n");
     fprintf (st, "The outbound traffic for the lines of the %s device can be logged to files\n", dptr->name);
     fprintf (st, "with:\n\n");
     fprintf (st, "   sim> ATTACH %s Log=LogFileName\n\n", dptr->name);
@@ -5393,6 +5906,8 @@ else {
         fprintf (st, " bps\n");
         }
     }
+if (lp->rxbfsz || lp->mp->rxbuffered)
+    fprintf (st, "  input buffer size = %d\n", lp->rxbsz);
 if (lp->txbfd)
     fprintf (st, "  output buffer size = %d\n", lp->txbsz);
 if (lp->txcnt || lp->txbpi)
@@ -6141,6 +6656,110 @@ return SCPE_OK;
 }
 
 
+/* Telnet receive filter correctness and throughput */
+
+static void _rx_telnet_add (char *raw, int32 *rawlen, char *exp, int32 *explen,
+                            const char *in, size_t inlen, const char *out, size_t outlen)
+{
+memcpy (raw + *rawlen, in, inlen);
+*rawlen += (int32)inlen;
+memcpy (exp + *explen, out, outlen);
+*explen += (int32)outlen;
+}
+
+static double _rx_telnet_rate (TMLN *lp, const char *raw, int32 rawlen)
+{
+uint32 start = sim_os_msec ();
+uint32 elapsed;
+double bytes = 0.0;
+
+do {
+    int32 pass;
+
+    for (pass = 0; pass < 256; pass++) {
+        memcpy (lp->rxb, raw, rawlen);
+        lp->rxbpi = rawlen;
+        lp->tsta = TNS_NORM;
+        tmxr_rx_telnet (lp, 0);
+        bytes += rawlen;
+        }
+    elapsed = sim_os_msec () - start;
+    } while (elapsed < 250);
+return (bytes / (1024.0 * 1024.0)) / (elapsed / 1000.0);
+}
+
+static t_stat sim_tmxr_test_rx_telnet (void)
+{
+TMLN ln;
+char *raw, *exp;
+int32 rawlen = 0, explen = 0, i;
+t_stat r = SCPE_OK;
+
+memset (&ln, 0, sizeof (ln));
+ln.rxbsz = TMXR_RXBUF;
+ln.rxb = (char *)malloc (ln.rxbsz);
+ln.rbr = (char *)calloc (ln.rxbsz, 1);
+ln.telnet_sent_opts = (uint8 *)calloc (256, 1);
+ln.dstb = 1;                                            /* strip CR pad characters */
+raw = (char *)malloc (ln.rxbsz);
+exp = (char *)malloc (ln.rxbsz);
+for (i = 0; rawlen < ln.rxbsz - 32; i++) {
+    switch (i % 5) {
+        case 0:                                         /* text, CR LF */
+            _rx_telnet_add (raw, &rawlen, exp, &explen, "The quick brown fox\r\n", 21, "The quick brown fox\r", 20);
+            break;
+        case 1:                                         /* escaped IAC */
+            _rx_telnet_add (raw, &rawlen, exp, &explen, "a\377\377b", 4, "a\377b", 3);
+            break;
+        case 2:                                         /* IAC NOP */
+            _rx_telnet_add (raw, &rawlen, exp, &explen, "\377\361", 2, "", 0);
+            break;
+        case 3:                                         /* CR NUL */
+            _rx_telnet_add (raw, &rawlen, exp, &explen, "x\r\0", 3, "x\r", 2);
+            break;
+        case 4:                                         /* CR followed by data */
+            _rx_telnet_add (raw, &rawlen, exp, &explen, "\ry", 2, "\ry", 2);
+            break;
+        }
+    }
+memcpy (ln.rxb, raw, rawlen);
+ln.rxbpi = rawlen;
+tmxr_rx_telnet (&ln, 0);
+if ((ln.rxbpi != explen) || (memcmp (ln.rxb, exp, explen) != 0) || (ln.tsta != TNS_NORM))
+    r = sim_messagef (SCPE_IERR, "Telnet receive filter produced %d bytes, expected %d\n", ln.rxbpi, explen);
+memcpy (ln.rxb, "A\377\363B", 4);                       /* IAC BRK */
+ln.rxbpi = 4;
+tmxr_rx_telnet (&ln, 0);
+if ((r == SCPE_OK) &&
+    ((ln.rxbpi != 3) || (ln.rxb[1] != 0) || (ln.rbr[1] != 1) || (ln.rbr[2] != 0) || (ln.rbr[3] != 0)))
+    r = sim_messagef (SCPE_IERR, "Telnet receive filter mishandled IAC BRK\n");
+memset (ln.rbr, 0, ln.rxbsz);
+ln.rxbpr = 100;                                         /* receive ring indexes */
+ln.rxbpi = ln.rxbsz - 10;
+if ((r == SCPE_OK) &&
+    ((tmxr_rx_count (&ln) != ln.rxbsz - 110) || (tmxr_rx_space (&ln) != 10)))
+    r = sim_messagef (SCPE_IERR, "Receive ring space before the wrap is wrong\n");
+ln.rxbpi = 0;                                           /* wrapped */
+if ((r == SCPE_OK) &&
+    ((tmxr_rx_count (&ln) != ln.rxbsz - 100) || (tmxr_rx_space (&ln) != 100 - (int32)sizeof (mantra))))
+    r = sim_messagef (SCPE_IERR, "Receive ring space after the wrap is wrong\n");
+ln.rxbpr = ln.rxbpi = 0;
+if (r == SCPE_OK) {
+    double telnet_rate = _rx_telnet_rate (&ln, raw, rawlen);
+
+    memset (raw, 'x', rawlen);                          /* data without Telnet commands */
+    sim_printf ("Telnet receive filter: %.1f MB/sec (plain data), %.1f MB/sec (with Telnet commands)\n",
+                _rx_telnet_rate (&ln, raw, rawlen), telnet_rate);
+    }
+free (raw);
+free (exp);
+free (ln.rxb);
+free (ln.rbr);
+free (ln.telnet_sent_opts);
+return r;
+}
+
+
 #include <setjmp.h>
 
 t_stat tmxr_sock_test (DEVICE *dptr, const char *cptr)
@@ -6183,6 +6802,18 @@ SIM_TEST(attach_cmd (0, cmd));
 tmxr = (TMXR *)dptr->units->tmxr;
 ln = &tmxr->ldsc[tmxr->lines - 1];
 SIM_TEST(detach_cmd (0, dptr->name));
+sprintf (cmd, "%s -u localhost:65500,RcvBuffer=16", dptr->name);
+SIM_TEST((attach_cmd (0, cmd) != SCPE_OK) ? SCPE_OK : SCPE_IERR);
+sprintf (cmd, "%s -u localhost:65500,RcvBuffer=8192", dptr->name);
+SIM_TEST(attach_cmd (0, cmd));
+SIM_TEST((ln->rxbsz == 8192) ? SCPE_OK : SCPE_IERR);
+SIM_TEST(detach_cmd (0, dptr->name));
+sprintf (cmd, "%s -u localhost:65500,RcvBuffer=0", dptr->name);
+SIM_TEST(attach_cmd (0, cmd));                          /* restores the default */
+SIM_TEST((ln->rxbsz == TMXR_RXBUF) ? SCPE_OK : SCPE_IERR);
+SIM_TEST(detach_cmd (0, dptr->name));
+SIM_TEST(sim_tmxr_test_rx_telnet ());
+sprintf (cmd, "%s -u localhost:65500;notelnet", dptr->name);
 if (tmxr->lines > 1) {
     tmxr->modem_control = FALSE;
     for (line=0; line < tmxr->lines; line++)
@@ -6196,6 +6827,19 @@ if (tmxr->lines > 1) {
     sock_mux = sim_connect_sock ("", "localhost", "65500");
     sim_os_ms_sleep (100);
     SIM_TEST(((tmp2 = tmxr_poll_conn (tmxr)) == 0) || (tmp2 == 2) ? SCPE_OK : SCPE_IERR);
+    for (line=0; (line < tmxr->lines) && (tmxr_poll_conn (tmxr) >= 0); line++)
+        ;                                               /* accept remaining connections */
+    for (line=0; line < tmxr->lines; line++)
+        tmxr->ldsc[line].rcve = 1;
+    SIM_TEST((sim_write_sock (sock_mux, "Hello", 5) == 5) ? SCPE_OK : SCPE_IERR);
+    SIM_TEST((sim_write_sock (sock_line, "World", 5) == 5) ? SCPE_OK : SCPE_IERR);
+    sim_os_ms_sleep (100);
+    tmxr_poll_rx (tmxr);                                /* input delivered to the active lines? */
+    for (line=tmp1=0; line < tmxr->lines; line++)
+        tmp1 += tmxr_input_pending_ln (&tmxr->ldsc[line]);
+    SIM_TEST((tmp1 == 10) ? SCPE_OK : SCPE_IERR);
+    ln = &tmxr->ldsc[tmxr->lines - 1];
+    SIM_TEST((tmxr_input_pending_ln (ln) == 5) ? SCPE_OK : SCPE_IERR);
     show_cmd (0, "MUX");
     sim_close_sock (sock_mux);
     sock_mux = INVALID_SOCKET;
@@ -61,6 +61,7 @@ typedef struct SERPORT *SERHANDLE;
 #define TMXR_V_VALID    15
 #define TMXR_VALID      (1 << TMXR_V_VALID)
 #define TMXR_MAXBUF     256                             /* buffer size */
+#define TMXR_RXBUF      4096                            /* default rcv buffer size */
 
 #define TMXR_DTR_DROP_TIME 500                          /* milliseconds to drop DTR for 'pseudo' modem control */
 #define TMXR_MODEM_RING_TIME 3                          /* seconds to wait for DTR for incoming connections */
@@ -156,6 +157,7 @@ struct tmln {
     int32               rxbpr;                          /* rcv buf remove */
     int32               rxbpi;                          /* rcv buf insert */
     int32               rxbsz;                          /* rcv buffer size */
+    int32               rxbfsz;                         /* configured rcv buffer size (0 = default) */
     int32               rxcnt;                          /* rcv count */
     int32               rxpcnt;                         /* rcv packet count */
     int32               txbpr;                          /* xmt buf remove */
@@ -212,6 +214,9 @@ struct tmln {
     EXPECT              expect;                         /* Expect rules */
     SEND                send;                           /* Send input state */
     struct framer_data  *framer;                        /* ddcmp framer data */
+    SOCKET              evt_sock;                       /* socket registered for input events */
+    uint32              evt_pass;                       /* last receive poll which visited line */
+    t_bool              tx_listed;                      /* on the multiplexer's transmit list */
     };
 
 struct tmxr {
@@ -228,6 +233,7 @@ struct tmxr {
     char                logfiletmpl[FILENAME_MAX];      /* template logfile name */
     int32               txcount;                        /* count of transmit bytes */
     int32               buffered;                       /* Buffered Line Behavior and Buffer Size Flag */
+    int32               rxbuffered;                     /* rcv buffer size (0 = default) */
     int32               sessions;                       /* count of tcp connections received */
     uint32              poll_interval;                  /* frequency of connection polls (seconds) */
     uint32              last_poll_time;                 /* time of last connection poll */
@@ -240,6 +246,18 @@ struct tmxr {
     t_bool              port_speed_control;             /* multiplexer programmatically sets port speed */
     t_bool              packet;                         /* Lines are packet oriented */
     t_bool              datagram;                       /* Lines use datagram packet transport */
+    int                 evt_fd;                         /* input event descriptor (0 if none) */
+    t_bool              evt_failed;                     /* input events unavailable, poll all lines */
+    t_bool              evt_rescan;                     /* non socket line list needs rebuilding */
+    int32               evt_size;                       /* lines allocated in evt_lines */
+    int32               *evt_lines;                     /* lines to visit on a receive poll */
+    int32               evt_scan_count;                 /* non socket lines at start of evt_lines */
+    void                *evt_events;                    /* event buffer */
+    uint32              evt_pass;                       /* receive poll counter */
+    int32               tx_size;                        /* lines allocated in tx_lines */
+    int32               tx_count;                       /* lines on the transmit list */
+    int32               *tx_lines;                      /* lines with transmit activity */
+    t_bool              tx_failed;                      /* transmit list unavailable, poll all lines */
     };
 
 int32 tmxr_poll_conn (TMXR *mp);
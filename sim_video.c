@@ -90,6 +90,372 @@ t_stat vid_show (FILE* st, DEVICE *dptr,  UNIT* uptr, int32 val, CONST char* des
 return vid_show_video (st, uptr, val, desc);
 }
 
+/* Framebuffer routines
+
+   These don't depend on SDL, so headless framebuffers work in every
+   build.  Only the most recently created headless framebuffer can be
+   saved with SCREENSHOT.
+*/
+
+static VID_FRAMEBUFFER *vid_headless_fb = NULL;         /* headless framebuffer for SCREENSHOT */
+
+t_stat vid_fb_init (VID_FRAMEBUFFER *fb, VID_DISPLAY *vptr, int32 width, int32 height, int32 tile_w, int32 tile_h, t_bool headless)
+{
+memset (fb, 0, sizeof (*fb));
+if ((width <= 0) || (height <= 0) || (tile_w <= 0) || (tile_h <= 0))
+    return SCPE_ARG;
+fb->vptr = vptr;
+fb->headless = headless;
+fb->width = width;
+fb->height = height;
+fb->tile_w = tile_w;
+fb->tile_h = tile_h;
+fb->tiles_x = (width + tile_w - 1) / tile_w;
+fb->tiles_y = (height + tile_h - 1) / tile_h;
+fb->pixels = (uint32 *)calloc (width * height, sizeof (*fb->pixels));
+fb->dirty = (uint8 *)calloc (fb->tiles_x * fb->tiles_y, sizeof (*fb->dirty));
+if (!headless)
+    fb->region = (uint32 *)calloc (width * height, sizeof (*fb->region));
+if ((fb->pixels == NULL) || (fb->dirty == NULL) ||
+    ((!headless) && (fb->region == NULL))) {
+    vid_fb_free (fb);
+    return SCPE_MEM;
+    }
+if (headless)
+    vid_headless_fb = fb;
+return SCPE_OK;
+}
+
+void vid_fb_free (VID_FRAMEBUFFER *fb)
+{
+if (vid_headless_fb == fb)
+    vid_headless_fb = NULL;
+free (fb->pixels);
+free (fb->dirty);
+free (fb->region);
+memset (fb, 0, sizeof (*fb));
+}
+
+/* Headless framebuffers hold 0xAARRGGBB pixels, others the display's format */
+
+uint32 vid_fb_map_rgb (VID_FRAMEBUFFER *fb, uint8 r, uint8 g, uint8 b)
+{
+if (fb->headless)
+    return 0xFF000000 | (r << 16) | (g << 8) | b;
+if (fb->vptr)
+    return vid_map_rgb_window (fb->vptr, r, g, b);
+return vid_map_rgb (r, g, b);
+}
+
+void vid_fb_mark (VID_FRAMEBUFFER *fb, int32 x, int32 y, int32 w, int32 h)
+{
+int32 tx, ty, tx1, ty1;
+uint8 *row;
+
+if (x < 0) {                                            /* clip to framebuffer */
+    w += x;
+    x = 0;
+    }
+if (y < 0) {
+    h += y;
+    y = 0;
+    }
+if ((x + w) > fb->width)
+    w = fb->width - x;
+if ((y + h) > fb->height)
+    h = fb->height - y;
+if ((w <= 0) || (h <= 0))
+    return;
+tx1 = (x + w - 1) / fb->tile_w;
+ty1 = (y + h - 1) / fb->tile_h;
+for (ty = y / fb->tile_h; ty <= ty1; ty++) {
+    row = &fb->dirty[ty * fb->tiles_x];
+    for (tx = x / fb->tile_w; tx <= tx1; tx++) {
+        if (!row[tx]) {
+            row[tx] = 1;
+            ++fb->dirty_count;
+            }
+        }
+    }
+}
+
+/* Send a region, in tiles, to the display */
+
+static void _vid_fb_draw (VID_FRAMEBUFFER *fb, int32 tx, int32 ty, int32 tw, int32 th)
+{
+int32 x = tx * fb->tile_w;
+int32 y = ty * fb->tile_h;
+int32 w = tw * fb->tile_w;
+int32 h = th * fb->tile_h;
+uint32 *buf;
+int32 i;
+
+if (fb->headless)
+    return;
+if ((x + w) > fb->width)                                /* partial last tiles */
+    w = fb->width - x;
+if ((y + h) > fb->height)
+    h = fb->height - y;
+if (w == fb->width)                                     /* full width? */
+    buf = &fb->pixels[y * fb->width];                   /* already contiguous */
+else {
+    buf = fb->region;
+    for (i = 0; i < h; i++)
+        memcpy (&buf[i * w], &fb->pixels[(y + i) * fb->width + x], w * sizeof (*buf));
+    }
+if (fb->vptr)
+    vid_draw_window (fb->vptr, x, y, w, h, buf);
+else
+    vid_draw (x, y, w, h, buf);
+}
+
+/* Send the dirty tiles to the display
+
+   Runs of dirty tiles in a tile row become one region, and identical
+   runs in following tile rows are merged into it.  Returns the number
+   of regions, 0 if nothing changed since the last flush.
+*/
+
+int32 vid_fb_flush (VID_FRAMEBUFFER *fb)
+{
+int32 tx, ty, x0;
+int32 rx = -1, ry = 0, rw = 0, rh = 0;                  /* pending region, in tiles */
+int32 regions = 0;
+uint8 *row;
+
+if (fb->dirty_count == 0)
+    return 0;
+for (ty = 0; ty < fb->tiles_y; ty++) {
+    row = &fb->dirty[ty * fb->tiles_x];
+    tx = 0;
+    while (tx < fb->tiles_x) {
+        if (!row[tx]) {
+            ++tx;
+            continue;
+            }
+        for (x0 = tx; (tx < fb->tiles_x) && row[tx]; tx++)
+            row[tx] = 0;
+        if ((rx == x0) && (rw == (tx - x0)) && ((ry + rh) == ty))
+            ++rh;                                       /* extend pending region down */
+        else {
+            if (rx >= 0) {
+                _vid_fb_draw (fb, rx, ry, rw, rh);
+                ++regions;
+                }
+            rx = x0;
+            ry = ty;
+            rw = tx - x0;
+            rh = 1;
+            }
+        }
+    }
+_vid_fb_draw (fb, rx, ry, rw, rh);
+fb->dirty_count = 0;
+return regions + 1;
+}
+
+static void _vid_put_le (uint8 *p, uint32 val, int32 bytes)
+{
+while (bytes--) {
+    *p++ = (uint8)val;
+    val >>= 8;
+    }
+}
+
+/* Save a headless framebuffer as a 24bpp BMP file */
+
+t_stat vid_fb_save_bmp (VID_FRAMEBUFFER *fb, const char *filename)
+{
+uint32 row_size = ((fb->width * 3) + 3) & ~3;           /* rows are padded to 4 bytes */
+uint32 *src;
+uint8 hdr[54];
+uint8 *row;
+int32 x, y;
+FILE *f;
+
+if (!fb->headless)
+    return SCPE_NOFNC;
+row = (uint8 *)calloc (row_size, 1);
+if (row == NULL)
+    return SCPE_MEM;
+f = sim_fopen (filename, "wb");
+if (f == NULL) {
+    free (row);
+    return SCPE_OPENERR;
+    }
+memset (hdr, 0, sizeof (hdr));
+hdr[0] = 'B';                                           /* BITMAPFILEHEADER */
+hdr[1] = 'M';
+_vid_put_le (&hdr[2], sizeof (hdr) + row_size * fb->height, 4);
+_vid_put_le (&hdr[10], sizeof (hdr), 4);
+_vid_put_le (&hdr[14], 40, 4);                          /* BITMAPINFOHEADER */
+_vid_put_le (&hdr[18], fb->width, 4);
+_vid_put_le (&hdr[22], fb->height, 4);                  /* bottom up */
+_vid_put_le (&hdr[26], 1, 2);                           /* planes */
+_vid_put_le (&hdr[28], 24, 2);                          /* bits per pixel */
+_vid_put_le (&hdr[34], row_size * fb->height, 4);
+fwrite (hdr, 1, sizeof (hdr), f);
+for (y = fb->height - 1; y >= 0; y--) {
+    src = &fb->pixels[y * fb->width];
+    for (x = 0; x < fb->width; x++)
+        _vid_put_le (&row[x * 3], src[x], 3);           /* B, G, R */
+    fwrite (row, 1, row_size, f);
+    }
+free (row);
+if (ferror (f)) {
+    fclose (f);
+    return SCPE_IOERR;
+    }
+fclose (f);
+return SCPE_OK;
+}
+
+static t_stat vid_headless_screenshot (const char *filename)
+{
+char *fullname = (char *)malloc (strlen (filename) + 5);
+t_stat r;
+
+if (fullname == NULL)
+    return SCPE_MEM;
+sprintf (fullname, "%s%s", filename, match_ext (filename, "bmp") ? "" : ".bmp");
+r = vid_fb_save_bmp (vid_headless_fb, fullname);
+if (r != SCPE_OK)
+    sim_printf ("Error saving screenshot to %s: %s\n", fullname, sim_error_text (r));
+else {
+    if (!sim_quiet)
+        sim_printf ("Screenshot saved to %s\n", fullname);
+    }
+free (fullname);
+return (r == SCPE_OK) ? r : (r | SCPE_NOMESSAGE);
+}
+
+/* Pixel expansion
+
+   These convert a run of packed pixels to 32bpp through a palette.  The
+   inner loops are branch free so compilers can vectorize them, and
+   1bpp words which are all background or all foreground, as most of a
+   mostly static screen is, are stored as a fill.
+*/
+
+/* 1bpp, least significant bit first in 32 bit words */
+
+void vid_expand_1bpp (uint32 *dst, const uint32 *src, int32 pixels, const uint32 *palette)
+{
+uint32 p0 = palette[0];
+uint32 pdiff = palette[0] ^ palette[1];
+uint32 bits, fill;
+int32 i, n;
+
+for (; pixels > 0; pixels -= 32, dst += 32) {
+    bits = *src++;
+    n = (pixels < 32) ? pixels : 32;
+    if ((bits == 0) || (bits == 0xFFFFFFFF)) {
+        fill = palette[bits & 1];
+        for (i = 0; i < n; i++)
+            dst[i] = fill;
+        }
+    else {
+        for (i = 0; i < n; i++)
+            dst[i] = p0 ^ (pdiff & (0 - ((bits >> i) & 1)));
+        }
+    }
+}
+
+/* 4bpp, low nibble first */
+
+void vid_expand_4bpp (uint32 *dst, const uint8 *src, int32 pixels, const uint32 *palette)
+{
+int32 i;
+
+for (i = 0; i < (pixels >> 1); i++) {
+    dst[2 * i] = palette[src[i] & 0xF];
+    dst[2 * i + 1] = palette[src[i] >> 4];
+    }
+if (pixels & 1)
+    dst[pixels - 1] = palette[src[i] & 0xF];
+}
+
+/* 8bpp */
+
+void vid_expand_8bpp (uint32 *dst, const uint8 *src, int32 pixels, const uint32 *palette)
+{
+int32 i;
+
+for (i = 0; i < pixels; i++)
+    dst[i] = palette[src[i]];
+}
+
+/* Self test for the expansion and dirty tile routines */
+
+t_stat vid_framebuffer_test (void)
+{
+static const uint32 bits[3] = { 0x00000000, 0xA5C3F00F, 0xFFFFFFFF };
+static const char *bmp_file = "TestVideo.bmp";
+uint32 palette[256];
+uint32 out[96];
+uint8 bytes[64];
+VID_FRAMEBUFFER fb;
+int32 i, regions;
+t_offset size;
+t_stat r = SCPE_OK;
+
+sim_printf ("Testing video framebuffer:\n");
+for (i = 0; i < 256; i++)
+    palette[i] = 0xFF000000 | (i * 0x010203);
+for (i = 0; i < 64; i++)
+    bytes[i] = (uint8)(i * 37 + 11);
+vid_expand_1bpp (out, bits, 90, palette);
+for (i = 0; i < 90; i++)
+    if (out[i] != palette[(bits[i >> 5] >> (i & 0x1F)) & 1])
+        return sim_messagef (SCPE_IERR, "1bpp expansion wrong at pixel %d\n", i);
+vid_expand_4bpp (out, bytes, 91, palette);
+for (i = 0; i < 91; i++)
+    if (out[i] != palette[(bytes[i >> 1] >> ((i & 1) << 2)) & 0xF])
+        return sim_messagef (SCPE_IERR, "4bpp expansion wrong at pixel %d\n", i);
+vid_expand_8bpp (out, bytes, 64, palette);
+for (i = 0; i < 64; i++)
+    if (out[i] != palette[bytes[i]])
+        return sim_messagef (SCPE_IERR, "8bpp expansion wrong at pixel %d\n", i);
+sim_printf ("  Pixel expansion: OK\n");
+
+if (vid_fb_init (&fb, NULL, 100, 50, 16, 16, TRUE) != SCPE_OK)
+    return sim_messagef (SCPE_MEM, "Can't allocate framebuffer\n");
+if ((fb.tiles_x != 7) || (fb.tiles_y != 4))
+    r = sim_messagef (SCPE_IERR, "Wrong tile layout: %dx%d\n", fb.tiles_x, fb.tiles_y);
+if ((r == SCPE_OK) && (vid_fb_flush (&fb) != 0))
+    r = sim_messagef (SCPE_IERR, "Clean framebuffer flushed regions\n");
+vid_fb_mark (&fb, 5, 5, 1, 1);
+vid_fb_mark (&fb, -10, 0, 200, 10);                     /* clipped, overlaps the first */
+if ((r == SCPE_OK) && (fb.dirty_count != 7))
+    r = sim_messagef (SCPE_IERR, "Expected 7 dirty tiles, have %d\n", fb.dirty_count);
+if ((r == SCPE_OK) && ((regions = vid_fb_flush (&fb)) != 1))
+    r = sim_messagef (SCPE_IERR, "Expected 1 region for a full tile row, have %d\n", regions);
+vid_fb_mark (&fb, 20, 20, 20, 20);                      /* 2 tiles by 2 tiles */
+vid_fb_mark (&fb, 99, 49, 5, 5);                        /* last tile */
+if ((r == SCPE_OK) && (fb.dirty_count != 5))
+    r = sim_messagef (SCPE_IERR, "Expected 5 dirty tiles, have %d\n", fb.dirty_count);
+if ((r == SCPE_OK) && ((regions = vid_fb_flush (&fb)) != 2))
+    r = sim_messagef (SCPE_IERR, "Expected 2 regions, have %d\n", regions);
+if ((r == SCPE_OK) && (fb.dirty_count != 0))
+    r = sim_messagef (SCPE_IERR, "Tiles still dirty after flush\n");
+if (r == SCPE_OK)
+    sim_printf ("  Dirty tile tracking: OK\n");
+for (i = 0; i < fb.height; i++)
+    vid_expand_1bpp (&fb.pixels[i * fb.width], bits, 90, palette);
+if ((r == SCPE_OK) && (vid_fb_save_bmp (&fb, bmp_file) != SCPE_OK))
+    r = sim_messagef (SCPE_IERR, "Can't save %s\n", bmp_file);
+if (r == SCPE_OK) {
+    size = sim_fsize_name_ex (bmp_file);
+    if (size != (54 + 300 * 50))
+        r = sim_messagef (SCPE_IERR, "%s is %u bytes, expected %u\n", bmp_file, (uint32)size, 54 + 300 * 50);
+    else
+        sim_printf ("  Headless screenshot: OK\n");
+    }
+(void)remove (bmp_file);
+vid_fb_free (&fb);
+return r;
+}
+
 #if defined(USE_SIM_VIDEO) && defined(HAVE_LIBSDL)
 
 static const char *vid_dname (DEVICE *dev)
@@ -2643,6 +3009,8 @@ t_stat vid_screenshot (const char *filename)
 {
 SDL_Event user_event;
 
+if ((vid_active == 0) && (vid_headless_fb != NULL))
+    return vid_headless_screenshot (filename);
 _screenshot_stat = -1;
 _screenshot_filename = filename;
 
@@ -2826,6 +3194,8 @@ return SCPE_OK;
 
 t_stat vid_screenshot (const char *filename)
 {
+if (vid_headless_fb != NULL)
+    return vid_headless_screenshot (filename);
 sim_printf ("video support unavailable\n");
 return SCPE_NOFNC|SCPE_NOMESSAGE;
 }
@@ -231,6 +231,43 @@ t_stat vid_set_fullscreen_window (VID_DISPLAY *vptr, t_bool flag);
 void vid_set_cursor_position_window (VID_DISPLAY *vptr, int32 x, int32 y);        /* cursor position (set by calling code) */
 t_stat vid_set_alpha_mode (VID_DISPLAY *vptr, int mode);
 
+/* Framebuffer with dirty tile tracking
+
+   A device renders into the 32bpp pixels of a VID_FRAMEBUFFER (usually
+   with the vid_expand_* routines), marks the areas it changed with
+   vid_fb_mark, and calls vid_fb_flush to send only the dirty tiles to
+   the display.  A headless framebuffer has no display window: the
+   pixels are the rendered image, and SCREENSHOT saves them as a BMP
+   file.  This allows display devices to run and be checked on hosts
+   without a window system, or without SDL support.
+*/
+
+typedef struct VID_FRAMEBUFFER {
+    VID_DISPLAY *vptr;                                    /* display window (NULL = default window) */
+    t_bool headless;                                      /* render to memory only */
+    int32 width;                                          /* size in pixels */
+    int32 height;
+    uint32 *pixels;                                       /* image, width*height pixels */
+    int32 tile_w;                                         /* tile size in pixels */
+    int32 tile_h;
+    int32 tiles_x;                                        /* tiles across */
+    int32 tiles_y;                                        /* tiles down */
+    uint8 *dirty;                                         /* per tile dirty flags */
+    int32 dirty_count;                                    /* count of dirty tiles */
+    uint32 *region;                                       /* staging buffer for partial width regions */
+    } VID_FRAMEBUFFER;
+
+t_stat vid_fb_init (VID_FRAMEBUFFER *fb, VID_DISPLAY *vptr, int32 width, int32 height, int32 tile_w, int32 tile_h, t_bool headless);
+void vid_fb_free (VID_FRAMEBUFFER *fb);
+uint32 vid_fb_map_rgb (VID_FRAMEBUFFER *fb, uint8 r, uint8 g, uint8 b);
+void vid_fb_mark (VID_FRAMEBUFFER *fb, int32 x, int32 y, int32 w, int32 h);
+int32 vid_fb_flush (VID_FRAMEBUFFER *fb);
+t_stat vid_fb_save_bmp (VID_FRAMEBUFFER *fb, const char *filename);
+void vid_expand_1bpp (uint32 *dst, const uint32 *src, int32 pixels, const uint32 *palette);
+void vid_expand_4bpp (uint32 *dst, const uint8 *src, int32 pixels, const uint32 *palette);
+void vid_expand_8bpp (uint32 *dst, const uint8 *src, int32 pixels, const uint32 *palette);
+t_stat vid_framebuffer_test (void);
+
 /* A device simulator can optionally set the vid_display_kb_event_process
  * routine pointer to the address of a routine.
  * Simulator code which uses the display library which processes window 